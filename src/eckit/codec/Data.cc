@@ -25,15 +25,33 @@ namespace eckit::codec {
 
 Data::Data(void* p, size_t size) : buffer_(p, size), size_(size) {}
 
+Data::Data(Buffer&& buffer, size_t size) : buffer_(std::move(buffer)), size_(size) {
+    ASSERT(buffer_.size() >= size_);
+}
+
+Data::Data(const void* p, size_t size, std::shared_ptr<const void> owner) :
+    size_(size), view_(p), owner_(std::move(owner)) {
+    ASSERT(owner_);
+}
+
+void Data::release_view() {
+    if (view_ != nullptr) {
+        view_ = nullptr;
+        owner_.reset();
+        size_ = 0;
+    }
+}
+
 std::uint64_t Data::write(Stream& out) const {
     if (size() > 0) {
-        ASSERT(buffer_.size() >= size());
-        return out.write(buffer_.data(), size());
+        ASSERT(view_ != nullptr || buffer_.size() >= size());
+        return out.write(data(), size());
     }
     return 0;
 }
 
 std::uint64_t Data::read(Stream& in, size_t size) {
+    release_view();
     if (size > size_) {
         buffer_.resize(size);
         size_ = size;
@@ -50,7 +68,9 @@ void Data::compress(const std::string& compression) {
         }
 
         Buffer compressed(static_cast<size_t>(1.2 * static_cast<double>(size_)));
-        size_   = compressor->compress(buffer_, size_, compressed);
+        auto size = compressor->compress(data(), size_, compressed);
+        release_view();
+        size_   = size;
         buffer_ = std::move(compressed);
     }
 }
@@ -62,30 +82,37 @@ void Data::decompress(const std::string& compression, size_t uncompressed_size)
     }
 
     Buffer uncompressed(static_cast<size_t>(1.2 * static_cast<double>(uncompressed_size)));
-    compressor->uncompress(buffer_, size_, uncompressed, uncompressed_size);
+    compressor->uncompress(data(), size_, uncompressed, uncompressed_size);
+    release_view();
     size_   = uncompressed_size;
     buffer_ = std::move(uncompressed);
 }
 
 void Data::clear() {
+    release_view();
     buffer_ = Buffer{};
     size_   = 0;
 }
 
 std::string Data::checksum(const std::string& algorithm) const {
-    return codec::checksum(buffer_, size_, algorithm);
+    return codec::checksum(data(), size_, algorithm);
 }
 
 void Data::assign(const Data& other) {
+    if (&other == this) {
+        return;
+    }
+    release_view();
     if (other.size() > buffer_.size()) {
         buffer_.resize(other.size());
     }
     size_ = other.size();
-    buffer_.copy(other.buffer_, size_);
+    buffer_.copy(other.data(), size_);
 }
 
 void Data::assign(const void* p, size_t s) {
-    if (s > size()) {
+    release_view();
+    if (s > buffer_.size()) {
         buffer_.resize(s);
     }
     size_ = s;
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 
 #include "eckit/io/Buffer.h"
 
@@ -27,13 +28,23 @@ public:
     Data() = default;
     Data(void*, size_t);
 
+    /// Takes the first size bytes of buffer, without copy
+    Data(Buffer&& buffer, size_t size);
+
+    /// View of memory kept alive by owner, e.g. a MappedFile; nothing is copied.
+    /// Modifying operations (read, assign, compress, decompress) replace the view by owned memory.
+    Data(const void*, size_t, std::shared_ptr<const void> owner);
+
     Data(Data&&)            = default;
     Data& operator=(Data&&) = default;
 
     operator const void*() const { return data(); }
-    const void* data() const { return buffer_.data(); }
+    const void* data() const { return view_ != nullptr ? view_ : buffer_.data(); }
     size_t size() const { return size_; }
 
+    /// @returns what keeps a view alive, null if the memory is owned
+    const std::shared_ptr<const void>& owner() const { return owner_; }
+
     void assign(const Data& other);
     void assign(const void*, size_t);
     void clear();
@@ -45,8 +56,12 @@ public:
     std::string checksum(const std::string& algorithm = "") const;
 
 private:
+    void release_view();
+
     Buffer buffer_;
     size_t size_{0};
+    const void* view_{nullptr};
+    std::shared_ptr<const void> owner_;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
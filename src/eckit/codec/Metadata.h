@@ -58,6 +58,7 @@ public:
     // extended LocalConfiguration:
     using LocalConfiguration::set;
     Metadata& set(const LocalConfiguration& other) {
+        resetIndex();
         auto& root             = const_cast<Value&>(get());
         const auto& other_root = other.get();
         std::vector<std::string> other_keys;
@@ -79,6 +80,7 @@ public:
 
 
     Metadata& remove(const std::string& name) {
+        resetIndex();
         auto& root = const_cast<Value&>(get());
         root.remove(name);
         return *this;
@@ -31,6 +31,7 @@ static std::string stream_path(Stream stream) {
 ReadRequest::ReadRequest(const std::string& URI, Decoder* decoder) :
     uri_(URI), decoder_(decoder), item_(new RecordItem()) {
     do_checksum_ = defaults::checksum_read();
+    do_mmap_     = defaults::mmap_read();
     ASSERT(!uri_.empty());
 }
 
@@ -55,6 +56,10 @@ ReadRequest::ReadRequest(ReadRequest&& other) :
     decoder_(std::move(other.decoder_)),
     item_(std::move(other.item_)),
     do_checksum_{other.do_checksum_},
+    do_mmap_{other.do_mmap_},
+    checksum_deferred_{other.checksum_deferred_},
+    slice_{std::move(other.slice_)},
+    slice_pending_{other.slice_pending_},
     finished_{other.finished_} {
     other.do_checksum_ = true;
     other.finished_    = true;
@@ -74,12 +79,23 @@ ReadRequest::~ReadRequest() {
 
 void ReadRequest::read() {
     if (item_->empty()) {
+        auto read_item = [this](RecordItemReader&& reader) {
+            if (slice_) {
+                reader.slice(*slice_);
+            }
+            reader.read(*item_);
+        };
+
         if (stream_) {
-            RecordItemReader{stream_, offset_, key_}.read(*item_);
+            read_item(RecordItemReader{stream_, offset_, key_});
         }
         else {
-            RecordItemReader(uri_).read(*item_);
+            RecordItemReader reader(uri_);
+            reader.mmap(do_mmap_);
+            read_item(std::move(reader));
         }
+
+        slice_pending_ = slice_ && item_->metadata().data.compressed();
     }
 }
 
@@ -89,6 +105,14 @@ void ReadRequest::checksum(bool b) {
     do_checksum_ = b;
 }
 
+void ReadRequest::mmap(bool b) {
+    do_mmap_ = b;
+}
+
+void ReadRequest::slice(const ArraySlice& s) {
+    slice_ = s;
+}
+
 void ReadRequest::checksum() {
     if (not do_checksum_) {
         return;
@@ -97,6 +121,7 @@ void ReadRequest::checksum() {
     Checksum encoded_checksum{item_->metadata().data.checksum()};
 
     if (not encoded_checksum.available()) {
+        release_deferred();
         return;
     }
 
@@ -110,6 +135,14 @@ void ReadRequest::checksum() {
         throw DataCorruption(err.str());
     }
     do_checksum_ = false;
+    release_deferred();
+}
+
+void ReadRequest::release_deferred() {
+    if (checksum_deferred_) {
+        checksum_deferred_ = false;
+        item_->clear();
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -117,6 +150,20 @@ void ReadRequest::checksum() {
 void ReadRequest::decompress() {
     read();
     item_->decompress();
+
+    if (slice_pending_) {
+        auto metadata = slice_->metadata(item_->metadata());
+        ArrayMetadata array(item_->metadata());
+        ASSERT(item_->data().size() >= array.bytes());
+
+        auto size = metadata.data.size();
+        Buffer sliced(size);
+        slice_->extract(item_->data().data(), array.shape(), array.datatype().size(), sliced);
+
+        item_->metadata(metadata);
+        item_->data(Data(std::move(sliced), size));
+        slice_pending_ = false;
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -124,7 +171,9 @@ void ReadRequest::decompress() {
 void ReadRequest::decode() {
     decompress();
     codec::decode(item_->metadata(), item_->data(), *decoder_);
-    item_->clear();
+    if (not checksum_deferred_) {
+        item_->clear();
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -133,7 +182,14 @@ void ReadRequest::wait() {
     if (item_) {
         if (not finished_) {
             read();
-            checksum();
+            // Only views would not read all pages of the mapping anyway
+            if (do_mmap_ && do_checksum_ && item_->data().owner() && not item_->metadata().data.compressed() &&
+                decoder_->view()) {
+                checksum_deferred_ = true;  // keep the view for checksum()
+            }
+            else {
+                checksum();
+            }
             decompress();
             decode();
         }
@@ -14,10 +14,12 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "eckit/codec/RecordItem.h"
 #include "eckit/codec/detail/Decoder.h"
+#include "eckit/codec/types/array/ArraySlice.h"
 
 namespace eckit::codec {
 
@@ -54,10 +56,20 @@ public:
 
     void checksum(bool);
 
+    /// Map the record file and decode from views into it (file based requests only).
+    /// Checksums of uncompressed items decoded into an ArrayReference are then not verified by wait(), which would
+    /// read all pages of the mapping, but by a later call to checksum(). Other types copy the data, and are verified.
+    void mmap(bool);
+
+    /// Decode only a slice of an array item, see RecordItemReader::slice()
+    void slice(const ArraySlice&);
+
 private:
     ReadRequest(const std::string& URI, Decoder* decoder);
     ReadRequest(Stream, size_t offset, const std::string& key, Decoder*);
 
+    void release_deferred();
+
     Stream stream_;
     size_t offset_;
     std::string key_;
@@ -65,6 +77,10 @@ private:
     std::unique_ptr<Decoder> decoder_;
     std::unique_ptr<RecordItem> item_;
     bool do_checksum_{true};
+    bool do_mmap_{false};
+    bool checksum_deferred_{false};
+    std::optional<ArraySlice> slice_;
+    bool slice_pending_{false};  ///< compressed item read whole, sliced after decompression
     bool finished_{false};
 };
 
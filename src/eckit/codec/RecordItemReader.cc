@@ -12,12 +12,15 @@
 
 #include "eckit/codec/RecordItemReader.h"
 
+#include <cstring>
+
 #include "eckit/codec/Exceptions.h"
 #include "eckit/codec/FileStream.h"
 #include "eckit/codec/Record.h"
 #include "eckit/codec/Session.h"
 #include "eckit/codec/detail/ParsedRecord.h"
 #include "eckit/codec/detail/RecordSections.h"
+#include "eckit/io/MappedFile.h"
 
 namespace eckit::codec {
 
@@ -78,6 +81,132 @@ Data read_data(const Record& record, int data_section_index, Stream in) {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+Data map_data(const Record& record, int data_section_index, const std::shared_ptr<const MappedFile>& file) {
+    if (data_section_index == 0) {
+        return {};
+    }
+
+    const auto& parsed       = static_cast<const ParsedRecord&>(record);
+    const auto& data_section = parsed.data_sections.at(static_cast<size_t>(data_section_index) - 1);
+
+    auto offset = static_cast<size_t>(data_section.offset);
+    auto length = static_cast<size_t>(data_section.length);
+    if (length < sizeof(RecordDataSection::Begin) + sizeof(RecordDataSection::End) || offset > file->size()
+        || length > file->size() - offset) {
+        throw InvalidRecord("Data section is not valid");
+    }
+
+    const auto* section = static_cast<const char*>(file->data()) + offset;
+
+    RecordDataSection::Begin data_begin;
+    RecordDataSection::End data_end;
+    std::memcpy(reinterpret_cast<char*>(&data_begin), section, sizeof(data_begin));
+    std::memcpy(reinterpret_cast<char*>(&data_end), section + length - sizeof(data_end), sizeof(data_end));
+    if (not data_begin.valid() || not data_end.valid()) {
+        throw InvalidRecord("Data section is not valid");
+    }
+
+    auto data_size = length - sizeof(RecordDataSection::Begin) - sizeof(RecordDataSection::End);
+    return {section + sizeof(RecordDataSection::Begin), data_size, file};
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+const RecordDataIndexSection::Entry& data_section(const Record& record, int data_section_index) {
+    const auto& parsed = static_cast<const ParsedRecord&>(record);
+    return parsed.data_sections.at(static_cast<size_t>(data_section_index) - 1);
+}
+
+// Reads the byte ranges of a slice of the data in a section, ranges less than max_gap apart in one read
+Data read_data_slice(const Record& record, const Metadata& metadata, const ArraySlice& slice, Stream in) {
+    constexpr size_t max_gap = 64 * 1024;
+
+    const auto& section = data_section(record, metadata.data.section());
+    in.seek(section.offset);
+    auto data_begin = read_struct<RecordDataSection::Begin>(in);
+    if (not data_begin.valid()) {
+        throw InvalidRecord("Data section is not valid");
+    }
+    const auto begin = static_cast<size_t>(section.offset) + sizeof(RecordDataSection::Begin);
+
+    ArrayMetadata array(metadata);
+    std::vector<std::pair<size_t, size_t>> ranges;
+    slice.ranges(array.shape(), array.datatype().size(),
+                 [&](size_t offset, size_t length) { ranges.emplace_back(offset, length); });
+
+    if (array.bytes() + sizeof(RecordDataSection::Begin) + sizeof(RecordDataSection::End) > section.length) {
+        throw InvalidRecord("Data section is smaller than its array");
+    }
+
+    const auto size = slice.size() * array.datatype().size();
+
+    Buffer buffer(size);
+    Buffer scratch;
+    char* out = buffer;
+    for (size_t first = 0; first < ranges.size();) {
+        size_t last = first;
+        while (last + 1 < ranges.size()
+               && ranges[last + 1].first - (ranges[last].first + ranges[last].second) <= max_gap) {
+            ++last;
+        }
+
+        const auto span_begin = ranges[first].first;
+        const auto span       = ranges[last].first + ranges[last].second - span_begin;
+        in.seek(begin + span_begin);
+        if (first == last) {
+            if (in.read(out, span) != span) {
+                throw InvalidRecord("Unexpected EOF reached");
+            }
+            out += span;
+        }
+        else {
+            if (scratch.size() < span) {
+                scratch.resize(span);
+            }
+            if (in.read(scratch, span) != span) {
+                throw InvalidRecord("Unexpected EOF reached");
+            }
+            for (size_t r = first; r <= last; ++r) {
+                std::memcpy(out, scratch + (ranges[r].first - span_begin), ranges[r].second);
+                out += ranges[r].second;
+            }
+        }
+        first = last + 1;
+    }
+    return {std::move(buffer), size};
+}
+
+// A view when the slice is contiguous, else a copy of its ranges: only the pages of the slice are touched
+Data map_data_slice(const Record& record, const Metadata& metadata, const ArraySlice& slice,
+                    const std::shared_ptr<const MappedFile>& file) {
+    Data data = map_data(record, metadata.data.section(), file);
+
+    ArrayMetadata array(metadata);
+    if (array.bytes() > data.size()) {
+        throw InvalidRecord("Data section is smaller than its array");
+    }
+
+    const auto* in = static_cast<const char*>(data.data());
+    std::vector<std::pair<size_t, size_t>> ranges;
+    slice.ranges(array.shape(), array.datatype().size(),
+                 [&](size_t offset, size_t length) { ranges.emplace_back(offset, length); });
+
+    if (ranges.size() == 1) {
+        return {in + ranges[0].first, ranges[0].second, file};
+    }
+
+    const auto size = slice.size() * array.datatype().size();
+    Buffer buffer(size);
+    char* out = buffer;
+    for (const auto& range : ranges) {
+        std::memcpy(out, in + range.first, range.second);
+        out += range.second;
+    }
+    return {std::move(buffer), size};
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 PathName make_absolute_path(const std::string& reference_path, RecordItem::URI& uri) {
     PathName absolute_path = uri.path;
     if (!reference_path.empty() && uri.path[0] != '/' && uri.path[0] != '~') {
@@ -179,14 +308,23 @@ void RecordItemReader::read(Metadata& metadata, bool follow_links) {
 
 //---------------------------------------------------------------------------------------------------------------------
 
-static void read_from_stream(Record record, Stream in, const std::string& key, Metadata& metadata, Data& data) {
+static bool read_slice(const std::optional<ArraySlice>& slice, const Metadata& metadata) {
+    return slice && metadata.data.section() != 0 && not metadata.data.compressed();
+}
+
+static void read_from_stream(Record record, Stream in, const std::string& key, const std::optional<ArraySlice>& slice,
+                             Metadata& metadata, Data& data) {
     metadata = record.metadata(key);
 
     if (metadata.link()) {
         throw Exception("Cannot follow links in records that are not file based");
     }
 
-    if (metadata.data.section() != 0) {
+    if (read_slice(slice, metadata)) {
+        data     = read_data_slice(record, metadata, *slice, in);
+        metadata = slice->metadata(metadata);
+    }
+    else if (metadata.data.section() != 0) {
         data = read_data(record, metadata.data.section(), in);
     }
 }
@@ -194,7 +332,7 @@ static void read_from_stream(Record record, Stream in, const std::string& key, M
 
 void RecordItemReader::read(Metadata& metadata, Data& data) {
     if (in_) {
-        read_from_stream(record_, in_, uri_.key, metadata, data);
+        read_from_stream(record_, in_, uri_.key, slice_, metadata, data);
         return;
     }
 
@@ -204,11 +342,30 @@ void RecordItemReader::read(Metadata& metadata, Data& data) {
 
     if (metadata.link()) {
         Metadata linked;
-        RecordItemReader{absolute_path.dirName(), metadata.link()}.read(linked, data);
+        RecordItemReader linked_reader{absolute_path.dirName(), metadata.link()};
+        linked_reader.mmap(mmap_);
+        if (slice_) {
+            linked_reader.slice(*slice_);
+        }
+        linked_reader.read(linked, data);
         metadata.link(std::move(linked));
     }
+    else if (read_slice(slice_, metadata)) {
+        if (mmap_) {
+            data = map_data_slice(record_, metadata, *slice_, MappedFile::open(absolute_path.asString()));
+        }
+        else {
+            data = read_data_slice(record_, metadata, *slice_, InputFileStream(absolute_path));
+        }
+        metadata = slice_->metadata(metadata);
+    }
     else if (metadata.data.section() != 0) {
-        data = read_data(record_, metadata.data.section(), InputFileStream(absolute_path));
+        if (mmap_) {
+            data = map_data(record_, metadata.data.section(), MappedFile::open(absolute_path.asString()));
+        }
+        else {
+            data = read_data(record_, metadata.data.section(), InputFileStream(absolute_path));
+        }
     }
 };
 
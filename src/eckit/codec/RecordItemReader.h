@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 
 #include "eckit/codec/Record.h"
 #include "eckit/codec/RecordItem.h"
 #include "eckit/codec/Stream.h"
+#include "eckit/codec/types/array/ArraySlice.h"
 
 namespace eckit::codec {
 
@@ -36,6 +38,14 @@ public:
 
     void read(Metadata&, Data&);
 
+    /// Read data of file based records as views into a shared mapping of the file, instead of copying it.
+    void mmap(bool on) { mmap_ = on; }
+
+    /// Read only a slice of an array item. For uncompressed data only the byte ranges of the slice are read, and the
+    /// item gets the metadata of the slice (without checksum). Compressed data is read whole, to be sliced by the
+    /// caller after decompression.
+    void slice(const ArraySlice& slice) { slice_ = slice; }
+
 private:
     RecordItemReader(const std::string& ref, const std::string& uri);
 
@@ -44,6 +54,9 @@ private:
 
     std::string ref_{};  // directory to which relative URI's are evaluated
     RecordItem::URI uri_;
+
+    bool mmap_{false};
+    std::optional<ArraySlice> slice_;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -80,6 +80,24 @@ void RecordReader::checksum(bool b) {
     do_checksum_ = b ? 1 : 0;
 }
 
+void RecordReader::mmap(bool b) {
+    do_mmap_ = b ? 1 : 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void RecordReader::verify(const std::string& key) {
+    auto& request = requests_.at(key);
+    request.wait();
+    request.checksum();
+}
+
+void RecordReader::verify() {
+    for (auto& pair : requests_) {
+        verify(pair.first);
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::codec
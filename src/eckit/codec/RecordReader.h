@@ -44,9 +44,21 @@ public:
         if (do_checksum_ >= 0) {
             requests_.at(key).checksum(do_checksum_);
         }
+        if (do_mmap_ >= 0) {
+            requests_.at(key).mmap(do_mmap_);
+        }
         return requests_.at(key);
     }
 
+    /// Read only a slice of an array item, decoded with the shape of the slice.
+    /// Without compression only the byte ranges of the slice are read, and no checksum is verified.
+    template <typename T>
+    ReadRequest& read(const std::string& key, T& value, const ArraySlice& slice) {
+        auto& request = read(key, value);
+        request.slice(slice);
+        return request;
+    }
+
     void wait(const std::string& key);
 
     void wait();
@@ -57,6 +69,17 @@ public:
 
     void checksum(bool);
 
+    /// Read items of file based records through a shared mapping of the file. Uncompressed items decoded into an
+    /// ArrayReference then point into the mapping, without copy, and their checksums are only verified by verify().
+    /// Other types copy the data, and their checksums are verified by wait() as without mmap.
+    /// RecordWriter aligns data sections; sections not aligned on their element size, e.g. of older records, are copied.
+    void mmap(bool);
+
+    /// Verify the checksums that were deferred in mmap mode
+    void verify(const std::string& key);
+
+    void verify();
+
 private:
     Record::URI uri() const;
 
@@ -75,6 +98,7 @@ private:
     std::uint64_t offset_;
 
     int do_checksum_{-1};
+    int do_mmap_{-1};
 };
 
 //---------------------------------------------------------------------------------------------------------------------
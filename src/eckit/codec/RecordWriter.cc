@@ -41,6 +41,25 @@ inline void write_string(OStream& out, const std::string& s) {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+/// Data sections are preceded by blanks so that their data is aligned within the record, and records are padded to a
+/// multiple of the alignment, so that a mapped file of records can be decoded into views without copy.
+/// Readers find sections by their offsets in the index.
+static constexpr size_t data_alignment = 16;
+
+/// @returns the number of blanks at position so that what follows a marker of the given size is aligned
+inline size_t padding(size_t position, size_t marker) {
+    return (data_alignment - (position + marker) % data_alignment) % data_alignment;
+}
+
+template <typename OStream>
+inline void write_padding(OStream& out, size_t blanks) {
+    if (blanks > 0) {
+        write_string(out, std::string(blanks, ' '));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 size_t RecordWriter::write(Stream out) const {
     RecordHead r;
 
@@ -92,6 +111,7 @@ size_t RecordWriter::write(Stream out) const {
             Data data;
             encode_data(encoder, data);
             data.compress(info.compression());
+            write_padding(out, padding(position(), sizeof(RecordDataSection::Begin)));
             auto& data_section  = index[i];
             data_section.offset = position();
             write_struct(out, RecordDataSection::Begin());
@@ -107,6 +127,7 @@ size_t RecordWriter::write(Stream out) const {
 
     // End Record
     // ----------
+    write_padding(out, padding(position(), sizeof(RecordEnd)));
     write_struct(out, RecordEnd());
     auto end_of_record = out.position();
 
@@ -196,12 +217,17 @@ size_t RecordWriter::estimateMaximumSize() const {
     size += static_cast<size_t>(nb_data_sections_) * sizeof(RecordDataIndexSection::Entry);
     size += sizeof(RecordDataIndexSection::End);
 
+    // Padding is exact as long as the sizes of the sections before are
+    bool exact = true;
+    auto pad   = [&](size_t marker) { size += exact ? padding(size, marker) : data_alignment - 1; };
+
     for (const auto& key : keys_) {
         const auto& encoder = encoders_.at(key);
         const auto& info    = info_.at(key);
         if (info.section() == 0) {
             continue;
         }
+        pad(sizeof(RecordDataSection::Begin));
         size += sizeof(RecordDataSection::Begin);
         {
             Metadata m;
@@ -209,12 +235,14 @@ size_t RecordWriter::estimateMaximumSize() const {
             if (info.compression() != "none") {
                 max_data_size = static_cast<size_t>(1.2 * static_cast<double>(max_data_size));
                 max_data_size = std::max<size_t>(max_data_size, 10 * 1024);  // minimum 10KB
+                exact         = false;
             }
             size += max_data_size;
         }
         size += sizeof(RecordDataSection::End);
     }
 
+    pad(sizeof(RecordEnd));
     size += sizeof(RecordEnd);
 
     return size;
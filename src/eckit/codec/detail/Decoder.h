@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <type_traits>
 
 #include "eckit/codec/Data.h"
 #include "eckit/codec/Metadata.h"
@@ -20,11 +21,16 @@
 
 namespace eckit::codec {
 
+class ArrayReference;
+
 class Decoder {
 public:
     template <typename T, enable_if_decodable_t<T> = 0>
     explicit Decoder(T& value) : self_(new DecodableItem<T>(value)) {}
 
+    /// @returns true if the decoded value may be a view of the data, rather than a copy
+    bool view() const { return self_->view_(); }
+
     friend void decode(const Metadata& metadata, const Data& data, Decoder&);
     friend void decode(const Metadata& metadata, const Data& data, Decoder&&);
 
@@ -32,6 +38,7 @@ private:
     struct Decodable {
         virtual ~Decodable()                               = default;
         virtual void decode_(const Metadata&, const Data&) = 0;
+        virtual bool view_() const                         = 0;
     };
 
     template <typename T>
@@ -40,6 +47,8 @@ private:
 
         void decode_(const Metadata& metadata, const Data& encoded) override { decode(metadata, encoded, data_); }
 
+        bool view_() const override { return std::is_same_v<T, ArrayReference>; }
+
         T& data_;
     };
 
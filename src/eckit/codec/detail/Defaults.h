@@ -28,6 +28,11 @@ namespace eckit::codec::defaults {
     return checksum;
 }
 
+[[maybe_unused]] static bool mmap_read() {
+    static const auto mmap = Resource<bool>("eckit.codec.mmap.read;$ECKIT_CODEC_MMAP_READ", false);
+    return mmap;
+}
+
 [[maybe_unused]] static bool checksum_write() {
     static const auto checksum = Resource<bool>("eckit.codec.checksum.write;$ECKIT_CODEC_CHECKSUM_WRITE", true);
     return checksum;
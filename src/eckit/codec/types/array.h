@@ -11,6 +11,7 @@
 #pragma once
 
 #include "eckit/codec/types/array/ArrayReference.h"
+#include "eckit/codec/types/array/ArraySlice.h"
 #include "eckit/codec/types/array/adaptors/StdArrayAdaptor.h"
 #include "eckit/codec/types/array/adaptors/StdVectorAdaptor.h"
 #include "eckit/codec/types/array/adaptors/StdVectorOfStdArrayAdaptor.h"
@@ -12,7 +12,12 @@
 
 #include "eckit/codec/types/array/ArrayReference.h"
 
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
 #include "eckit/codec/Exceptions.h"
+#include "eckit/io/Buffer.h"
 
 namespace eckit::codec {
 
@@ -61,13 +66,45 @@ size_t encode_metadata(const ArrayReference& value, Metadata& out) {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void decode(const Metadata& metadata, const Data& data, ArrayReference& out) {
+    ArrayMetadata array(metadata);
+    if (data.size() < array.bytes()) {
+        std::stringstream err;
+        err << "Could not decode " << metadata.json() << " into ArrayReference: " << data.size()
+            << " bytes of data for " << array.bytes() << " bytes of array.";
+        throw Exception(err.str(), Here());
+    }
+
+    static_cast<ArrayMetadata&>(out) = std::move(array);
+
+    // A view only if its elements are aligned, the data section follows metadata of any length
+    auto alignment = out.datatype().size();
+    bool aligned   = alignment == 0 || reinterpret_cast<std::uintptr_t>(data.data()) % alignment == 0;
+
+    if (data.owner() && aligned) {
+        out.owner_ = data.owner();
+        out.data_  = const_cast<void*>(data.data());
+    }
+    else {
+        auto buffer = std::make_shared<Buffer>(out.bytes());
+        if (out.bytes() > 0) {
+            std::memcpy(buffer->data(), data.data(), out.bytes());
+        }
+        out.data_  = buffer->data();
+        out.owner_ = std::move(buffer);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 ArrayReference::ArrayReference(const void* data, ArrayMetadata::DataType datatype,
                                const ArrayMetadata::ArrayShape& shape) :
     ArrayMetadata(datatype, shape), data_(const_cast<void*>(data)) {}
 
 //---------------------------------------------------------------------------------------------------------------------
 
-ArrayReference::ArrayReference(ArrayReference&& other) : ArrayMetadata(std::move(other)), data_(other.data_) {
+ArrayReference::ArrayReference(ArrayReference&& other) :
+    ArrayMetadata(std::move(other)), data_(other.data_), owner_(std::move(other.owner_)) {
     other.data_ = nullptr;
 }
 
@@ -76,6 +113,7 @@ ArrayReference::ArrayReference(ArrayReference&& other) : ArrayMetadata(std::move
 ArrayReference& ArrayReference::operator=(ArrayReference&& rhs) {
     ArrayMetadata::operator=(std::move(rhs));
     data_     = rhs.data_;
+    owner_    = std::move(rhs.owner_);
     rhs.data_ = nullptr;
     return *this;
 }
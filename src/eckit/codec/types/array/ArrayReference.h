@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "eckit/codec/Data.h"
 #include "eckit/codec/Metadata.h"
 #include "eckit/codec/types/array/ArrayMetadata.h"
@@ -36,10 +38,13 @@ public:
 
     void* data() const { return data_; }
 
+    /// Decodes without copying when the data is a view into a mapped record (RecordReader::mmap), keeping the
+    /// mapping alive as long as this reference. Other data is copied into memory shared by this reference.
     friend void decode(const Metadata&, const Data&, ArrayReference&);
 
 private:
     void* data_{nullptr};
+    std::shared_ptr<const void> owner_;  ///< keeps decoded data alive, null when referencing user memory
 };
 
 //---------------------------------------------------------------------------------------------------------------------
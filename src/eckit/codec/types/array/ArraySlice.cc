@@ -0,0 +1,150 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/codec/types/array/ArraySlice.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "eckit/codec/Exceptions.h"
+
+namespace eckit::codec {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+namespace {
+std::ostream& operator<<(std::ostream& out, const ArrayShape& shape) {
+    out << "[";
+    for (size_t i = 0; i < shape.size(); ++i) {
+        out << (i > 0 ? "," : "") << shape[i];
+    }
+    return out << "]";
+}
+}  // namespace
+
+//---------------------------------------------------------------------------------------------------------------------
+
+ArraySlice::ArraySlice(const ArrayShape& offsets, const ArrayShape& counts) : offsets_(offsets), counts_(counts) {
+    if (offsets_.size() != counts_.size()) {
+        std::stringstream err;
+        err << "ArraySlice: offsets " << offsets_ << " and counts " << counts_ << " have different ranks";
+        throw Exception(err.str(), Here());
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+size_t ArraySlice::size() const {
+    size_t size = 1;
+    for (auto count : counts_) {
+        size *= count;
+    }
+    return size;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void ArraySlice::check(const ArrayShape& shape) const {
+    bool valid = shape.size() == counts_.size();
+    for (size_t i = 0; valid && i < shape.size(); ++i) {
+        valid = offsets_[i] <= shape[i] && counts_[i] <= shape[i] - offsets_[i];
+    }
+    if (not valid) {
+        std::stringstream err;
+        err << "ArraySlice with offsets " << offsets_ << " and counts " << counts_ << " is not within shape " << shape;
+        throw Exception(err.str(), Here());
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void ArraySlice::ranges(const ArrayShape& shape, size_t element_size,
+                        const std::function<void(size_t, size_t)>& range) const {
+    check(shape);
+    if (size() == 0) {
+        return;
+    }
+
+    const auto rank = static_cast<int>(shape.size());
+
+    std::vector<size_t> stride(shape.size());
+    size_t base   = 0;
+    size_t extent = element_size;
+    for (int d = rank - 1; d >= 0; --d) {
+        stride[d] = extent;
+        base += offsets_[d] * extent;
+        extent *= shape[d];
+    }
+
+    // Trailing dimensions covered fully, and the one before, make a contiguous run
+    int d         = rank - 1;
+    size_t length = element_size;
+    while (d >= 0 && counts_[d] == shape[d]) {
+        length *= shape[d];
+        --d;
+    }
+    if (d >= 0) {
+        length *= counts_[d];
+    }
+
+    // Iterate over the leading dimensions [0, d)
+    std::vector<size_t> index(d > 0 ? d : 0, 0);
+    while (true) {
+        size_t offset = base;
+        for (size_t i = 0; i < index.size(); ++i) {
+            offset += index[i] * stride[i];
+        }
+        range(offset, length);
+
+        int i = static_cast<int>(index.size()) - 1;
+        while (i >= 0 && ++index[i] == counts_[i]) {
+            index[i] = 0;
+            --i;
+        }
+        if (i < 0) {
+            break;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void ArraySlice::extract(const void* array, const ArrayShape& shape, size_t element_size, void* out) const {
+    const auto* in = static_cast<const char*>(array);
+    auto* p        = static_cast<char*>(out);
+    ranges(shape, element_size, [&](size_t offset, size_t length) {
+        std::memcpy(p, in + offset, length);
+        p += length;
+    });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+Metadata ArraySlice::metadata(const Metadata& metadata) const {
+    ArrayMetadata array(metadata);
+    check(array.shape());
+
+    Metadata sliced(metadata);
+    sliced.remove("value");
+    sliced.set("shape", counts_);
+
+    auto bytes = size() * array.datatype().size();
+    sliced.data.compressed(false);
+    sliced.data.size(bytes);
+    sliced.data.compressed_size(bytes);
+    sliced.data.checksum("none");
+    return sliced;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::codec
@@ -0,0 +1,60 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include <functional>
+
+#include "eckit/codec/Metadata.h"
+#include "eckit/codec/types/array/ArrayMetadata.h"
+
+namespace eckit::codec {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/// Hyperslab of an array: offsets and counts per dimension, arrays being stored row-major.
+/// An array item read with a slice decodes as an array of shape counts().
+class ArraySlice {
+public:
+    ArraySlice() = default;
+
+    ArraySlice(const ArrayShape& offsets, const ArrayShape& counts);
+
+    const ArrayShape& offsets() const { return offsets_; }
+    const ArrayShape& counts() const { return counts_; }
+
+    int rank() const { return static_cast<int>(counts_.size()); }
+
+    /// Number of elements
+    size_t size() const;
+
+    /// @throws Exception if the slice is not within an array of that shape
+    void check(const ArrayShape&) const;
+
+    /// Calls range(offset, length) for each contiguous run of bytes of the slice, in increasing order of offset.
+    /// Runs span all trailing dimensions the slice covers fully.
+    void ranges(const ArrayShape&, size_t element_size, const std::function<void(size_t, size_t)>& range) const;
+
+    /// Copies the slice of an array of that shape into contiguous memory
+    void extract(const void* array, const ArrayShape&, size_t element_size, void* out) const;
+
+    /// Metadata of the sliced array item, of shape counts(), not compressed and without checksum
+    Metadata metadata(const Metadata&) const;
+
+private:
+    ArrayShape offsets_;
+    ArrayShape counts_;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::codec
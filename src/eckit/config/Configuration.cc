@@ -12,6 +12,11 @@
 /// @author Tiago Quintino
 /// @date   July 2015
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
 #include "eckit/config/Configuration.h"
 #include "eckit/config/LocalConfiguration.h"
 #include "eckit/exception/Exceptions.h"
@@ -35,16 +40,20 @@ public:
 //----------------------------------------------------------------------------------------------------------------------
 
 Configuration::Configuration(const Configuration& other, const std::string& path) :
-    root_(new Value(*other.root_)), separator_(other.separator_) {
-    bool found = false;
-    *root_     = lookUp(path, found);
-    if (!found) {
+    root_(new Value()), separator_(other.separator_) {
+    // Shares the index of the subtree with other, if it has one
+    Value scratch;
+    std::shared_ptr<const Index> index;
+    const Value* v = other.find(path, scratch, &index);
+    if (!v) {
         throw ConfigurationNotFound(path);
     }
+    *root_ = *v;
+    std::atomic_store(&index_, index);
 }
 
 Configuration::Configuration(const Configuration& other) :
-    root_(new Value(*other.root_)), separator_(other.separator_) {}
+    root_(new Value(*other.root_)), separator_(other.separator_), index_(std::atomic_load(&other.index_)) {}
 
 Configuration::Configuration(const eckit::Value& root, char separator) :
     root_(new Value(root)), separator_(separator) {}
@@ -52,6 +61,7 @@ Configuration::Configuration(const eckit::Value& root, char separator) :
 Configuration& Configuration::operator=(const Configuration& other) {
     *root_     = *other.root_;
     separator_ = other.separator_;
+    std::atomic_store(&index_, std::atomic_load(&other.index_));
     return *this;
 }
 
@@ -65,7 +75,222 @@ char Configuration::separator() const {
     return separator_;
 }
 
-eckit::Value Configuration::lookUp(const std::string& s, bool& found) const {
+namespace {
+
+const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const std::uint64_t FNV_PRIME  = 1099511628211ULL;
+
+inline std::uint64_t hashOf(std::uint64_t h, const char* p, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        h = (h ^ static_cast<unsigned char>(p[i])) * FNV_PRIME;
+    }
+    return h;
+}
+
+/// Not starting or ending with a separator, nor with two in a row, i.e. as Tokenizer would rebuild it
+bool normalised(const char* name, size_t length, char separator) {
+    if (length && (name[0] == separator || name[length - 1] == separator)) {
+        return false;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if (name[i] == separator && name[i - 1] == separator) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The values of one map, by key, in an open addressing hash table, built on first use. The index of a map in
+/// the map is built the first time a look-up goes through it, and shared with the sub-configurations of that map.
+/// Values are shared with the tree, not copied
+class Configuration::Index {
+public:
+    Index(const Value& map, char separator) :
+        map_(map), separator_(separator) {}
+
+    /// Walks down the indexes of the maps on the path, with the hash of each component if known
+    /// @returns the value, or nullptr if it is not there. Sets slow if the index cannot tell, when the path goes
+    /// through something else than a map, where the original look-up decides (and usually throws)
+    const Value* find(const char* path, size_t length, const std::uint64_t* hashes, bool& slow,
+                      std::shared_ptr<const Index>* sub) const {
+        const Index* index = this;
+        size_t begin       = 0;
+        for (size_t k = 0;; ++k) {
+            const char* p = static_cast<const char*>(::memchr(path + begin, separator_, length - begin));
+            size_t end    = p ? p - path : length;
+
+            if (!index->map_.isMap()) {
+                slow = true;
+                return nullptr;
+            }
+
+            std::uint64_t h = hashes ? hashes[k] : hashOf(FNV_OFFSET, path + begin, end - begin);
+            const Entry* e  = index->entry(path + begin, end - begin, h);
+            if (!e) {
+                return nullptr;
+            }
+
+            if (end == length) {
+                if (sub) {
+                    *sub = index->child(*e);
+                }
+                return &e->value;
+            }
+
+            index = index->child(*e).get();
+            begin = end + 1;
+        }
+    }
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        std::string key;
+        Value value;
+        mutable std::shared_ptr<const Index> child;  ///< index of value, created on first use
+    };
+
+    const Entry* entry(const char* key, size_t length, std::uint64_t hash) const {
+        std::call_once(built_, [this] { build(); });
+        for (size_t slot = hash & mask_; slots_[slot]; slot = (slot + 1) & mask_) {
+            const Entry& e = entries_[slots_[slot] - 1];
+            if (e.hash == hash && e.key.size() == length && e.key.compare(0, length, key, length) == 0) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<const Index> child(const Entry& e) const {
+        std::shared_ptr<const Index> index = std::atomic_load(&e.child);
+        if (!index) {
+            // Threads racing here agree on the same index
+            std::shared_ptr<const Index> created = std::make_shared<const Index>(e.value, separator_);
+            if (std::atomic_compare_exchange_strong(&e.child, &index, created)) {
+                index = created;
+            }
+        }
+        return index;
+    }
+
+    void build() const {
+        Value keys = map_.keys();
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const Value& key = keys[i];
+            if (!key.isString()) {
+                continue;
+            }
+
+            // A key containing the separator cannot be reached by name
+            std::string name = key;
+            if (name.empty() || name.find(separator_) != std::string::npos) {
+                continue;
+            }
+
+            Entry e = {hashOf(FNV_OFFSET, name.data(), name.size()), name, map_[key], nullptr};
+            entries_.push_back(e);
+        }
+
+        size_t size = 16;
+        while (size < 2 * entries_.size()) {
+            size *= 2;
+        }
+        slots_.assign(size, 0);
+        mask_ = size - 1;
+
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            size_t slot = entries_[i].hash & mask_;
+            while (slots_[slot]) {
+                slot = (slot + 1) & mask_;
+            }
+            slots_[slot] = i + 1;
+        }
+    }
+
+    Value map_;
+    char separator_;
+
+    mutable std::once_flag built_;
+    mutable std::vector<Entry> entries_;
+    mutable std::vector<size_t> slots_;  ///< entry + 1, 0 if free
+    mutable size_t mask_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Configuration::Key::Key(const std::string& name, char separator) :
+    name_(name), separator_(separator) {
+    eckit::Tokenizer parse(separator);
+    std::vector<std::string> path;
+    parse(name, path);
+
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (i) {
+            path_ += separator;
+        }
+        path_ += path[i];
+        hashes_.push_back(hashOf(FNV_OFFSET, path[i].data(), path[i].size()));
+    }
+}
+
+Configuration::Key::Key(const char* name, char separator) :
+    Key(std::string(name), separator) {}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const Configuration::Index> Configuration::index() const {
+    std::shared_ptr<const Index> index = std::atomic_load(&index_);
+    if (!index) {
+        // Threads racing here create equivalent indexes
+        index = std::make_shared<const Index>(*root_, separator_);
+        std::atomic_store(&index_, index);
+    }
+    return index;
+}
+
+void Configuration::resetIndex() {
+    std::atomic_store(&index_, std::shared_ptr<const Index>());
+}
+
+const Value* Configuration::find(const char* name, size_t length, const std::uint64_t* hashes, Value& scratch,
+                                 std::shared_ptr<const Index>* sub) const {
+    if (length == 0) {
+        if (sub) {
+            *sub = index();
+        }
+        return root_.get();
+    }
+
+    if (normalised(name, length, separator_)) {
+        // The indexes are kept by index_ until root_ changes
+        bool slow      = false;
+        const Value* v = index()->find(name, length, hashes, slow, sub);
+        if (!slow) {
+            return v;
+        }
+    }
+
+    bool found = false;
+    scratch    = lookUpSlow(std::string(name, length), found);
+    return found ? &scratch : nullptr;
+}
+
+const Value* Configuration::find(const std::string& name, Value& scratch, std::shared_ptr<const Index>* sub) const {
+    return find(name.data(), name.size(), nullptr, scratch, sub);
+}
+
+const Value* Configuration::find(const Key& key, Value& scratch) const {
+    if (key.separator_ != separator_) {
+        return find(key.name_, scratch);
+    }
+    return find(key.path_.data(), key.path_.size(), key.hashes_.data(), scratch);
+}
+
+eckit::Value Configuration::lookUpSlow(const std::string& s, bool& found) const {
     eckit::Tokenizer parse(separator_);
     std::vector<std::string> path;
     parse(s, path);
@@ -88,6 +313,13 @@ eckit::Value Configuration::lookUp(const std::string& s, bool& found) const {
     return result;
 }
 
+eckit::Value Configuration::lookUp(const std::string& s, bool& found) const {
+    Value scratch;
+    const Value* v = find(s, scratch);
+    found          = v != nullptr;
+    return found ? *v : *root_;
+}
+
 eckit::Configuration::operator Value() const {
     return *root_;
 }
@@ -102,193 +334,218 @@ eckit::Value Configuration::lookUp(const std::string& name) const {
     return v;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+void convert(const Value& v, std::string& value) {
+    value = std::string(v);
+}
+
+void convert(const Value& v, bool& value) {
+    value = v;
+}
+
+void convert(const Value& v, int& value) {
+    long result(v);
+    ASSERT(int(result) == result);
+    value = result;
+}
+
+void convert(const Value& v, long& value) {
+    value = long(v);
+}
+
+void convert(const Value& v, long long& value) {
+    using long_long_t = long long;
+    value             = long_long_t(v);
+}
+
+void convert(const Value& v, size_t& value) {
+    value = size_t(v);
+}
+
+void convert(const Value& v, float& value) {
+    value = double(v);
+}
+
+void convert(const Value& v, double& value) {
+    value = v;
+}
+
+void convert(const Value& v, std::vector<int>& value) {
+    ASSERT(v.isList());
+    value.clear();
+    int i = 0;
+    while (v.contains(i)) {
+        long result(v[i]);
+        ASSERT(int(result) == result);
+        value.push_back(result);
+        i++;
+    }
+}
+
+void convert(const Value& v, std::vector<float>& value) {
+    ASSERT(v.isList());
+    value.clear();
+    int i = 0;
+    while (v.contains(i)) {
+        value.push_back(double(v[i]));
+        i++;
+    }
+}
+
+template <class T>
+void convert(const Value& v, std::vector<T>& value) {
+    ASSERT(v.isList());
+    value.clear();
+    int i = 0;
+    while (v.contains(i)) {
+        value.push_back(v[i]);
+        i++;
+    }
+}
+
+}  // namespace
+
+template <class K, class T>
+bool Configuration::fetch(const K& name, T& value) const {
+    Value scratch;
+    const Value* v = find(name, scratch);
+    if (v) {
+        convert(*v, value);
+    }
+    return v != nullptr;
+}
 
 bool Configuration::has(const std::string& name) const {
-    bool found = false;
-    lookUp(name, found);
-    return found;
+    Value scratch;
+    return find(name, scratch) != nullptr;
+}
+
+bool Configuration::has(const Key& key) const {
+    Value scratch;
+    return find(key, scratch) != nullptr;
 }
 
 bool Configuration::get(const std::string& name, std::string& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        value = std::string(v);
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, bool& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        value = v;
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, int& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        long result(v);
-        ASSERT(int(result) == result);
-        value = result;
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, long& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        value = long(v);
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, long long& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        using long_long_t = long long;
-        value             = long_long_t(v);
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, size_t& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        value = size_t(v);
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, float& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        value = double(v);
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, double& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        value = v;
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<int>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            long result(v[i]);
-            ASSERT(int(result) == result);
-            value.push_back(result);
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<long>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            value.push_back(v[i]);
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<long long>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            value.push_back(v[i]);
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<size_t>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            value.push_back(v[i]);
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<float>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            value.push_back(double(v[i]));
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<double>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            value.push_back(v[i]);
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
 }
 
 bool Configuration::get(const std::string& name, std::vector<std::string>& value) const {
-    bool found     = false;
-    eckit::Value v = lookUp(name, found);
-    if (found) {
-        ASSERT(v.isList());
-        value.clear();
-        int i = 0;
-        while (v.contains(i)) {
-            value.push_back(v[i]);
-            i++;
-        }
-    }
-    return found;
+    return fetch(name, value);
+}
+
+bool Configuration::get(const Key& key, std::string& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, bool& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, int& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, long& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, long long& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, size_t& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, float& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, double& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<int>& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<long>& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<long long>& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<size_t>& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<float>& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<double>& value) const {
+    return fetch(key, value);
+}
+
+bool Configuration::get(const Key& key, std::vector<std::string>& value) const {
+    return fetch(key, value);
 }
 
 bool Configuration::get(const std::string& name, LocalConfiguration& value) const {
@@ -331,6 +588,13 @@ void Configuration::_get(const std::string& name, T& value) const {
     }
 }
 
+template <class T>
+void Configuration::_get(const Key& key, T& value) const {
+    if (!get(key, value)) {
+        throw ConfigurationNotFound(key.name());
+    }
+}
+
 bool Configuration::getBool(const std::string& name) const {
     bool result;
     _get(name, result);
@@ -460,8 +724,8 @@ LocalConfiguration Configuration::getSubConfiguration(const std::string& name) c
     return result;
 }
 
-template <class T>
-void Configuration::_getWithDefault(const std::string& name, T& value, const T& defaultVal) const {
+template <class K, class T>
+void Configuration::_getWithDefault(const K& name, T& value, const T& defaultVal) const {
     if (!get(name, value)) {
         value = defaultVal;
     }
@@ -575,6 +839,114 @@ std::vector<std::string> Configuration::getStringVector(const std::string& name,
     return result;
 }
 
+bool Configuration::getBool(const Key& key) const {
+    bool result;
+    _get(key, result);
+    return result;
+}
+
+int Configuration::getInt(const Key& key) const {
+    int result;
+    _get(key, result);
+    return result;
+}
+
+long Configuration::getLong(const Key& key) const {
+    long result;
+    _get(key, result);
+    return result;
+}
+
+size_t Configuration::getUnsigned(const Key& key) const {
+    size_t result;
+    _get(key, result);
+    return result;
+}
+
+std::int32_t Configuration::getInt32(const Key& key) const {
+    std::int32_t result;
+    _get(key, result);
+    return result;
+}
+
+std::int64_t Configuration::getInt64(const Key& key) const {
+    std::int64_t result;
+    _get(key, result);
+    return result;
+}
+
+float Configuration::getFloat(const Key& key) const {
+    float result;
+    _get(key, result);
+    return result;
+}
+
+double Configuration::getDouble(const Key& key) const {
+    double result;
+    _get(key, result);
+    return result;
+}
+
+std::string Configuration::getString(const Key& key) const {
+    std::string result;
+    _get(key, result);
+    return result;
+}
+
+bool Configuration::getBool(const Key& key, const bool& defaultVal) const {
+    bool result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+int Configuration::getInt(const Key& key, const int& defaultVal) const {
+    int result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+long Configuration::getLong(const Key& key, const long& defaultVal) const {
+    long result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+size_t Configuration::getUnsigned(const Key& key, const size_t& defaultVal) const {
+    size_t result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+std::int32_t Configuration::getInt32(const Key& key, const std::int32_t& defaultVal) const {
+    std::int32_t result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+std::int64_t Configuration::getInt64(const Key& key, const std::int64_t& defaultVal) const {
+    std::int64_t result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+float Configuration::getFloat(const Key& key, const float& defaultVal) const {
+    float result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+double Configuration::getDouble(const Key& key, const double& defaultVal) const {
+    double result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
+std::string Configuration::getString(const Key& key, const std::string& defaultVal) const {
+    std::string result;
+    _getWithDefault(key, result, defaultVal);
+    return result;
+}
+
 void Configuration::json(JSON& s) const {
     s << *root_;
 }
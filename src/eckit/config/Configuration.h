@@ -18,6 +18,9 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
+
 #include "eckit/config/Parametrisation.h"
 
 
@@ -35,6 +38,25 @@ class Configuration : public Parametrisation {
     ///       eckit::Value should remain an internal detail of configuration objects
     ///       Clients should use typed configuration parameters
 
+public:  // types
+    /// A parameter name split once, to be reused for many look-ups (e.g. in loops over fields).
+    /// Looking up a Key is a single probe in an index of the configuration, built on first use
+    class Key {
+    public:
+        explicit Key(const std::string& name, char separator = '.');
+        explicit Key(const char* name, char separator = '.');
+
+        const std::string& name() const { return name_; }
+
+    private:
+        std::string name_;  ///< as given
+        std::string path_;                   ///< without empty components
+        std::vector<std::uint64_t> hashes_;  ///< of each component
+        char separator_;
+
+        friend class Configuration;
+    };
+
 public:  // methods
     // -- Destructor
 
@@ -86,6 +108,47 @@ public:  // methods
     std::vector<std::string> getStringVector(const std::string& name,
                                              const std::vector<std::string>& defaultValue) const;
 
+    // Access with a precompiled key
+
+    bool getBool(const Key&) const;
+    int getInt(const Key&) const;
+    long getLong(const Key&) const;
+    std::size_t getUnsigned(const Key&) const;
+    std::int32_t getInt32(const Key&) const;
+    std::int64_t getInt64(const Key&) const;
+    float getFloat(const Key&) const;
+    double getDouble(const Key&) const;
+    std::string getString(const Key&) const;
+
+    bool getBool(const Key&, const bool& defaultValue) const;
+    int getInt(const Key&, const int& defaultValue) const;
+    long getLong(const Key&, const long& defaultValue) const;
+    std::size_t getUnsigned(const Key&, const std::size_t& defaultValue) const;
+    std::int32_t getInt32(const Key&, const std::int32_t& defaultValue) const;
+    std::int64_t getInt64(const Key&, const std::int64_t& defaultValue) const;
+    float getFloat(const Key&, const float& defaultValue) const;
+    double getDouble(const Key&, const double& defaultValue) const;
+    std::string getString(const Key&, const std::string& defaultValue) const;
+
+    bool has(const Key&) const;
+
+    bool get(const Key&, std::string& value) const;
+    bool get(const Key&, bool& value) const;
+    bool get(const Key&, int& value) const;
+    bool get(const Key&, long& value) const;
+    bool get(const Key&, long long& value) const;
+    bool get(const Key&, std::size_t& value) const;
+    bool get(const Key&, float& value) const;
+    bool get(const Key&, double& value) const;
+
+    bool get(const Key&, std::vector<int>& value) const;
+    bool get(const Key&, std::vector<long>& value) const;
+    bool get(const Key&, std::vector<long long>& value) const;
+    bool get(const Key&, std::vector<std::size_t>& value) const;
+    bool get(const Key&, std::vector<float>& value) const;
+    bool get(const Key&, std::vector<double>& value) const;
+    bool get(const Key&, std::vector<std::string>& value) const;
+
     bool empty() const;
 
     std::vector<std::string> keys() const;
@@ -144,11 +207,31 @@ protected:  // methods
 
     operator Value() const;
 
+    /// To be called after root_ is modified
+    void resetIndex();
+
 protected:  // members
     std::unique_ptr<Value> root_;
     char separator_;
 
+private:  // types
+    class Index;
+
 private:  // methods
+    std::shared_ptr<const Index> index() const;
+
+    /// @returns the value in the configuration, or in scratch, or nullptr if not found. Sets sub to the index of the
+    /// value, if there is one
+    const Value* find(const char* name, size_t length, const std::uint64_t* hashes, Value& scratch,
+                      std::shared_ptr<const Index>* sub = nullptr) const;
+    const Value* find(const std::string& name, Value& scratch, std::shared_ptr<const Index>* sub = nullptr) const;
+    const Value* find(const Key&, Value& scratch) const;
+
+    Value lookUpSlow(const std::string&, bool&) const;
+
+    template <class K, class T>
+    bool fetch(const K&, T&) const;
+
     void json(JSON& s) const;
     friend JSON& operator<<(JSON& s, const Configuration& v) {
         v.json(s);
@@ -159,10 +242,16 @@ private:  // methods
     void _get(const std::string&, T&) const;
 
     template <class T>
-    void _getWithDefault(const std::string& name, T& value, const T& defaultVal) const;
+    void _get(const Key&, T&) const;
+
+    template <class K, class T>
+    void _getWithDefault(const K& name, T& value, const T& defaultVal) const;
 
     virtual void print(std::ostream&) const = 0;
 
+private:  // members
+    mutable std::shared_ptr<const Index> index_;  ///< created on first look-up, shared by copies and sub-configurations
+
     friend std::ostream& operator<<(std::ostream& s, const Configuration& p) {
         p.print(s);
         return s;
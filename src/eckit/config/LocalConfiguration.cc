@@ -72,6 +72,9 @@ void LocalConfiguration::setValue(const std::string& s, const eckit::Value& valu
     std::vector<std::string> path;
     parse(s, path);
 
+    // Release the values shared with the index first, so that they are not cloned
+    resetIndex();
+
     setValue(path, 0, *root_, value);
 }
 
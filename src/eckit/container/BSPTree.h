@@ -42,12 +42,10 @@ public:
 };
 
 template <class Traits, class Partition>
-class BSPTreeMemory : public BSPTreeX<TT<Traits, KDMemory>, Partition> {
-    KDMemory alloc_;
-
+class BSPTreeMemory : private SPAllocHolder<KDMemory>, public BSPTreeX<TT<Traits, KDMemory>, Partition> {
 public:
     BSPTreeMemory() :
-        BSPTreeX<TT<Traits, KDMemory>, Partition>(alloc_) {}
+        BSPTreeX<TT<Traits, KDMemory>, Partition>(this->allocator_) {}
 };
 
 template <class Traits, class Partition>
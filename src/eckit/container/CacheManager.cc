@@ -71,17 +71,16 @@ void CacheManagerBase::rescanCache(const eckit::PathName& base) const {
 
 
     std::vector<PathName> files;
-    std::vector<PathName> dirs;
 
-    base.childrenRecursive(files, dirs);
+    base.walk([&](const PathName& path, bool dir) {
+        if (!dir && path.extension() == extension_) {
+            files.push_back(path);
+        }
+    });
 
     std::ofstream out(mapping.asString().c_str(), std::ios::app);
 
     for (std::vector<PathName>::const_iterator j = files.begin(); j != files.end(); ++j) {
-        if (j->extension() != extension_) {
-            continue;
-        }
-
         eckit::Log::info() << "CACHE-MANAGER cleanup " << db << ", indexing " << (*j) << std::endl;
 
         MD5 md5(*j);
@@ -85,6 +85,17 @@ public:
     }
 
 
+    /// Room for n consecutive nodes, for the caller to construct in place
+    template <class Node>
+    Node* newNodes(size_t n, const Node* dummy) {
+        Node* r = base(dummy);
+        ASSERT(!readonly_);
+        ASSERT(base_ + (count_ + n + 1) * sizeof(Node) <= static_cast<char*>(addr_) + size_);
+        Node* first = &r[count_ + 1];
+        count_ += n;
+        return first;
+    }
+
     template <class Node>
     void deleteNode(Ptr p, Node* n) {
         // Ignore
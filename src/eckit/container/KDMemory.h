@@ -13,8 +13,13 @@
 
 #include "eckit/eckit.h"
 
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <new>
+#include <utility>
+#include <vector>
 
 #include "eckit/container/StatCollector.h"
 
@@ -27,6 +32,20 @@ namespace eckit {
 struct KDMemory : public StatCollector {
     typedef void* Ptr;
 
+    KDMemory() = default;
+
+    /// Copies do not own the blocks of nodes
+    KDMemory(const KDMemory& other) :
+        StatCollector(other), nbItems_(other.nbItems_) {}
+
+    KDMemory& operator=(const KDMemory&) = delete;
+
+    ~KDMemory() {
+        for (auto& b : blocks_) {
+            ::operator delete(b.first);
+        }
+    }
+
     Ptr root() const { return nullptr; }
     void root(Ptr) {}
 
@@ -58,13 +77,28 @@ struct KDMemory : public StatCollector {
         return new Node(a, b, c);
     }
 
+    /// Room for n nodes in one block, for the caller to construct in place. The block is freed with the allocator
+    template <class Node>
+    Node* newNodes(size_t n, const Node*) {
+        void* block = ::operator new(n * sizeof(Node));
+        Block b(block, n * sizeof(Node));
+        blocks_.insert(std::upper_bound(blocks_.begin(), blocks_.end(), b, before), b);
+        nbItems_ += n;
+        return static_cast<Node*>(block);
+    }
+
     template <class Node>
     void deleteNode(Ptr p, const Node*) {
         Node* n = static_cast<Node*>(p);
         if (n) {
             deleteNode(n->left(*this), n);
             deleteNode(n->right(*this), n);
-            delete n;
+            if (inBlock(n)) {
+                n->~Node();
+            }
+            else {
+                delete n;
+            }
             nbItems_--;
         }
     }
@@ -72,7 +106,31 @@ struct KDMemory : public StatCollector {
     size_t nbItems() const { return nbItems_; }
 
 private:
+    typedef std::pair<void*, size_t> Block;
+
+    static bool before(const Block& a, const Block& b) { return std::less<const void*>()(a.first, b.first); }
+
+    /// Blocks are kept sorted by address: p can only be in the last one starting at or before it
+    bool inBlock(const void* p) const {
+        Block key(const_cast<void*>(p), 0);
+        auto j = std::upper_bound(blocks_.begin(), blocks_.end(), key, before);
+        if (j == blocks_.begin()) {
+            return false;
+        }
+        --j;
+        const char* begin = static_cast<const char*>(j->first);
+        return std::less<const char*>()(static_cast<const char*>(p), begin + j->second);
+    }
+
     size_t nbItems_{0};
+    std::vector<Block> blocks_;  ///< sorted by address
+};
+
+/// Owns the allocator of a tree. As the first base class of the tree, the allocator is constructed before the tree
+/// and destroyed after it, since the tree deletes its nodes through it
+template <class Alloc>
+struct SPAllocHolder {
+    Alloc allocator_;
 };
 
 template <class T, class A>
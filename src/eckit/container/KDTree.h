@@ -37,20 +37,21 @@ public:
 
     /// ITER must be a random access iterator
     /// WARNING: container is changed (sorted)
+    /// Subtrees are built by up to threads threads (0 for kdTreeBuildThreads, see KDNode::build)
     template <typename ITER>
-    void build(ITER begin, ITER end) {
+    void build(ITER begin, ITER end, size_t threads = 0) {
         Alloc& a    = this->alloc_;
-        this->root_ = a.convert(Node::build(a, begin, end));
+        this->root_ = a.convert(Node::build(a, begin, end, 0, threads));
         a.root(this->root_);
     }
 
     /// Container must be a random access
     /// WARNING: container is changed (sorted)
     template <typename Container>
-    void build(Container& c) {
+    void build(Container& c, size_t threads = 0) {
         typename Container::iterator b = c.begin();
         typename Container::iterator e = c.end();
-        build(b, e);
+        build(b, e, threads);
     }
 
     //
@@ -67,9 +68,7 @@ public:
 
 
 template <class Traits>
-class KDTreeMemory : public KDTreeX<TT<Traits, KDMemory> > {
-    KDMemory alloc_;
-
+class KDTreeMemory : private SPAllocHolder<KDMemory>, public KDTreeX<TT<Traits, KDMemory> > {
 public:
     typedef KDTreeX<TT<Traits, KDMemory> > KDTree;
     typedef typename KDTree::Value Value;
@@ -78,7 +77,7 @@ public:
 
 public:
     KDTreeMemory() :
-        KDTree(alloc_) {}
+        KDTree(this->allocator_) {}
 };
 
 template <class Traits>
@@ -18,7 +18,12 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <exception>
 #include <limits>
+#include <new>
+#include <thread>
+
+#include "eckit/config/Resource.h"
 
 #include "KDNode.h"
 
@@ -117,6 +122,25 @@ void KDNode<Traits>::kNearestNeighboursX(Alloc& a, const Point& p, size_t k, Nod
     }
 }
 
+template <class Traits>
+template <class Queue>
+void KDNode<Traits>::kNearestNeighboursBatchX(Alloc& a, const Point& p, Queue& result) {
+    const bool goLeft = p.x(axis_) < this->value_.point().x(axis_);
+
+    Node* near = goLeft ? this->left(a) : this->right(a);
+    Node* far  = goLeft ? this->right(a) : this->left(a);
+
+    if (near) {
+        near->kNearestNeighboursBatchX(a, p, result);
+    }
+
+    result.push(this, a.convert(this), Point::distance(p, this->value_.point()));
+
+    if (far && Point::distance(p, this->value_.point(), axis_) <= result.largest()) {
+        far->kNearestNeighboursBatchX(a, p, result);
+    }
+}
+
 
 template <class Value>
 struct sorter {
@@ -129,32 +153,92 @@ struct sorter {
 
 template <class Traits>
 template <typename ITER>
-KDNode<Traits>* KDNode<Traits>::build(Alloc& a, const ITER& begin, const ITER& end, int depth) {
+KDNode<Traits>* KDNode<Traits>::build(Alloc& a, const ITER& begin, const ITER& end, int depth, size_t threads) {
     if (end == begin)
         return 0;
 
-    a.statsDepth(depth);
+    const size_t n = end - begin;
 
-    // size_t k    = Point::size(*begin);
-    size_t k    = Point::DIMS;
-    size_t axis = depth % k;
+    // Splitting at the median gives a balanced tree
+    size_t height = 0;
+    while ((size_t(2) << height) <= n) {
+        height++;
+    }
+    a.statsDepth(depth + height);
+
+    // Serial unless asked otherwise: processes of an MPI job would all start a thread per core
+    if (threads == 0) {
+        static size_t buildThreads = Resource<size_t>("kdTreeBuildThreads;$ECKIT_KDTREE_BUILD_THREADS", 1);
+        threads = buildThreads ? buildThreads : std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    KDNode* nodes = a.newNodes(n, (KDNode*)0);
+    buildSubtree(a, nodes, begin, end, depth, threads);
+    return nodes;
+}
 
-    // std::sort(begin, end, sorter<Point>(axis));
 
-    size_t median = (end - begin) / 2;
+template <class Traits>
+template <typename ITER>
+void KDNode<Traits>::buildSubtree(Alloc& a, KDNode* node, const ITER& begin, const ITER& end, int depth,
+                                  size_t threads) {
+
+    // Nodes are laid out in pre-order: each subtree is contiguous, its root first, then its left subtree
+    const size_t n      = end - begin;
+    const size_t axis   = depth % Point::DIMS;
+    const size_t median = n / 2;
 
     std::nth_element(begin, begin + median, end, sorter<Value>(axis));
 
     ITER e2 = begin + median;
     ITER b2 = begin + median + 1;
 
+    new (node) KDNode(*e2, axis);
 
-    KDNode* n = a.newNode2(*e2, axis, (KDNode*)0);
+    KDNode* left  = median > 0 ? node + 1 : 0;
+    KDNode* right = b2 != end ? node + 1 + median : 0;
 
-    n->left(a, build(a, begin, e2, depth + 1));
-    n->right(a, build(a, b2, end, depth + 1));
+    node->left(a, left);
+    node->right(a, right);
 
-    return n;
+    const size_t minimumParallel = 64 * 1024;
+
+    if (threads > 1 && n >= minimumParallel) {
+        std::exception_ptr error;
+        std::thread thread([&] {
+            try {
+                if (left) {
+                    buildSubtree(a, left, begin, e2, depth + 1, threads / 2);
+                }
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        });
+
+        try {
+            if (right) {
+                buildSubtree(a, right, b2, end, depth + 1, threads - threads / 2);
+            }
+        }
+        catch (...) {
+            thread.join();
+            throw;
+        }
+
+        thread.join();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    if (left) {
+        buildSubtree(a, left, begin, e2, depth + 1, 1);
+    }
+    if (right) {
+        buildSubtree(a, right, b2, end, depth + 1, 1);
+    }
 }
 
 
@@ -214,6 +298,27 @@ void KDNode<Traits>::findInSphereX(Alloc& a, const Point& p, double radius, Node
     }
 }
 
+template <class Traits>
+void KDNode<Traits>::findInSphereBatchX(Alloc& a, const Point& p, double radius, NodeList& result) {
+    const bool goLeft = p.x(axis_) < this->value_.point().x(axis_);
+
+    Node* near = goLeft ? this->left(a) : this->right(a);
+    Node* far  = goLeft ? this->right(a) : this->left(a);
+
+    if (near) {
+        near->findInSphereBatchX(a, p, radius, result);
+    }
+
+    double d = Point::distance(p, this->value_.point());
+    if (d <= radius) {
+        result.push_back(NodeInfo(this, a.convert(this), d));
+    }
+
+    if (far && Point::distance(p, this->value_.point(), axis_) <= radius) {
+        far->findInSphereBatchX(a, p, radius, result);
+    }
+}
+
 
 }  // namespace eckit
 
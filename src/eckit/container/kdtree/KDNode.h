@@ -39,19 +39,31 @@ public:
     KDNode(const Value& value, size_t axis);
     ~KDNode() {}
 
+    /// Builds the tree of [begin, end) in one block of nodes from the allocator, with up to threads threads
+    /// (0 for kdTreeBuildThreads, 1 by default, itself 0 for one per core)
     template <typename ITER>
-    static KDNode* build(Alloc& a, const ITER& begin, const ITER& end, int depth = 0);
+    static KDNode* build(Alloc& a, const ITER& begin, const ITER& end, int depth = 0, size_t threads = 0);
 
     static KDNode<Traits>* insert(Alloc& a, const Value& value, KDNode<Traits>* node, int depth = 0);
 
     /// Return the axis along which this node is split.
     size_t axis() const { return axis_; }
 
+private:
+    template <typename ITER>
+    static void buildSubtree(Alloc& a, KDNode* node, const ITER& begin, const ITER& end, int depth, size_t threads);
+
 public:
     void nearestNeighbourX(Alloc& a, const Point& p, Node*& best, double& max, int depth);
     void findInSphereX(Alloc& a, const Point& p, double radius, NodeList& result, int depth);
     void kNearestNeighboursX(Alloc& a, const Point& p, size_t k, NodeQueue& result, int depth);
 
+    /// As kNearestNeighboursX() and findInSphereX(), for the batch queries of SPTree: statistics are not collected,
+    /// so that threads can share the tree
+    template <class Queue>
+    void kNearestNeighboursBatchX(Alloc& a, const Point& p, Queue& result);
+    void findInSphereBatchX(Alloc& a, const Point& p, double radius, NodeList& result);
+
     //==========================
 };
 
@@ -0,0 +1,168 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef SPBatch_H
+#define SPBatch_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace eckit {
+
+template <class Traits, class NodeType>
+struct SPNodeInfo;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The k nearest items of one query of a batch, kept as a max-heap in the k entries the caller provided
+template <class Traits, class NodeType>
+class SPBatchQueue {
+public:
+    typedef typename Traits::Alloc Alloc;
+    typedef typename Alloc::Ptr ID;
+
+    typedef NodeType Node;
+    typedef SPNodeInfo<Traits, NodeType> NodeInfo;
+
+private:
+    NodeInfo* begin_;
+    size_t k_;
+    size_t size_;
+
+public:
+    SPBatchQueue(NodeInfo* begin, size_t k) :
+        begin_(begin), k_(k), size_(0) {}
+
+    void push(Node* n, ID id, double d) {
+        if (size_ < k_) {
+            begin_[size_++] = NodeInfo(n, id, d);
+            std::push_heap(begin_, begin_ + size_);
+        }
+        else if (k_ > 0 && d < begin_[0].distance_) {
+            std::pop_heap(begin_, begin_ + size_);
+            begin_[size_ - 1] = NodeInfo(n, id, d);
+            std::push_heap(begin_, begin_ + size_);
+        }
+    }
+
+    double largest() const { return size_ == k_ && k_ ? begin_[0].distance_ : std::numeric_limits<double>::max(); }
+
+    /// Sorts by distance, entries not found (fewer than k items) have no node and an infinite distance
+    void finish() {
+        std::sort_heap(begin_, begin_ + size_);
+        std::fill(begin_ + size_, begin_ + k_, NodeInfo(0, 0, std::numeric_limits<double>::infinity()));
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Order in which to run a batch of queries, so that consecutive ones are close in space and visit the same nodes:
+/// the points are sorted along a Z-order (Morton) curve over their bounding box
+template <class Point>
+std::vector<size_t> spaceFillingCurveOrder(const Point* points, size_t n) {
+    const size_t dims = Point::DIMS;
+    const size_t bits = std::min<size_t>(63 / dims, 32);
+    const double cells = double((uint64_t(1) << bits) - 1);
+
+    std::vector<double> lo(dims, std::numeric_limits<double>::max());
+    std::vector<double> hi(dims, std::numeric_limits<double>::lowest());
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t d = 0; d < dims; ++d) {
+            lo[d] = std::min(lo[d], points[i].x(d));
+            hi[d] = std::max(hi[d], points[i].x(d));
+        }
+    }
+
+    std::vector<double> scale(dims);
+    for (size_t d = 0; d < dims; ++d) {
+        scale[d] = hi[d] > lo[d] ? cells / (hi[d] - lo[d]) : 0.;
+    }
+
+    std::vector<std::pair<uint64_t, size_t> > codes(n);
+    std::vector<uint64_t> cell(dims);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t d = 0; d < dims; ++d) {
+            cell[d] = uint64_t((points[i].x(d) - lo[d]) * scale[d]);
+        }
+        uint64_t code = 0;
+        for (size_t b = bits; b-- > 0;) {
+            for (size_t d = 0; d < dims; ++d) {
+                code = (code << 1) | ((cell[d] >> b) & 1);
+            }
+        }
+        codes[i] = std::make_pair(code, i);
+    }
+
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = codes[i].second;
+    }
+    return order;
+}
+
+/// Calls work(begin, end) on the chunks of [0, n), which start at multiples of chunk, from several threads.
+/// Rethrows the first exception
+template <class Work>
+void spParallelFor(size_t n, size_t threads, size_t chunk, Work work) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    threads = std::min(threads, (n + chunk - 1) / chunk);
+
+    if (threads <= 1) {
+        for (size_t begin = 0; begin < n; begin += chunk) {
+            work(begin, std::min(n, begin + chunk));
+        }
+        return;
+    }
+
+    // Small chunks, taken in order, so that threads stay on neighbouring queries and finish together
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            try {
+                size_t begin;
+                while ((begin = next.fetch_add(chunk)) < n) {
+                    work(begin, std::min(n, begin + chunk));
+                }
+            }
+            catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
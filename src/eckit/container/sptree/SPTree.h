@@ -11,6 +11,10 @@
 #ifndef SPTree_H
 #define SPTree_H
 
+#include <limits>
+#include <vector>
+
+#include "eckit/container/sptree/SPBatch.h"
 #include "eckit/container/sptree/SPIterator.h"
 #include "eckit/container/sptree/SPMetadata.h"
 #include "eckit/container/sptree/SPNode.h"
@@ -46,6 +50,8 @@ public:
 
     typedef std::pair<Point, Payload> value_type;
 
+    static constexpr size_t batchChunk = 256;  ///< queries handed to a thread at a time
+
 public:
     SPTree(Alloc& alloc) :
         alloc_(alloc), root_(0) {}
@@ -93,6 +99,74 @@ public:
         return alloc_.convert(root_, (Node*)0)->kNearestNeighbours(alloc_, p, k);
     }
 
+    /// Batch queries: the points are taken along a space-filling curve, so that consecutive queries visit the same
+    /// nodes, and shared between threads (0 for one per core). Results are written to the caller's arrays, and
+    /// statistics are not collected. The nodes must provide the batch traversals (see KDNode).
+
+    /// The k nearest neighbours of points[i], sorted by distance, into result[i * k, (i + 1) * k). If the tree has
+    /// fewer than k items, the remaining entries have no node and an infinite distance
+    void kNearestNeighbours(const Point* points, size_t n, size_t k, NodeInfo* result, size_t threads = 0) {
+        if (!root_) {
+            root_ = alloc_.root();
+        }
+        ASSERT(root_);
+
+        Node* root = alloc_.convert(root_, (Node*)0);
+        std::vector<size_t> order = spaceFillingCurveOrder(points, n);
+
+        spParallelFor(n, threads, batchChunk, [&](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) {
+                size_t i = order[j];
+                SPBatchQueue<Traits, NodeType> queue(result + i * k, k);
+                root->kNearestNeighboursBatchX(alloc_, points[i], queue);
+                queue.finish();
+            }
+        });
+    }
+
+    /// The items within radius of points[i], sorted by distance, into result[offsets[i], offsets[i + 1]).
+    /// Pass the same vectors to successive calls to reuse their memory
+    void findInSphere(const Point* points, size_t n, double radius, std::vector<size_t>& offsets, NodeList& result,
+                      size_t threads = 0) {
+        if (!root_) {
+            root_ = alloc_.root();
+        }
+        ASSERT(root_);
+
+        Node* root = alloc_.convert(root_, (Node*)0);
+        std::vector<size_t> order = spaceFillingCurveOrder(points, n);
+
+        // Each chunk of queries collects its own results, which are then copied in place
+        std::vector<NodeList> found((n + batchChunk - 1) / batchChunk);
+        offsets.assign(n + 1, 0);
+
+        spParallelFor(n, threads, batchChunk, [&](size_t begin, size_t end) {
+            NodeList& list = found[begin / batchChunk];
+            for (size_t j = begin; j < end; ++j) {
+                size_t i     = order[j];
+                size_t first = list.size();
+                root->findInSphereBatchX(alloc_, points[i], radius, list);
+                std::sort(list.begin() + first, list.end());
+                offsets[i + 1] = list.size() - first;
+            }
+        });
+
+        for (size_t i = 0; i < n; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        result.resize(offsets[n]);
+        for (size_t c = 0; c < found.size(); ++c) {
+            auto from = found[c].begin();
+            for (size_t j = c * batchChunk; j < std::min(n, (c + 1) * batchChunk); ++j) {
+                size_t i     = order[j];
+                size_t count = offsets[i + 1] - offsets[i];
+                std::copy(from, from + count, result.begin() + offsets[i]);
+                from += count;
+            }
+        }
+    }
+
     // For testing only...
     NodeInfo nearestNeighbourBruteForce(const Point& p) {
         if (!root_) {
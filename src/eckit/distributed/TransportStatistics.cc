@@ -20,7 +20,11 @@ TransportStatistics::TransportStatistics():
     sendCount_(0),
     receiveCount_(0),
     sendSize_(0),
-    receiveSize_(0)
+    receiveSize_(0),
+    batchCount_(0),
+    queueDepthSum_(0),
+    queueDepthSamples_(0),
+    maxQueueDepth_(0)
 {
 }
 
@@ -34,6 +38,11 @@ TransportStatistics::TransportStatistics(eckit::Stream &s) {
     s >> receiveTiming_;
     s >> barrierTiming_;
     s >> shutdownTiming_;
+    s >> stallTiming_;
+    s >> batchCount_;
+    s >> queueDepthSum_;
+    s >> queueDepthSamples_;
+    s >> maxQueueDepth_;
 }
 
 void TransportStatistics::encode(eckit::Stream &s) const {
@@ -46,6 +55,11 @@ void TransportStatistics::encode(eckit::Stream &s) const {
     s << receiveTiming_;
     s << barrierTiming_;
     s << shutdownTiming_;
+    s << stallTiming_;
+    s << batchCount_;
+    s << queueDepthSum_;
+    s << queueDepthSamples_;
+    s << maxQueueDepth_;
 }
 
 TransportStatistics &TransportStatistics::operator+=(const TransportStatistics &other) {
@@ -58,6 +72,11 @@ TransportStatistics &TransportStatistics::operator+=(const TransportStatistics &
     receiveTiming_ += other.receiveTiming_;
     barrierTiming_ += other.barrierTiming_;
     shutdownTiming_ += other.shutdownTiming_;
+    stallTiming_ += other.stallTiming_;
+    batchCount_ += other.batchCount_;
+    queueDepthSum_ += other.queueDepthSum_;
+    queueDepthSamples_ += other.queueDepthSamples_;
+    maxQueueDepth_ = std::max(maxQueueDepth_, other.maxQueueDepth_);
 
     return *this;
 }
@@ -76,6 +95,10 @@ TransportStatistics &TransportStatistics::operator/=(size_t n) {
     receiveTiming_ /= n;
     barrierTiming_ /= n;
     shutdownTiming_ /= n;
+    stallTiming_ /= n;
+    divide(batchCount_, n);
+    queueDepthSum_ /= n;
+    divide(queueDepthSamples_, n);
 
     return *this;
 }
@@ -98,10 +121,20 @@ void TransportStatistics::report(std::ostream &out, const char *indent) const {
     reportTime(out, "Transport: barrier", barrierTiming_, indent);
     reportTime(out, "Transport: shutdown", shutdownTiming_, indent);
 
+    if (batchCount_) {
+        reportCount(out, "Transport: batches", batchCount_, indent);
+    }
+    if (queueDepthSamples_) {
+        reportCount(out, "Transport: average queue depth", queueDepthSum_ / queueDepthSamples_, indent);
+        reportCount(out, "Transport: maximum queue depth", maxQueueDepth_, indent);
+    }
+    reportTime(out, "Transport: stalled", stallTiming_, indent);
+
 }
 
 void TransportStatistics::csvHeader(std::ostream& out) const {
-    out << "sends,sendSize,send,receives,receiveSize,receive,barrier,shutdown";
+    out << "sends,sendSize,send,receives,receiveSize,receive,barrier,shutdown,stall,batches,averageQueueDepth,"
+           "maxQueueDepth";
 }
 
 void TransportStatistics::csvRow(std::ostream& out) const {
@@ -112,7 +145,11 @@ void TransportStatistics::csvRow(std::ostream& out) const {
         << receiveSize_ << ","
         << receiveTiming_ << ","
         << barrierTiming_ << ","
-        << shutdownTiming_;
+        << shutdownTiming_ << ","
+        << stallTiming_ << ","
+        << batchCount_ << ","
+        << (queueDepthSamples_ ? queueDepthSum_ / queueDepthSamples_ : 0) << ","
+        << maxQueueDepth_;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -16,6 +16,7 @@
 #ifndef eckit_TransportStatistics_H
 #define eckit_TransportStatistics_H
 
+#include <algorithm>
 #include <iosfwd>
 
 #include "eckit/log/Statistics.h"
@@ -47,6 +48,21 @@ public:
     eckit::Timing barrierTiming_;
     eckit::Timing shutdownTiming_;
 
+    // Flow control: time waiting for the other side (producer: for workers to take messages, workers: for
+    // messages to arrive), frames sent or received, and depth of the queue of messages not yet taken or processed
+
+    eckit::Timing stallTiming_;
+    size_t batchCount_;
+    unsigned long long queueDepthSum_;
+    size_t queueDepthSamples_;
+    size_t maxQueueDepth_;
+
+    void queueDepth(size_t depth) {
+        queueDepthSum_ += depth;
+        queueDepthSamples_++;
+        maxQueueDepth_ = std::max(maxQueueDepth_, depth);
+    }
+
 
     TransportStatistics &operator+=(const TransportStatistics &other) ;
     TransportStatistics &operator/=(size_t) ;
@@ -159,7 +159,10 @@ void MPITransport::sendMessageToNextWorker(const Message& msg) {
 
     Message request;
 
-    receive(request, worker, tag);
+    {
+        eckit::AutoTiming stall(statistics_.stallTiming_);
+        receive(request, worker, tag);
+    }
 
     ASSERT(ranksToWriters_.find(worker) == ranksToWriters_.end());
     ASSERT(tag == Actor::READY);
@@ -176,7 +179,10 @@ void MPITransport::getNextWorkMessage(Message& message) {
     int source = master;
     int tag    = comm_.anyTag();
 
-    receive(message, source, tag);
+    {
+        eckit::AutoTiming stall(statistics_.stallTiming_);
+        receive(message, source, tag);
+    }
 
     ASSERT(source == master);
     ASSERT(tag == Actor::WORK || tag == Actor::SHUTDOWN);
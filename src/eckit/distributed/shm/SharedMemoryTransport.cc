@@ -0,0 +1,925 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/eckit.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if eckit_HAVE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Plural.h"
+#include "eckit/log/Statistics.h"
+#include "eckit/log/TimeStamp.h"
+#include "eckit/maths/Functions.h"
+#include "eckit/memory/MMap.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/runtime/Main.h"
+
+#include "eckit/distributed/Actor.h"
+#include "eckit/distributed/Message.h"
+#include "eckit/distributed/shm/SharedMemoryTransport.h"
+
+using namespace eckit;
+
+namespace eckit::distributed {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace shm {
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared memory needs address-free atomics");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory needs address-free atomics");
+
+const uint64_t MAGIC = 0x656b69742d73686dULL;  // "ekit-shm"
+
+const uint32_t CLOSED = 0x80000000;  ///< set in Segment::attached once the producer is done
+
+/// State of a worker slot
+enum
+{
+    FREE,      ///< claimed, the worker is starting
+    ATTACHED,  ///< the worker takes work
+    DONE,      ///< the worker has sent its statistics
+    LOST,      ///< the worker has gone
+};
+
+/// Header of a message in a ring, followed by the payload rounded up to 8 bytes
+struct Record {
+    uint64_t size;
+    uint64_t tag;
+};
+
+/// Single-producer single-consumer ring of records. Positions grow forever, the reader and the writer each own one
+/// of them, on separate cache lines
+struct Ring {
+    alignas(64) std::atomic<uint64_t> head;  ///< bytes released, the writer can reuse them
+    std::atomic<uint64_t> read;              ///< bytes consumed, released once the message is processed
+    std::atomic<uint64_t> popped;            ///< messages consumed
+    alignas(64) std::atomic<uint64_t> tail;  ///< bytes produced
+    std::atomic<uint64_t> pushed;            ///< messages produced
+    uint64_t offset;                         ///< of the data, from the start of the segment
+    uint64_t capacity;
+};
+
+struct alignas(64) Slot {
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> pid;
+    std::atomic<uint32_t> shutdown;  ///< no more work will be pushed
+    std::atomic<uint32_t> wakeup;    ///< futex the worker sleeps on
+    std::atomic<uint32_t> sleeping;
+    Ring input;   ///< work, from the producer
+    Ring output;  ///< statistics, to the producer
+};
+
+/// Start of the segment, followed by the slots and the data of their rings
+struct alignas(64) Segment {
+    std::atomic<uint64_t> magic;  ///< set last by the producer, once the segment is ready
+    uint64_t size;
+    uint64_t workers;
+    int32_t producer;
+    std::atomic<uint32_t> attached;  ///< number of slots claimed
+    std::atomic<uint32_t> aborted;
+    std::atomic<uint32_t> wakeup;  ///< futex the producer sleeps on
+    std::atomic<uint32_t> sleeping;
+
+    Slot* slots() { return reinterpret_cast<Slot*>(this + 1); }
+};
+
+}  // namespace shm
+
+using namespace shm;
+
+namespace {
+
+const long CHECK   = 1;   // seconds, before checking that the other side is still there
+const long TIMEOUT = 30;  // seconds, between messages saying that we are still waiting
+
+size_t recordSize(size_t size) {
+    return sizeof(Record) + eckit::round(size, 8);
+}
+
+bool alive(pid_t pid) {
+    return ::kill(pid, 0) == 0 || errno == EPERM;
+}
+
+/// Sleeps while word is value, or for a second
+void sleepOn(std::atomic<uint32_t>& word, uint32_t value, std::atomic<uint32_t>& sleeping) {
+    sleeping.fetch_add(1);
+#if eckit_HAVE_FUTEX
+    struct timespec timeout = {1, 0};
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value, &timeout, nullptr, 0);
+#else
+    if (word.load() == value) {
+        ::usleep(100);
+    }
+#endif
+    sleeping.fetch_sub(1);
+}
+
+/// Wakes up whoever sleeps on word. The system is only called if someone does: a sleeper that comes after
+/// the increment does not sleep, as word no longer has the value it checked against
+void wakeUp(std::atomic<uint32_t>& word, std::atomic<uint32_t>& sleeping) {
+    word.fetch_add(1);
+#if eckit_HAVE_FUTEX
+    if (sleeping.load()) {
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+#endif
+}
+
+/// Waits until ready() is true, sleeping on word.
+/// @returns false if it is not after timeout seconds
+template <class Ready>
+bool waitUntil(std::atomic<uint32_t>& word, std::atomic<uint32_t>& sleeping, Ready ready, long timeout) {
+
+    // The other side is often about to answer, spin a little before going to sleep
+    for (size_t i = 0; i < 1000; ++i) {
+        if (ready()) {
+            return true;
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+    for (;;) {
+        uint32_t value = word.load();
+        if (ready()) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        sleepOn(word, value, sleeping);
+    }
+}
+
+class RingAccess {
+public:
+    RingAccess(Segment* segment, Ring& ring) :
+        ring_(ring), data_(reinterpret_cast<char*>(segment) + ring.offset) {}
+
+    bool empty() const { return ring_.read.load() == ring_.tail.load(); }
+
+    bool released() const { return ring_.head.load() == ring_.tail.load(); }
+
+    size_t queued() const { return ring_.pushed.load() - ring_.popped.load(); }
+
+    bool fits(size_t size) const {
+        return ring_.capacity - (ring_.tail.load(std::memory_order_relaxed) - ring_.head.load()) >= recordSize(size);
+    }
+
+    bool push(int tag, const void* data, size_t size) {
+        if (!fits(size)) {
+            return false;
+        }
+
+        uint64_t tail = ring_.tail.load(std::memory_order_relaxed);
+        Record record = {size, uint64_t(tag)};
+        copyIn(tail, &record, sizeof(record));
+        copyIn(tail + sizeof(record), data, size);
+
+        ring_.tail.store(tail + recordSize(size), std::memory_order_release);
+        ring_.pushed.fetch_add(1);
+        return true;
+    }
+
+    /// The record stays in the ring until release(), so that it can be sent again if the reader is lost
+    bool pop(Message& message, int source, size_t& size) {
+        uint64_t read = ring_.read.load(std::memory_order_relaxed);
+        if (read == ring_.tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        Record record;
+        copyOut(read, &record, sizeof(record));
+        message.reserve(record.size);
+        copyOut(read + sizeof(record), message.messageData(), record.size);
+        message.messageReceived(int(record.tag), source);
+
+        size = record.size;
+        ring_.read.store(read + recordSize(size), std::memory_order_relaxed);
+        ring_.popped.fetch_add(1);
+        return true;
+    }
+
+    void release() { ring_.head.store(ring_.read.load(std::memory_order_relaxed), std::memory_order_release); }
+
+    /// Takes the records not released by a reader that has gone, including the one it was processing
+    size_t drain(std::deque<Buffer>& messages) {
+        uint64_t head = ring_.head.load(std::memory_order_acquire);
+        uint64_t tail = ring_.tail.load(std::memory_order_acquire);
+
+        size_t count = 0;
+        while (head != tail) {
+            Record record;
+            copyOut(head, &record, sizeof(record));
+            messages.emplace_back(record.size);
+            copyOut(head + sizeof(record), messages.back().data(), record.size);
+            head += recordSize(record.size);
+            count++;
+        }
+
+        ring_.read.store(tail);
+        ring_.head.store(tail);
+        return count;
+    }
+
+private:
+    void copyIn(uint64_t position, const void* data, size_t size) {
+        size_t at = position % ring_.capacity;
+        size_t n  = std::min(size, size_t(ring_.capacity - at));
+        ::memcpy(data_ + at, data, n);
+        ::memcpy(data_, static_cast<const char*>(data) + n, size - n);
+    }
+
+    void copyOut(uint64_t position, void* data, size_t size) const {
+        size_t at = position % ring_.capacity;
+        size_t n  = std::min(size, size_t(ring_.capacity - at));
+        ::memcpy(data, data_ + at, n);
+        ::memcpy(static_cast<char*>(data) + n, data_, size - n);
+    }
+
+    Ring& ring_;
+    char* data_;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SharedMemoryTransport::SharedMemoryTransport(const option::CmdArgs &args):
+    Transport(args),
+    name_("/eckit-distributed"),
+    segment_(nullptr),
+    size_(0),
+    producer_(true),
+    created_(false),
+    window_(16),
+    slot_(0),
+    closed_(false),
+    next_(0),
+    logged_(::time(nullptr)) {
+
+    args.get("shm", name_);
+    if (name_.empty() || name_[0] != '/') {
+        name_ = "/" + name_;
+    }
+
+    args.get("window", window_);
+    ASSERT(window_ > 0);
+
+    bool attach = false;
+    args.get("attach", attach);
+
+    std::string hostname = Main::hostname();
+
+    std::ostringstream oss;
+
+    if (attach) {
+        // We are a consumer
+        producer_ = false;
+        this->attach();
+        oss << "Consumer-" << ::getpid() << "@" << hostname;
+
+    } else {
+        // We are the producer
+        size_t workers = 64;
+        size_t ring    = 16 * 1024 * 1024;
+        args.get("workers", workers);
+        args.get("ring", ring);
+        create(workers, ring);
+        oss << "Producer-" << ::getpid() << "@" << hostname;
+    }
+
+    title_ = oss.str();
+
+    std::ostringstream oid;
+    oid << hostname << "@" << ::getpid();
+    id_ = oid.str();
+}
+
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    if (!segment_) {
+        return;
+    }
+
+    if (!producer_ && !closed_) {
+        // Let the producer know straight away if we did not finish
+        uint32_t state = ATTACHED;
+        slot(slot_).state.compare_exchange_strong(state, LOST);
+        wakeUp(segment_->wakeup, segment_->sleeping);
+    }
+
+    MMap::munmap(segment_, size_);
+
+    if (created_) {
+        ::shm_unlink(name_.c_str());
+    }
+}
+
+
+void SharedMemoryTransport::create(size_t workers, size_t ring) {
+
+    ASSERT(workers > 0 && workers < CLOSED);
+
+    ring  = eckit::round(std::max(ring, size_t(4096)), 64);
+    size_ = sizeof(Segment) + workers * sizeof(Slot) + 2 * workers * ring;
+
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        Log::error() << "shm_open(" << name_ << ')' << Log::syserr << std::endl;
+        if (errno == EEXIST) {
+            throw SeriousBug("SharedMemoryTransport: " + name_ +
+                             " exists, another producer is running or a previous one did not finish."
+                             " Remove it or use --shm to choose another name");
+        }
+        throw FailedSystemCall("shm_open", Here());
+    }
+
+    created_ = true;
+
+    // The memory is only used as it is touched
+    if (::ftruncate(fd, size_) < 0) {
+        Log::error() << "ftruncate(" << name_ << ", " << size_ << ')' << Log::syserr << std::endl;
+        ::close(fd);
+        throw FailedSystemCall("ftruncate", Here());
+    }
+
+    void* addr = MMap::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        Log::error() << "SharedMemoryTransport: cannot mmap " << name_ << " size=" << size_ << Log::syserr << std::endl;
+        throw FailedSystemCall("mmap", Here());
+    }
+
+    segment_           = new (addr) Segment();
+    segment_->size     = size_;
+    segment_->workers  = workers;
+    segment_->producer = ::getpid();
+    segment_->attached = 0;
+    segment_->aborted  = 0;
+    segment_->wakeup   = 0;
+    segment_->sleeping = 0;
+
+    size_t offset = sizeof(Segment) + workers * sizeof(Slot);
+    for (size_t i = 0; i < workers; ++i) {
+        Slot* s = new (segment_->slots() + i) Slot();
+        s->state    = FREE;
+        s->pid      = 0;
+        s->shutdown = 0;
+        s->wakeup   = 0;
+        s->sleeping = 0;
+
+        for (Ring* r : {&s->input, &s->output}) {
+            r->head     = 0;
+            r->read     = 0;
+            r->popped   = 0;
+            r->tail     = 0;
+            r->pushed   = 0;
+            r->offset   = offset;
+            r->capacity = ring;
+            offset += ring;
+        }
+    }
+
+    ASSERT(offset == size_);
+
+    segment_->magic.store(MAGIC, std::memory_order_release);
+
+    Log::info() << TimeStamp() << " SharedMemoryTransport: created " << name_ << " for "
+                << Plural(workers, "worker") << ", " << Bytes(ring) << " per ring" << std::endl;
+}
+
+
+void SharedMemoryTransport::attach() {
+
+    // The producer may not have started yet
+    int fd;
+    for (size_t i = 0; (fd = ::shm_open(name_.c_str(), O_RDWR, 0)) < 0; ++i) {
+        if (errno != ENOENT || i == 60) {
+            Log::error() << "shm_open(" << name_ << ')' << Log::syserr << std::endl;
+            throw FailedSystemCall("shm_open", Here());
+        }
+        if (i % 10 == 0) {
+            Log::info() << TimeStamp() << " SharedMemoryTransport: waiting for " << name_ << std::endl;
+        }
+        ::sleep(1);
+    }
+
+    // ... or not have sized it yet
+    struct stat st;
+    for (size_t i = 0;; ++i) {
+        if (::fstat(fd, &st) < 0) {
+            ::close(fd);
+            throw FailedSystemCall("fstat", Here());
+        }
+        if (size_t(st.st_size) >= sizeof(Segment)) {
+            break;
+        }
+        if (i == 60000) {
+            ::close(fd);
+            throw SeriousBug("SharedMemoryTransport: " + name_ + " was not initialised by the producer");
+        }
+        ::usleep(1000);
+    }
+
+    size_      = st.st_size;
+    void* addr = MMap::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        Log::error() << "SharedMemoryTransport: cannot mmap " << name_ << " size=" << size_ << Log::syserr << std::endl;
+        throw FailedSystemCall("mmap", Here());
+    }
+
+    segment_ = static_cast<Segment*>(addr);
+
+    for (size_t i = 0; segment_->magic.load(std::memory_order_acquire) != MAGIC; ++i) {
+        if (i == 60000) {
+            throw SeriousBug("SharedMemoryTransport: " + name_ + " was not initialised by the producer");
+        }
+        ::usleep(1000);
+    }
+
+    ASSERT(segment_->size == size_);
+
+    // Claim a slot
+    uint32_t n = segment_->attached.load();
+    do {
+        if (n & CLOSED) {
+            Log::warning() << TimeStamp() << " SharedMemoryTransport: the producer has finished" << std::endl;
+            closed_ = true;
+            return;
+        }
+        if (n >= segment_->workers) {
+            std::ostringstream oss;
+            oss << "SharedMemoryTransport: " << name_ << " has no room for more than "
+                << Plural(segment_->workers, "worker") << ", see --workers";
+            throw SeriousBug(oss.str());
+        }
+    } while (!segment_->attached.compare_exchange_weak(n, n + 1));
+
+    slot_ = n;
+
+    // The pid first: the producer gives up on a slot claimed without one for too long
+    Slot& s = slot(slot_);
+    s.pid   = ::getpid();
+
+    uint32_t state = FREE;
+    if (!s.state.compare_exchange_strong(state, ATTACHED)) {
+        Log::warning() << TimeStamp() << " SharedMemoryTransport: the producer has given up on slot " << (slot_ + 1)
+                       << std::endl;
+        closed_ = true;
+        return;
+    }
+
+    wakeUp(segment_->wakeup, segment_->sleeping);
+}
+
+
+Slot& SharedMemoryTransport::slot(size_t n) const {
+    ASSERT(n < segment_->workers);
+    return segment_->slots()[n];
+}
+
+Ring& SharedMemoryTransport::input(size_t n) const {
+    return slot(n).input;
+}
+
+Ring& SharedMemoryTransport::output(size_t n) const {
+    return slot(n).output;
+}
+
+
+bool SharedMemoryTransport::single() const {
+    return false;
+}
+
+bool SharedMemoryTransport::producer() const {
+    return producer_;
+}
+
+bool SharedMemoryTransport::writer() const {
+    return false;
+}
+
+void SharedMemoryTransport::synchronise() {
+}
+
+
+void SharedMemoryTransport::initialise() {
+
+    ASSERT(producer_);
+
+    Log::info() << TimeStamp() << " " << title() << ", waiting for a worker" << std::endl;
+
+    auto attached = [this] {
+        uint32_t n = segment_->attached.load() & ~CLOSED;
+        for (size_t i = 0; i < n; ++i) {
+            if (slot(i).state.load() == ATTACHED) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    while (!waitUntil(segment_->wakeup, segment_->sleeping, attached, TIMEOUT)) {
+        Log::info() << TimeStamp() << " " << title() << ", waiting for a worker" << std::endl;
+    }
+}
+
+
+bool SharedMemoryTransport::nextWorker(size_t size, size_t& worker) {
+
+    uint32_t n = segment_->attached.load() & ~CLOSED;
+
+    // The worker with the fewest messages queued, starting after the last one used
+    size_t best    = n;
+    size_t fewest  = window_;
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = (next_ + k) % n;
+        if (slot(i).state.load() != ATTACHED) {
+            continue;
+        }
+
+        RingAccess ring(segment_, input(i));
+        size_t queued = ring.queued();
+        if (queued < fewest && ring.fits(size)) {
+            best   = i;
+            fewest = queued;
+            if (queued == 0) {
+                break;
+            }
+        }
+    }
+
+    if (best == n) {
+        return false;
+    }
+
+    worker = best;
+    next_  = best + 1;
+    return true;
+}
+
+
+void SharedMemoryTransport::waitForWorkers(const char* what) {
+
+    uint32_t n = segment_->attached.load() & ~CLOSED;
+    time_t now = ::time(nullptr);
+
+    size_t active = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Slot& s       = slot(i);
+        uint32_t state = s.state.load();
+        pid_t pid      = s.pid.load();
+
+        if (state == ATTACHED && !alive(pid)) {
+            lostWorker(i);
+        }
+
+        // Claimed, but not attached yet. Without a pid after a while, the worker died in between
+        if (state == FREE && (pid ? !alive(pid) : now - starting_.emplace(i, now).first->second >= TIMEOUT)) {
+            lostWorker(i);
+        }
+
+        // Lost, found above or by the worker itself on its way out
+        if (s.state.load() == LOST) {
+            RingAccess ring(segment_, input(i));
+            if (!ring.released()) {
+                size_t count = ring.drain(requeued_);
+                Log::warning() << TimeStamp() << " " << title() << ", " << Plural(count, "message") << " of worker "
+                               << (i + 1) << " sent again to the others" << std::endl;
+            }
+        }
+        else {
+            active++;
+        }
+    }
+
+    if (active == 0) {
+        throw SeriousBug("SharedMemoryTransport: no more workers");
+    }
+
+    if (now - logged_ >= TIMEOUT) {
+        Log::info() << TimeStamp() << " " << title() << ", " << what << "... " << Plural(active, "worker")
+                    << " still active" << std::endl;
+        logged_ = now;
+    }
+}
+
+
+void SharedMemoryTransport::lostWorker(size_t n) {
+    Slot& s = slot(n);
+
+    uint32_t state = s.state.load();
+    while (state == FREE || state == ATTACHED) {
+        if (s.state.compare_exchange_weak(state, LOST)) {
+            Log::error() << TimeStamp() << " " << title() << ", lost worker " << (n + 1) << " (pid " << s.pid.load()
+                         << ")" << std::endl;
+            return;
+        }
+    }
+}
+
+
+void SharedMemoryTransport::push(const void* data, size_t size) {
+
+    size_t worker;
+    if (!nextWorker(size, worker)) {
+        eckit::AutoTiming stall(statistics_.stallTiming_);
+
+        auto ready = [&] { return nextWorker(size, worker); };
+        while (!waitUntil(segment_->wakeup, segment_->sleeping, ready, CHECK)) {
+            waitForWorkers("waiting");
+        }
+    }
+
+    RingAccess ring(segment_, input(worker));
+    bool pushed = ring.push(Actor::WORK, data, size);
+    ASSERT(pushed);
+
+    Slot& s = slot(worker);
+    wakeUp(s.wakeup, s.sleeping);
+
+    statistics_.queueDepth(ring.queued());
+}
+
+
+void SharedMemoryTransport::resend() {
+    // push() may find more lost workers, and add to the back
+    while (!requeued_.empty()) {
+        const Buffer& buffer = requeued_.front();
+        push(buffer, buffer.size());
+        requeued_.pop_front();
+    }
+}
+
+
+void SharedMemoryTransport::sendMessageToNextWorker(const Message &message) {
+
+    eckit::AutoTiming timing(statistics_.sendTiming_);
+
+    size_t size = message.messageSize();
+    if (recordSize(size) > input(0).capacity) {
+        std::ostringstream oss;
+        oss << "SharedMemoryTransport: a message of " << Bytes(size) << " does not fit in a ring of "
+            << Bytes(input(0).capacity) << ", see --ring";
+        throw SeriousBug(oss.str());
+    }
+
+    resend();
+    push(message.messageData(), size);
+
+    statistics_.sendCount_++;
+    statistics_.sendSize_ += size;
+}
+
+
+void SharedMemoryTransport::waitForProducer(const char* what) {
+    if (segment_->aborted.load()) {
+        throw SeriousBug("SharedMemoryTransport: the producer has aborted");
+    }
+    if (!alive(segment_->producer)) {
+        throw SeriousBug("SharedMemoryTransport: the producer has gone");
+    }
+    time_t now = ::time(nullptr);
+    if (now - logged_ >= TIMEOUT) {
+        Log::info() << TimeStamp() << " " << title() << ", " << what << "..." << std::endl;
+        logged_ = now;
+    }
+}
+
+
+void SharedMemoryTransport::getNextWorkMessage(Message &message) {
+
+    message.rewind();
+
+    if (closed_) {
+        message.messageReceived(Actor::SHUTDOWN, 0);
+        return;
+    }
+
+    Slot& s = slot(slot_);
+    RingAccess ring(segment_, s.input);
+
+    // We are done with the previous message, the producer may be waiting for room, or for the work to be done
+    ring.release();
+    wakeUp(segment_->wakeup, segment_->sleeping);
+
+    statistics_.queueDepth(ring.queued());
+
+    for (;;) {
+
+        // Read before looking at the ring: the producer sets it after its last message
+        bool shutdown = s.shutdown.load();
+
+        {
+            eckit::AutoTiming timing(statistics_.receiveTiming_);
+
+            size_t size;
+            if (ring.pop(message, 0, size)) {
+                statistics_.receiveCount_++;
+                statistics_.receiveSize_ += size;
+                return;
+            }
+        }
+
+        if (shutdown) {
+            message.messageReceived(Actor::SHUTDOWN, 0);
+            return;
+        }
+
+        eckit::AutoTiming stall(statistics_.stallTiming_);
+
+        auto ready = [&] { return !ring.empty() || s.shutdown.load() || segment_->aborted.load(); };
+        while (!waitUntil(s.wakeup, s.sleeping, ready, CHECK)) {
+            waitForProducer("waiting for work");
+        }
+
+        if (segment_->aborted.load()) {
+            waitForProducer("aborting");
+        }
+    }
+}
+
+
+void SharedMemoryTransport::sendStatisticsToProducer(const Message &message) {
+
+    if (closed_) {
+        return;
+    }
+
+    Slot& s = slot(slot_);
+    RingAccess ring(segment_, s.output);
+
+    if (recordSize(message.messageSize()) > s.output.capacity) {
+        std::ostringstream oss;
+        oss << "SharedMemoryTransport: statistics of " << Bytes(message.messageSize())
+            << " do not fit in a ring of " << Bytes(s.output.capacity) << ", see --ring";
+        throw SeriousBug(oss.str());
+    }
+
+    auto ready = [&] { return ring.fits(message.messageSize()); };
+    while (!waitUntil(s.wakeup, s.sleeping, ready, CHECK)) {
+        waitForProducer("sending statistics");
+    }
+
+    bool pushed = ring.push(Actor::STATISTICS, message.messageData(), message.messageSize());
+    ASSERT(pushed);
+
+    s.state = DONE;
+    wakeUp(segment_->wakeup, segment_->sleeping);
+}
+
+
+void SharedMemoryTransport::sendShutDownMessage(const Actor& actor) {
+
+    eckit::AutoTiming timing(statistics_.shutdownTiming_);
+
+    // The workers are only told to stop once all the work is processed, the work of those lost until then is
+    // sent again to the others
+    auto processed = [this] {
+        uint32_t n = segment_->attached.load() & ~CLOSED;
+        for (size_t i = 0; i < n; ++i) {
+            if (slot(i).state.load() != LOST && !RingAccess(segment_, input(i)).released()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (;;) {
+        resend();
+
+        bool ready = waitUntil(segment_->wakeup, segment_->sleeping, processed, CHECK);
+        waitForWorkers("waiting for the work to be processed");
+
+        if (ready && requeued_.empty()) {
+            break;
+        }
+    }
+
+    // Workers that attach from now on are told to stop straight away
+    uint32_t n = segment_->attached.fetch_or(CLOSED) & ~CLOSED;
+
+    for (size_t i = 0; i < n; ++i) {
+        Log::info() << TimeStamp() << " " << title() << " shutdown worker " << (i + 1) << std::endl;
+        Slot& s   = slot(i);
+        s.shutdown = 1;
+        wakeUp(s.wakeup, s.sleeping);
+    }
+
+    std::vector<bool> done(n, false);
+    size_t remaining = n;
+
+    auto ready = [&] {
+        for (size_t i = 0; i < n; ++i) {
+            if (!done[i] && (!RingAccess(segment_, output(i)).empty() || slot(i).state.load() == LOST)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    Message message;
+
+    while (remaining) {
+
+        while (!waitUntil(segment_->wakeup, segment_->sleeping, ready, CHECK)) {
+            waitForWorkers("waiting for statistics");
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            if (done[i]) {
+                continue;
+            }
+
+            RingAccess ring(segment_, output(i));
+            size_t size;
+
+            message.rewind();
+            if (ring.pop(message, i + 1, size)) {
+                // The worker may be waiting for room
+                ring.release();
+                wakeUp(slot(i).wakeup, slot(i).sleeping);
+
+                ASSERT(message.tag() == Actor::STATISTICS);
+                actor.messageFromWorker(message, i + 1);
+            }
+            else if (slot(i).state.load() != LOST) {
+                continue;
+            }
+
+            done[i] = true;
+            remaining--;
+        }
+
+        Log::info() << TimeStamp() << " " << title() << " " << Plural(remaining, "worker") << " remaining"
+                    << std::endl;
+    }
+}
+
+
+void SharedMemoryTransport::abort() {
+    if (!segment_) {
+        return;
+    }
+
+    if (producer_) {
+        segment_->aborted = 1;
+        uint32_t n = segment_->attached.load() & ~CLOSED;
+        for (size_t i = 0; i < n; ++i) {
+            wakeUp(slot(i).wakeup, slot(i).sleeping);
+        }
+    }
+    else if (!closed_) {
+        slot(slot_).state = LOST;
+        wakeUp(segment_->wakeup, segment_->sleeping);
+    }
+}
+
+
+void SharedMemoryTransport::sendToWriter(size_t writer, const Message &message) {
+    NOTIMP;
+}
+
+void SharedMemoryTransport::getNextWriteMessage(Message &message) {
+    NOTIMP;
+}
+
+void SharedMemoryTransport::print(std::ostream &out) const {
+    out << "SharedMemoryTransport[name=" << name_ << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static TransportBuilder<SharedMemoryTransport> builder("shm");
+
+
+} // namespace eckit::distributed
@@ -0,0 +1,128 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   SharedMemoryTransport.h
+/// @date   Oct 2026
+
+#ifndef eckit_SharedMemoryTransport_H
+#define eckit_SharedMemoryTransport_H
+
+#include <ctime>
+#include <deque>
+#include <map>
+#include <string>
+
+#include "eckit/distributed/Transport.h"
+#include "eckit/io/Buffer.h"
+
+namespace eckit::option {
+class Option;
+class CmdArgs;
+}
+
+namespace eckit::distributed {
+
+class Message;
+
+namespace shm {
+struct Segment;
+struct Slot;
+struct Ring;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Producer and workers on the same node, exchanging messages through a POSIX shared memory segment.
+///
+/// The producer creates the segment, workers attach to it with --attach. Each worker claims a slot with two
+/// single-producer single-consumer ring buffers: one for its work, one for its statistics. Messages are copied
+/// once into the ring by the sender and once out of it by the receiver, the kernel is only involved to sleep and
+/// wake up (futex), when a ring is empty or full. The producer gives each message to the worker with the fewest
+/// queued, up to a window per worker.
+///
+/// A message stays in the ring of a worker until the worker asks for the next one. If the worker goes, its messages
+/// still in the ring, including the one it was processing, are sent again to the others: a message is processed at
+/// least once. The workers are only told to stop once all the messages are processed.
+///
+/// Options: --shm (segment name, default /eckit-distributed), --window (messages per worker, default 16),
+/// --ring (bytes per ring, default 16MB, bounds the size of a message) and --workers (maximum number of workers,
+/// default 64)
+
+class SharedMemoryTransport : public Transport {
+public: // methods
+
+    SharedMemoryTransport(const eckit::option::CmdArgs &args);
+    virtual ~SharedMemoryTransport() override;
+
+protected: // methods
+
+    virtual void sendMessageToNextWorker(const Message &message) override;
+    virtual void getNextWorkMessage(Message &message) override;
+    virtual void sendStatisticsToProducer(const Message &message) override;
+    virtual void sendShutDownMessage(const Actor&) override;
+
+    virtual bool producer() const override;
+    virtual bool single() const override;
+    virtual void initialise() override;
+    virtual void abort() override;
+    virtual void synchronise() override;
+    virtual bool writer() const override;
+    virtual void sendToWriter(size_t writer, const Message &message) override;
+    virtual void getNextWriteMessage(Message &message) override;
+
+    void print(std::ostream& out) const override;
+
+private: // methods
+
+    void create(size_t workers, size_t ring);
+    void attach();
+
+    shm::Slot& slot(size_t n) const;
+    shm::Ring& input(size_t n) const;
+    shm::Ring& output(size_t n) const;
+
+    // Producer
+    bool nextWorker(size_t size, size_t& worker);
+    void push(const void* data, size_t size);
+    void resend();
+    void waitForWorkers(const char* what);
+    void lostWorker(size_t n);
+
+    // Worker
+    void waitForProducer(const char* what);
+
+private: // members
+
+    std::string name_;
+
+    shm::Segment* segment_;
+    size_t size_;
+
+    bool producer_;
+    bool created_;
+
+    size_t window_;
+
+    size_t slot_;      ///< worker: our slot
+    bool closed_;      ///< worker: the producer was done when we attached
+    size_t next_;      ///< producer: where to start looking for a worker
+
+    std::deque<eckit::Buffer> requeued_;  ///< producer: messages of lost workers, to send again
+    std::map<size_t, time_t> starting_;   ///< producer: when slots were first seen claimed but not attached
+
+    time_t logged_;  ///< when we last said that we were waiting
+
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace eckit::distributed
+
+#endif
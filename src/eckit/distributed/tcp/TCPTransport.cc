@@ -11,9 +11,15 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iterator>
+
 #include "eckit/log/Log.h"
 #include "eckit/log/Seconds.h"
 #include "eckit/log/Plural.h"
+#include "eckit/log/Statistics.h"
 #include "eckit/log/TimeStamp.h"
 #include "eckit/runtime/Main.h"
 
@@ -41,6 +47,9 @@ class Connection : public InstantTCPStream {
     TCPSocket socket_;
     size_t id_;
     bool active_;
+    size_t credits_;
+    bool shutdown_;
+    std::deque<Buffer> inflight_;
 
 private:
 
@@ -52,7 +61,9 @@ public:
         select_(select),
         socket_(socket),
         id_(id),
-        active_(true) {
+        active_(true),
+        credits_(0),
+        shutdown_(false) {
         select_.add(socket_);
     }
 
@@ -66,6 +77,21 @@ public:
 
     bool active() const { return active_; }
 
+    /// Number of messages the worker can take
+    size_t credits() const { return credits_; }
+    void credits(size_t n) { credits_ = n; }
+
+    bool shutdown() const { return shutdown_; }
+    void shutdown(bool on) { shutdown_ = on; }
+
+    /// Messages sent to the worker, not reported as processed yet
+    std::deque<Buffer>& inflight() { return inflight_; }
+
+    void processed(size_t n) {
+        ASSERT(n <= inflight_.size());
+        inflight_.erase(inflight_.begin(), inflight_.begin() + n);
+    }
+
     void disconnect() {
         active_ = false;
         select_.remove(socket_);
@@ -90,12 +116,23 @@ TCPTransport::TCPTransport(const option::CmdArgs &args):
     nextId_(0),
     master_(false),
     worker_(false),
-    writer_(false) {
+    writer_(false),
+    window_(16),
+    batch_(8),
+    requested_(0),
+    done_(0),
+    busy_(false),
+    shutdown_(false) {
 
 
     size_t port = 7777;
     args.get("port", port);
 
+    args.get("window", window_);
+    args.get("batch", batch_);
+    ASSERT(window_ > 0);
+    ASSERT(batch_ > 0);
+
     std::string hostname = Main::hostname();
 
     std::ostringstream oss;
@@ -142,36 +179,57 @@ void TCPTransport::synchronise() {
 }
 
 void TCPTransport::sendMessageToNextWorker(const Message &message) {
-    while (!send(message)) {
-        cleanup();
-        Log::info() << TimeStamp()
-                  << " "
-                  << title()
-                  << ", resending..."
-                  << std::endl;
-        if (connections_.empty()) {
-            throw  SeriousBug("TCPTransport: no more workers");
-        }
+
+    pending_.emplace_back(message.messageData(), message.messageSize());
+
+    statistics_.sendCount_++;
+    statistics_.sendSize_ += message.messageSize();
+    statistics_.queueDepth(pending_.size());
+
+    // Only wait for the workers when the window is full
+    dispatch(window_ - 1);
+}
+
+
+void TCPTransport::dispatch(size_t maxPending) {
+
+    eckit::AutoTiming timing(statistics_.sendTiming_);
+
+    receiveCredits(0);
+    sendBatches();
+
+    while (pending_.size() > maxPending) {
+        eckit::AutoTiming stall(statistics_.stallTiming_);
+
+        receiveCredits(30);
+        sendBatches();
     }
 }
 
 
-bool TCPTransport::send(const Message &message) {
+void TCPTransport::receiveCredits(long timeout) {
 
     cleanup();
 
+    if (connections_.empty()) {
+        throw SeriousBug("TCPTransport: no more workers");
+    }
+
     bool more = true;
     while (more) {
         more = false;
 
-        while (!select_.ready(30)) {
-            Log::info() <<  TimeStamp()
-                      << " "
-                      << title()
-                      << ", waiting... "
-                      << Plural(connections_.size(), "worker")
-                      << " still active"
-                      << std::endl;
+        if (!select_.ready(timeout)) {
+            if (timeout) {
+                Log::info() << TimeStamp()
+                            << " "
+                            << title()
+                            << ", waiting... "
+                            << Plural(connections_.size(), "worker")
+                            << " still active"
+                            << std::endl;
+            }
+            return;
         }
 
         if (select_.set(*accept_)) {
@@ -180,40 +238,64 @@ bool TCPTransport::send(const Message &message) {
         }
     }
 
-    for (auto j = connections_.rbegin(); j != connections_.rend(); ++j) {
+    for (auto j = connections_.begin(); j != connections_.end(); ++j) {
         Connection &connection = **j;
         if (connection.ready()) {
             try {
-
                 size_t tag;
                 connection >> tag;
 
                 ASSERT(tag == Actor::READY);
 
-                // Log::info() << TimeStamp()
-                //           << " "
-                //           << title()
-                //           << " sending to worker "
-                //           << connection.id()
-                //           << " tag " << message.tag()
-                //           << std::endl;
+                size_t credits;
+                size_t done;
+                connection >> credits;
+                connection >> done;
+                connection.credits(connection.credits() + credits);
+                connection.processed(done);
 
-                connection << size_t(message.tag());
-                connection << message.messageSize();
-                connection.writeBlob(message.messageData(), message.messageSize());
+            } catch (std::exception &e) {
+                disconnect(e, connection);
+            }
+        }
+    }
+}
 
-                // Next time, we consider other connections first
-                std::swap(*j, connections_[0]);
 
-                return true;
+void TCPTransport::sendBatches() {
 
-            } catch (std::exception &e) {
-                disconnect(e, connection);
-                continue;
+    for (auto j = connections_.begin(); j != connections_.end() && !pending_.empty(); ++j) {
+        Connection &connection = **j;
+        if (!connection.active() || connection.credits() == 0) {
+            continue;
+        }
+
+        size_t n = std::min(std::min(connection.credits(), pending_.size()), batch_);
+
+        try {
+            connection << size_t(Actor::WORK);
+            connection << n;
+            for (size_t i = 0; i < n; ++i) {
+                connection << pending_[i].size();
+                connection.writeBlob(pending_[i], pending_[i].size());
             }
+        } catch (std::exception &e) {
+            // The messages are sent again to another worker
+            disconnect(e, connection);
+            continue;
         }
+
+        // Kept until the worker reports them processed
+        std::move(pending_.begin(), pending_.begin() + n, std::back_inserter(connection.inflight()));
+        pending_.erase(pending_.begin(), pending_.begin() + n);
+        connection.credits(connection.credits() - n);
+        statistics_.batchCount_++;
+    }
+
+    // Next time, we consider other connections first
+    if (connections_.size() > 1) {
+        std::rotate(connections_.begin(), connections_.begin() + 1, connections_.end());
     }
-    return false;
 }
 
 
@@ -224,6 +306,14 @@ void TCPTransport::cleanup() {
         for (auto j = connections_.begin(); j != connections_.end(); ++j) {
             Connection *connection = *j;
             if (!connection->active()) {
+                // What the worker did not report processed is sent again to the others, first
+                auto& inflight = connection->inflight();
+                if (!inflight.empty()) {
+                    Log::warning() << TimeStamp() << " " << title() << ", " << Plural(inflight.size(), "message")
+                                   << " of worker " << connection->id() << " sent again to the others" << std::endl;
+                    pending_.insert(pending_.begin(), std::make_move_iterator(inflight.begin()),
+                                    std::make_move_iterator(inflight.end()));
+                }
                 delete connection;
                 connections_.erase(j);
                 more = true;
@@ -250,43 +340,101 @@ void TCPTransport::getNextWorkMessage(Message &message) {
 
     auto& connection = producerConnection();
 
-    Log::info() << TimeStamp()
-              << " "
-              << title()
-              << " TCPTransport::getNextWorkMessage -> send"
-              << std::endl;
+    // We are done with the previous message
+    if (busy_) {
+        done_++;
+        busy_ = false;
+    }
 
-    connection << size_t(Actor::READY);
+    requestWork(connection);
 
-    size_t tag;
-    connection >> tag;
-    Log::info() << TimeStamp()
-              << " "
-              << title()
-              << " TCPTransport::getNextWorkMessage got reply"
-              << std::endl;
+    if (queue_.empty() && !shutdown_) {
+        eckit::AutoTiming stall(statistics_.stallTiming_);
+        receiveWork(connection);
+    }
+
+    statistics_.queueDepth(queue_.size());
+
+    message.rewind();
+
+    if (queue_.empty()) {
+        ASSERT(shutdown_);
+        message.messageReceived(Actor::SHUTDOWN, connection.id());
+        return;
+    }
+
+    eckit::Buffer& buffer = queue_.front();
+    message.reserve(buffer.size());
+    ::memcpy(message.messageData(), buffer, buffer.size());
+    queue_.pop_front();
+    busy_ = true;
+
+    message.messageReceived(Actor::WORK, connection.id());
+}
+
+
+void TCPTransport::requestWork(Connection& connection) {
 
-    size_t size;
+    // Ask for more before running out, so that the next messages arrive while we work
+    bool more = queue_.size() + requested_ <= window_ / 2;
 
-    switch (tag) {
+    // Once idle, say what was done anyway: the producer waits for it before telling the workers to stop
+    bool idle = queue_.empty() && done_ > 0;
 
-    case Actor::WORK:
-        connection >> size;
-        ASSERT(size <= message.bufferSize());
-        connection.readBlob(message.messageData(), size);
-        break;
+    if (!shutdown_ && (more || idle)) {
+        size_t credits = more ? window_ - queue_.size() - requested_ : 0;
 
-    case Actor::SHUTDOWN:
-        break;
+        eckit::AutoTiming timing(statistics_.sendTiming_);
+        connection << size_t(Actor::READY);
+        connection << credits;
+        connection << done_;
 
-    default:
-        ASSERT(tag == Actor::WORK || tag == Actor::SHUTDOWN);
-        break;
+        requested_ += credits;
+        done_ = 0;
     }
+}
 
-    message.rewind();
-    message.messageReceived(tag, connection.id());
 
+void TCPTransport::receiveWork(Connection& connection) {
+
+    eckit::AutoTiming timing(statistics_.receiveTiming_);
+
+    while (queue_.empty() && !shutdown_) {
+
+        size_t tag;
+        connection >> tag;
+
+        switch (tag) {
+
+        case Actor::WORK: {
+            size_t n;
+            connection >> n;
+            ASSERT(n <= requested_);
+
+            for (size_t i = 0; i < n; ++i) {
+                size_t size;
+                connection >> size;
+                queue_.emplace_back(size);
+                connection.readBlob(queue_.back(), size);
+
+                statistics_.receiveCount_++;
+                statistics_.receiveSize_ += size;
+            }
+
+            requested_ -= n;
+            statistics_.batchCount_++;
+            break;
+        }
+
+        case Actor::SHUTDOWN:
+            shutdown_ = true;
+            break;
+
+        default:
+            ASSERT(tag == Actor::WORK || tag == Actor::SHUTDOWN);
+            break;
+        }
+    }
 }
 
 void TCPTransport::sendStatisticsToProducer(const Message &message) {
@@ -395,10 +543,55 @@ void TCPTransport::disconnect(std::exception& e, Connection& connection) const {
 }
 
 
+void TCPTransport::sendShutDown(Connection& connection) {
+    if (!connection.shutdown()) {
+        Log::info() << TimeStamp()
+                  << " "
+                  << title()
+                  << " shutdown worker "
+                  << connection.id()
+                  << std::endl;
+        connection << size_t(Actor::SHUTDOWN);
+        connection.shutdown(true);
+    }
+}
+
+
 void TCPTransport::sendShutDownMessage(const Actor& actor) {
 
+    eckit::AutoTiming timing(statistics_.shutdownTiming_);
+
+    // Send what is left, and wait until it is processed: the work of the workers lost until then is sent again
+    // to the others
+    for (;;) {
+        dispatch(0);
+
+        bool processed = true;
+        for (auto j = connections_.begin(); j != connections_.end(); ++j) {
+            processed = processed && (*j)->inflight().empty();
+        }
+
+        if (processed) {
+            break;
+        }
+
+        receiveCredits(30);
+        sendBatches();
+    }
+
     select_.remove(*accept_);
 
+    // Idle workers wait for the messages they asked for, they will not ask again
+    for (auto j = connections_.begin(); j != connections_.end(); ++j) {
+        Connection &connection = **j;
+        try {
+            sendShutDown(connection);
+        } catch (std::exception &e) {
+            disconnect(e, connection);
+        }
+    }
+    cleanup();
+
     while (connections_.size()) {
 
         bool more = true;
@@ -445,13 +638,9 @@ void TCPTransport::sendShutDownMessage(const Actor& actor) {
                     switch (tag) {
 
                     case Actor::READY:
-                        Log::info() << TimeStamp()
-                                  << " "
-                                  << title()
-                                  << " shutdown worker "
-                                  << connection.id()
-                                  << std::endl;
-                        connection << size_t(Actor::SHUTDOWN);
+                        connection >> size;  // credits
+                        connection >> size;  // processed
+                        sendShutDown(connection);
                         break;
 
                     case Actor::STATISTICS:
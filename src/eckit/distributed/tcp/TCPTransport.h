@@ -16,10 +16,12 @@
 #ifndef eckit_TCPTransport_H
 #define eckit_TCPTransport_H
 
+#include <deque>
 #include <vector>
 #include <memory>
 
 #include "eckit/net/TCPServer.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/io/Select.h"
 
 #include "eckit/distributed/Transport.h"
@@ -41,6 +43,17 @@ class Message;
 
 class Connection;
 
+/// Work messages are sent with credit-based flow control: workers announce with READY how many messages they can
+/// take (their window), and the producer sends them up to that many, batched in frames. Workers ask for more before
+/// running out, so that the next messages are on their way while they work.
+/// The producer keeps up to a window of messages that no worker can take yet, and only blocks when it is full.
+///
+/// The messages sent to a worker are kept until the worker reports them processed, with its next READY. If the
+/// connection is lost, they are sent again to the others, so a message is processed at least once. The workers are
+/// only told to stop once all the messages are processed.
+///
+/// Options: --window (messages, default 16) and --batch (messages per frame, default 8)
+
 class TCPTransport : public Transport {
 public: // methods
 
@@ -83,9 +96,18 @@ private: // members
     void accept();
     void connect();
 
-    bool send(const Message &message);
     void cleanup();
 
+    // Producer
+    void dispatch(size_t maxPending);
+    void receiveCredits(long timeout);
+    void sendBatches();
+    void sendShutDown(Connection&);
+
+    // Worker
+    void requestWork(Connection&);
+    void receiveWork(Connection&);
+
     mutable std::unique_ptr<Connection> producer_;
 
     mutable std::unique_ptr<eckit::net::TCPServer> accept_;
@@ -100,6 +122,16 @@ private: // members
     bool worker_;
     bool writer_;
 
+    size_t window_;
+    size_t batch_;
+
+    std::deque<eckit::Buffer> pending_;  ///< producer: messages not sent yet
+    std::deque<eckit::Buffer> queue_;    ///< worker: messages received, not processed yet
+    size_t requested_;                   ///< worker: credits given to the producer, not used yet
+    size_t done_;                        ///< worker: messages processed, not reported to the producer yet
+    bool busy_;                          ///< worker: a message is being processed
+    bool shutdown_;                      ///< worker: shutdown received
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
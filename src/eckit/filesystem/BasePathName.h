@@ -16,6 +16,8 @@
 #ifndef eckit_filesystem_BasePathName_h
 #define eckit_filesystem_BasePathName_h
 
+#include <functional>
+
 #include "eckit/eckit.h"
 
 #include "eckit/io/DataHandle.h"
@@ -57,6 +59,7 @@ public:
     virtual void touch() const                                                                       = 0;
     virtual void children(std::vector<BasePathName*>& files, std::vector<BasePathName*>& dirs) const = 0;
     virtual void match(std::vector<BasePathName*>&, bool) const                                      = 0;
+    virtual void walk(const std::function<void(BasePathName*, bool)>&, size_t threads) const         = 0;
     virtual void reserve(const Length&) const                                                        = 0;
 
     virtual BasePathName* unique() const                      = 0;
@@ -166,6 +166,11 @@ void BasePathNameT<T>::match(std::vector<BasePathName*>& result, bool rec) const
         result.push_back(new BasePathNameT<T>(*j));
 }
 
+template <class T>
+void BasePathNameT<T>::walk(const std::function<void(BasePathName*, bool)>& visitor, size_t threads) const {
+    path_.walk([&visitor](const T& p, bool dir) { visitor(new BasePathNameT<T>(p), dir); }, threads);
+}
+
 template <class T>
 void BasePathNameT<T>::reserve(const Length& length) const {
     path_.reserve(length);
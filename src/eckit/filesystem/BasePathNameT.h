@@ -73,6 +73,7 @@ private:
     void touch() const override;
     void children(std::vector<BasePathName*>& files, std::vector<BasePathName*>& dirs) const override;
     void match(std::vector<BasePathName*>&, bool) const override;
+    void walk(const std::function<void(BasePathName*, bool)>&, size_t threads) const override;
     void reserve(const Length&) const override;
 
     BasePathName* unique() const override;
@@ -10,7 +10,10 @@
 
 #include "LocalPathName.h"
 
+#include "eckit/eckit.h"
+
 #include <dirent.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <pwd.h>
 #include <stdlib.h>
@@ -20,10 +23,21 @@
 #include <unistd.h>
 #include <utime.h>
 
+#if eckit_HAVE_GETDENTS64
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>  // for strlen
 #include <deque>
+#include <exception>
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "eckit/config/LibEcKit.h"
@@ -738,6 +752,232 @@ void LocalPathName::children(std::vector<LocalPathName>& files, std::vector<Loca
     }
 }
 
+namespace {
+
+size_t walkThreads() {
+    static long threads = Resource<long>("directoryWalkThreads;$ECKIT_DIRECTORY_WALK_THREADS", 8);
+    return std::max(threads, 1L);
+}
+
+/// Reads a directory in batches of entries, with their type when the file system provides it
+class DirectoryReader {
+public:
+    using Entries = std::vector<std::pair<std::string, bool> >;  // name, directory
+
+    explicit DirectoryReader(const LocalPathName& path) :
+        path_(path) {
+#if eckit_HAVE_GETDENTS64
+        fd_ = ::open(path.localPath(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd_ < 0) {
+            Log::error() << "open(" << path << ")" << Log::syserr << std::endl;
+            throw FailedSystemCall(std::string("open(") + path.localPath() + ")");
+        }
+        buffer_.resize(256 * 1024);
+#else
+        dir_ = ::opendir(path.localPath());
+        if (!dir_) {
+            Log::error() << "opendir(" << path << ")" << Log::syserr << std::endl;
+            throw FailedSystemCall(std::string("opendir(") + path.localPath() + ")");
+        }
+#endif
+    }
+
+    ~DirectoryReader() {
+#if eckit_HAVE_GETDENTS64
+        ::close(fd_);
+#else
+        ::closedir(dir_);
+#endif
+    }
+
+    /// Replaces entries with the next batch, . and .. excluded
+    /// @returns false at the end of the directory
+    bool next(Entries& entries) {
+        entries.clear();
+
+#if eckit_HAVE_GETDENTS64
+        // Layout of the records returned by the system call
+        struct linux_dirent64 {
+            uint64_t d_ino;
+            int64_t d_off;
+            unsigned short d_reclen;
+            unsigned char d_type;
+            char d_name[1];
+        };
+
+        long n;
+        while ((n = ::syscall(SYS_getdents64, fd_, &buffer_[0], buffer_.size())) < 0 && errno == EINTR) {}
+
+        if (n < 0) {
+            Log::error() << "getdents64(" << path_ << ")" << Log::syserr << std::endl;
+            throw FailedSystemCall(std::string("getdents64(") + path_.localPath() + ")");
+        }
+
+        for (long pos = 0; pos < n;) {
+            const linux_dirent64* e = reinterpret_cast<const linux_dirent64*>(&buffer_[pos]);
+            add(entries, e->d_name, e->d_type);
+            pos += e->d_reclen;
+        }
+
+        return n > 0;
+#else
+        struct dirent* e;
+        while (entries.size() < 1024 && (e = ::readdir(dir_)) != nullptr) {
+#if eckit_HAVE_DIRENT_D_TYPE
+            add(entries, e->d_name, e->d_type);
+#else
+            add(entries, e->d_name, DT_UNKNOWN);
+#endif
+        }
+        return !entries.empty();
+#endif
+    }
+
+private:
+    void add(Entries& entries, const char* name, unsigned char type) {
+        if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+            return;
+        }
+
+        // As children(): stat, so that a link to a directory is one
+        if (type == DT_UNKNOWN) {
+            Stat::Struct info;
+            LocalPathName full = path_ + "/" + name;
+            if (Stat::stat(full.localPath(), &info) != 0) {
+                Log::error() << "Cannot stat " << full << Log::syserr << std::endl;
+                return;
+            }
+            type = S_ISDIR(info.st_mode) ? DT_DIR : DT_REG;
+        }
+
+        entries.emplace_back(name, type == DT_DIR);
+    }
+
+    LocalPathName path_;
+#if eckit_HAVE_GETDENTS64
+    int fd_;
+    std::vector<char> buffer_;
+#else
+    DIR* dir_;
+#endif
+};
+
+/// Directories waiting to be read are shared by a pool of threads, which report their entries to the visitor
+/// as they read them
+class DirectoryWalker {
+public:
+    using Visitor = std::function<void(const LocalPathName&, bool)>;
+
+    explicit DirectoryWalker(const Visitor& visitor) :
+        visitor_(visitor) {}
+
+    void run(const LocalPathName& root, size_t threads) {
+        pending_.push_back(root);
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    void work() {
+        for (;;) {
+            LocalPathName dir;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stop_ || !pending_.empty() || busy_ == 0; });
+                if (stop_ || pending_.empty()) {
+                    return;
+                }
+
+                // Depth first, to bound the number of directories waiting
+                dir = pending_.back();
+                pending_.pop_back();
+                busy_++;
+            }
+
+            try {
+                read(dir);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                stop_ = true;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_--;
+            if (stop_ || (busy_ == 0 && pending_.empty())) {
+                ready_.notify_all();
+            }
+        }
+    }
+
+    void read(const LocalPathName& dir) {
+        DirectoryReader reader(dir);
+        DirectoryReader::Entries entries;
+        std::vector<LocalPathName> paths;
+        std::vector<LocalPathName> subdirs;
+
+        while (reader.next(entries)) {
+            paths.clear();
+            subdirs.clear();
+            for (const auto& e : entries) {
+                paths.push_back(dir + "/" + e.first);
+                if (e.second) {
+                    subdirs.push_back(paths.back());
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(visitorMutex_);
+                for (size_t i = 0; i < paths.size(); ++i) {
+                    if (stop_) {
+                        return;
+                    }
+                    visitor_(paths[i], entries[i].second);
+                }
+            }
+
+            // Only now, so that directories are visited before their content
+            if (!subdirs.empty()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_.insert(pending_.end(), subdirs.begin(), subdirs.end());
+                ready_.notify_all();
+            }
+        }
+    }
+
+    const Visitor& visitor_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<LocalPathName> pending_;
+    size_t busy_ = 0;
+    std::atomic<bool> stop_{false};  ///< also read by the threads calling the visitor
+    std::exception_ptr error_;
+
+    std::mutex visitorMutex_;
+};
+
+}  // namespace
+
+void LocalPathName::walk(const std::function<void(const LocalPathName&, bool)>& visitor, size_t threads) const {
+    DirectoryWalker walker(visitor);
+    walker.run(*this, threads ? threads : walkThreads());
+}
+
 void LocalPathName::touch() const {
     dirName().mkdir();
 
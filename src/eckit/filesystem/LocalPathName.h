@@ -17,6 +17,8 @@
 #ifndef eckit_filesystem_LocalPathName_h
 #define eckit_filesystem_LocalPathName_h
 
+#include <functional>
+
 #include "eckit/io/Length.h"
 #include "eckit/io/Offset.h"
 #include "eckit/serialisation/Stream.h"
@@ -233,6 +235,15 @@ public:  // methods
     /// @param directories vector to be filled with child diretories of path
     void children(std::vector<LocalPathName>& files, std::vector<LocalPathName>& dirs) const;
 
+    /// Visits all the files and directories under path, descending into sub directories with a pool of threads
+    /// (0 for the default). Entries are read in large batches and their type taken from the directory, so that
+    /// they are not stat'ed on file systems that provide it. As with children(), symbolic links are then reported as
+    /// files and not followed; on file systems that do not provide the type, entries are stat'ed, so links are
+    /// reported as what they point to and links to directories are followed.
+    /// @param visitor called with each entry and whether it is a directory, as they are found, one call at a time.
+    ///                A directory is visited before its content.
+    void walk(const std::function<void(const LocalPathName&, bool)>& visitor, size_t threads = 0) const;
+
     const std::string& node() const;
 
     /// String representation
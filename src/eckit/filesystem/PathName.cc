@@ -210,6 +210,10 @@ void PathName::childrenRecursive(std::vector<PathName>& files, std::vector<PathN
     }
 }
 
+void PathName::walk(const std::function<void(const PathName&, bool)>& visitor, size_t threads) const {
+    path_->walk([&visitor](BasePathName* p, bool dir) { visitor(PathName(p), dir); }, threads);
+}
+
 void PathName::match(const PathName& path, std::vector<PathName>& result, bool rec) {
     std::vector<BasePathName*> v;
     path.path_->match(v, rec);
@@ -23,6 +23,7 @@
 #include "eckit/serialisation/Stream.h"
 #include "eckit/types/Types.h"
 
+#include <functional>
 #include <map>
 #include <mutex>
 
@@ -226,6 +227,11 @@ public:
     /// @param directories vector to be filled with child diretories of path
     void childrenRecursive(std::vector<PathName>& files, std::vector<PathName>& dirs) const;
 
+    /// Visits all the files and directories under path, with a pool of threads (0 for the default)
+    /// @param visitor called with each entry and whether it is a directory, as they are found, one call at a time.
+    ///                A directory is visited before its content.
+    void walk(const std::function<void(const PathName&, bool)>& visitor, size_t threads = 0) const;
+
     void fileSystemSize(FileSystemSize&) const;
 
     DataHandle* fileHandle(bool overwrite = false) const;
@@ -102,6 +102,81 @@ double Sphere::centralAngle(const double& radius, const Point3& A, const Point3&
     return angle;
 }
 
+void Sphere::centralAngle(const Point2& Alonlat,
+                          size_t n,
+                          const double* Blon,
+                          const double* Blat,
+                          double* angle,
+                          bool normalise_angle) {
+    // As centralAngle(Alonlat, Blonlat), with the trigonometry of A hoisted out and the points processed in blocks
+    // of independent, branch-free iterations so that the compiler can vectorise them
+
+    if (!normalise_angle) {
+        assert_latitude_range(Alonlat[1]);
+        for (size_t i = 0; i < n; ++i) {
+            assert_latitude_range(Blat[i]);
+        }
+    }
+
+    const Point2 alonlat = canonicaliseOnSphere(Alonlat);
+
+    const double phi1     = degrees_to_radians * alonlat[1];
+    const double cos_phi1 = std::cos(phi1);
+    const double sin_phi1 = std::sin(phi1);
+
+    constexpr size_t block = 256;
+    double lon[block];
+    double lat[block];
+
+    for (size_t start = 0; start < n; start += block) {
+        const size_t m = std::min(block, n - start);
+
+        // Only latitudes outside [-90, 90] need canonicalising, longitudes enter through periodic functions
+        for (size_t j = 0; j < m; ++j) {
+            lon[j] = Blon[start + j];
+            lat[j] = Blat[start + j];
+        }
+        if (normalise_angle) {
+            for (size_t j = 0; j < m; ++j) {
+                if (lat[j] < -90. || lat[j] > 90.) {
+                    const Point2 p = canonicaliseOnSphere({lon[j], lat[j]});
+                    lon[j]         = p[0];
+                    lat[j]         = p[1];
+                }
+            }
+        }
+
+        double* result = angle + start;
+        for (size_t j = 0; j < m; ++j) {
+            const double phi2   = degrees_to_radians * lat[j];
+            const double lambda = degrees_to_radians * (lon[j] - alonlat[0]);
+
+            const double cos_phi2   = std::cos(phi2);
+            const double sin_phi2   = std::sin(phi2);
+            const double cos_lambda = std::cos(lambda);
+            const double sin_lambda = std::sin(lambda);
+
+            const double a = std::atan2(std::sqrt(squared(cos_phi2 * sin_lambda)
+                                                  + squared(cos_phi1 * sin_phi2 - sin_phi1 * cos_phi2 * cos_lambda)),
+                                        sin_phi1 * sin_phi2 + cos_phi1 * cos_phi2 * cos_lambda);
+
+            result[j] = a <= std::numeric_limits<double>::epsilon() ? 0. : a;
+        }
+    }
+}
+
+void Sphere::distance(const double& radius,
+                      const Point2& Alonlat,
+                      size_t n,
+                      const double* Blon,
+                      const double* Blat,
+                      double* distance) {
+    centralAngle(Alonlat, n, Blon, Blat, distance, true);
+    for (size_t i = 0; i < n; ++i) {
+        distance[i] *= radius;
+    }
+}
+
 double Sphere::distance(const double& radius, const Point2& Alonlat, const Point2& Blonlat) {
     return radius * centralAngle(Alonlat, Blonlat, true);
 }
@@ -11,6 +11,8 @@
 #ifndef Sphere_H
 #define Sphere_H
 
+#include <cstddef>
+
 //----------------------------------------------------------------------------------------------------------------------
 
 namespace eckit::geometry {
@@ -31,12 +33,30 @@ struct Sphere {
     /// Great-circle central angle between two points (Cartesian coordinates) in radians
     static double centralAngle(const double& radius, const Point3& A, const Point3& B);
 
+    /// Great-circle central angles between a point and n points (longitude/latitude coordinates, as separate arrays)
+    /// in radians
+    static void centralAngle(const Point2& Alonlat,
+                             size_t n,
+                             const double* Blon,
+                             const double* Blat,
+                             double* angle,
+                             bool normalise_angle = false);
+
     /// Great-circle distance between two points (latitude/longitude coordinates) in metres
     static double distance(const double& radius, const Point2& Alonlat, const Point2& Blonlat);
 
     /// Great-circle distance between two points (Cartesian coordinates) in metres
     static double distance(const double& radius, const Point3& A, const Point3& B);
 
+    /// Great-circle distances between a point and n points (longitude/latitude coordinates, as separate arrays) in
+    /// metres
+    static void distance(const double& radius,
+                         const Point2& Alonlat,
+                         size_t n,
+                         const double* Blon,
+                         const double* Blat,
+                         double* distance);
+
     /// Surface area in square metres
     static double area(const double& radius);
 
@@ -38,6 +38,12 @@ struct SphereT {
         return Sphere::centralAngle(DATUM::radius(), A, B);
     }
 
+    /// Great-circle central angles between a point and n points (longitude/latitude coordinates) in radians
+    inline static void centralAngle(const Point2& Alonlat, size_t n, const double* Blon, const double* Blat,
+                                    double* angle, bool normalise_angle = false) {
+        Sphere::centralAngle(Alonlat, n, Blon, Blat, angle, normalise_angle);
+    }
+
     /// Great-circle distance between two points (longitude/latitude coordinates) in metres
     inline static double distance(const Point2& Alonlat, const Point2& Blonlat) {
         return Sphere::distance(DATUM::radius(), Alonlat, Blonlat);
@@ -46,6 +52,12 @@ struct SphereT {
     /// Great-circle distance between two points (Cartesian coordinates) in metres
     inline static double distance(const Point3& A, const Point3& B) { return Sphere::distance(DATUM::radius(), A, B); }
 
+    /// Great-circle distances between a point and n points (longitude/latitude coordinates) in metres
+    inline static void distance(const Point2& Alonlat, size_t n, const double* Blon, const double* Blat,
+                                double* distance) {
+        Sphere::distance(DATUM::radius(), Alonlat, n, Blon, Blat, distance);
+    }
+
     /// Surface area in square metres
     inline static double area() { return Sphere::area(DATUM::radius()); }
 
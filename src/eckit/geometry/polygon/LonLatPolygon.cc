@@ -10,7 +10,10 @@
 
 #include "eckit/geometry/polygon/LonLatPolygon.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <ostream>
 
 #include "eckit/exception/Exceptions.h"
@@ -89,6 +92,62 @@ LonLatPolygon::LonLatPolygon(const std::vector<Point2>& points, bool includePole
     ASSERT(is_approximately_greater_or_equal(90, max_[LAT]));
 
     quickCheckLongitude_ = is_approximately_greater_or_equal(360, max_[LON] - min_[LON]);
+
+    setupBands();
+}
+
+void LonLatPolygon::setupBands() {
+    const size_t edges = size() - 1;
+
+    // An edge belongs to all the bands its closed latitude range overlaps. band() is monotonic, so a point within
+    // the latitude range of an edge always falls in one of its bands. Long meridional edges span many bands, so
+    // bands are halved until the index holds a bounded number of entries per edge
+    const size_t maxEntries = 16 * edges;
+
+    auto entries = [this]() {
+        size_t total = 0;
+        for (size_t i = 1; i < size(); ++i) {
+            const auto lat = std::minmax(operator[](i - 1)[LAT], operator[](i)[LAT]);
+            total += band(lat.second) - band(lat.first) + 1;
+        }
+        return total;
+    };
+
+    for (size_t bands = std::max<size_t>(1, std::min<size_t>(edges / 2, 4096));; bands /= 2) {
+        bandScale_ = max_[LAT] > min_[LAT] ? double(bands) / (max_[LAT] - min_[LAT]) : 0.;
+        bandOffsets_.assign(bands + 1, 0);
+        if (bands == 1 || entries() <= maxEntries) {
+            break;
+        }
+    }
+
+    const size_t bands = bandOffsets_.size() - 1;
+
+    std::vector<size_t> counts(bands, 0);
+    for (size_t i = 1; i < size(); ++i) {
+        const auto lat = std::minmax(operator[](i - 1)[LAT], operator[](i)[LAT]);
+        for (size_t b = band(lat.first); b <= band(lat.second); ++b) {
+            counts[b]++;
+        }
+    }
+
+    for (size_t b = 0; b < bands; ++b) {
+        bandOffsets_[b + 1] = bandOffsets_[b] + counts[b];
+    }
+
+    bandEdges_.resize(bandOffsets_.back());
+    std::vector<size_t> next(bandOffsets_.begin(), bandOffsets_.end() - 1);
+    for (size_t i = 1; i < size(); ++i) {
+        const auto lat = std::minmax(operator[](i - 1)[LAT], operator[](i)[LAT]);
+        for (size_t b = band(lat.first); b <= band(lat.second); ++b) {
+            bandEdges_[next[b]++] = i;
+        }
+    }
+}
+
+size_t LonLatPolygon::band(double lat) const {
+    const double b = std::floor((lat - min_[LAT]) * bandScale_);
+    return b <= 0 ? 0 : std::min(static_cast<size_t>(b), bandOffsets_.size() - 2);
 }
 
 void LonLatPolygon::print(std::ostream& out) const {
@@ -133,13 +192,170 @@ bool LonLatPolygon::contains(const Point2& Plonlat, bool normalise_angle) const
         }
     }
 
+    return containsCanonical(lon, lat);
+}
+
+void LonLatPolygon::contains(size_t n, const double* lon, const double* lat, bool* inside,
+                             bool normalise_angle) const {
+    if (!normalise_angle) {
+        for (size_t i = 0; i < n; ++i) {
+            assert_latitude_range(lat[i]);
+        }
+    }
+
+    // Poles and bounding box, as for a single point; the points left are sorted by band
+    const size_t bands = bandOffsets_.size() - 1;
+    std::vector<size_t> offsets(bands + 1, 0);
+    std::vector<size_t> pending;
+    std::vector<Point2> canonical;
+
+    for (size_t i = 0; i < n; ++i) {
+        const Point2 p = canonicaliseOnSphere({lon[i], lat[i]}, min_[LON]);
+        const auto x   = p[LON];
+        const auto y   = p[LAT];
+
+        inside[i] = (includeNorthPole_ && is_approximately_equal(y, 90)) ||
+                    (includeSouthPole_ && is_approximately_equal(y, -90));
+        if (inside[i]) {
+            continue;
+        }
+
+        if (!is_approximately_greater_or_equal(y, min_[LAT]) || !is_approximately_greater_or_equal(max_[LAT], y)) {
+            continue;
+        }
+        if (quickCheckLongitude_) {
+            if (!is_approximately_greater_or_equal(x, min_[LON]) || !is_approximately_greater_or_equal(max_[LON], x)) {
+                continue;
+            }
+        }
+
+        pending.push_back(i);
+        canonical.push_back(p);
+        offsets[band(y) + 1]++;
+    }
+
+    for (size_t b = 0; b < bands; ++b) {
+        offsets[b + 1] += offsets[b];
+    }
+
+    std::vector<size_t> order(pending.size());
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t k = 0; k < pending.size(); ++k) {
+        order[next[band(canonical[k][LAT])]++] = k;
+    }
+
+    std::vector<double> x(pending.size());
+    std::vector<double> y(pending.size());
+    for (size_t j = 0; j < order.size(); ++j) {
+        x[j] = canonical[order[j]][LON];
+        y[j] = canonical[order[j]][LAT];
+    }
+
+    std::unique_ptr<bool[]> result(new bool[pending.size()]);
+    for (size_t b = 0; b < bands; ++b) {
+        if (offsets[b] != offsets[b + 1]) {
+            const size_t m = offsets[b + 1] - offsets[b];
+            containsCanonical(b, m, x.data() + offsets[b], y.data() + offsets[b], result.get() + offsets[b]);
+        }
+    }
+
+    for (size_t j = 0; j < order.size(); ++j) {
+        inside[pending[order[j]]] = result[j];
+    }
+}
+
+void LonLatPolygon::containsCanonical(size_t band, size_t n, const double* lon, const double* lat,
+                                      bool* inside) const {
+    const auto* edge     = bandEdges_.data() + bandOffsets_[band];
+    const auto* edge_end = bandEdges_.data() + bandOffsets_[band + 1];
+
+    // Points of the band still tested, and their winding number state (as in the single point test)
+    std::vector<size_t> points(n);
+    std::vector<int> wn(n);
+    std::vector<int> prev(n);
+    std::vector<int> onEdge(n);
+
+    for (size_t k = 0; k < n; ++k) {
+        points[k] = k;
+    }
+
+    std::vector<double> x(lon, lon + n);
+    std::vector<double> y(lat, lat + n);
+
+    while (!points.empty()) {
+        const size_t m = points.size();
+        std::fill_n(wn.begin(), m, 0);
+        std::fill_n(prev.begin(), m, 0);
+        std::fill_n(onEdge.begin(), m, 0);
+
+        const double* px = x.data();
+        const double* py = y.data();
+        int* pwn         = wn.data();
+        int* pprev       = prev.data();
+        int* ponEdge     = onEdge.data();
+
+        for (const auto* e = edge; e != edge_end; ++e) {
+            const auto& A   = operator[](*e - 1);
+            const auto& B   = operator[](*e);
+            const double ax = A[LON];
+            const double ay = A[LAT];
+            const double bx = B[LON];
+            const double by = B[LAT];
+
+            // Branch-free form of the single point test, with bitwise rather than logical operators (vectorised by
+            // GCC at -O3 for targets beyond SSE2, e.g. x86-64-v2 or AVX2)
+            for (size_t k = 0; k < m; ++k) {
+                const double xk = px[k];
+                const double yk = py[k];
+
+                // on_direction: 1 (up) takes precedence over -1 (down)
+                const int up        = (ay <= yk) & (yk <= by);
+                const int down      = (by <= yk) & (yk <= ay) & (1 - up);
+                const int direction = up - down;
+
+                // on_side: is_approximately_equal(p, 0, 1e-10) is |p| <= 1e-10
+                const double p = (xk - bx) * (ay - by) - (yk - by) * (ax - bx);
+                const int zero = std::abs(p) <= 1e-10;
+                const int pos  = (1 - zero) & (p > 0);
+                const int neg  = (1 - zero) & (1 - pos);
+
+                const int onLon = ((ax <= xk) & (xk <= bx)) | ((bx <= xk) & (xk <= ax));
+                ponEdge[k] |= (up | down) & zero & onLon;
+
+                const int cross = ((pprev[k] != 1) & up & pos) | ((pprev[k] != -1) & down & neg);
+                pwn[k] += cross * direction;
+                pprev[k] += cross * (direction - pprev[k]);
+            }
+        }
+
+        // Points outside are tested again one turn east, while within the longitude range
+        size_t left = 0;
+        for (size_t k = 0; k < m; ++k) {
+            inside[points[k]] = ponEdge[k] != 0 || pwn[k] != 0;
+            if (!inside[points[k]] && x[k] + 360 <= max_[LON]) {
+                points[left] = points[k];
+                x[left]      = x[k] + 360;
+                y[left]      = y[k];
+                left++;
+            }
+        }
+        points.resize(left);
+    }
+}
+
+bool LonLatPolygon::containsCanonical(double lon, double lat) const {
+    const size_t b       = band(lat);
+    const auto* edge     = bandEdges_.data() + bandOffsets_[b];
+    const auto* edge_end = bandEdges_.data() + bandOffsets_[b + 1];
+
     do {
         // winding number
         int wn   = 0;
         int prev = 0;
 
-        // loop on polygon edges
-        for (size_t i = 1; i < size(); ++i) {
+        // loop on polygon edges spanning the point latitude, in order (other edges cannot cross it)
+        for (const auto* e = edge; e != edge_end; ++e) {
+            const size_t i = *e;
             const auto& A = operator[](i - 1);
             const auto& B = operator[](i);
 
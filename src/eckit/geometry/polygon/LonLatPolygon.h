@@ -62,9 +62,27 @@ public:
     /// @return if point (lon,lat) is in polygon
     bool contains(const Point2& Plonlat, bool normalise_angle = false) const;
 
+    /// @brief Point-in-polygon test on many points, given as separate arrays of longitudes and latitudes
+    /// @note points are grouped by latitude band, and the winding numbers of the points of a band are computed one
+    /// edge at a time over all the points, in a loop without branches that the compiler can vectorise
+    /// @param[in] n number of points
+    /// @param[in] lon point longitudes
+    /// @param[in] lat point latitudes
+    /// @param[out] inside if each point (lon,lat) is in polygon
+    /// @param[in] normalise_angle normalise point angles
+    void contains(size_t n, const double* lon, const double* lat, bool* inside, bool normalise_angle = false) const;
+
 private:
     // -- Methods
 
+    void setupBands();
+
+    bool containsCanonical(double lon, double lat) const;
+
+    void containsCanonical(size_t band, size_t n, const double* lon, const double* lat, bool* inside) const;
+
+    size_t band(double lat) const;
+
     void print(std::ostream&) const;
     friend std::ostream& operator<<(std::ostream&, const LonLatPolygon&);
 
@@ -75,6 +93,12 @@ private:
     bool includeNorthPole_;
     bool includeSouthPole_;
     bool quickCheckLongitude_;
+
+    // Edges crossing each latitude band, so that a point is only tested against the edges spanning its latitude.
+    // Edge i joins points i-1 and i; band b lists its edges in bandEdges_[bandOffsets_[b]:bandOffsets_[b+1]]
+    std::vector<size_t> bandOffsets_;
+    std::vector<size_t> bandEdges_;
+    double bandScale_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -12,6 +12,7 @@
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 
 namespace eckit {
 
@@ -19,12 +20,12 @@ namespace eckit {
 
 namespace {
 
-static char* allocate(size_t size) {
-    return new char[size];
+static char* allocate(size_t size, size_t& capacity) {
+    return BufferPool::instance().allocate(size, capacity);
 }
 
-static void deallocate(char* buffer) {
-    delete[] buffer;
+static void deallocate(char* buffer, size_t capacity) {
+    BufferPool::instance().deallocate(buffer, capacity);
 }
 
 }  // namespace
@@ -49,9 +50,10 @@ Buffer::Buffer(const std::string& s) :
 }
 
 Buffer::Buffer(Buffer&& rhs) noexcept :
-    buffer_{rhs.buffer_}, size_{rhs.size_} {
-    rhs.buffer_ = nullptr;
-    rhs.size_   = 0;
+    buffer_{rhs.buffer_}, size_{rhs.size_}, capacity_{rhs.capacity_} {
+    rhs.buffer_   = nullptr;
+    rhs.size_     = 0;
+    rhs.capacity_ = 0;
 }
 
 Buffer& Buffer::operator=(Buffer&& rhs) noexcept {
@@ -59,13 +61,15 @@ Buffer& Buffer::operator=(Buffer&& rhs) noexcept {
         return *this;
     }
 
-    deallocate(buffer_);
+    deallocate(buffer_, capacity_);
 
-    buffer_ = rhs.buffer_;
-    size_   = rhs.size_;
+    buffer_   = rhs.buffer_;
+    size_     = rhs.size_;
+    capacity_ = rhs.capacity_;
 
-    rhs.buffer_ = nullptr;
-    rhs.size_   = 0;
+    rhs.buffer_   = nullptr;
+    rhs.size_     = 0;
+    rhs.capacity_ = 0;
 
     return *this;
 }
@@ -81,14 +85,15 @@ void Buffer::zero() {
 }
 
 void Buffer::create() {
-    buffer_ = allocate(size_);
+    buffer_ = allocate(size_, capacity_);
 }
 
 void Buffer::destroy() {
     if (buffer_) {
-        deallocate(buffer_);
-        buffer_ = nullptr;
-        size_   = 0;
+        deallocate(buffer_, capacity_);
+        buffer_   = nullptr;
+        size_     = 0;
+        capacity_ = 0;
     }
 }
 
@@ -107,17 +112,14 @@ void Buffer::copy(const void* p, size_t size, size_t pos) {
 void Buffer::resize(size_t size, bool preserveData) {
     if (size != size_) {
         if (preserveData) {
-            char* newbuffer = allocate(size);
-            ::memcpy(newbuffer, buffer_, std::min(size_, size));
-            deallocate(buffer_);
-            size_   = size;
-            buffer_ = newbuffer;
+            buffer_ = BufferPool::instance().reallocate(buffer_, capacity_, size_, size, capacity_);
         }
-        else {
-            deallocate(buffer_);
-            size_   = size;
-            buffer_ = allocate(size);
+        else if (BufferPool::instance().capacity(size) != capacity_) {
+            deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+            buffer_ = allocate(size, capacity_);
         }
+        size_ = size;
     }
 }
 
@@ -23,6 +23,7 @@
 namespace eckit {
 
 /// Simple class to implement memory buffers
+/// Memory comes from BufferPool: page aligned from one page up, reused and grown in place when large
 
 class Buffer : private NonCopyable {
 public:  // methods
@@ -52,10 +53,14 @@ public:  // methods
     /// @return allocated size
     size_t size() const { return size_; }
 
+    /// @return size of the memory behind the buffer, at least size()
+    size_t capacity() const { return capacity_; }
+
     /// Zero content of buffer
     void zero();
 
-    /// @post Invalidates contents of buffer
+    /// @post Invalidates contents of buffer, unless preserveData
+    /// @note Memory is kept when the new size falls in the same size class
     void resize(size_t, bool preserveData = false);
 
     /// Copy data of given size (bytes) into buffer at given position
@@ -71,6 +76,7 @@ protected:  // methods
 private:  // members
     char* buffer_{nullptr};
     size_t size_{0};
+    size_t capacity_{0};
 };
 
 }  // namespace eckit
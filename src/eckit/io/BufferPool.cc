@@ -0,0 +1,286 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include "eckit/eckit.h"
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/log/BigNum.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const size_t hugePageSize = 2 * 1024 * 1024;
+
+/// From there, size classes are whole huge pages anyway
+const size_t hugePageRounding = 8 * hugePageSize;
+
+size_t pageSize() {
+    static size_t page = ::sysconf(_SC_PAGE_SIZE);
+    return page;
+}
+
+size_t roundUp(size_t size, size_t multiple) {
+    return (size + multiple - 1) / multiple * multiple;
+}
+
+char* alignedMalloc(size_t size) {
+    void* p = nullptr;
+    if (size >= pageSize()) {
+        if (::posix_memalign(&p, pageSize(), size) != 0) {
+            p = nullptr;
+        }
+    }
+    else {
+        p = ::malloc(size);
+    }
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return static_cast<char*>(p);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BufferPool& BufferPool::instance() {
+    // Never deleted, buffers may be released by static destructors
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+BufferPool::BufferPool() :
+    minimumSize_(Resource<size_t>("bufferPoolMinimumSize;$ECKIT_BUFFER_POOL_MINIMUM_SIZE", 64 * 1024)),
+    cacheSize_(Resource<size_t>("bufferPoolCacheSize;$ECKIT_BUFFER_POOL_CACHE_SIZE", 16 * 1024 * 1024)),
+    hugePages_(Resource<std::string>("bufferPoolHugePages;$ECKIT_BUFFER_POOL_HUGE_PAGES", "transparent")) {
+    if (hugePages_ != "transparent" && hugePages_ != "hugetlb" && hugePages_ != "none") {
+        throw UserError("bufferPoolHugePages should be one of transparent, hugetlb or none, not " + hugePages_);
+    }
+    minimumSize_ = std::max(minimumSize_, pageSize());
+}
+
+size_t BufferPool::capacity(size_t size) const {
+    if (size < minimumSize_) {
+        return std::max<size_t>(size, 1);  // never a null buffer
+    }
+
+    // Four classes per power of two, whole pages. Rounding mappings to whole huge pages would double 2M + 1
+    size_t power = 1;
+    while (power < size) {
+        power <<= 1;
+    }
+
+    size_t result = roundUp(size, std::max(power / 8, pageSize()));
+    return result < hugePageRounding ? result : roundUp(result, hugePageSize);
+}
+
+char* BufferPool::allocate(size_t size, size_t& capacity) {
+    capacity = this->capacity(size);
+
+    if (capacity < minimumSize_) {
+        return alignedMalloc(capacity);
+    }
+
+    {
+        AutoLock<Mutex> lock(mutex_);
+
+        auto j = free_.find(capacity);
+        if (j != free_.end() && !j->second.empty()) {
+            char* p = j->second.back();
+            j->second.pop_back();
+
+            stats_.cached--;
+            stats_.cachedSize -= capacity;
+            stats_.hits++;
+            stats_.count++;
+            stats_.size += capacity;
+            return p;
+        }
+
+        stats_.misses++;
+    }
+
+    char* p = capacity < hugePageSize ? alignedMalloc(capacity) : map(capacity);
+
+    AutoLock<Mutex> lock(mutex_);
+    stats_.count++;
+    stats_.size += capacity;
+    return p;
+}
+
+void BufferPool::deallocate(char* p, size_t capacity) {
+    if (!p) {
+        return;
+    }
+
+    if (capacity < minimumSize_) {
+        ::free(p);
+        return;
+    }
+
+    {
+        AutoLock<Mutex> lock(mutex_);
+
+        stats_.count--;
+        stats_.size -= capacity;
+
+        // A mapping moved by mremap is only page aligned, it is not given again as one from map()
+        bool aligned = capacity < hugePageSize || reinterpret_cast<uintptr_t>(p) % hugePageSize == 0;
+
+        if (aligned && stats_.cachedSize + capacity <= cacheSize_) {
+            free_[capacity].push_back(p);
+            stats_.cached++;
+            stats_.cachedSize += capacity;
+            return;
+        }
+    }
+
+    if (capacity < hugePageSize) {
+        ::free(p);
+    }
+    else {
+        unmap(p, capacity);
+    }
+}
+
+char* BufferPool::reallocate(char* p, size_t capacity, size_t used, size_t size, size_t& newCapacity) {
+    if (!p) {
+        return allocate(size, newCapacity);
+    }
+
+    newCapacity = this->capacity(size);
+    if (newCapacity == capacity) {
+        return p;
+    }
+
+#if eckit_HAVE_MREMAP
+    if (capacity >= hugePageSize && newCapacity >= hugePageSize) {
+        void* q = ::mremap(p, capacity, newCapacity, MREMAP_MAYMOVE);
+        if (q != MAP_FAILED) {
+            AutoLock<Mutex> lock(mutex_);
+            stats_.size += newCapacity;
+            stats_.size -= capacity;
+            stats_.remapped++;
+            return static_cast<char*>(q);
+        }
+    }
+#endif
+
+    char* q = allocate(size, newCapacity);
+    ::memcpy(q, p, std::min(used, size));
+    deallocate(p, capacity);
+    return q;
+}
+
+char* BufferPool::map(size_t capacity) {
+#ifdef MAP_HUGETLB
+    // Only whole huge pages, munmap() of a hugetlb mapping fails on other lengths
+    if (hugePages_ == "hugetlb" && capacity % hugePageSize == 0) {
+        void* p = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            AutoLock<Mutex> lock(mutex_);
+            stats_.hugePages++;
+            return static_cast<char*>(p);
+        }
+        // No huge pages reserved, fall back to normal ones
+    }
+#endif
+
+    // Map one huge page more, and trim to 2M alignment
+    size_t length = capacity + hugePageSize;
+    void* p       = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        throw FailedSystemCall("mmap", Here());
+    }
+
+    char* begin   = static_cast<char*>(p);
+    char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(begin), hugePageSize));
+    char* end     = aligned + capacity;
+
+    if (aligned > begin) {
+        ::munmap(begin, aligned - begin);
+    }
+    if (begin + length > end) {
+        ::munmap(end, begin + length - end);
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (hugePages_ == "transparent") {
+        ::madvise(aligned, capacity, MADV_HUGEPAGE);
+    }
+#endif
+
+    return aligned;
+}
+
+void BufferPool::unmap(char* p, size_t capacity) {
+    SYSCALL(::munmap(p, capacity));
+}
+
+void BufferPool::purge() {
+    std::map<size_t, std::vector<char*> > free;
+    {
+        AutoLock<Mutex> lock(mutex_);
+        std::swap(free, free_);
+        stats_.cached     = 0;
+        stats_.cachedSize = 0;
+    }
+
+    for (const auto& f : free) {
+        for (char* p : f.second) {
+            if (f.first < hugePageSize) {
+                ::free(p);
+            }
+            else {
+                unmap(p, f.first);
+            }
+        }
+    }
+}
+
+BufferPool::Stats BufferPool::stats() const {
+    AutoLock<Mutex> lock(mutex_);
+    return stats_;
+}
+
+void BufferPool::info(size_t& count, size_t& size, size_t& cached) {
+    Stats s = instance().stats();
+    count   = s.count;
+    size    = s.size;
+    cached  = s.cachedSize;
+}
+
+void BufferPool::print(std::ostream& out) const {
+    Stats s = stats();
+    out << "BufferPool[in use: " << BigNum(s.count) << " (" << Bytes(s.size) << "), cached: " << BigNum(s.cached)
+        << " (" << Bytes(s.cachedSize) << "), hits: " << BigNum(s.hits) << ", misses: " << BigNum(s.misses)
+        << ", hugetlb: " << BigNum(s.hugePages) << ", remapped: " << BigNum(s.remapped) << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,104 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_io_BufferPool_h
+#define eckit_io_BufferPool_h
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Memory behind Buffer.
+///
+/// Small sizes come from malloc, and are page aligned from one page up. From bufferPoolMinimumSize (64K), sizes are
+/// rounded up to size classes (four per power of two) and released buffers are kept, up to bufferPoolCacheSize
+/// bytes (16M, 0 to disable), for the next allocation of the same class. From 2M, buffers are anonymous mappings
+/// aligned on 2M, backed by huge pages according to bufferPoolHugePages: "transparent" (the default, madvise),
+/// "hugetlb" (MAP_HUGETLB for sizes of whole huge pages, as all are from 16M, falling back to normal pages) or
+/// "none". These can grow with mremap, which may leave them only page aligned; such buffers are not kept for reuse.
+
+class BufferPool : private NonCopyable {
+public:  // types
+    struct Stats {
+        size_t count      = 0;  ///< buffers in use
+        size_t size       = 0;  ///< bytes in use
+        size_t cached     = 0;  ///< buffers kept for reuse
+        size_t cachedSize = 0;  ///< bytes kept for reuse
+        size_t hits       = 0;  ///< allocations served by a kept buffer
+        size_t misses     = 0;  ///< pooled allocations that needed new memory
+        size_t hugePages  = 0;  ///< mappings created with MAP_HUGETLB
+        size_t remapped   = 0;  ///< resizes done with mremap
+    };
+
+public:  // methods
+    static BufferPool& instance();
+
+    /// @returns memory for at least size bytes, capacity is set to its actual size
+    char* allocate(size_t size, size_t& capacity);
+
+    /// @pre capacity is the one returned by allocate() or reallocate()
+    void deallocate(char*, size_t capacity);
+
+    /// Resizes keeping the first min(used, size) bytes, in place when possible
+    char* reallocate(char*, size_t capacity, size_t used, size_t size, size_t& newCapacity);
+
+    /// @returns the capacity allocate() gives for that size
+    size_t capacity(size_t size) const;
+
+    /// Releases the buffers kept for reuse
+    void purge();
+
+    Stats stats() const;
+
+    /// For MemoryInfo
+    static void info(size_t& count, size_t& size, size_t& cached);
+
+private:  // methods
+    BufferPool();
+
+    char* map(size_t capacity);
+    void unmap(char*, size_t capacity);
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const BufferPool& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    mutable Mutex mutex_;
+
+    std::map<size_t, std::vector<char*> > free_;  ///< by capacity
+
+    size_t minimumSize_;
+    size_t cacheSize_;
+    std::string hugePages_;
+
+    Stats stats_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
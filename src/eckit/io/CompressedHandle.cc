@@ -0,0 +1,564 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/CompressedHandle.h"
+#include "eckit/utils/Compressor.h"
+#include "eckit/utils/StringTools.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const char MAGIC[]            = {'E', 'C', 'K', 'Z'};
+const unsigned char VERSION   = 1;
+const size_t FRAME_HEADER_LEN = 16;
+
+void encodeLength(unsigned char* p, unsigned long long value) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<unsigned char>(value & 0xff);
+        value >>= 8;
+    }
+}
+
+unsigned long long decodeLength(const unsigned char* p) {
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+size_t defaultBlockSize() {
+    static long blockSize = Resource<long>("compressedHandleBlockSize;$ECKIT_COMPRESSED_HANDLE_BLOCK_SIZE",
+                                           4 * 1024 * 1024);
+    return blockSize;
+}
+
+size_t defaultThreads() {
+    static long threads = Resource<long>("compressedHandleThreads;$ECKIT_COMPRESSED_HANDLE_THREADS", 2);
+    return threads;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct CompressedHandle::Block {
+    Block(Buffer&& buffer, size_t size) :
+        raw(std::move(buffer)), rawSize(size), zipSize(0), future(promise.get_future()) {}
+
+    Buffer raw;
+    size_t rawSize;
+
+    Buffer zip;
+    size_t zipSize;
+
+    std::promise<void> promise;
+    std::future<void> future;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CompressedHandle::CompressedHandle(DataHandle* h, const std::string& compression, size_t blockSize, long threads) :
+    HandleHolder(h),
+    compression_(StringTools::lower(compression)),
+    blockSize_(blockSize ? blockSize : defaultBlockSize()),
+    threads_(threads < 0 ? defaultThreads() : threads),
+    queueSize_(2 * threads_),
+    reading_(false),
+    writing_(false),
+    used_(0),
+    pos_(0),
+    eof_(false),
+    position_(0) {
+    ASSERT(blockSize_ > 0);
+}
+
+CompressedHandle::CompressedHandle(DataHandle& h, const std::string& compression, size_t blockSize, long threads) :
+    HandleHolder(h),
+    compression_(StringTools::lower(compression)),
+    blockSize_(blockSize ? blockSize : defaultBlockSize()),
+    threads_(threads < 0 ? defaultThreads() : threads),
+    queueSize_(2 * threads_),
+    reading_(false),
+    writing_(false),
+    used_(0),
+    pos_(0),
+    eof_(false),
+    position_(0) {
+    ASSERT(blockSize_ > 0);
+}
+
+CompressedHandle::~CompressedHandle() {
+    try {
+        stop(true);
+    }
+    catch (std::exception& e) {
+        Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+        Log::error() << "** Exception is ignored" << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Length CompressedHandle::openForRead() {
+    ASSERT(!reading_ && !writing_);
+
+    handle().openForRead();
+
+    reading_  = true;
+    eof_      = false;
+    pos_      = 0;
+    position_ = 0;
+    error_    = nullptr;
+
+    readHeader();
+
+    compressor_.reset(CompressorFactory::instance().build(compression_));
+
+    start();
+
+    return 0;  // uncompressed length is unknown
+}
+
+void CompressedHandle::openForWrite(const Length&) {
+    ASSERT(!reading_ && !writing_);
+
+    if (compression_.empty()) {
+        compression_ = CompressorFactory::instance().defaultCompression();
+    }
+
+    compressor_.reset(CompressorFactory::instance().build(compression_));
+
+    handle().openForWrite(0);  // compressed length is unknown
+
+    writing_  = true;
+    used_     = 0;
+    position_ = 0;
+    error_    = nullptr;
+    buffer_.resize(blockSize_);
+
+    writeHeader();
+
+    start();
+}
+
+void CompressedHandle::openForAppend(const Length&) {
+    NOTIMP;
+}
+
+long CompressedHandle::read(void* buffer, long length) {
+    ASSERT(reading_);
+
+    char* p    = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length) {
+        if (!current_ || pos_ == current_->rawSize) {
+            current_ = nextBlock();
+            pos_     = 0;
+            if (!current_) {
+                break;
+            }
+        }
+
+        size_t len = std::min<size_t>(length - total, current_->rawSize - pos_);
+        ::memcpy(p + total, static_cast<const char*>(current_->raw) + pos_, len);
+        pos_ += len;
+        total += len;
+    }
+
+    position_ += total;
+    return total;
+}
+
+long CompressedHandle::write(const void* buffer, long length) {
+    ASSERT(writing_);
+
+    if (threads_) {
+        checkError();
+    }
+
+    const char* p = static_cast<const char*>(buffer);
+    long left     = length;
+
+    while (left > 0) {
+        size_t len = std::min<size_t>(left, blockSize_ - used_);
+        buffer_.copy(p, len, used_);
+        used_ += len;
+        p += len;
+        left -= len;
+
+        if (used_ == blockSize_) {
+            compressBlock();
+        }
+    }
+
+    position_ += length;
+    return length;
+}
+
+void CompressedHandle::flush() {
+    ASSERT(writing_);
+
+    compressBlock();
+
+    // Drain the pipeline so that everything written so far reaches the wrapped handle
+    stop(false);
+    checkError();
+    handle().flush();
+    start();
+}
+
+void CompressedHandle::close() {
+    std::exception_ptr e;
+
+    if (writing_) {
+        try {
+            compressBlock();
+        }
+        catch (...) {
+            e = std::current_exception();
+        }
+    }
+
+    stop(e != nullptr);
+
+    if (writing_) {
+        if (!e) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            e = error_;
+        }
+        if (!e) {
+            try {
+                writeEnd();
+            }
+            catch (...) {
+                e = std::current_exception();
+            }
+        }
+    }
+
+    reading_ = false;
+    writing_ = false;
+    current_.reset();
+    compressor_.reset();
+
+    handle().close();
+
+    if (e) {
+        std::rethrow_exception(e);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompressedHandle::start() {
+    if (!threads_) {
+        return;
+    }
+
+    // Blocks in work_ are always a subset of the blocks in flight, so pushing to work_ never blocks
+    ordered_.reset(new BlockQueue(queueSize_));
+    work_.reset(new BlockQueue(queueSize_ + 2));
+
+    for (size_t i = 0; i < threads_; ++i) {
+        compressors_.emplace_back(CompressorFactory::instance().build(compression_));
+        Compressor& c = *compressors_.back();
+        workers_.emplace_back([this, &c] { worker(c); });
+    }
+
+    if (writing_) {
+        io_ = std::thread([this] { writer(); });
+    }
+    else {
+        io_ = std::thread([this] { reader(); });
+    }
+}
+
+void CompressedHandle::stop(bool abort) {
+    if (!io_.joinable()) {
+        return;
+    }
+
+    // The reader never finishes on its own unless the end of the stream was reached
+    if (abort || reading_) {
+        ordered_->interrupt(std::make_exception_ptr(QueueInterruptedError("CompressedHandle stopped", Here())));
+    }
+    else {
+        ordered_->close();
+    }
+
+    // Workers drain whatever is left, so the I/O thread is never left waiting for a block
+    if (writing_) {
+        work_->close();
+    }
+
+    io_.join();
+
+    if (!writing_) {
+        work_->close();
+    }
+
+    for (auto& w : workers_) {
+        w.join();
+    }
+
+    workers_.clear();
+    compressors_.clear();
+}
+
+void CompressedHandle::compressBlock() {
+    if (!used_) {
+        return;
+    }
+
+    BlockPtr b = std::make_shared<Block>(std::move(buffer_), used_);
+
+    buffer_ = Buffer(blockSize_);
+    used_   = 0;
+
+    if (!threads_) {
+        process(*compressor_, *b);
+        writeBlock(*b);
+        return;
+    }
+
+    ordered_->push(b);  // blocks when too many blocks are in flight
+    work_->push(b);
+}
+
+CompressedHandle::BlockPtr CompressedHandle::nextBlock() {
+    if (eof_) {
+        return nullptr;
+    }
+
+    BlockPtr b;
+
+    if (!threads_) {
+        b = readBlock();
+        if (b) {
+            process(*compressor_, *b);
+        }
+    }
+    else if (ordered_->pop(b) >= 0) {
+        b->future.get();  // rethrows if uncompression failed
+    }
+
+    eof_ = !b;
+    return b;
+}
+
+void CompressedHandle::process(Compressor& c, Block& b) const {
+    if (writing_) {
+        b.zipSize = c.compress(b.raw, b.rawSize, b.zip);
+    }
+    else {
+        c.uncompress(b.zip, b.zipSize, b.raw, b.rawSize);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompressedHandle::worker(Compressor& c) {
+    BlockPtr b;
+    while (work_->pop(b) >= 0) {
+        try {
+            process(c, *b);
+            b->promise.set_value();
+        }
+        catch (...) {
+            b->promise.set_exception(std::current_exception());
+        }
+        b.reset();
+    }
+}
+
+void CompressedHandle::writer() {
+    try {
+        BlockPtr b;
+        while (ordered_->pop(b) >= 0) {
+            b->future.get();  // rethrows if compression failed
+            writeBlock(*b);
+            b.reset();
+        }
+    }
+    catch (...) {
+        error(std::current_exception());
+    }
+}
+
+void CompressedHandle::reader() {
+    try {
+        BlockPtr b;
+        while ((b = readBlock())) {
+            ordered_->push(b);
+            work_->push(b);
+        }
+        ordered_->close();
+    }
+    catch (...) {
+        error(std::current_exception());
+    }
+}
+
+void CompressedHandle::error(std::exception_ptr e) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = e;
+        }
+    }
+    ordered_->interrupt(e);
+}
+
+void CompressedHandle::checkError() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompressedHandle::writeHeader() {
+    ASSERT(compression_.size() < 256);
+
+    unsigned char header[sizeof(MAGIC) + 2];
+    ::memcpy(header, MAGIC, sizeof(MAGIC));
+    header[sizeof(MAGIC)]     = VERSION;
+    header[sizeof(MAGIC) + 1] = static_cast<unsigned char>(compression_.size());
+
+    writeFully(header, sizeof(header));
+    writeFully(compression_.c_str(), compression_.size());
+}
+
+void CompressedHandle::readHeader() {
+    unsigned char header[sizeof(MAGIC) + 2];
+    readFully(header, sizeof(header));
+
+    if (::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        throw BadValue("CompressedHandle: " + handle().name() + " is not a compressed stream");
+    }
+
+    if (header[sizeof(MAGIC)] != VERSION) {
+        std::ostringstream oss;
+        oss << "CompressedHandle: unsupported stream version " << int(header[sizeof(MAGIC)]);
+        throw BadValue(oss.str());
+    }
+
+    std::string compression(header[sizeof(MAGIC) + 1], ' ');
+    readFully(&compression[0], compression.size());
+
+    if (!compression_.empty() && compression_ != compression) {
+        throw BadValue("CompressedHandle: stream is compressed with '" + compression + "', expected '" +
+                       compression_ + "'");
+    }
+
+    compression_ = compression;
+}
+
+void CompressedHandle::writeBlock(Block& b) {
+    unsigned char header[FRAME_HEADER_LEN];
+    encodeLength(header, b.rawSize);
+    encodeLength(header + 8, b.zipSize);
+
+    writeFully(header, sizeof(header));
+    writeFully(b.zip, b.zipSize);
+}
+
+void CompressedHandle::writeEnd() {
+    unsigned char header[FRAME_HEADER_LEN] = {0};
+    writeFully(header, sizeof(header));
+}
+
+CompressedHandle::BlockPtr CompressedHandle::readBlock() {
+    unsigned char header[FRAME_HEADER_LEN];
+    readFully(header, sizeof(header));
+
+    size_t rawSize = decodeLength(header);
+    size_t zipSize = decodeLength(header + 8);
+
+    if (rawSize == 0) {
+        return nullptr;
+    }
+
+    BlockPtr b = std::make_shared<Block>(Buffer(rawSize), rawSize);
+    b->zip     = Buffer(zipSize);
+    b->zipSize = zipSize;
+    readFully(b->zip, zipSize);
+
+    return b;
+}
+
+void CompressedHandle::readFully(void* buffer, size_t length) {
+    char* p     = static_cast<char*>(buffer);
+    size_t done = 0;
+    while (done < length) {
+        long len = handle().read(p + done, length - done);
+        if (len <= 0) {
+            std::ostringstream oss;
+            oss << "CompressedHandle: unexpected end of compressed stream, read " << done << " out of " << length;
+            throw ReadError(oss.str());
+        }
+        done += len;
+    }
+}
+
+void CompressedHandle::writeFully(const void* buffer, size_t length) {
+    long written = handle().write(buffer, length);
+    if (written != static_cast<long>(length)) {
+        std::ostringstream oss;
+        oss << "CompressedHandle: written " << written << " out of " << length;
+        throw WriteError(oss.str());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompressedHandle::print(std::ostream& s) const {
+    s << "CompressedHandle[compression=" << compression_ << ",blockSize=" << blockSize_ << ",threads=" << threads_
+      << ",handle=";
+    handle().print(s);
+    s << ']';
+}
+
+Length CompressedHandle::estimate() {
+    return 0;
+}
+
+Offset CompressedHandle::position() {
+    return position_;
+}
+
+std::string CompressedHandle::title() const {
+    return compression_ + "(" + handle().title() + ")";
+}
+
+void CompressedHandle::collectMetrics(const std::string& what) const {
+    handle().collectMetrics(what);
+}
+
+DataHandle* CompressedHandle::clone() const {
+    return new CompressedHandle(handle().clone(), compression_, blockSize_, threads_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
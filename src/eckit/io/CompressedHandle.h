@@ -0,0 +1,147 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_io_CompressedHandle_h
+#define eckit_io_CompressedHandle_h
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/container/Queue.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/HandleHolder.h"
+
+namespace eckit {
+
+class Compressor;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Streaming compression on top of the Compressor backends.
+///
+/// Writing to a CompressedHandle compresses the bytestream into the wrapped handle, reading from it
+/// uncompresses the wrapped handle. Data is cut into independent blocks of blockSize bytes, that are
+/// (un)compressed by a pool of worker threads while a dedicated thread performs the I/O on the wrapped
+/// handle. At most two blocks per worker are in flight, so memory usage is bounded regardless of the size
+/// of the transfer. With threads == 0 all the work is done synchronously in the calling thread.
+///
+/// The compressed bytestream is self-describing: a header records the compressor name, and each block is
+/// framed with its uncompressed and compressed lengths, so no other information is needed to read it back.
+
+class CompressedHandle : public DataHandle, public HandleHolder {
+public:
+    /// Contructor, taking ownership
+    /// @param compression compressor name, if empty the default compressor is used when writing and
+    ///                    the one recorded in the stream when reading
+    CompressedHandle(DataHandle*, const std::string& compression = "", size_t blockSize = 0, long threads = -1);
+
+    /// Contructor, not taking ownership
+    CompressedHandle(DataHandle&, const std::string& compression = "", size_t blockSize = 0, long threads = -1);
+
+    ~CompressedHandle() override;
+
+    // -- Overridden methods
+
+    // From DataHandle
+
+    Length openForRead() override;
+    void openForWrite(const Length&) override;
+    void openForAppend(const Length&) override;
+
+    long read(void*, long) override;
+    long write(const void*, long) override;
+    void close() override;
+    void flush() override;
+    void print(std::ostream&) const override;
+
+    Length estimate() override;
+    Offset position() override;
+    bool canSeek() const override { return false; }
+
+    DataHandle* clone() const override;
+
+    std::string title() const override;
+    void collectMetrics(const std::string& what) const override;
+
+    // -- Methods
+
+    const std::string& compression() const { return compression_; }
+
+private:  // types
+    struct Block;
+
+    typedef std::shared_ptr<Block> BlockPtr;
+    typedef eckit::Queue<BlockPtr> BlockQueue;
+
+private:  // methods
+    void start();
+    void stop(bool abort);
+
+    void compressBlock();
+    void process(Compressor&, Block&) const;
+
+    void writeHeader();
+    void readHeader();
+    void writeBlock(Block&);
+    void writeEnd();
+    BlockPtr readBlock();
+    BlockPtr nextBlock();
+
+    void readFully(void*, size_t);
+    void writeFully(const void*, size_t);
+
+    void worker(Compressor&);
+    void writer();
+    void reader();
+
+    void error(std::exception_ptr);
+    void checkError();
+
+private:  // members
+    std::string compression_;
+    size_t blockSize_;
+    size_t threads_;
+    size_t queueSize_;
+
+    bool reading_;
+    bool writing_;
+
+    std::unique_ptr<Compressor> compressor_;
+
+    Buffer buffer_;  // block being filled (writing)
+    size_t used_;
+
+    BlockPtr current_;  // block being consumed (reading)
+    size_t pos_;
+    bool eof_;
+
+    unsigned long long position_;
+
+    std::unique_ptr<BlockQueue> work_;     // blocks waiting for a worker
+    std::unique_ptr<BlockQueue> ordered_;  // all blocks in flight, in stream order
+
+    std::vector<std::unique_ptr<Compressor>> compressors_;  // one per worker
+    std::vector<std::thread> workers_;
+    std::thread io_;
+
+    std::mutex mutex_;
+    std::exception_ptr error_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
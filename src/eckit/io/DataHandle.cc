@@ -21,6 +21,7 @@
 #include "eckit/io/DataHandle.h"
 #include "eckit/io/DblBuffer.h"
 #include "eckit/io/MoverTransfer.h"
+#include "eckit/io/ZeroCopy.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/log/Progress.h"
 #include "eckit/log/Timer.h"
@@ -87,6 +88,12 @@ Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
         return mover.transfer(*this, other);
     }
 
+    static const bool zeroCopy = Resource<bool>("zeroCopyTransfer;$ECKIT_ZERO_COPY_TRANSFER", true);
+
+    if (zeroCopy && !watcher.needsData() && hasDescriptor(true) && other.hasDescriptor(false)) {
+        Log::debug<LibEcKit>() << "Using zero-copy transfer" << std::endl;
+        return zeroCopyInto(other, watcher);
+    }
 
     static const bool doubleBuffer = Resource<bool>("doubleBuffer", 0);
 
@@ -191,6 +198,70 @@ Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
     return total;
 }
 
+Length DataHandle::zeroCopyInto(DataHandle& other, TransferWatcher& watcher) {
+
+    watcher.watch(0, 0);
+
+    Length estimate = openForRead();
+    AutoClose closer1(*this);
+    watcher.fromHandleOpened();
+    other.openForWrite(estimate);
+    AutoClose closer2(other);
+    watcher.toHandleOpened();
+
+    Progress progress("Moving data", 0, estimate);
+
+    Length total = 0;
+    Timer timer("Save into");
+
+    ZeroCopy copier([&](long n) {
+        total += n;
+        progress(total);
+        watcher.watch(nullptr, n);
+        Log::message() << Bytes(total, timer.elapsed()).shorten() << std::endl;
+    });
+
+    OffsetList offsets;
+    LengthList lengths;
+    int in  = readDescriptor(offsets, lengths);
+    int out = other.writeDescriptor();
+
+    if (offsets.empty()) {
+        copier.copy(in, out);
+    }
+    else {
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            copier.copy(in, offsets[i], lengths[i], out);
+        }
+    }
+
+    Log::message() << "" << std::endl;
+
+    Log::info() << "Transfer rate: " << Bytes(total, timer.elapsed()) << " (" << copier.method() << ")" << std::endl;
+
+    if (estimate != 0 && estimate != total) {
+        std::ostringstream os;
+        os << "DataHandle::saveInto got " << total << " bytes out of " << estimate;
+        throw ReadError(name() + " into " + other.name() + " " + os.str());
+    }
+
+    this->collectMetrics("source");
+    other.collectMetrics("target");
+    Metrics::set("size", total);
+    Metrics::set("time", timer.elapsed());
+    Metrics::set("double_buffering", false);
+
+    return total;
+}
+
+int DataHandle::readDescriptor(OffsetList&, LengthList&) {
+    NOTIMP;
+}
+
+int DataHandle::writeDescriptor() {
+    NOTIMP;
+}
+
 Length DataHandle::saveInto(const PathName& path, TransferWatcher& w) {
     std::unique_ptr<DataHandle> file{path.fileHandle()};
     return saveInto(*file, w);
@@ -92,6 +92,8 @@ public:
     virtual DataHandle* clone() const;
 
     /// Save into an other datahandle
+    /// When both handles expose file descriptors and the watcher does not need the data, the copy is done
+    /// in the kernel (see ZeroCopy)
     virtual Length saveInto(DataHandle&, TransferWatcher& = TransferWatcher::dummy());
 
     /// Save into a file
@@ -147,6 +149,18 @@ public:
 
     virtual bool doubleBufferOK() const { return true; }
 
+    // For transfers in the kernel, see saveInto()
+
+    /// @returns true if, once opened for read (or write), the handle exposes a file descriptor
+    virtual bool hasDescriptor(bool read) const { return false; }
+
+    /// Once opened for read, the file descriptor to read from and its ranges holding the data,
+    /// no ranges for a stream, which is read until its end
+    virtual int readDescriptor(OffsetList&, LengthList&);
+
+    /// Once opened for write, the file descriptor to write to
+    virtual int writeDescriptor();
+
     // -- Overridden methods
 
     // From Streamble
@@ -159,6 +173,10 @@ public:
     static const ClassSpec& classSpec() { return classSpec_; }
 
 private:
+    // -- Methods
+
+    Length zeroCopyInto(DataHandle&, TransferWatcher&);
+
     // -- Class members
 
     static ClassSpec classSpec_;
@@ -194,6 +194,23 @@ void FileHandle::rewind() {
     ::rewind(file_);
 }
 
+int FileHandle::readDescriptor(OffsetList& offsets, LengthList& lengths) {
+    ASSERT(file_ && read_);
+    Offset from = position();
+    offsets.assign(1, from);
+    lengths.assign(1, estimate() - Length(from));
+    return ::fileno(file_);
+}
+
+int FileHandle::writeDescriptor() {
+    ASSERT(file_ && !read_);
+    // Writes are not buffered (see open()), so the descriptor is in sync with the stream
+    if (::fflush(file_)) {
+        throw WriteError(std::string("fflush(") + name_ + ")", Here());
+    }
+    return ::fileno(file_);
+}
+
 Length FileHandle::size() {
     Stat::Struct info;
     SYSCALL(Stat::stat(name_.c_str(), &info));
@@ -70,6 +70,10 @@ public:
     DataHandle* clone() const override;
     void hash(MD5& md5) const override;
 
+    bool hasDescriptor(bool) const override { return true; }
+    int readDescriptor(OffsetList&, LengthList&) override;
+    int writeDescriptor() override;
+
     // From Streamable
 
     void encode(Stream&) const override;
@@ -0,0 +1,109 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/io/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <iterator>
+#include <map>
+#include <mutex>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/memory/MMap.h"
+
+namespace eckit {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+MappedFile::Identity identityOf(const struct stat& s) {
+    return MappedFile::Identity{s.st_dev, s.st_ino, s.st_size, s.st_mtime};
+}
+
+}  // namespace
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<Identity, std::weak_ptr<const MappedFile>> files;
+
+    struct stat s;
+    if (::stat(path.c_str(), &s) < 0) {
+        throw FailedSystemCall(path, "stat", Here(), errno);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto j = files.find(identityOf(s));
+    if (j != files.end()) {
+        if (auto mapped = j->second.lock()) {
+            return mapped;
+        }
+    }
+
+    // Forget the files no longer mapped, e.g. previous versions of this one
+    for (auto k = files.begin(); k != files.end();) {
+        k = k->second.expired() ? files.erase(k) : std::next(k);
+    }
+
+    auto mapped = std::make_shared<const MappedFile>(path);
+
+    // Under what was mapped, in case the file changed since stat()
+    files[mapped->identity()] = mapped;
+    return mapped;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+MappedFile::MappedFile(const std::string& path) : path_(path) {
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FailedSystemCall(path_, "open", Here(), errno);
+    }
+
+    struct stat s;
+    if (::fstat(fd, &s) < 0) {
+        int err = errno;
+        ::close(fd);
+        throw FailedSystemCall(path_, "fstat", Here(), err);
+    }
+    identity_ = identityOf(s);
+    size_     = static_cast<size_t>(s.st_size);
+
+    if (size_ > 0) {
+        address_ = MMap::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (address_ == MAP_FAILED) {
+            int err  = errno;
+            address_ = nullptr;
+            ::close(fd);
+            throw FailedSystemCall(path_, "mmap", Here(), err);
+        }
+    }
+    ::close(fd);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+MappedFile::~MappedFile() {
+    if (address_ != nullptr) {
+        MMap::munmap(address_, size_);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
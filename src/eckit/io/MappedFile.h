@@ -0,0 +1,58 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace eckit {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/// Read-only mapping of a whole file.
+/// A file is mapped once for as long as something refers to it, e.g. a reader, or views into its data.
+/// Files are told apart by device, inode, size and modification time, so a file rewritten or replaced under the same
+/// path is mapped again.
+class MappedFile {
+public:
+    using Identity = std::tuple<dev_t, ino_t, off_t, time_t>;
+
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    const void* data() const { return address_; }
+    size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+    const Identity& identity() const { return identity_; }
+
+private:
+    std::string path_;
+    Identity identity_;
+    void* address_{nullptr};
+    size_t size_{0};
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
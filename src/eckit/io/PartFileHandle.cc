@@ -9,8 +9,21 @@
  */
 
 
+#include "eckit/eckit.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
 #include <numeric>
+#include <thread>
 
+#include "eckit/config/Resource.h"
 #include "eckit/io/cluster/NodeInfo.h"
 #include "eckit/log/Log.h"
 
@@ -24,6 +37,104 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+size_t readAheadSize() {
+    static long size = Resource<long>("partFileHandleReadAhead;$ECKIT_PART_FILE_HANDLE_READ_AHEAD", 8 * 1024 * 1024);
+    return std::max(size, 0L);
+}
+
+size_t coalesceGap() {
+    static long gap = Resource<long>("partFileHandleGap;$ECKIT_PART_FILE_HANDLE_GAP", 64 * 1024);
+    return std::max(gap, 0L);
+}
+
+size_t readThreads() {
+    static long threads = Resource<long>("partFileHandleThreads;$ECKIT_PART_FILE_HANDLE_THREADS", 4);
+    return std::max(threads, 1L);
+}
+
+#ifdef IOV_MAX
+constexpr size_t maxIovecs = IOV_MAX;
+#else
+constexpr size_t maxIovecs = 1024;
+#endif
+
+/// Part of a part, to be read at offset in the file, to dest in the read-ahead buffer
+struct Piece {
+    off_t offset;
+    size_t length;
+    size_t dest;
+};
+
+/// Contiguous range of the file, scattered into the read-ahead buffer. Gaps between pieces are read into a
+/// scratch area, which is cheaper than another request to the storage
+struct Extent {
+    off_t offset;
+    off_t end;
+    std::vector<struct iovec> iov;
+};
+
+void readExtent(int fd, const Extent& extent, const char* scratch, const PathName& path) {
+    std::vector<struct iovec> iov(extent.iov);
+    off_t offset = extent.offset;
+
+#if eckit_HAVE_PREADV
+    size_t first = 0;
+    while (first < iov.size()) {
+        ssize_t n = ::preadv(fd, &iov[first], iov.size() - first, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            std::ostringstream oss;
+            oss << path << ": cannot read " << (extent.end - offset) << " bytes at offset " << offset;
+            throw ReadError(oss.str(), Here());
+        }
+
+        offset += n;
+
+        // Short read, resume where it stopped
+        while (n > 0 && first < iov.size()) {
+            size_t len = std::min<size_t>(n, iov[first].iov_len);
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + len;
+            iov[first].iov_len -= len;
+            n -= len;
+            if (iov[first].iov_len == 0) {
+                ++first;
+            }
+        }
+    }
+#else
+    for (const auto& v : iov) {
+        if (v.iov_base != scratch) {
+            char* p    = static_cast<char*>(v.iov_base);
+            size_t len = v.iov_len;
+            off_t pos  = offset;
+            while (len > 0) {
+                ssize_t n = ::pread(fd, p, len, pos);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    std::ostringstream oss;
+                    oss << path << ": cannot read " << len << " bytes at offset " << pos;
+                    throw ReadError(oss.str(), Here());
+                }
+                p += n;
+                pos += n;
+                len -= n;
+            }
+        }
+        offset += v.iov_len;
+    }
+#endif
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 ClassSpec PartFileHandle::classSpec_ = {
     &DataHandle::classSpec(),
     "PartFileHandle",
@@ -79,7 +190,11 @@ bool PartFileHandle::compress(bool sorted) {
     return eckit::compress(offset_, length_);
 }
 
-PartFileHandle::~PartFileHandle() {}
+PartFileHandle::~PartFileHandle() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
 
 Length PartFileHandle::openForRead() {
     if (!handle_) {
@@ -147,7 +262,21 @@ long PartFileHandle::read(void* buffer, long length) {
     long n     = 0;
     long total = 0;
 
-    while (length > 0 && (n = read1(p, length)) > 0) {
+    while (length > 0) {
+        if (bufferPos_ == bufferLen_ && readAhead()) {
+            fill();
+        }
+
+        if (bufferPos_ < bufferLen_) {
+            n = std::min<long>(length, bufferLen_ - bufferPos_);
+            ::memcpy(p, static_cast<const char*>(buffer_) + bufferPos_, n);
+            bufferPos_ += n;
+            advance(n);
+        }
+        else if ((n = read1(p, length)) <= 0) {
+            break;
+        }
+
         length -= n;
         total += n;
         p += n;
@@ -156,11 +285,170 @@ long PartFileHandle::read(void* buffer, long length) {
     return total > 0 ? total : n;
 }
 
+bool PartFileHandle::readAhead() const {
+    // A single part is read sequentially, the pooled handle already buffers it
+    return offset_.size() > 1 && readAheadSize() > 0;
+}
+
+void PartFileHandle::advance(long long n) {
+    while (n > 0) {
+        ASSERT(index_ < offset_.size());
+        long long left = (long long)length_[index_] - (long long)pos_;
+        if (n < left) {
+            pos_ += n;
+            return;
+        }
+        n -= left;
+        index_++;
+        pos_ = 0;
+    }
+    while (index_ < offset_.size() && pos_ == 0 && length_[index_] == Length(0)) {
+        index_++;
+    }
+}
+
+size_t PartFileHandle::fill() {
+    const size_t window = readAheadSize();
+
+    bufferPos_ = bufferLen_ = 0;
+
+    // Collect what comes next, up to the size of the window
+
+    std::vector<Piece> pieces;
+    size_t total = 0;
+    for (Ordinal i = index_; i < offset_.size() && total < window; ++i) {
+        long long skip = i == index_ ? (long long)pos_ : 0;
+        long long left = (long long)length_[i] - skip;
+        if (left <= 0) {
+            continue;
+        }
+        if (pieces.empty() && size_t(left) >= window) {
+            // Large enough to be read directly into the caller's buffer
+            return 0;
+        }
+        size_t len = std::min<size_t>(left, window - total);
+        pieces.push_back({off_t((long long)offset_[i] + skip), len, total});
+        total += len;
+    }
+
+    if (pieces.empty()) {
+        return 0;
+    }
+
+    if (buffer_.size() < window) {
+        buffer_.resize(window);
+    }
+
+    // Sort by position in the file and coalesce the pieces closer than the gap
+
+    std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) { return a.offset < b.offset; });
+
+    const size_t gap = coalesceGap();
+    std::vector<char> scratch(gap);
+
+    std::vector<Extent> extents;
+    for (const auto& piece : pieces) {
+        struct iovec v;
+        v.iov_base = static_cast<char*>(buffer_) + piece.dest;
+        v.iov_len  = piece.length;
+
+        if (!extents.empty()) {
+            Extent& e = extents.back();
+            // Overlapping parts are read again, as they go to different places
+            if (piece.offset >= e.end && size_t(piece.offset - e.end) <= gap && e.iov.size() + 2 <= maxIovecs) {
+                if (piece.offset > e.end) {
+                    struct iovec skip;
+                    skip.iov_base = scratch.data();
+                    skip.iov_len  = piece.offset - e.end;
+                    e.iov.push_back(skip);
+                }
+                e.iov.push_back(v);
+                e.end = piece.offset + piece.length;
+                continue;
+            }
+        }
+
+        extents.push_back({piece.offset, off_t(piece.offset + piece.length), {v}});
+    }
+
+    // Issue the reads, in parallel if there are several
+
+    const int fd = descriptor();
+
+    const size_t threads = std::min(readThreads(), extents.size());
+    if (threads <= 1) {
+        for (const auto& e : extents) {
+            readExtent(fd, e, scratch.data(), path_);
+        }
+    }
+    else {
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                try {
+                    for (size_t i = t; i < extents.size(); i += threads) {
+                        readExtent(fd, extents[i], scratch.data(), path_);
+                    }
+                }
+                catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        for (auto& e : errors) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+    }
+
+    bufferLen_ = total;
+    return total;
+}
+
+int PartFileHandle::descriptor() {
+    if (fd_ < 0) {
+        SYSCALL2(fd_ = ::open(path_.localPath(), O_RDONLY), path_);
+        SYSCALL(::fcntl(fd_, F_SETFD, FD_CLOEXEC));
+    }
+    return fd_;
+}
+
 long PartFileHandle::write(const void*, long) {
     NOTIMP;
 }
 
+int PartFileHandle::readDescriptor(OffsetList& offsets, LengthList& lengths) {
+    ASSERT(handle_);
+
+    descriptor();
+
+    // What is left to read, from the current position
+
+    offsets.clear();
+    lengths.clear();
+    for (Ordinal i = index_; i < offset_.size(); ++i) {
+        Length skip = i == index_ ? Length(pos_) : Length(0);
+        if (length_[i] > skip) {
+            offsets.push_back(offset_[i] + skip);
+            lengths.push_back(length_[i] - skip);
+        }
+    }
+
+    return fd_;
+}
+
 void PartFileHandle::close() {
+    if (fd_ >= 0) {
+        SYSCALL(::close(fd_));
+        fd_ = -1;
+    }
     if (handle_) {
         handle_->close();
         // Don't delete the handle here so the PooledHandle entry continues
@@ -172,8 +460,10 @@ void PartFileHandle::close() {
 }
 
 void PartFileHandle::rewind() {
-    pos_   = 0;
-    index_ = 0;
+    pos_       = 0;
+    index_     = 0;
+    bufferPos_ = 0;
+    bufferLen_ = 0;
 }
 
 void PartFileHandle::restartReadFrom(const Offset& from) {
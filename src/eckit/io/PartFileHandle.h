@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/types/Types.h"
 
@@ -29,6 +30,13 @@ class PooledHandle;
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Reads parts of a file, in the order given.
+///
+/// When there are many parts, they are read ahead in windows: the parts of a window are sorted by offset,
+/// parts separated by less than a gap are coalesced into a single vectored read (preadv) that skips the gap,
+/// the reads are issued in parallel, and the bytes are handed back in the requested order.
+/// See the partFileHandleReadAhead, partFileHandleGap and partFileHandleThreads resources.
+
 class PartFileHandle : public DataHandle {
 public:  // methods
     PartFileHandle(const PathName&, const OffsetList&, const LengthList&);
@@ -72,6 +80,9 @@ public:  // methods
     bool moveable() const override { return true; }
     DataHandle* clone() const override;
 
+    bool hasDescriptor(bool read) const override { return read; }
+    int readDescriptor(OffsetList&, LengthList&) override;
+
     // From Streamable
 
     void encode(Stream&) const override;
@@ -88,10 +99,20 @@ private:  // members
     Ordinal index_;
     OffsetList offset_;
     LengthList length_;
+    int fd_ = -1;  //< for readDescriptor() and vectored reads, as the pooled handle does not expose one
+
+    Buffer buffer_;  //< parts read ahead, in the requested order
+    size_t bufferPos_ = 0;
+    size_t bufferLen_ = 0;
 
 private:  // methods
     long read1(char*, long);
 
+    bool readAhead() const;
+    size_t fill();
+    void advance(long long);
+    int descriptor();
+
     static ClassSpec classSpec_;
     static Reanimator<PartFileHandle> reanimator_;
 };
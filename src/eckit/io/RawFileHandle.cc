@@ -95,6 +95,19 @@ void RawFileHandle::skip(const Length& l) {
     ::lseek(fd_, l, SEEK_CUR);
 }
 
+int RawFileHandle::readDescriptor(OffsetList& offsets, LengthList& lengths) {
+    ASSERT(fd_ != -1);
+    Offset from = position();
+    offsets.assign(1, from);
+    lengths.assign(1, size() - Length(from));
+    return fd_;
+}
+
+int RawFileHandle::writeDescriptor() {
+    ASSERT(fd_ != -1);
+    return fd_;
+}
+
 Length RawFileHandle::size() {
     Stat::Struct info;
     SYSCALL(Stat::fstat(fd_, &info));
@@ -44,6 +44,10 @@ public:
     bool canSeek() const override { return true; }
     void skip(const Length&) override;
 
+    bool hasDescriptor(bool) const override { return true; }
+    int readDescriptor(OffsetList&, LengthList&) override;
+    int writeDescriptor() override;
+
     void encode(Stream&) const override;
 
 private:
@@ -49,9 +49,9 @@ public:  // methods
         buffer_(s.buffer_) { buffer_->attach(); }
 
     SharedBuffer& operator=(const SharedBuffer& s) {
+        s.buffer_->attach();  // first, in case it is the same buffer
         buffer_->detach();
         buffer_ = s.buffer_;
-        buffer_->attach();
         return *this;
     }
 
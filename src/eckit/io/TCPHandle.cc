@@ -68,6 +68,23 @@ long TCPHandle::write(const void* buffer, long length) {
     return connection_.write(buffer, length);
 }
 
+bool TCPHandle::hasDescriptor(bool) const {
+    // The socket is connected by open(), unless traced: the traffic then has to go through read() and write()
+    return !connection_.debug();
+}
+
+int TCPHandle::readDescriptor(OffsetList& offsets, LengthList& lengths) {
+    ASSERT(connection_.isConnected());
+    offsets.clear();
+    lengths.clear();
+    return connection_.socket();
+}
+
+int TCPHandle::writeDescriptor() {
+    ASSERT(connection_.isConnected());
+    return connection_.socket();
+}
+
 void TCPHandle::close() {
     connection_.close();
 }
@@ -53,6 +53,10 @@ public:
 
     bool canSeek() const override { return false; }
 
+    bool hasDescriptor(bool) const override;
+    int readDescriptor(OffsetList&, LengthList&) override;
+    int writeDescriptor() override;
+
     virtual void selectMover(eckit::MoverTransferSelection&, bool) const override;
 
     // From Streamable
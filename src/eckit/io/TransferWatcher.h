@@ -27,6 +27,10 @@ public:
     // -- Methods
 
     virtual void watch(const void*, long) = 0;
+
+    /// Whether watch() needs the data. If not, it may be called with nullptr, which allows transfers
+    /// that do not go through user space
+    virtual bool needsData() const { return true; }
     virtual void restartFrom(const Offset&) {}
     virtual void fromHandleOpened() {}
     virtual void toHandleOpened() {}
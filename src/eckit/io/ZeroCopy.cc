@@ -0,0 +1,256 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/eckit.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if eckit_HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/ZeroCopy.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+long chunkSize() {
+    static long size = Resource<long>("zeroCopyChunkSize;$ECKIT_ZERO_COPY_CHUNK_SIZE", 64 * 1024 * 1024);
+    return size;
+}
+
+/// errno values telling that a system call does not support these file descriptors, rather than a failure.
+/// Not EBADF: a descriptor that is not open is a failure of the handle, not something to work around
+bool unsupported(int err) {
+    return err == ENOSYS || err == EINVAL || err == EXDEV || err == EOPNOTSUPP;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ZeroCopy::ZeroCopy(const Progress& progress) :
+    progress_(progress),
+    method_("read/write"),
+    copyFileRange_(eckit_HAVE_COPY_FILE_RANGE),
+    sendFile_(eckit_HAVE_SENDFILE),
+    splice_(eckit_HAVE_SPLICE),
+    pipe_{-1, -1},
+    buffer_(0) {}
+
+ZeroCopy::~ZeroCopy() {
+    if (pipe_[0] >= 0) {
+        ::close(pipe_[0]);
+        ::close(pipe_[1]);
+    }
+}
+
+void ZeroCopy::done(long n) {
+    if (progress_) {
+        progress_(n);
+    }
+}
+
+Length ZeroCopy::copy(int in, const Offset& offset, const Length& length, int out) {
+    long long pos       = offset;
+    long long remaining = length;
+
+    while (remaining > 0) {
+        const long len = std::min<long long>(remaining, chunkSize());
+
+        long n = -1;
+        if (copyFileRange_ && (n = copyFileRange(in, pos, len, out)) < 0) {
+            copyFileRange_ = false;
+        }
+        if (n < 0 && sendFile_ && (n = sendFile(in, pos, len, out)) < 0) {
+            sendFile_ = false;
+        }
+        if (n < 0) {
+            n = readWrite(in, &pos, len, out);
+        }
+
+        if (n == 0) {
+            std::ostringstream oss;
+            oss << "ZeroCopy: unexpected end of file at offset " << pos << ", " << remaining << " bytes missing";
+            throw ReadError(oss.str(), Here());
+        }
+
+        remaining -= n;
+        done(n);
+    }
+
+    return length;
+}
+
+Length ZeroCopy::copy(int in, int out) {
+    long long total = 0;
+
+    for (;;) {
+        long n = -1;
+        if (splice_ && (n = splice(in, chunkSize(), out)) < 0) {
+            splice_ = false;
+        }
+        if (n < 0) {
+            n = readWrite(in, nullptr, chunkSize(), out);
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        total += n;
+        done(n);
+    }
+
+    return total;
+}
+
+long ZeroCopy::copyFileRange(int in, long long& offset, long length, int out) {
+#if eckit_HAVE_COPY_FILE_RANGE
+    loff_t off = offset;
+    ssize_t n;
+    while ((n = ::copy_file_range(in, &off, out, nullptr, length, 0)) < 0 && errno == EINTR) {}
+
+    if (n < 0) {
+        if (unsupported(errno)) {
+            return -1;
+        }
+        throw FailedSystemCall("copy_file_range", Here());
+    }
+
+    method_ = "copy_file_range";
+    offset  = off;
+    return n;
+#else
+    return -1;
+#endif
+}
+
+long ZeroCopy::sendFile(int in, long long& offset, long length, int out) {
+#if eckit_HAVE_SENDFILE
+    off_t off = offset;
+    ssize_t n;
+    while ((n = ::sendfile(out, in, &off, length)) < 0 && errno == EINTR) {}
+
+    if (n < 0) {
+        if (unsupported(errno)) {
+            return -1;
+        }
+        throw FailedSystemCall("sendfile", Here());
+    }
+
+    method_ = "sendfile";
+    offset  = off;
+    return n;
+#else
+    return -1;
+#endif
+}
+
+long ZeroCopy::splice(int in, long length, int out) {
+#if eckit_HAVE_SPLICE
+    if (pipe_[0] < 0) {
+        SYSCALL(::pipe(pipe_));
+    }
+
+    // Nothing is taken from in when this fails, so the caller can still use read()
+    ssize_t n;
+    while ((n = ::splice(in, nullptr, pipe_[1], nullptr, length, SPLICE_F_MOVE | SPLICE_F_MORE)) < 0 &&
+           errno == EINTR) {}
+
+    if (n < 0) {
+        if (unsupported(errno)) {
+            return -1;
+        }
+        throw FailedSystemCall("splice", Here());
+    }
+
+    long pending = n;
+    while (pending > 0) {
+        ssize_t m = ::splice(pipe_[0], nullptr, out, nullptr, pending, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (m < 0 && errno == EINTR) {
+            continue;
+        }
+        if (m < 0 && unsupported(errno)) {
+            // out does not accept splice, empty the pipe by hand and read directly from now on
+            splice_ = false;
+            while (pending > 0) {
+                long r = readWrite(pipe_[0], nullptr, pending, out);
+                if (r == 0) {
+                    throw ReadError("ZeroCopy: pipe emptied before all data spliced into it was written", Here());
+                }
+                pending -= r;
+            }
+            return n;
+        }
+        if (m <= 0) {
+            throw FailedSystemCall("splice", Here());
+        }
+        pending -= m;
+    }
+
+    method_ = "splice";
+    return n;
+#else
+    return -1;
+#endif
+}
+
+long ZeroCopy::readWrite(int in, long long* offset, long length, int out) {
+    // Grown as needed, callers ask for less than a chunk at the end of a range or when emptying the pipe
+    const size_t size = std::min(length, 4L * 1024 * 1024);
+    if (buffer_.size() < size) {
+        buffer_.resize(size);
+    }
+
+    length = std::min<long>(length, buffer_.size());
+
+    ssize_t n;
+    while ((n = offset ? ::pread(in, buffer_, length, *offset) : ::read(in, buffer_, length)) < 0 &&
+           errno == EINTR) {}
+
+    if (n < 0) {
+        throw ReadError("ZeroCopy", Here());
+    }
+
+    const char* p = buffer_;
+    long left     = n;
+    while (left > 0) {
+        ssize_t m = ::write(out, p, left);
+        if (m < 0 && errno == EINTR) {
+            continue;
+        }
+        if (m <= 0) {
+            throw WriteError("ZeroCopy", Here());
+        }
+        p += m;
+        left -= m;
+    }
+
+    if (offset) {
+        *offset += n;
+    }
+
+    method_ = "read/write";
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_ZeroCopy_h
+#define eckit_io_ZeroCopy_h
+
+#include <functional>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Copies between file descriptors without moving the data through user space, when the system supports it.
+///
+/// Uses copy_file_range() from a file, then sendfile() if the kernel or the file systems do not support it, and
+/// splice() from a stream (pipe, socket). Falls back to read()/write() through a buffer if none is available.
+/// The method is chosen per call, and downgraded transparently when the kernel reports it is not supported.
+
+class ZeroCopy : private NonCopyable {
+public:  // types
+    using Progress = std::function<void(long)>;
+
+public:  // methods
+    explicit ZeroCopy(const Progress& progress = Progress());
+
+    ~ZeroCopy();
+
+    /// Copies length bytes from offset of the file in, to the current position of out.
+    /// Does not change the position of in.
+    Length copy(int in, const Offset& offset, const Length& length, int out);
+
+    /// Copies the stream in, until its end, to the current position of out
+    Length copy(int in, int out);
+
+    /// @returns the last method used, for reporting
+    const char* method() const { return method_; }
+
+private:  // methods
+    long copyFileRange(int in, long long& offset, long length, int out);
+    long sendFile(int in, long long& offset, long length, int out);
+    long readWrite(int in, long long* offset, long length, int out);
+    long splice(int in, long length, int out);
+
+    void done(long);
+
+private:  // members
+    Progress progress_;
+    const char* method_;
+
+    bool copyFileRange_;
+    bool sendFile_;
+    bool splice_;
+
+    int pipe_[2];
+    Buffer buffer_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
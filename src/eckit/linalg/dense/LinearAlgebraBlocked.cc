@@ -0,0 +1,412 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/dense/LinearAlgebraBlocked.h"
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/eckit_config.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/Vector.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ECKIT_LINALG_BLOCKED_X86 1
+#include <immintrin.h>
+#else
+#define ECKIT_LINALG_BLOCKED_X86 0
+#endif
+
+namespace eckit::linalg::dense {
+
+static const LinearAlgebraBlocked __la_blocked("blocked");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Blocks of A (MC x KC) stay in L2, panels of B (KC x NC) in L3
+constexpr Size MC = 128;
+constexpr Size KC = 256;
+constexpr Size NC = 2048;
+
+// Largest microkernel tile
+constexpr Size MAX_TILE = 16 * 8;
+
+// Rows of y computed together by gemv
+constexpr Size GEMV_ROWS = 2048;
+
+
+/// Microkernel: C(mr x nr) += Apanel (mr x kc) * Bpanel (kc x nr), panels as packed by packA/packB
+struct Kernel {
+    const char* name;
+    Size mr;
+    Size nr;
+    void (*run)(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc);
+};
+
+
+template <Size MR, Size NR>
+void kernelPortable(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc) {
+    Scalar ab[MR * NR] = {};
+
+    for (Size p = 0; p < kc; ++p, a += MR, b += NR) {
+        for (Size j = 0; j < NR; ++j) {
+            for (Size i = 0; i < MR; ++i) {
+                ab[j * MR + i] += a[i] * b[j];
+            }
+        }
+    }
+
+    for (Size j = 0; j < NR; ++j) {
+        for (Size i = 0; i < MR; ++i) {
+            c[j * ldc + i] += ab[j * MR + i];
+        }
+    }
+}
+
+
+#if ECKIT_LINALG_BLOCKED_X86
+
+__attribute__((target("avx2,fma"))) void kernelAVX2(Size kc, const Scalar* a, const Scalar* b, Scalar* c,
+                                                     Size ldc) {
+    // 8 x 6 tile: two vectors of 4 rows per column, 12 accumulators
+    __m256d c00 = _mm256_setzero_pd(), c01 = c00, c02 = c00, c03 = c00, c04 = c00, c05 = c00;
+    __m256d c10 = c00, c11 = c00, c12 = c00, c13 = c00, c14 = c00, c15 = c00;
+
+    for (Size p = 0; p < kc; ++p, a += 8, b += 6) {
+        const __m256d a0 = _mm256_loadu_pd(a);
+        const __m256d a1 = _mm256_loadu_pd(a + 4);
+        __m256d bj;
+
+        bj  = _mm256_broadcast_sd(b);
+        c00 = _mm256_fmadd_pd(a0, bj, c00);
+        c10 = _mm256_fmadd_pd(a1, bj, c10);
+        bj  = _mm256_broadcast_sd(b + 1);
+        c01 = _mm256_fmadd_pd(a0, bj, c01);
+        c11 = _mm256_fmadd_pd(a1, bj, c11);
+        bj  = _mm256_broadcast_sd(b + 2);
+        c02 = _mm256_fmadd_pd(a0, bj, c02);
+        c12 = _mm256_fmadd_pd(a1, bj, c12);
+        bj  = _mm256_broadcast_sd(b + 3);
+        c03 = _mm256_fmadd_pd(a0, bj, c03);
+        c13 = _mm256_fmadd_pd(a1, bj, c13);
+        bj  = _mm256_broadcast_sd(b + 4);
+        c04 = _mm256_fmadd_pd(a0, bj, c04);
+        c14 = _mm256_fmadd_pd(a1, bj, c14);
+        bj  = _mm256_broadcast_sd(b + 5);
+        c05 = _mm256_fmadd_pd(a0, bj, c05);
+        c15 = _mm256_fmadd_pd(a1, bj, c15);
+    }
+
+    const __m256d top[]    = {c00, c01, c02, c03, c04, c05};
+    const __m256d bottom[] = {c10, c11, c12, c13, c14, c15};
+    for (Size j = 0; j < 6; ++j, c += ldc) {
+        _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), top[j]));
+        _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), bottom[j]));
+    }
+}
+
+
+__attribute__((target("avx512f"))) void kernelAVX512(Size kc, const Scalar* a, const Scalar* b, Scalar* c,
+                                                      Size ldc) {
+    // 16 x 8 tile: two vectors of 8 rows per column, 16 accumulators
+    __m512d c00 = _mm512_setzero_pd(), c01 = c00, c02 = c00, c03 = c00, c04 = c00, c05 = c00, c06 = c00, c07 = c00;
+    __m512d c10 = c00, c11 = c00, c12 = c00, c13 = c00, c14 = c00, c15 = c00, c16 = c00, c17 = c00;
+
+    for (Size p = 0; p < kc; ++p, a += 16, b += 8) {
+        const __m512d a0 = _mm512_loadu_pd(a);
+        const __m512d a1 = _mm512_loadu_pd(a + 8);
+        __m512d bj;
+
+        bj  = _mm512_set1_pd(b[0]);
+        c00 = _mm512_fmadd_pd(a0, bj, c00);
+        c10 = _mm512_fmadd_pd(a1, bj, c10);
+        bj  = _mm512_set1_pd(b[1]);
+        c01 = _mm512_fmadd_pd(a0, bj, c01);
+        c11 = _mm512_fmadd_pd(a1, bj, c11);
+        bj  = _mm512_set1_pd(b[2]);
+        c02 = _mm512_fmadd_pd(a0, bj, c02);
+        c12 = _mm512_fmadd_pd(a1, bj, c12);
+        bj  = _mm512_set1_pd(b[3]);
+        c03 = _mm512_fmadd_pd(a0, bj, c03);
+        c13 = _mm512_fmadd_pd(a1, bj, c13);
+        bj  = _mm512_set1_pd(b[4]);
+        c04 = _mm512_fmadd_pd(a0, bj, c04);
+        c14 = _mm512_fmadd_pd(a1, bj, c14);
+        bj  = _mm512_set1_pd(b[5]);
+        c05 = _mm512_fmadd_pd(a0, bj, c05);
+        c15 = _mm512_fmadd_pd(a1, bj, c15);
+        bj  = _mm512_set1_pd(b[6]);
+        c06 = _mm512_fmadd_pd(a0, bj, c06);
+        c16 = _mm512_fmadd_pd(a1, bj, c16);
+        bj  = _mm512_set1_pd(b[7]);
+        c07 = _mm512_fmadd_pd(a0, bj, c07);
+        c17 = _mm512_fmadd_pd(a1, bj, c17);
+    }
+
+    const __m512d top[]    = {c00, c01, c02, c03, c04, c05, c06, c07};
+    const __m512d bottom[] = {c10, c11, c12, c13, c14, c15, c16, c17};
+    for (Size j = 0; j < 8; ++j, c += ldc) {
+        _mm512_storeu_pd(c, _mm512_add_pd(_mm512_loadu_pd(c), top[j]));
+        _mm512_storeu_pd(c + 8, _mm512_add_pd(_mm512_loadu_pd(c + 8), bottom[j]));
+    }
+}
+
+#endif
+
+
+const Kernel portable{"portable", 4, 4, &kernelPortable<4, 4>};
+#if ECKIT_LINALG_BLOCKED_X86
+const Kernel avx2{"avx2", 8, 6, &kernelAVX2};
+const Kernel avx512{"avx512", 16, 8, &kernelAVX512};
+#endif
+
+
+/// The fastest kernel the CPU supports, unless linearAlgebraBlockedKernel names one
+const Kernel& kernel() {
+    static const Kernel& k = []() -> const Kernel& {
+        std::vector<const Kernel*> supported{&portable};
+#if ECKIT_LINALG_BLOCKED_X86
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            supported.push_back(&avx2);
+        }
+        if (__builtin_cpu_supports("avx512f")) {
+            supported.push_back(&avx512);
+        }
+#endif
+
+        std::string name = Resource<std::string>("linearAlgebraBlockedKernel;$ECKIT_LINEAR_ALGEBRA_BLOCKED_KERNEL", "");
+        if (name.empty()) {
+            return *supported.back();
+        }
+
+        for (const auto* s : supported) {
+            if (name == s->name) {
+                return *s;
+            }
+        }
+        throw UserError("LinearAlgebraBlocked: kernel '" + name + "' is not supported on this CPU");
+    }();
+    return k;
+}
+
+
+/// Rows [ic, ic + mc) and columns [pc, pc + kc) of A, as panels of mr rows stored column by column, padded with 0
+void packA(const Scalar* A, Size lda, Size ic, Size mc, Size pc, Size kc, Size mr, Scalar* pack) {
+    for (Size ir = 0; ir < mc; ir += mr, pack += mr * kc) {
+        const Size rows = std::min(mr, mc - ir);
+        for (Size p = 0; p < kc; ++p) {
+            const Scalar* a = A + (pc + p) * lda + ic + ir;
+            Scalar* dst     = pack + p * mr;
+            std::copy(a, a + rows, dst);
+            std::fill(dst + rows, dst + mr, 0.);
+        }
+    }
+}
+
+
+/// Rows [pc, pc + kc) and columns [jc, jc + nc) of B, as panels of nr columns stored row by row, padded with 0
+void packB(const Scalar* B, Size ldb, Size pc, Size kc, Size jc, Size nc, Size nr, Scalar* pack) {
+    for (Size jr = 0; jr < nc; jr += nr, pack += nr * kc) {
+        const Size cols = std::min(nr, nc - jr);
+        for (Size j = 0; j < nr; ++j) {
+            if (j < cols) {
+                const Scalar* b = B + (jc + jr + j) * ldb + pc;
+                for (Size p = 0; p < kc; ++p) {
+                    pack[p * nr + j] = b[p];
+                }
+            }
+            else {
+                for (Size p = 0; p < kc; ++p) {
+                    pack[p * nr + j] = 0.;
+                }
+            }
+        }
+    }
+}
+
+
+/// y[0, rows) = A[0, rows) x, four columns at a time so that y is loaded and stored once per four columns
+void gemvRows(Size rows, Size cols, const Scalar* A, Size lda, const Scalar* x, Scalar* y) {
+    std::fill(y, y + rows, 0.);
+
+    Size j = 0;
+    for (; j + 4 <= cols; j += 4) {
+        const Scalar* a0 = A + j * lda;
+        const Scalar* a1 = a0 + lda;
+        const Scalar* a2 = a1 + lda;
+        const Scalar* a3 = a2 + lda;
+
+        const Scalar x0 = x[j];
+        const Scalar x1 = x[j + 1];
+        const Scalar x2 = x[j + 2];
+        const Scalar x3 = x[j + 3];
+
+        for (Size i = 0; i < rows; ++i) {
+            y[i] += a0[i] * x0 + a1[i] * x1 + a2[i] * x2 + a3[i] * x3;
+        }
+    }
+
+    for (; j < cols; ++j) {
+        const Scalar* a = A + j * lda;
+        const Scalar xj = x[j];
+        for (Size i = 0; i < rows; ++i) {
+            y[i] += a[i] * xj;
+        }
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void LinearAlgebraBlocked::print(std::ostream& out) const {
+    out << "LinearAlgebraBlocked[kernel=" << kernel().name << "]";
+}
+
+
+Scalar LinearAlgebraBlocked::dot(const Vector& x, const Vector& y) const {
+    const auto Ni = x.size();
+    ASSERT(y.size() == Ni);
+
+    const Scalar* a = x.data();
+    const Scalar* b = y.data();
+
+    // Independent partial sums, so that additions overlap
+    Scalar s0 = 0.;
+    Scalar s1 = 0.;
+    Scalar s2 = 0.;
+    Scalar s3 = 0.;
+
+    const Size N4 = Ni - Ni % 4;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for reduction(+ : s0, s1, s2, s3)
+#endif
+    for (Size i = 0; i < N4; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+
+    for (Size i = N4; i < Ni; ++i) {
+        s0 += a[i] * b[i];
+    }
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+
+void LinearAlgebraBlocked::gemv(const Matrix& A, const Vector& x, Vector& y) const {
+    const auto Ni = A.rows();
+    const auto Nj = A.cols();
+
+    ASSERT(y.rows() == Ni);
+    ASSERT(x.rows() == Nj);
+
+    const Size blocks = (Ni + GEMV_ROWS - 1) / GEMV_ROWS;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size b = 0; b < blocks; ++b) {
+        const Size i = b * GEMV_ROWS;
+        gemvRows(std::min(GEMV_ROWS, Ni - i), Nj, A.data() + i, Ni, x.data(), y.data() + i);
+    }
+}
+
+
+void LinearAlgebraBlocked::gemm(const Matrix& A, const Matrix& B, Matrix& C) const {
+    const auto Ni = A.rows();
+    const auto Nj = B.cols();
+    const auto Nk = A.cols();
+
+    ASSERT(C.rows() == Ni);
+    ASSERT(C.cols() == Nj);
+    ASSERT(B.rows() == Nk);
+
+    Scalar* c = C.data();
+    std::fill(c, c + Ni * Nj, 0.);
+
+    const Kernel& k = kernel();
+    const Size MR   = k.mr;
+    const Size NR   = k.nr;
+
+    // Packing buffers only as large as the blocks of these matrices
+    const Size kcMax = std::min(KC, Nk);
+    const Size mcMax = (std::min(MC, Ni) + MR - 1) / MR * MR;
+    const Size ncMax = (std::min(NC, Nj) + NR - 1) / NR * NR;
+
+    std::vector<Scalar> bpack(kcMax * ncMax);
+
+    for (Size jc = 0; jc < Nj; jc += NC) {
+        const Size nc = std::min(NC, Nj - jc);
+
+        for (Size pc = 0; pc < Nk; pc += KC) {
+            const Size kc = std::min(KC, Nk - pc);
+
+            packB(B.data(), Nk, pc, kc, jc, nc, NR, bpack.data());
+
+            const Size blocks = (Ni + MC - 1) / MC;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel
+#endif
+            {
+                std::vector<Scalar> apack(kcMax * mcMax);
+                Scalar tile[MAX_TILE];
+
+#if eckit_HAVE_OMP
+#pragma omp for
+#endif
+                for (Size block = 0; block < blocks; ++block) {
+                    const Size ic = block * MC;
+                    const Size mc = std::min(MC, Ni - ic);
+
+                    packA(A.data(), Ni, ic, mc, pc, kc, MR, apack.data());
+
+                    for (Size jr = 0; jr < nc; jr += NR) {
+                        const Size nr = std::min(NR, nc - jr);
+                        const Scalar* b = bpack.data() + jr * kc;
+
+                        for (Size ir = 0; ir < mc; ir += MR) {
+                            const Size mr   = std::min(MR, mc - ir);
+                            const Scalar* a = apack.data() + ir * kc;
+                            Scalar* cij     = c + (jc + jr) * Ni + ic + ir;
+
+                            if (mr == MR && nr == NR) {
+                                k.run(kc, a, b, cij, Ni);
+                                continue;
+                            }
+
+                            // Edge of C: full tile computed aside, only its valid part added
+                            std::fill(tile, tile + MR * NR, 0.);
+                            k.run(kc, a, b, tile, MR);
+                            for (Size j = 0; j < nr; ++j) {
+                                for (Size i = 0; i < mr; ++i) {
+                                    cij[j * Ni + i] += tile[j * MR + i];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace eckit::linalg::dense
@@ -0,0 +1,34 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include "eckit/linalg/LinearAlgebraDense.h"
+
+namespace eckit::linalg::dense {
+
+/// Cache-blocked dense backend, without external libraries.
+///
+/// gemm packs blocks of A and B into contiguous panels and runs a register-blocked microkernel on them, using AVX-512
+/// or AVX2/FMA when the CPU supports it (chosen at run time, or with linearAlgebraBlockedKernel), else portable code.
+/// gemv accumulates columns of A over blocks of rows of y.
+struct LinearAlgebraBlocked final : public LinearAlgebraDense {
+    LinearAlgebraBlocked() {}
+    LinearAlgebraBlocked(const std::string& name) :
+        LinearAlgebraDense(name) {}
+
+    Scalar dot(const Vector&, const Vector&) const override;
+    void gemv(const Matrix&, const Vector&, Vector&) const override;
+    void gemm(const Matrix&, const Matrix&, Matrix&) const override;
+    void print(std::ostream&) const override;
+};
+
+}  // namespace eckit::linalg::dense
@@ -16,6 +16,9 @@
 #ifndef eckit_Counted_h
 #define eckit_Counted_h
 
+#include <atomic>
+#include <cstddef>
+
 #include "eckit/memory/NonCopyable.h"
 #include "eckit/thread/Mutex.h"
 
@@ -46,28 +49,22 @@ public:
 
 /// Reference counting objects
 /// Subclass from this class if you want reference counting object.
+/// The count is atomic: attach() and detach() take no lock. lock() and unlock() remain for subclasses.
 /// @note Remember to use 'virtual' inheritance in case of multiple inheritance
 
 class Counted : private NonCopyable, private memory::detail::ThreadedLock {
 public:  // methods
-    void attach() const {
-        lock();
-        count_++;
-        unlock();
-    }
+    void attach() const { count_.fetch_add(1, std::memory_order_relaxed); }
 
     void detach() const {
-        lock();
-        if (--count_ == 0) {
-            unlock();
+        // Release our writes to the object, the last owner acquires them all before deleting it
+        if (count_.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
             delete this;
         }
-        else {
-            unlock();
-        }
     }
 
-    size_t count() const { return count_; }
+    size_t count() const { return count_.load(std::memory_order_relaxed); }
 
     void lock() const { memory::detail::ThreadedLock::lock(); }
 
@@ -80,7 +77,7 @@ public:
     virtual ~Counted();
 
 private:  // members
-    mutable size_t count_;
+    mutable std::atomic<size_t> count_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -15,6 +15,8 @@
 #ifndef eckit_memory_Owned_h
 #define eckit_memory_Owned_h
 
+#include <atomic>
+
 #include "eckit/memory/Counted.h"
 
 
@@ -24,6 +26,7 @@ namespace eckit {
 
 /// Reference counting objects
 /// Subclass from this class to use a SharedPtr class
+/// The count is atomic whatever the LOCK, which is only made available to subclasses
 
 template <typename LOCK>
 class OwnedT : private NonCopyable, public LOCK {
@@ -34,22 +37,21 @@ public:  // methods
 
     virtual ~OwnedT() {}
 
-    void attach() const {
-        LOCK::lock();
-        count_++;
-        LOCK::unlock();
-    }
+    void attach() const { count_.fetch_add(1, std::memory_order_relaxed); }
 
-    void detach() const {
-        LOCK::lock();
-        --count_;
-        LOCK::unlock();
+    /// @returns the number of owners left, when 0 the caller is the last one and may delete the object
+    size_t detach() const {
+        size_t left = count_.fetch_sub(1, std::memory_order_release) - 1;
+        if (left == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return left;
     }
 
-    size_t owners() const { return count_; }
+    size_t owners() const { return count_.load(std::memory_order_relaxed); }
 
 private:  // members
-    mutable size_t count_;
+    mutable std::atomic<size_t> count_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -102,16 +102,11 @@ public:  // methods
     /// @post ptr_ = 0
     void release() {
         if (!null()) {
-            ptr_->lock();
-            ptr_->detach(); /* lock/unlock in detach() isn't sufficient, else there is race
-                               condition on owners() */
-
-            if (ptr_->owners() == 0) {
-                ptr_->unlock();
+            // detach() returns the owners left, so that only the last one deallocates
+            if (ptr_->detach() == 0) {
                 ALLOC::deallocate(ptr_);  // also zeros ptr_
                 return;
             }
-            ptr_->unlock();
             ptr_ = 0;
         }
     }
@@ -0,0 +1,266 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/message/MessageIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <thread>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/MappedFile.h"
+#include "eckit/log/Log.h"
+#include "eckit/message/Splitter.h"
+
+namespace eckit::message {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const char INDEX_MAGIC[] = {'E', 'C', 'M', 'S', 'G', 'I', 'D', 'X'};
+const unsigned long long INDEX_VERSION = 1;
+
+size_t defaultThreads() {
+    static long threads = Resource<long>("messageIndexThreads;$ECKIT_MESSAGE_INDEX_THREADS", 4);
+    return std::max(threads, 1L);
+}
+
+size_t minimumChunkSize() {
+    static long size = Resource<long>("messageIndexChunkSize;$ECKIT_MESSAGE_INDEX_CHUNK_SIZE", 16 * 1024 * 1024);
+    return std::max(size, 1L);
+}
+
+struct Candidate {
+    size_t offset;
+    size_t length;
+
+    bool operator<(const Candidate& other) const { return offset < other.offset; }
+};
+
+/// Finds the valid messages starting in [begin, end). memchr() on the first byte of the magic is vectorised by the
+/// C library, candidates are then confirmed by the splitter, which may look past end
+void scan(const MappedFile& file, size_t begin, size_t end, const std::vector<const SplitterBuilderBase*>& scanners,
+          const std::vector<std::string>& magics, std::vector<Candidate>& result) {
+    const char* base  = static_cast<const char*>(file.data());
+    const size_t size = file.size();
+
+    for (size_t k = 0; k < scanners.size(); ++k) {
+        const std::string& magic = magics[k];
+        if (magic.size() > size) {
+            continue;
+        }
+
+        const char* p    = base + begin;
+        const char* last = base + std::min(end, size - magic.size() + 1);
+
+        while (p < last) {
+            p = static_cast<const char*>(::memchr(p, magic[0], last - p));
+            if (p == nullptr) {
+                break;
+            }
+            if (::memcmp(p, magic.data(), magic.size()) == 0) {
+                size_t length = scanners[k]->messageLength(p, base + size - p);
+                if (length > 0) {
+                    result.push_back({size_t(p - base), length});
+                }
+            }
+            ++p;
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+}
+
+void writeValue(DataHandle& out, unsigned long long value) {
+    unsigned char p[8];
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<unsigned char>(value & 0xff);
+        value >>= 8;
+    }
+    if (out.write(p, sizeof(p)) != sizeof(p)) {
+        throw WriteError("MessageIndex: failed to write index", Here());
+    }
+}
+
+void readBytes(DataHandle& in, void* buffer, size_t length) {
+    if (in.read(buffer, length) != long(length)) {
+        throw ReadError("MessageIndex: unexpected end of index", Here());
+    }
+}
+
+unsigned long long readValue(DataHandle& in) {
+    unsigned char p[8];
+    readBytes(in, p, sizeof(p));
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MessageIndex::MessageIndex() :
+    fileSize_(0) {}
+
+MessageIndex::MessageIndex(const PathName& path, size_t threads) :
+    path_(path), fileSize_(0) {
+
+    std::vector<const SplitterBuilderBase*> scanners = SplitterFactory::instance().scanners();
+    if (scanners.empty()) {
+        throw SeriousBug("MessageIndex: no SplitterBuilder supports scanning for messages", Here());
+    }
+
+    std::vector<std::string> magics;
+    for (const auto* s : scanners) {
+        magics.push_back(s->magic());
+    }
+
+    auto mapped            = MappedFile::open(path.localPath());
+    const MappedFile& file = *mapped;
+    fileSize_              = file.size();
+
+    if (threads == 0) {
+        threads = defaultThreads();
+    }
+
+    // A few chunks per thread, to even out the work
+    const size_t chunkSize = std::max(minimumChunkSize(), (file.size() + 4 * threads - 1) / (4 * threads));
+    const size_t nchunks   = (file.size() + chunkSize - 1) / chunkSize;
+
+    std::vector<std::vector<Candidate> > candidates(nchunks);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < std::min(threads, nchunks); ++t) {
+        workers.emplace_back([&, t] {
+            try {
+                for (size_t c = t; c < nchunks; c += threads) {
+                    scan(file, c * chunkSize, std::min(file.size(), (c + 1) * chunkSize), scanners, magics,
+                         candidates[c]);
+                }
+            }
+            catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    // Magic bytes can appear within messages, keep only the candidates a sequential reader would find
+
+    size_t next = 0;
+    for (const auto& chunk : candidates) {
+        for (const auto& c : chunk) {
+            if (c.offset >= next) {
+                entries_.push_back({c.offset, c.length});
+                next = c.offset + c.length;
+            }
+        }
+    }
+
+    Log::debug() << "MessageIndex: " << path << " " << entries_.size() << " messages, " << nchunks << " chunks, "
+                 << threads << " threads" << std::endl;
+}
+
+DataHandle* MessageIndex::readHandle(size_t n) const {
+    ASSERT(n < entries_.size());
+    return path_.partHandle(entries_[n].offset, entries_[n].length);
+}
+
+bool MessageIndex::upToDate() const {
+    return path_.exists() && (unsigned long long)path_.size() == fileSize_;
+}
+
+void MessageIndex::save(const PathName& path) const {
+    std::unique_ptr<DataHandle> out(path.fileHandle());
+    out->openForWrite(0);
+    AutoClose closer(*out);
+
+    const std::string name = path_.asString();
+
+    if (out->write(INDEX_MAGIC, sizeof(INDEX_MAGIC)) != sizeof(INDEX_MAGIC)) {
+        throw WriteError("MessageIndex: failed to write index", Here());
+    }
+    writeValue(*out, INDEX_VERSION);
+    writeValue(*out, name.size());
+    if (out->write(name.data(), name.size()) != long(name.size())) {
+        throw WriteError("MessageIndex: failed to write index", Here());
+    }
+    writeValue(*out, fileSize_);
+    writeValue(*out, entries_.size());
+
+    for (const auto& e : entries_) {
+        writeValue(*out, (unsigned long long)e.offset);
+        writeValue(*out, (unsigned long long)e.length);
+    }
+}
+
+MessageIndex MessageIndex::load(const PathName& path) {
+    std::unique_ptr<DataHandle> in(path.fileHandle());
+    in->openForRead();
+    AutoClose closer(*in);
+
+    char magic[sizeof(INDEX_MAGIC)];
+    readBytes(*in, magic, sizeof(magic));
+    if (::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0) {
+        throw BadValue("MessageIndex: " + path.asString() + " is not a message index", Here());
+    }
+
+    unsigned long long version = readValue(*in);
+    if (version != INDEX_VERSION) {
+        std::ostringstream oss;
+        oss << "MessageIndex: " << path << " has unsupported version " << version;
+        throw BadValue(oss.str(), Here());
+    }
+
+    MessageIndex index;
+
+    std::string name(readValue(*in), '\0');
+    readBytes(*in, &name[0], name.size());
+    index.path_ = name;
+
+    index.fileSize_ = readValue(*in);
+
+    size_t n = readValue(*in);
+    index.entries_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        Offset offset = readValue(*in);
+        Length length = readValue(*in);
+        index.entries_.push_back({offset, length});
+    }
+
+    return index;
+}
+
+void MessageIndex::print(std::ostream& s) const {
+    s << "MessageIndex[path=" << path_ << ",messages=" << entries_.size() << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::message
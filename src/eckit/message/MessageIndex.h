@@ -0,0 +1,85 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_message_MessageIndex_h
+#define eckit_message_MessageIndex_h
+
+#include <iosfwd>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+namespace eckit {
+class DataHandle;
+}
+
+namespace eckit::message {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Offsets and lengths of the messages of a file.
+///
+/// The index is built without reading the file sequentially: the file is mapped in memory and cut into chunks,
+/// which workers scan for the magic bytes of the registered splitters that support it (see
+/// SplitterBuilderBase::magic()). Candidates found inside a previous message are then discarded, in order.
+///
+/// The index can be saved next to the file, so that later readers can go straight to message n, e.g. with
+/// Reader::seek() or readHandle().
+
+class MessageIndex {
+public:  // types
+    struct Entry {
+        Offset offset;
+        Length length;
+    };
+
+public:  // methods
+    MessageIndex();
+
+    /// Scans path for messages, with the given number of threads (0 for the default)
+    explicit MessageIndex(const PathName& path, size_t threads = 0);
+
+    size_t size() const { return entries_.size(); }
+
+    const Entry& operator[](size_t n) const { return entries_[n]; }
+
+    const PathName& path() const { return path_; }
+
+    /// @returns a handle on message n
+    DataHandle* readHandle(size_t n) const;
+
+    /// @returns false if the indexed file has changed size since it was indexed
+    bool upToDate() const;
+
+    void save(const PathName&) const;
+
+    static MessageIndex load(const PathName&);
+
+private:  // methods
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const MessageIndex& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    PathName path_;
+    unsigned long long fileSize_;
+    std::vector<Entry> entries_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::message
+
+#endif
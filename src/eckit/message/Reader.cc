@@ -64,4 +64,8 @@ eckit::Offset Reader::position() {
     return handle_.position();
 }
 
+void Reader::seek(const eckit::Offset& offset) {
+    handle_.seek(offset);
+}
+
 }  // namespace eckit::message
@@ -46,6 +46,9 @@ public:
     Message next();
     eckit::Offset position();
 
+    /// Continues reading from the given offset, typically of a message from a MessageIndex
+    void seek(const eckit::Offset&);
+
 private:
     std::unique_ptr<Splitter> splitter_;
     eckit::PeekHandle handle_;
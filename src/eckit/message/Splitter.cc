@@ -51,6 +51,26 @@ SplitterBuilderBase::~SplitterBuilderBase() {
     SplitterFactory::instance().deregister(this);
 }
 
+std::string SplitterBuilderBase::magic() const {
+    return {};
+}
+
+size_t SplitterBuilderBase::messageLength(const void*, size_t) const {
+    return 0;
+}
+
+std::vector<const SplitterBuilderBase*> SplitterFactory::scanners() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<const SplitterBuilderBase*> result;
+    for (const auto* b : decoders_) {
+        if (!b->magic().empty()) {
+            result.push_back(b);
+        }
+    }
+    return result;
+}
+
 Splitter* SplitterFactory::lookup(eckit::PeekHandle& handle) {
     std::lock_guard<std::mutex> lock(mutex_);
 
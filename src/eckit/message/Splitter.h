@@ -14,8 +14,10 @@
 #ifndef eckit_message_Splitter_h
 #define eckit_message_Splitter_h
 
+#include <cstddef>
 #include <iosfwd>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace eckit {
@@ -59,6 +61,15 @@ public:
 
     virtual Splitter* make(eckit::PeekHandle&) const = 0;
     virtual bool match(eckit::PeekHandle&) const     = 0;
+
+    // Optional support for finding messages in memory, used to index files in parallel (see MessageIndex)
+
+    /// @returns the bytes every message of this kind starts with, empty if the kind cannot be scanned for
+    virtual std::string magic() const;
+
+    /// @returns the length of the message starting at p, which has size bytes available,
+    /// or 0 if p does not start a complete message of this kind
+    virtual size_t messageLength(const void* p, size_t size) const;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -69,6 +80,9 @@ public:
 
     Splitter* lookup(eckit::PeekHandle&);
 
+    /// Builders that support scanning, see SplitterBuilderBase::magic()
+    std::vector<const SplitterBuilderBase*> scanners();
+
     void enregister(SplitterBuilderBase*);
     void deregister(const SplitterBuilderBase*);
 
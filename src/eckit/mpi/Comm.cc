@@ -289,6 +289,23 @@ Comm::Comm(const std::string& name) :
 
 Comm::~Comm() {}
 
+namespace {
+
+class PrivateBuffer : public NodeSharedBuffer {
+public:
+    explicit PrivateBuffer(const eckit::SharedBuffer& buffer) :
+        NodeSharedBuffer(buffer->data(), buffer.size()), buffer_(buffer) {}
+
+private:
+    eckit::SharedBuffer buffer_;
+};
+
+}  // namespace
+
+std::unique_ptr<NodeSharedBuffer> Comm::broadcastFileNodeShared(const PathName& filepath, size_t root) const {
+    return std::make_unique<PrivateBuffer>(broadcastFile(filepath, root));
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 Comm& comm(const char* name) {
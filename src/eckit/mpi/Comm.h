@@ -13,6 +13,7 @@
 
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,7 @@
 #include "eckit/mpi/Buffer.h"
 #include "eckit/mpi/DataType.h"
 #include "eckit/mpi/Group.h"
+#include "eckit/mpi/NodeSharedBuffer.h"
 #include "eckit/mpi/Operation.h"
 #include "eckit/mpi/Request.h"
 #include "eckit/mpi/Status.h"
@@ -311,6 +313,20 @@ public:  // methods
     void allToAllv(const T* sendbuf, const int sendcounts[], const int sdispls[], T* recvbuf, const int recvcounts[],
                    const int rdispls[]) const;
 
+    ///
+    /// All to All with the neighbours of a graph communicator (see graph()), variable data size.
+    /// Blocks are sent in the order of the destinations, and received in the order of the sources
+    ///
+
+    template <typename T>
+    void neighbourAllToAllv(const T* sendbuf, const int sendcounts[], const int sdispls[], T* recvbuf,
+                            const int recvcounts[], const int rdispls[]) const;
+
+    template <typename T>
+    void neighbourAllToAllv(const std::vector<T>& send, const std::vector<int>& sendcounts,
+                            const std::vector<int>& sdispls, std::vector<T>& recv, const std::vector<int>& recvcounts,
+                            const std::vector<int>& rdispls) const;
+
     ///
     ///  Non-blocking receive
     ///
@@ -362,6 +378,24 @@ public:  // methods
     template <typename T>
     Request iSend(const T& sendbuf, int dest, int tag) const;
 
+    ///
+    /// Persistent send and receive: the request is created once, then each start() sends (or receives) the
+    /// current contents of the buffer, to be completed with wait().
+    /// The request is released when the last copy of the Request is destroyed
+    ///
+
+    template <typename T>
+    Request sendInit(const T* sendbuf, size_t count, int dest, int tag) const;
+
+    template <typename T>
+    Request receiveInit(T* recv, size_t count, int source, int tag) const;
+
+    /// @brief Start a persistent request, see sendInit() and receiveInit()
+    virtual void start(Request&) const = 0;
+
+    /// @brief Start persistent requests, see sendInit() and receiveInit()
+    virtual void startAll(std::vector<Request>&) const = 0;
+
     ///
     /// In place simultaneous send and receive
     ///
@@ -387,9 +421,25 @@ public:  // methods
 
     virtual eckit::SharedBuffer broadcastFile(const eckit::PathName& filepath, size_t root) const = 0;
 
+    /// Read file on one rank, and broadcast it so that each node holds a single copy, in memory shared by the ranks
+    /// of the node. The default keeps a copy per rank, see broadcastFile().
+    /// @note the buffer must be released by all the ranks, as this may be a collective operation
+    virtual std::unique_ptr<NodeSharedBuffer> broadcastFileNodeShared(const eckit::PathName& filepath,
+                                                                      size_t root) const;
+
     /// @brief Split the communicator based on color & give the new communicator a name
     virtual Comm& split(int color, const std::string& name) const = 0;
 
+    /// @brief Create a communicator with a distributed graph topology & give it a name
+    /// @param sources      ranks this rank receives from, in the order of the received blocks
+    /// @param destinations ranks this rank sends to, in the order of the sent blocks
+    /// @param reorder      allow the ranks to be renumbered in the new communicator
+    virtual Comm& graph(const std::vector<int>& sources, const std::vector<int>& destinations,
+                        const std::string& name, bool reorder = false) const = 0;
+
+    /// @brief Neighbours of this rank in a graph communicator
+    virtual void neighbours(std::vector<int>& sources, std::vector<int>& destinations) const = 0;
+
     /// @brief The communicator
     virtual int communicator() const = 0;
 
@@ -456,6 +506,14 @@ protected:  // methods
 
     virtual Request iSend(const void* send, size_t count, Data::Code datatype, int dest, int tag) const = 0;
 
+    virtual void neighbourAllToAllv(const void* sendbuf, const int sendcounts[], const int sdispls[], void* recvbuf,
+                                    const int recvcounts[], const int rdispls[], Data::Code datatype) const
+        = 0;
+
+    virtual Request sendInit(const void* send, size_t count, Data::Code datatype, int dest, int tag) const = 0;
+
+    virtual Request receiveInit(void* recv, size_t count, Data::Code datatype, int source, int tag) const = 0;
+
     virtual Status sendReceiveReplace(void* sendrecv, size_t count, Data::Code datatype,
                                       int dest, int sendtag, int source, int recvtag) const
         = 0;
@@ -901,6 +959,22 @@ void eckit::mpi::Comm::allToAllv(const T* sendbuf, const int sendcounts[], const
     allToAllv(sendbuf, sendcounts, sdispls, recvbuf, recvcounts, rdispls, Data::Type<T>::code());
 }
 
+template <typename T>
+void eckit::mpi::Comm::neighbourAllToAllv(const T* sendbuf, const int sendcounts[], const int sdispls[], T* recvbuf,
+                                          const int recvcounts[], const int rdispls[]) const {
+    neighbourAllToAllv(sendbuf, sendcounts, sdispls, recvbuf, recvcounts, rdispls, Data::Type<T>::code());
+}
+
+template <typename T>
+void eckit::mpi::Comm::neighbourAllToAllv(const std::vector<T>& send, const std::vector<int>& sendcounts,
+                                          const std::vector<int>& sdispls, std::vector<T>& recv,
+                                          const std::vector<int>& recvcounts, const std::vector<int>& rdispls) const {
+    ECKIT_MPI_ASSERT(sendcounts.size() == sdispls.size());
+    ECKIT_MPI_ASSERT(recvcounts.size() == rdispls.size());
+    neighbourAllToAllv(send.data(), sendcounts.data(), sdispls.data(), recv.data(), recvcounts.data(), rdispls.data(),
+                       Data::Type<T>::code());
+}
+
 ///
 ///  Non-blocking receive
 ///
@@ -985,6 +1059,16 @@ eckit::mpi::Request eckit::mpi::Comm::iSend(const T& sendbuf, int dest, int tag)
     return iSend(&sendbuf, 1, Data::Type<T>::code(), dest, tag);
 }
 
+template <typename T>
+eckit::mpi::Request eckit::mpi::Comm::sendInit(const T* sendbuf, size_t count, int dest, int tag) const {
+    return sendInit(sendbuf, count, Data::Type<T>::code(), dest, tag);
+}
+
+template <typename T>
+eckit::mpi::Request eckit::mpi::Comm::receiveInit(T* recv, size_t count, int source, int tag) const {
+    return receiveInit(recv, count, Data::Type<T>::code(), source, tag);
+}
+
 template <typename T, typename CIter>
 void eckit::mpi::Comm::allGatherv(CIter first, CIter last, mpi::Buffer<T>& recv) const {
     int sendcnt = int(std::distance(first, last));
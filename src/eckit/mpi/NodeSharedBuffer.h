@@ -0,0 +1,49 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_mpi_NodeSharedBuffer_h
+#define eckit_mpi_NodeSharedBuffer_h
+
+#include <cstddef>
+#include <string>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit::mpi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Read-only memory holding the contents of a file, as returned by Comm::broadcastFileNodeShared().
+/// Depending on the communicator, the memory is private to the rank, or shared by the ranks of a node.
+
+class NodeSharedBuffer : private NonCopyable {
+public:  // methods
+    virtual ~NodeSharedBuffer() = default;
+
+    const void* data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    std::string str() const { return std::string(static_cast<const char*>(data_), size_); }
+
+protected:  // methods
+    NodeSharedBuffer(const void* data, size_t size) :
+        data_(data), size_(size) {}
+
+private:  // members
+    const void* data_;
+    size_t size_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::mpi
+
+#endif
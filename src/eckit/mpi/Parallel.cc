@@ -12,7 +12,10 @@
 
 #include <errno.h>
 #include <unistd.h>
+#include <algorithm>
+#include <deque>
 #include <limits>
+#include <memory>
 #include <sstream>
 
 #include "eckit/exception/Exceptions.h"
@@ -20,6 +23,7 @@
 #include "eckit/config/Resource.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/DataHandle.h"
+#include "eckit/log/Log.h"
 #include "eckit/mpi/ParallelGroup.h"
 #include "eckit/mpi/ParallelRequest.h"
 #include "eckit/mpi/ParallelStatus.h"
@@ -631,6 +635,62 @@ Request Parallel::iSend(const void* send, size_t count, Data::Code type, int des
     return req;
 }
 
+void Parallel::neighbourAllToAllv(const void* sendbuf, const int sendcounts[], const int sdispls[], void* recvbuf,
+                                  const int recvcounts[], const int rdispls[], Data::Code type) const {
+    MPI_Datatype mpitype = toType(type);
+
+    MPI_CALL(MPI_Neighbor_alltoallv(const_cast<void*>(sendbuf), const_cast<int*>(sendcounts),
+                                    const_cast<int*>(sdispls), mpitype, recvbuf, const_cast<int*>(recvcounts),
+                                    const_cast<int*>(rdispls), mpitype, comm_));
+}
+
+Request Parallel::sendInit(const void* send, size_t count, Data::Code type, int dest, int tag) const {
+    ASSERT(count < size_t(std::numeric_limits<int>::max()));
+
+    ParallelRequest* request = new ParallelRequest(MPI_REQUEST_NULL);
+    Request req(request);
+
+    MPI_Datatype mpitype = toType(type);
+
+    MPI_CALL(MPI_Send_init(const_cast<void*>(send), int(count), mpitype, dest, tag, comm_, &request->request_));
+    request->persistent_ = true;
+
+    return req;
+}
+
+Request Parallel::receiveInit(void* recv, size_t count, Data::Code type, int source, int tag) const {
+    ASSERT(count < size_t(std::numeric_limits<int>::max()));
+
+    ParallelRequest* request = new ParallelRequest(MPI_REQUEST_NULL);
+    Request req(request);
+
+    MPI_Datatype mpitype = toType(type);
+
+    MPI_CALL(MPI_Recv_init(recv, int(count), mpitype, source, tag, comm_, &request->request_));
+    request->persistent_ = true;
+
+    return req;
+}
+
+void Parallel::start(Request& req) const {
+    MPI_CALL(MPI_Start(toRequest(req)));
+}
+
+void Parallel::startAll(std::vector<Request>& req) const {
+    int count = req.size();
+    std::vector<MPI_Request> req_(count);
+
+    for (int i = 0; i < count; i++) {
+        req_[i] = *(toRequest(req[i]));
+    }
+
+    MPI_CALL(MPI_Startall(count, req_.data()));
+
+    for (int i = 0; i < count; i++) {
+        *(toRequest(req[i])) = req_[i];
+    }
+}
+
 Status Parallel::sendReceiveReplace(void* sendrecv, size_t count, Data::Code type,
                                     int dest, int sendtag, int source, int recvtag) const {
     ASSERT(count < size_t(std::numeric_limits<int>::max()));
@@ -658,6 +718,40 @@ Comm& Parallel::split(int color, const std::string& name) const {
     return *newcomm;
 }
 
+Comm& Parallel::graph(const std::vector<int>& sources, const std::vector<int>& destinations,
+                      const std::string& name, bool reorder) const {
+
+    if (hasComm(name.c_str())) {
+        throw SeriousBug("Communicator with name " + name + " already exists");
+    }
+
+    MPI_Comm new_mpi_comm;
+    MPI_CALL(MPI_Dist_graph_create_adjacent(comm_, int(sources.size()), sources.data(), MPI_UNWEIGHTED,
+                                            int(destinations.size()), destinations.data(), MPI_UNWEIGHTED,
+                                            MPI_INFO_NULL, reorder, &new_mpi_comm));
+    Comm* newcomm = new Parallel(name, new_mpi_comm, true);
+    addComm(name.c_str(), newcomm);
+    return *newcomm;
+}
+
+void Parallel::neighbours(std::vector<int>& sources, std::vector<int>& destinations) const {
+    int topology;
+    MPI_CALL(MPI_Topo_test(comm_, &topology));
+    if (topology != MPI_DIST_GRAPH) {
+        throw SeriousBug("Communicator " + name() + " does not have a graph topology", Here());
+    }
+
+    int indegree;
+    int outdegree;
+    int weighted;
+    MPI_CALL(MPI_Dist_graph_neighbors_count(comm_, &indegree, &outdegree, &weighted));
+
+    sources.resize(indegree);
+    destinations.resize(outdegree);
+    MPI_CALL(MPI_Dist_graph_neighbors(comm_, indegree, sources.data(), MPI_UNWEIGHTED, outdegree,
+                                      destinations.data(), MPI_UNWEIGHTED));
+}
+
 void Parallel::free() {
     MPI_CALL(MPI_Comm_free(&comm_));
     rank_ = 0;
@@ -726,13 +820,21 @@ int Parallel::communicator() const {
     return MPI_Comm_c2f(comm_);
 }
 
-eckit::SharedBuffer Parallel::broadcastFile(const PathName& filepath, size_t root) const {
+namespace {
 
-    ASSERT(root < size());
+size_t broadcastFileChunkSize() {
+    static long size
+        = Resource<long>("mpiBroadcastFileChunkSize;$ECKIT_MPI_BROADCAST_FILE_CHUNK_SIZE", 64 * 1024 * 1024);
+    return std::min<size_t>(std::max(size, 1L), std::numeric_limits<int>::max());
+}
+
+/// Opens the file on root, and shares its length, or the error, with the other ranks
+std::unique_ptr<DataHandle> openBroadcastFile(const PathName& filepath, int root, MPI_Comm comm, size_t& length) {
 
-    bool isRoot = rank() == root;
+    int rank;
+    MPI_CALL(MPI_Comm_rank(comm, &rank));
 
-    eckit::CountedBuffer* buffer = nullptr;
+    std::unique_ptr<DataHandle> dh;
 
     struct BFileOp {
         int err_;
@@ -741,14 +843,10 @@ eckit::SharedBuffer Parallel::broadcastFile(const PathName& filepath, size_t roo
 
     errno = 0;
 
-    if (isRoot) {
+    if (rank == root) {
         try {
-            std::unique_ptr<DataHandle> dh(filepath.fileHandle());
-
+            dh.reset(filepath.fileHandle());
             op.len_ = dh->openForRead();
-            AutoClose closer(*dh);
-            buffer = new eckit::CountedBuffer(op.len_);
-            dh->read(buffer->data(), op.len_);
 
             if (filepath.isDir()) {
                 op.err_ = EISDIR;
@@ -759,7 +857,7 @@ eckit::SharedBuffer Parallel::broadcastFile(const PathName& filepath, size_t roo
         }
     }
 
-    broadcast(&op, sizeof(op), Data::BYTE, root);
+    MPI_CALL(MPI_Bcast(&op, sizeof(op), MPI_BYTE, root, comm));
 
     errno = op.err_;  // set errno to ensure consistent error messages across MPI tasks
 
@@ -771,13 +869,139 @@ eckit::SharedBuffer Parallel::broadcastFile(const PathName& filepath, size_t roo
         throw ShortFile(filepath);
     }
 
-    if (!isRoot) {
-        buffer = new eckit::CountedBuffer(op.len_);
+    length = op.len_;
+    return dh;
+}
+
+/// Broadcasts length bytes of data in chunks, keeping two chunks in flight.
+/// On root, the chunks are read from the handle, the next one while the previous ones are broadcast.
+/// @returns false if root failed to read the data
+bool pipelinedBroadcast(DataHandle* dh, char* data, size_t length, int root, MPI_Comm comm) {
+
+    const size_t chunk = broadcastFileChunkSize();
+    const size_t depth = 2;
+
+    int ok = 1;
+    std::deque<MPI_Request> inflight;
+
+    for (size_t pos = 0; pos < length; pos += chunk) {
+        const size_t len = std::min(chunk, length - pos);
+
+        // Other ranks cannot be told to stop, so carry on broadcasting after a failure
+        if (dh && ok) {
+            try {
+                if (dh->read(data + pos, len) != long(len)) {
+                    ok = 0;
+                }
+            }
+            catch (Exception& e) {
+                Log::error() << "broadcastFile: " << e.what() << std::endl;
+                ok = 0;
+            }
+        }
+
+        if (inflight.size() == depth) {
+            MPI_CALL(MPI_Wait(&inflight.front(), MPI_STATUS_IGNORE));
+            inflight.pop_front();
+        }
+
+        inflight.emplace_back();
+        MPI_CALL(MPI_Ibcast(data + pos, int(len), MPI_BYTE, root, comm, &inflight.back()));
+    }
+
+    for (auto& r : inflight) {
+        MPI_CALL(MPI_Wait(&r, MPI_STATUS_IGNORE));
+    }
+
+    MPI_CALL(MPI_Bcast(&ok, 1, MPI_INT, root, comm));
+    return ok;
+}
+
+/// Memory shared by the ranks of a node, from a MPI window
+class WindowBuffer : public NodeSharedBuffer {
+public:
+    WindowBuffer(MPI_Win win, const void* data, size_t size) :
+        NodeSharedBuffer(data, size), win_(win) {}
+
+    ~WindowBuffer() override {
+        MPI_Win_unlock_all(win_);
+        MPI_Win_free(&win_);
     }
 
-    broadcast(*buffer, op.len_, Data::BYTE, root);
+private:
+    MPI_Win win_;
+};
+
+}  // namespace
+
+eckit::SharedBuffer Parallel::broadcastFile(const PathName& filepath, size_t root) const {
+
+    ASSERT(root < size());
+
+    size_t length = 0;
+    std::unique_ptr<DataHandle> dh = openBroadcastFile(filepath, int(root), comm_, length);
+    std::unique_ptr<AutoClose> closer(dh ? new AutoClose(*dh) : nullptr);
+
+    eckit::SharedBuffer buffer(length);
+
+    if (!pipelinedBroadcast(dh.get(), static_cast<char*>(buffer.data()), length, int(root), comm_)) {
+        throw ReadError("broadcastFile: cannot read " + filepath.asString(), Here());
+    }
+
+    return buffer;
+}
+
+std::unique_ptr<NodeSharedBuffer> Parallel::broadcastFileNodeShared(const PathName& filepath, size_t root) const {
+
+    ASSERT(root < size());
+
+    const bool isRoot = rank() == root;
+
+    size_t length = 0;
+    std::unique_ptr<DataHandle> dh = openBroadcastFile(filepath, int(root), comm_, length);
+    std::unique_ptr<AutoClose> closer(dh ? new AutoClose(*dh) : nullptr);
+
+    // One rank per node receives the file, root first on its node so that it leads it
+
+    MPI_Comm node;
+    MPI_CALL(MPI_Comm_split_type(comm_, MPI_COMM_TYPE_SHARED, isRoot ? 0 : 1, MPI_INFO_NULL, &node));
+
+    int nodeRank;
+    MPI_CALL(MPI_Comm_rank(node, &nodeRank));
+    const bool leader = nodeRank == 0;
+
+    MPI_Comm leaders;
+    MPI_CALL(MPI_Comm_split(comm_, leader ? 0 : MPI_UNDEFINED, isRoot ? 0 : 1, &leaders));
+
+    char* base = nullptr;
+    MPI_Win win;
+    MPI_CALL(MPI_Win_allocate_shared(leader ? MPI_Aint(length) : 0, 1, MPI_INFO_NULL, node, &base, &win));
+    if (!leader) {
+        MPI_Aint size;
+        int disp;
+        MPI_CALL(MPI_Win_shared_query(win, 0, &size, &disp, &base));
+    }
+    MPI_CALL(MPI_Win_lock_all(MPI_MODE_NOCHECK, win));
+
+    std::unique_ptr<NodeSharedBuffer> buffer(new WindowBuffer(win, base, length));
+
+    int ok = 1;
+    if (leader) {
+        ok = pipelinedBroadcast(dh.get(), base, length, 0, leaders);
+        MPI_CALL(MPI_Comm_free(&leaders));
+        MPI_CALL(MPI_Win_sync(win));
+    }
+
+    // The leader shares the outcome once the data is in place, which also tells the other ranks they can read it
+    MPI_CALL(MPI_Bcast(&ok, 1, MPI_INT, 0, node));
+    MPI_CALL(MPI_Win_sync(win));
+    MPI_CALL(MPI_Comm_free(&node));
+
+    if (!ok) {
+        throw ReadError("broadcastFile: cannot read " + filepath.asString(), Here());
+    }
 
-    return eckit::SharedBuffer(buffer);
+    return buffer;
 }
 
 static CommBuilder<Parallel> ParallelBuilder("parallel");
@@ -114,13 +114,32 @@ protected:  // methods
 
     Request iSend(const void* send, size_t count, Data::Code type, int dest, int tag) const override;
 
+    void neighbourAllToAllv(const void* sendbuf, const int sendcounts[], const int sdispls[], void* recvbuf,
+                            const int recvcounts[], const int rdispls[], Data::Code type) const override;
+
+    Request sendInit(const void* send, size_t count, Data::Code type, int dest, int tag) const override;
+
+    Request receiveInit(void* recv, size_t count, Data::Code type, int source, int tag) const override;
+
+    void start(Request&) const override;
+
+    void startAll(std::vector<Request>&) const override;
+
     virtual Status sendReceiveReplace(void* sendrecv, size_t count, Data::Code type,
                                       int dest, int sendtag, int source, int recvtag) const override;
 
     eckit::SharedBuffer broadcastFile(const eckit::PathName& filepath, size_t root) const override;
 
+    std::unique_ptr<NodeSharedBuffer> broadcastFileNodeShared(const eckit::PathName& filepath,
+                                                              size_t root) const override;
+
     Comm& split(int color, const std::string& name) const override;
 
+    Comm& graph(const std::vector<int>& sources, const std::vector<int>& destinations, const std::string& name,
+                bool reorder) const override;
+
+    void neighbours(std::vector<int>& sources, std::vector<int>& destinations) const override;
+
     void free() override;
 
     void print(std::ostream&) const override;
@@ -26,6 +26,16 @@ ParallelRequest::ParallelRequest() {}
 ParallelRequest::ParallelRequest(MPI_Request request) :
     request_(request) {}
 
+ParallelRequest::~ParallelRequest() {
+    if (persistent_ && request_ != MPI_REQUEST_NULL) {
+        int finalized = 1;
+        MPI_Finalized(&finalized);
+        if (!finalized) {
+            MPI_Request_free(&request_);
+        }
+    }
+}
+
 void ParallelRequest::print(std::ostream& os) const {
     os << "ParallelRequest("
        << ")";
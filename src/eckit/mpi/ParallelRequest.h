@@ -31,6 +31,9 @@ private:  // constructor
     ParallelRequest();
     ParallelRequest(MPI_Request);
 
+public:  // destructor
+    ~ParallelRequest() override;
+
 private:  // methods
     void print(std::ostream&) const override;
 
@@ -42,6 +45,7 @@ private:  // members
     friend class Parallel;
 
     MPI_Request request_;
+    bool persistent_ = false;  ///< persistent requests are freed with the last reference to them
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -52,6 +52,8 @@ public:
         return registerRequest(request);
     }
 
+    Request createPersistentRequest(SerialRequest* request) { return registerRequest(request); }
+
     Request operator[](int request) { return requests_[request]; }
 
     SendRequest& matchingSendRequest(const ReceiveRequest& req) { return matchingSendRequest(req.tag()); }
@@ -177,6 +179,33 @@ Comm& Serial::split(int /*color*/, const std::string& name) const {
     return *newcomm;
 }
 
+Comm& Serial::graph(const std::vector<int>& sources, const std::vector<int>& destinations, const std::string& name,
+                    bool) const {
+    if (hasComm(name.c_str())) {
+        throw SeriousBug("Communicator with name " + name + " already exists");
+    }
+    for (int r : sources) {
+        ASSERT(r == 0);
+    }
+    for (int r : destinations) {
+        ASSERT(r == 0);
+    }
+    Serial* newcomm        = new Serial(name);
+    newcomm->graph_        = true;
+    newcomm->sources_      = sources;
+    newcomm->destinations_ = destinations;
+    addComm(name.c_str(), newcomm);
+    return *newcomm;
+}
+
+void Serial::neighbours(std::vector<int>& sources, std::vector<int>& destinations) const {
+    if (!graph_) {
+        throw SeriousBug("Communicator " + name() + " does not have a graph topology", Here());
+    }
+    sources      = sources_;
+    destinations = destinations_;
+}
+
 void Serial::free() {
     // nothing todo
 }
@@ -444,6 +473,56 @@ Request Serial::iSend(const void* send, size_t count, Data::Code type, int /*des
     return SerialRequestPool::instance().createSendRequest(send, count, type, tag);
 }
 
+void Serial::neighbourAllToAllv(const void* sendbuf, const int sendcounts[], const int sdispls[], void* recvbuf,
+                                const int recvcounts[], const int rdispls[], Data::Code type) const {
+    if (!graph_) {
+        throw SeriousBug("Communicator " + name() + " does not have a graph topology", Here());
+    }
+
+    // All the neighbours are this rank: the n-th block sent is the n-th block received
+    ASSERT(sources_.size() == destinations_.size());
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        ASSERT(sendcounts[i] == recvcounts[i]);
+        if (sendcounts[i] > 0) {
+            memcpy(static_cast<char*>(recvbuf) + size_t(rdispls[i]) * dataSize[type],
+                   static_cast<const char*>(sendbuf) + size_t(sdispls[i]) * dataSize[type],
+                   size_t(sendcounts[i]) * dataSize[type]);
+        }
+    }
+}
+
+Request Serial::sendInit(const void* send, size_t count, Data::Code type, int /*dest*/, int tag) const {
+    AutoLock<SerialRequestPool> lock(SerialRequestPool::instance());
+    return SerialRequestPool::instance().createPersistentRequest(new PersistentSendRequest(send, count, type, tag));
+}
+
+Request Serial::receiveInit(void* recv, size_t count, Data::Code type, int /*source*/, int tag) const {
+    AutoLock<SerialRequestPool> lock(SerialRequestPool::instance());
+    return SerialRequestPool::instance().createPersistentRequest(new PersistentReceiveRequest(recv, count, type, tag));
+}
+
+void Serial::start(Request& req) const {
+    AutoLock<SerialRequestPool> lock(SerialRequestPool::instance());
+
+    auto& serialRequest = req.as<SerialRequest>();
+    ASSERT(serialRequest.handled());  // not already active
+
+    if (auto* send = dynamic_cast<PersistentSendRequest*>(&serialRequest)) {
+        // The data is copied, so the send is complete
+        SerialRequestPool::instance().createSendRequest(send->buffer(), send->count(), send->type(), send->tag());
+        return;
+    }
+
+    ASSERT(dynamic_cast<PersistentReceiveRequest*>(&serialRequest));
+    serialRequest.handled(false);
+}
+
+void Serial::startAll(std::vector<Request>& requests) const {
+    for (auto& req : requests) {
+        start(req);
+    }
+}
+
 Status Serial::createStatus() {
     return Status(new SerialStatus());
 }
@@ -114,11 +114,27 @@ protected:  // methods
 
     Request iSend(const void* send, size_t count, Data::Code type, int dest, int tag) const override;
 
+    void neighbourAllToAllv(const void* sendbuf, const int sendcounts[], const int sdispls[], void* recvbuf,
+                            const int recvcounts[], const int rdispls[], Data::Code type) const override;
+
+    Request sendInit(const void* send, size_t count, Data::Code type, int dest, int tag) const override;
+
+    Request receiveInit(void* recv, size_t count, Data::Code type, int source, int tag) const override;
+
+    void start(Request&) const override;
+
+    void startAll(std::vector<Request>&) const override;
+
     virtual Status sendReceiveReplace(void* sendrecv, size_t count, Data::Code type,
                                       int dest, int sendtag, int source, int recvtag) const override;
 
     Comm& split(int color, const std::string& name) const override;
 
+    Comm& graph(const std::vector<int>& sources, const std::vector<int>& destinations, const std::string& name,
+                bool reorder) const override;
+
+    void neighbours(std::vector<int>& sources, std::vector<int>& destinations) const override;
+
     void free() override;
 
     eckit::SharedBuffer broadcastFile(const eckit::PathName& filepath, size_t root) const override;
@@ -148,6 +164,12 @@ protected:  // methods
     static Status createStatus();
 
     int communicator() const override;
+
+private:  // members
+    // Neighbours, for a graph communicator
+    bool graph_ = false;
+    std::vector<int> sources_;
+    std::vector<int> destinations_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -46,4 +46,20 @@ ReceiveRequest::ReceiveRequest(void* buffer, size_t count, Data::Code type, int
 
 //----------------------------------------------------------------------------------------------------------------------
 
+PersistentSendRequest::PersistentSendRequest(const void* buffer, size_t count, Data::Code type, int tag) :
+    buffer_(buffer), count_(count), tag_(tag), type_(type) {
+    // Inactive until started
+    handled(true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PersistentReceiveRequest::PersistentReceiveRequest(void* buffer, size_t count, Data::Code type, int tag) :
+    ReceiveRequest(buffer, count, type, tag) {
+    // Inactive until started
+    handled(true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::mpi
@@ -37,12 +37,13 @@ public:  // methods
 
     bool test() override { return true; }
 
-private:  // methods
-    void print(std::ostream&) const override;
-
+protected:  // methods
     bool handled() const { return handled_; }
     void handled(bool v) { handled_ = v; }
 
+private:  // methods
+    void print(std::ostream&) const override;
+
 private:  // members
     friend class SerialRequestPool;
     friend class Serial;
@@ -105,6 +106,42 @@ private:
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Persistent send, each start() posts a SendRequest with the current contents of the buffer
+
+class PersistentSendRequest : public SerialRequest {
+
+public:  // methods
+    PersistentSendRequest(const void* buffer, size_t count, Data::Code type, int tag);
+
+    bool isReceive() const override { return false; }
+
+    const void* buffer() const { return buffer_; }
+
+    size_t count() const { return count_; }
+
+    int tag() const override { return tag_; }
+
+    Data::Code type() const { return type_; }
+
+private:
+    const void* buffer_;
+    size_t count_;
+    int tag_;
+    Data::Code type_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Persistent receive, each start() makes it match the next send when waited for
+
+class PersistentReceiveRequest : public ReceiveRequest {
+
+public:  // methods
+    PersistentReceiveRequest(void* buffer, size_t count, Data::Code type, int tag);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::mpi
 
 #endif
@@ -99,6 +99,7 @@ public:  // methods
     void closeInput();
 
     void debug(bool on);
+    bool debug() const { return debug_; }
 
 public:  // class methods
     static std::string addrToHost(in_addr);
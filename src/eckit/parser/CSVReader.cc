@@ -0,0 +1,556 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/parser/CSVReader.h"
+#include "eckit/parser/StreamParser.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Smallest part of a block given to a thread
+const size_t minChunk = 64 * 1024;
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+double toReal(std::string_view field, size_t line) {
+    std::string_view s = trim(field);
+    if (s.empty()) {
+        return CSVReader::Column::missingReal;
+    }
+
+    // strtod needs a terminated string
+    char buffer[64];
+    std::string copy;
+    const char* str = buffer;
+    if (s.size() < sizeof(buffer)) {
+        ::memcpy(buffer, s.data(), s.size());
+        buffer[s.size()] = 0;
+    }
+    else {
+        copy = s;
+        str  = copy.c_str();
+    }
+
+    char* end;
+    double d = ::strtod(str, &end);
+    if (end != str + s.size()) {
+        throw StreamParser::Error("CSVReader: invalid real '" + std::string(field) + "'", line);
+    }
+    return d;
+}
+
+long toInteger(std::string_view field, size_t line) {
+    std::string_view s = trim(field);
+    if (s.empty()) {
+        return CSVReader::Column::missingInteger;
+    }
+    if (s.size() > 1 && s.front() == '+') {
+        s.remove_prefix(1);
+    }
+
+    long l;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), l);
+    if (ec != std::errc() || end != s.data() + s.size()) {
+        throw StreamParser::Error("CSVReader: invalid integer '" + std::string(field) + "'", line);
+    }
+    return l;
+}
+
+/// Start of the last line in [begin, end) that ends, or null
+const char* afterLastLine(const char* begin, const char* end) {
+    for (const char* p = end; p != begin; --p) {
+        if (p[-1] == '\n') {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<std::istream> openFile(const PathName& path) {
+    std::unique_ptr<std::istream> in(new std::ifstream(path.asString().c_str(), std::ios::binary));
+    if (!*in) {
+        throw CantOpenFile(path);
+    }
+    return in;
+}
+
+struct Field {
+    const char* begin;  ///< or null, if unescaped into the scratch string
+    size_t offset;
+    size_t length;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CSVReader::Column::Column(const std::string& name, Type type) :
+    name_(name), index_(size_t(-1)), type_(type) {}
+
+CSVReader::Column::Column(size_t index, Type type) :
+    index_(index), type_(type) {}
+
+size_t CSVReader::Column::size() const {
+    switch (type_) {
+        case REAL:
+            return reals_.size();
+        case INTEGER:
+            return integers_.size();
+        case STRING:
+            return strings_.size();
+    }
+    NOTIMP;
+}
+
+CSVReader::Column CSVReader::Column::layout() const {
+    Column c(index_, type_);
+    c.name_ = name_;
+    return c;
+}
+
+void CSVReader::Column::add(std::string_view field, size_t line) {
+    switch (type_) {
+        case REAL:
+            reals_.push_back(toReal(field, line));
+            break;
+        case INTEGER:
+            integers_.push_back(toInteger(field, line));
+            break;
+        case STRING:
+            strings_.emplace_back(field);
+            break;
+    }
+}
+
+void CSVReader::Column::append(Column& other) {
+    ASSERT(type_ == other.type_);
+    reals_.insert(reals_.end(), other.reals_.begin(), other.reals_.end());
+    integers_.insert(integers_.end(), other.integers_.begin(), other.integers_.end());
+    strings_.insert(strings_.end(), std::make_move_iterator(other.strings_.begin()),
+                    std::make_move_iterator(other.strings_.end()));
+    other.reals_.clear();
+    other.integers_.clear();
+    other.strings_.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CSVReader::CSVReader(std::istream& in, bool hasHeader, char delimiter) :
+    in_(in),
+    hasHeader_(hasHeader),
+    headerRead_(false),
+    delimiter_(delimiter),
+    threads_(Resource<size_t>("csvReaderThreads;$ECKIT_CSV_READER_THREADS", 1)),
+    bufferSize_(Resource<size_t>("csvReaderBufferSize;$ECKIT_CSV_READER_BUFFER_SIZE", 4 * 1024 * 1024)),
+    begin_(0),
+    end_(0),
+    eof_(false),
+    line_(1) {
+    ASSERT(delimiter_ != '"' && delimiter_ != '\n' && delimiter_ != '\r');
+}
+
+CSVReader::CSVReader(const PathName& path, bool hasHeader, char delimiter) :
+    file_(openFile(path)),
+    in_(*file_),
+    hasHeader_(hasHeader),
+    headerRead_(false),
+    delimiter_(delimiter),
+    threads_(Resource<size_t>("csvReaderThreads;$ECKIT_CSV_READER_THREADS", 1)),
+    bufferSize_(Resource<size_t>("csvReaderBufferSize;$ECKIT_CSV_READER_BUFFER_SIZE", 4 * 1024 * 1024)),
+    begin_(0),
+    end_(0),
+    eof_(false),
+    line_(1) {
+    ASSERT(delimiter_ != '"' && delimiter_ != '\n' && delimiter_ != '\r');
+}
+
+CSVReader::~CSVReader() {}
+
+const std::vector<std::string>& CSVReader::header() {
+    if (hasHeader_ && !headerRead_) {
+        const char* begin;
+        const char* end;
+        size_t rows = 0;
+        while (rows == 0 && next(begin, end)) {
+            const char* p = parse(
+                begin, end, eof_, line_,
+                [this, &rows](const Row& row) {
+                    for (size_t i = 0; i < row.size(); ++i) {
+                        header_.emplace_back(trim(row[i]));
+                    }
+                    rows++;
+                },
+                1);
+            consumed(p, begin);
+        }
+        headerRead_ = true;
+    }
+    return header_;
+}
+
+size_t CSVReader::read(const Callback& callback) {
+    header();
+
+    size_t rows = 0;
+    const char* begin;
+    const char* end;
+    while (next(begin, end)) {
+        const char* p = parse(begin, end, eof_, line_, [&callback, &rows](const Row& row) {
+            callback(row);
+            rows++;
+        });
+        consumed(p, begin);
+    }
+    return rows;
+}
+
+size_t CSVReader::read(std::vector<Column>& columns) {
+    header();
+    resolve(columns);
+
+    std::vector<size_t> indices;
+    for (const auto& c : columns) {
+        indices.push_back(c.index_);
+    }
+
+    size_t rows = 0;
+    const char* begin;
+    const char* end;
+    while (next(begin, end)) {
+        if (threads_ > 1 && size_t(end - begin) >= 2 * minChunk && !::memchr(begin, '"', end - begin)) {
+            rows += parseChunks(begin, end, eof_, columns);
+            consumed(end, begin);
+            continue;
+        }
+
+        const char* p = parse(begin, end, eof_, line_, [&columns, &indices, &rows](const Row& row) {
+            addRow(columns, indices, row);
+            rows++;
+        });
+        consumed(p, begin);
+    }
+    return rows;
+}
+
+void CSVReader::resolve(std::vector<Column>& columns) {
+    for (auto& c : columns) {
+        if (c.index_ != size_t(-1)) {
+            if (c.name_.empty() && c.index_ < header_.size()) {
+                c.name_ = header_[c.index_];
+            }
+            continue;
+        }
+
+        if (!hasHeader_) {
+            throw UserError("CSVReader: column '" + c.name_ + "' of a file without a header");
+        }
+
+        auto j = std::find(header_.begin(), header_.end(), c.name_);
+        if (j == header_.end()) {
+            throw UserError("CSVReader: no column '" + c.name_ + "' in the header");
+        }
+        c.index_ = j - header_.begin();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CSVReader::addRow(std::vector<Column>& columns, const std::vector<size_t>& indices, const Row& row) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (indices[i] >= row.size()) {
+            throw StreamParser::Error("CSVReader: " + std::to_string(row.size()) + " fields, expected at least " +
+                                          std::to_string(indices[i] + 1),
+                                      row.line());
+        }
+        columns[i].add(row[indices[i]], row.line());
+    }
+}
+
+void CSVReader::fill() {
+    if (buffer_.empty()) {
+        buffer_.resize(bufferSize_ * std::max<size_t>(1, threads_));
+    }
+
+    if (begin_ != 0) {
+        ::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+
+    // A row longer than the buffer
+    if (end_ == buffer_.size()) {
+        buffer_.resize(2 * buffer_.size());
+    }
+
+    in_.read(buffer_.data() + end_, buffer_.size() - end_);
+    end_ += in_.gcount();
+
+    if (in_.bad()) {
+        throw ReadError("CSVReader");
+    }
+    eof_ = in_.eof();
+}
+
+bool CSVReader::next(const char*& begin, const char*& end) {
+    for (;;) {
+        if (begin_ != end_) {
+            begin = buffer_.data() + begin_;
+            end   = eof_ ? buffer_.data() + end_ : afterLastLine(begin, buffer_.data() + end_);
+            if (end) {
+                return true;
+            }
+        }
+        else if (eof_) {
+            return false;
+        }
+        fill();
+    }
+}
+
+void CSVReader::consumed(const char* p, const char* begin) {
+    if (p == begin) {
+        // A row goes on past the data read
+        fill();
+        return;
+    }
+    begin_ = p - buffer_.data();
+}
+
+const char* CSVReader::parse(const char* begin, const char* end, bool last, size_t& line, const Callback& callback,
+                             size_t limit) const {
+    Row row;
+    std::vector<Field> fields;
+    std::string scratch;
+
+#if defined(__SSE2__)
+    const __m128i delimiter = _mm_set1_epi8(delimiter_);
+    const __m128i lf        = _mm_set1_epi8('\n');
+    const __m128i cr        = _mm_set1_epi8('\r');
+#endif
+
+    const char* p = begin;
+    size_t rows   = 0;
+
+    while (p != end && rows < limit) {
+        if (*p == '\n') {
+            line++;
+            p++;
+            continue;
+        }
+        if (*p == '\r') {
+            p++;
+            continue;
+        }
+
+        const char* start = p;
+        size_t startLine  = line;
+
+        fields.clear();
+        scratch.clear();
+
+        for (;;) {
+            if (p != end && *p == '"') {
+                size_t offset = scratch.size();
+                const char* q = p + 1;
+                bool closed   = false;
+                for (;;) {
+                    const char* r = static_cast<const char*>(::memchr(q, '"', end - q));
+                    if (!r || (r + 1 == end && !last)) {
+                        break;
+                    }
+                    line += std::count(q, r, '\n');
+                    scratch.append(q, r);
+                    if (r + 1 != end && r[1] == '"') {
+                        scratch.push_back('"');
+                        q = r + 2;
+                        continue;
+                    }
+                    q      = r + 1;
+                    closed = true;
+                    break;
+                }
+
+                if (!closed) {
+                    if (last) {
+                        throw StreamParser::Error("CSVReader: unterminated quoted field", startLine);
+                    }
+                    line = startLine;
+                    return start;
+                }
+
+                fields.push_back({nullptr, offset, scratch.size() - offset});
+                p = q;
+
+                if (p != end && *p != delimiter_ && *p != '\n' && *p != '\r') {
+                    throw StreamParser::Error("CSVReader: unexpected character after a quoted field", line);
+                }
+            }
+            else {
+                const char* q = p;
+#if defined(__SSE2__)
+                while (end - q >= 16) {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+                    int mask  = _mm_movemask_epi8(_mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(x, delimiter), _mm_cmpeq_epi8(x, lf)), _mm_cmpeq_epi8(x, cr)));
+                    if (mask) {
+                        q += __builtin_ctz(mask);
+                        break;
+                    }
+                    q += 16;
+                }
+#endif
+                while (q != end && *q != delimiter_ && *q != '\n' && *q != '\r') {
+                    q++;
+                }
+                fields.push_back({p, 0, size_t(q - p)});
+                p = q;
+            }
+
+            if (p == end) {
+                if (!last) {
+                    line = startLine;
+                    return start;
+                }
+                break;
+            }
+
+            if (*p == delimiter_) {
+                p++;
+                continue;
+            }
+
+            // End of the row, a following '\n' of "\r\n" is skipped as a blank line
+            if (*p == '\n') {
+                line++;
+            }
+            p++;
+            break;
+        }
+
+        row.fields_.clear();
+        for (const auto& f : fields) {
+            row.fields_.emplace_back(f.begin ? f.begin : scratch.data() + f.offset, f.length);
+        }
+        row.line_ = startLine;
+
+        callback(row);
+        rows++;
+    }
+
+    return p;
+}
+
+size_t CSVReader::parseChunks(const char* begin, const char* end, bool last, std::vector<Column>& columns) {
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<Column> columns;
+        size_t rows  = 0;
+        size_t lines = 0;
+        std::exception_ptr error;
+    };
+
+    // Chunks of whole lines
+
+    const size_t n = std::min<size_t>(threads_, (end - begin) / minChunk);
+    std::vector<Chunk> chunks;
+    const char* p = begin;
+    for (size_t i = 1; i <= n && p != end; ++i) {
+        const char* q = (i == n) ? end : begin + (end - begin) * i / n;
+        if (q < p) {
+            continue;
+        }
+        if (q != end) {
+            q = static_cast<const char*>(::memchr(q, '\n', end - q));
+            q = q ? q + 1 : end;
+        }
+        chunks.push_back(Chunk{p, q, {}, 0, 0, nullptr});
+        p = q;
+    }
+
+    std::vector<size_t> indices;
+    for (const auto& c : columns) {
+        indices.push_back(c.index_);
+    }
+
+    auto work = [this, &chunks, &columns, &indices, last](size_t i) {
+        Chunk& chunk(chunks[i]);
+        try {
+            for (const auto& c : columns) {
+                chunk.columns.push_back(c.layout());
+            }
+            parse(chunk.begin, chunk.end, last && chunk.end == chunks.back().end, chunk.lines,
+                  [&chunk, &indices](const Row& row) {
+                      addRow(chunk.columns, indices, row);
+                      chunk.rows++;
+                  });
+        }
+        catch (...) {
+            chunk.error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    size_t rows = 0;
+    for (auto& chunk : chunks) {
+        if (chunk.error) {
+            // Parsed again from the line where the chunk starts, to report errors at their line in the input
+            parse(chunk.begin, chunk.end, last && chunk.end == end, line_,
+                  [&columns, &indices](const Row& row) { addRow(columns, indices, row); });
+            std::rethrow_exception(chunk.error);
+        }
+
+        for (size_t j = 0; j < columns.size(); ++j) {
+            columns[j].append(chunk.columns[j]);
+        }
+        rows += chunk.rows;
+        line_ += chunk.lines;
+    }
+    return rows;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,166 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_CSVReader_h
+#define eckit_CSVReader_h
+
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+class PathName;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Streaming reader of CSV, for files too large to hold as a Value (see CSVParser).
+///
+/// The input is read in large blocks, which are scanned for delimiters and ends of lines 16 bytes at a time where
+/// SSE2 is available. Rows are either given to a callback, as views of their fields, or appended to typed columns.
+/// Columns can be parsed by several threads, each taking a part of a block.
+///
+/// Blank lines are skipped. Fields in double quotes may contain delimiters, ends of lines and doubled quotes.
+
+class CSVReader : private NonCopyable {
+public:  // types
+    /// Fields of a row, valid during the callback
+    class Row {
+    public:
+        size_t size() const { return fields_.size(); }
+        std::string_view operator[](size_t i) const { return fields_[i]; }
+
+        /// Line of the input where the row starts, from 1
+        size_t line() const { return line_; }
+
+    private:
+        std::vector<std::string_view> fields_;
+        size_t line_ = 0;
+
+        friend class CSVReader;
+    };
+
+    using Callback = std::function<void(const Row&)>;
+
+    /// Values of a field of every row, converted to a type
+    class Column {
+    public:
+        enum Type
+        {
+            REAL,
+            INTEGER,
+            STRING
+        };
+
+        /// Empty fields of numeric columns
+        static constexpr long missingInteger = std::numeric_limits<long>::min();
+        static constexpr double missingReal  = std::numeric_limits<double>::quiet_NaN();
+
+        /// A column given by its name in the header
+        Column(const std::string& name, Type);
+
+        /// A column given by its position, from 0
+        Column(size_t index, Type);
+
+        const std::string& name() const { return name_; }
+        Type type() const { return type_; }
+        size_t size() const;
+
+        const std::vector<double>& reals() const { return reals_; }
+        const std::vector<long>& integers() const { return integers_; }
+        const std::vector<std::string>& strings() const { return strings_; }
+
+    private:
+        /// A column of the same field and type, without values
+        Column layout() const;
+
+        void add(std::string_view, size_t line);
+        void append(Column&);
+
+        std::string name_;
+        size_t index_;
+        Type type_;
+
+        std::vector<double> reals_;
+        std::vector<long> integers_;
+        std::vector<std::string> strings_;
+
+        friend class CSVReader;
+    };
+
+public:  // methods
+    CSVReader(std::istream&, bool hasHeader, char delimiter = ',');
+    CSVReader(const PathName&, bool hasHeader, char delimiter = ',');
+    ~CSVReader();
+
+    /// Names of the fields of the first line, if the input has a header
+    const std::vector<std::string>& header();
+
+    /// Threads that parse blocks into columns
+    void threads(size_t n) { threads_ = n; }
+
+    /// Gives the rows that are left to the callback, in order
+    /// @returns the number of rows
+    size_t read(const Callback&);
+
+    /// Appends the rows that are left to the columns
+    /// @returns the number of rows
+    size_t read(std::vector<Column>&);
+
+private:  // methods
+    bool next(const char*& begin, const char*& end);
+    void consumed(const char* begin, const char* end);
+    void fill();
+    void resolve(std::vector<Column>&);
+
+    /// Parses the rows in [begin, end), up to limit rows. Unless the data is the last, a row that may go on past the
+    /// end is left.
+    /// @returns the end of the rows parsed
+    const char* parse(const char* begin, const char* end, bool last, size_t& line, const Callback&,
+                      size_t limit = size_t(-1)) const;
+
+    /// Parses the rows in [begin, end), without quotes, into the columns, splitting them between threads
+    /// @returns the number of rows
+    size_t parseChunks(const char* begin, const char* end, bool last, std::vector<Column>&);
+
+    /// Adds the fields of a row at the indices to the columns
+    static void addRow(std::vector<Column>&, const std::vector<size_t>& indices, const Row&);
+
+private:  // members
+    std::unique_ptr<std::istream> file_;
+    std::istream& in_;
+    bool hasHeader_;
+    bool headerRead_;
+    char delimiter_;
+    size_t threads_;
+    size_t bufferSize_;
+
+    std::vector<char> buffer_;
+    size_t begin_;  ///< of what is left to parse in the buffer
+    size_t end_;    ///< of the data in the buffer
+    bool eof_;
+    size_t line_;  ///< at begin_
+
+    std::vector<std::string> header_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
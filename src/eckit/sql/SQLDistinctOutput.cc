@@ -8,6 +8,11 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
 #include "eckit/sql/SQLDistinctOutput.h"
 #include "eckit/sql/SQLSelect.h"
 #include "eckit/sql/expression/SQLExpressions.h"
@@ -16,8 +21,84 @@ namespace eckit::sql {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+const size_t partitionCount = 16;
+const size_t maxDepth       = 8;  ///< of re-partitioning, beyond which partitions are deduplicated whatever their size
+
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb3fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/// Hash of a row that does not depend on the widths of the layout, trailing zero words of a value are skipped
+uint64_t hashRow(const std::vector<size_t>& widths, const double* row) {
+    const uint64_t flag = 0x9e3779b97f4a7c15ULL;  // marks the missing flag, wherever the width puts it
+
+    uint64_t h = 0;
+    for (size_t width : widths) {
+        size_t used = width;
+        uint64_t word;
+        while (used > 0 && (std::memcpy(&word, &row[used - 1], sizeof(word)), word == 0)) {
+            --used;
+        }
+        for (size_t i = 0; i < used; ++i) {
+            std::memcpy(&word, &row[i], sizeof(word));
+            h = mix(h ^ word) + i;
+        }
+        std::memcpy(&word, &row[width], sizeof(word));
+        h = mix(h ^ word) + flag;
+        row += width + 1;
+    }
+    return h;
+}
+
+/// Each level of partitioning takes the next bits down from the top, the table uses the low bits
+size_t partition(uint64_t hash, size_t depth = 0) {
+    return (hash >> (60 - 4 * depth)) & (partitionCount - 1);
+}
+
+/// Merges files of records that are each in order of their sequence numbers
+std::unique_ptr<SQLSpillFile> merge(std::vector<std::unique_ptr<SQLSpillFile>>& files, size_t recordSize) {
+    std::unique_ptr<SQLSpillFile> out(new SQLSpillFile(recordSize));
+
+    std::vector<const char*> heads;
+    for (auto& f : files) {
+        f->rewind();
+        heads.push_back(f->next());
+    }
+
+    for (;;) {
+        size_t first    = files.size();
+        uint64_t lowest = 0;
+        for (size_t i = 0; i < files.size(); ++i) {
+            uint64_t s;
+            if (heads[i] && (std::memcpy(&s, heads[i], sizeof(s)), first == files.size() || s < lowest)) {
+                first  = i;
+                lowest = s;
+            }
+        }
+        if (first == files.size()) {
+            break;
+        }
+        out->write(heads[first]);
+        heads[first] = files[first]->next();
+    }
+
+    files.clear();
+    return out;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 SQLDistinctOutput::SQLDistinctOutput(SQLOutput& output) :
-    output_(output) {}
+    output_(output), memory_(Resource<size_t>("sqlDistinctMemory;$ECKIT_SQL_DISTINCT_MEMORY", 512 * 1024 * 1024)) {}
 
 SQLDistinctOutput::~SQLDistinctOutput() {}
 
@@ -25,71 +106,240 @@ void SQLDistinctOutput::print(std::ostream& s) const {
     s << "SQLDistinctOutput[" << output_ << "]";
 }
 
+void SQLDistinctOutput::clear() {
+    format_.clear();
+    row_.clear();
+    seen_.reset();
+    spills_.clear();
+    sequence_ = 0;
+    merging_  = false;
+    partitions_.clear();
+    heads_.clear();
+    heap_.clear();
+}
+
 void SQLDistinctOutput::reset() {
     output_.reset();
-    seen_.clear();
+    clear();
 }
 
 void SQLDistinctOutput::flush() {
     output_.flush();
 }
 
-bool SQLDistinctOutput::cachedNext() {
-    return output_.cachedNext();
-}
-
 unsigned long long SQLDistinctOutput::count() {
     return output_.count();
 }
 
+void SQLDistinctOutput::rebuild(const std::vector<size_t>& widths) {
+    std::unique_ptr<SQLRowSet> seen(new SQLRowSet(format_.words() * sizeof(double)));
+    if (seen_) {
+        std::vector<double> row(format_.words());
+        for (size_t i = 0; i < seen_->size(); ++i) {
+            format_.widen(widths, seen_->row(i), row.data());
+            seen->insert(row.data(), seen_->hash(i));
+        }
+    }
+    seen_.swap(seen);
+    row_.resize(format_.words());
+}
+
+void SQLDistinctOutput::spill(uint64_t hash) {
+    if (spills_.empty() || spills_.back().widths != format_.widths()) {
+        LOG_DEBUG_LIB(LibEcKit) << "SQLDistinctOutput: spilling beyond " << seen_->size() << " rows" << std::endl;
+
+        SpillSet set{format_.widths(), {}};
+        for (size_t p = 0; p < partitionCount; ++p) {
+            set.partitions.emplace_back(new SQLSpillFile(sizeof(uint64_t) + format_.words() * sizeof(double)));
+        }
+        spills_.emplace_back(std::move(set));
+    }
+
+    std::vector<char> record(sizeof(uint64_t) + row_.size() * sizeof(double));
+    std::memcpy(record.data(), &sequence_, sizeof(uint64_t));
+    std::memcpy(record.data() + sizeof(uint64_t), row_.data(), row_.size() * sizeof(double));
+    spills_.back().partitions[partition(hash)]->write(record.data());
+}
+
 bool SQLDistinctOutput::output(const expression::Expressions& results) {
 
-    // Get the data into a temporary buffer we can compare
+    if (!format_.fits(results)) {
+        std::vector<size_t> widths(format_.widths());
+        format_.update(results);
+        rebuild(widths);
+    }
+
+    // Rows are compared with their missing flags, and the unused words of values zeroed
+
+    format_.encode(results, row_.data());
+    uint64_t hash = hashRow(format_.widths(), row_.data());
 
-    ASSERT(results.size() == offsets_.size());
+    sequence_++;
 
-    for (size_t i = 0; i < results.size(); i++) {
-        bool missing = false;
-        results[i]->eval(&tmp_[offsets_[i]], missing);
-        // What do we do with missing? Or has it been already evaluated somewhere before and it doesn't matter???...
+    if (!spills_.empty() || seen_->bytes() >= memory_) {
+        // The table is full: rows it does not hold may be new, or repeat one spilled earlier
+        if (!seen_->contains(row_.data(), hash)) {
+            spill(hash);
+        }
+        return false;
     }
 
-    if (seen_.find(tmp_) == seen_.end()) {
-        seen_.insert(tmp_);
+    if (seen_->insert(row_.data(), hash).second) {
         return output_.output(results);
     }
 
     return false;
 }
 
-void SQLDistinctOutput::preprepare(SQLSelect& sql) {
-    output_.preprepare(sql);
+void SQLDistinctOutput::deduplicate() {
+    for (size_t p = 0; p < partitionCount; ++p) {
+        std::vector<Spilled> inputs;
+        for (auto& set : spills_) {
+            inputs.push_back({set.widths, std::move(set.partitions[p])});
+        }
+
+        std::unique_ptr<SQLSpillFile> out = deduplicate(inputs, 0);
+        out->rewind();
+        partitions_.emplace_back(std::move(out));
+    }
+
+    spills_.clear();
 }
 
-void SQLDistinctOutput::prepare(SQLSelect& sql) {
-    output_.prepare(sql);
-    updateTypes(sql);
-    seen_.clear();
+std::unique_ptr<SQLSpillFile> SQLDistinctOutput::deduplicate(std::vector<Spilled>& inputs, size_t depth) {
+
+    // Keep the first occurrence in each partition, which a row and its repeats all go to
+
+    const size_t recordSize = sizeof(uint64_t) + format_.words() * sizeof(double);
+    std::vector<char> record(recordSize);
+    const double* widened = reinterpret_cast<const double*>(record.data() + sizeof(uint64_t));
+
+    std::vector<std::unique_ptr<SQLSpillFile>> outputs;
+    outputs.emplace_back(new SQLSpillFile(recordSize));
+
+    std::vector<Spilled> partitions(partitionCount);
+
+    {
+        SQLRowSet seen(format_.words() * sizeof(double));
+
+        for (auto& in : inputs) {
+            in.file->rewind();
+            while (const char* r = in.file->next()) {
+                std::vector<double> row((in.file->recordSize() - sizeof(uint64_t)) / sizeof(double));
+                std::memcpy(row.data(), r + sizeof(uint64_t), row.size() * sizeof(double));
+                format_.widen(in.widths, row.data(), reinterpret_cast<double*>(record.data() + sizeof(uint64_t)));
+                std::memcpy(record.data(), r, sizeof(uint64_t));
+
+                uint64_t hash = hashRow(format_.widths(), widened);
+
+                // An empty table takes a row whatever the budget, for the partitions to get smaller
+                if (depth == maxDepth || seen.size() == 0 || seen.bytes() < memory_) {
+                    if (seen.insert(widened, hash).second) {
+                        outputs.front()->write(record.data());
+                    }
+                }
+                else if (!seen.contains(widened, hash)) {
+                    // The table is full again: partition the rows it does not hold on the next bits of the hash
+                    Spilled& sub = partitions[partition(hash, depth + 1)];
+                    if (!sub.file) {
+                        sub.widths = format_.widths();
+                        sub.file.reset(new SQLSpillFile(recordSize));
+                    }
+                    sub.file->write(record.data());
+                }
+            }
+            in.file.reset();
+        }
+
+        if (std::any_of(partitions.begin(), partitions.end(), [](const Spilled& sub) { return bool(sub.file); })) {
+            LOG_DEBUG_LIB(LibEcKit) << "SQLDistinctOutput: partitioning again beyond " << seen.size() << " rows, depth "
+                                    << depth + 1 << std::endl;
+        }
+    }
+
+    // Deduplicated in turn once the table is released, each in order of arrival
+
+    for (auto& sub : partitions) {
+        if (sub.file) {
+            std::vector<Spilled> in;
+            in.emplace_back(std::move(sub));
+            outputs.emplace_back(deduplicate(in, depth + 1));
+        }
+    }
+
+    if (outputs.size() == 1) {
+        return std::move(outputs.front());
+    }
+    return merge(outputs, recordSize);
 }
 
-void SQLDistinctOutput::updateTypes(SQLSelect& sql) {
+bool SQLDistinctOutput::cachedNext() {
 
-    output_.updateTypes(sql);
+    auto later = [this](size_t a, size_t b) {
+        uint64_t sa, sb;
+        std::memcpy(&sa, heads_[a], sizeof(uint64_t));
+        std::memcpy(&sb, heads_[b], sizeof(uint64_t));
+        return sa > sb;
+    };
+
+    if (!spills_.empty()) {
+        merging_ = true;
+        seen_.reset();
+        deduplicate();
 
-    // How much space is needed to store each row of selected data
-    offsets_.clear();
-    size_t offset = 0;
+        heads_.resize(partitions_.size());
+        for (size_t p = 0; p < partitions_.size(); ++p) {
+            if ((heads_[p] = partitions_[p]->next())) {
+                heap_.push_back(p);
+            }
+        }
+        std::make_heap(heap_.begin(), heap_.end(), later);
+    }
+
+    if (merging_) {
+
+        // Partitions are each in order of arrival, merge them on the sequence numbers
+
+        while (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), later);
+            size_t p = heap_.back();
+
+            std::memcpy(row_.data(), heads_[p] + sizeof(uint64_t), row_.size() * sizeof(double));
+            bool success = output_.output(format_.decode(row_.data()));
+
+            if ((heads_[p] = partitions_[p]->next())) {
+                std::push_heap(heap_.begin(), heap_.end(), later);
+            }
+            else {
+                heap_.pop_back();
+            }
 
-    for (const auto& column : sql.output()) {
-        size_t colSizeBytes = column->type()->size();
-        ASSERT(colSizeBytes % 8 == 0);
-        offsets_.push_back(offset);
-        offset += colSizeBytes / 8;
+            if (success) {
+                return true;
+            }
+        }
+
+        clear();
     }
 
-    // And buffers to do the storage
+    return output_.cachedNext();
+}
+
+bool SQLDistinctOutput::evaluatesExpressions() const {
+    return output_.evaluatesExpressions();
+}
 
-    tmp_.resize(offset);
+void SQLDistinctOutput::preprepare(SQLSelect& sql) {
+    output_.preprepare(sql);
+}
+
+void SQLDistinctOutput::prepare(SQLSelect& sql) {
+    output_.prepare(sql);
+    clear();
+}
+
+void SQLDistinctOutput::updateTypes(SQLSelect& sql) {
+    output_.updateTypes(sql);
 }
 
 void SQLDistinctOutput::cleanup(SQLSelect& sql) {
@@ -17,54 +17,75 @@
 #define eckit_sql_SQLDistinctOutput_H
 
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLRowFormat.h"
+#include "eckit/sql/SQLRowSet.h"
+#include "eckit/sql/SQLSpillFile.h"
 
 namespace eckit::sql {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-class SQLDistinctOutput : public SQLOutput {
-
-    // Comparator to ensure that all cases are well defined, even if we are representing non-double
-    // data as doubles
-
-    struct DoubleBitwiseLessComparator {
-        bool operator()(const std::vector<double>& lhs, const std::vector<double>& rhs) const {
-            if (lhs.size() != rhs.size()) {
-                return lhs.size() < rhs.size();
-            }
-            for (int i = 0; i < lhs.size(); ++i) {
-                const void* p1          = &lhs[i];
-                const void* p2          = &rhs[i];
-                const uint64_t& punned1 = *reinterpret_cast<const uint64_t*>(p1);
-                const uint64_t& punned2 = *reinterpret_cast<const uint64_t*>(p2);
-                if (punned1 != punned2) {
-                    return punned1 < punned2;
-                }
-            }
-            return false;
-        }
-    };
+/// Passes on the first occurrence of each row, found in a hash table of rows encoded with SQLRowFormat.
+/// Beyond sqlDistinctMemory bytes, rows not already in the table are spilled to temporary files partitioned by hash.
+/// These are deduplicated one partition at a time when the input ends, and output in the order they arrived.
+/// A partition with more distinct rows than fit in the budget is partitioned again, on the next bits of the hash.
 
+class SQLDistinctOutput : public SQLOutput {
 public:  // methods
     SQLDistinctOutput(SQLOutput& output);
     ~SQLDistinctOutput() override;
 
+private:  // types
+    struct SpillSet {
+        std::vector<size_t> widths;
+        std::vector<std::unique_ptr<SQLSpillFile>> partitions;
+    };
+
+    struct Spilled {
+        std::vector<size_t> widths;
+        std::unique_ptr<SQLSpillFile> file;
+    };
+
 private:  // methods
     void print(std::ostream&) const override;
 
+    void rebuild(const std::vector<size_t>& widths);
+    void spill(uint64_t hash);
+    void deduplicate();
+    std::unique_ptr<SQLSpillFile> deduplicate(std::vector<Spilled>& inputs, size_t depth);
+    void clear();
+
     // -- Members
 
     SQLOutput& output_;
-    std::set<std::vector<double>, DoubleBitwiseLessComparator> seen_;
-    std::vector<double> tmp_;
-    std::vector<size_t> offsets_;
+
+    SQLRowFormat format_;
+    std::vector<double> row_;
+    std::unique_ptr<SQLRowSet> seen_;
+
+    // Spilled rows: a set of partitions for each layout, records are a sequence number then a row
+    std::vector<SpillSet> spills_;
+    uint64_t sequence_ = 0;
+
+    // Deduplicated spilled rows, merged back in order of arrival
+    bool merging_ = false;
+    std::vector<std::unique_ptr<SQLSpillFile>> partitions_;
+    std::vector<const char*> heads_;
+    std::vector<size_t> heap_;  ///< of partitions_
+
+    size_t memory_;
 
     // -- Overridden methods
     void reset() override;
     void flush() override;
     bool cachedNext() override;
     bool output(const expression::Expressions&) override;
+    bool evaluatesExpressions() const override;
     void preprepare(SQLSelect&) override;
     void prepare(SQLSelect&) override;
     void updateTypes(SQLSelect&) override;
@@ -0,0 +1,382 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLHashAggregation.h"
+#include "eckit/sql/expression/SQLExpressionEvaluated.h"
+#include "eckit/sql/expression/function/FunctionAVG.h"
+#include "eckit/sql/expression/function/FunctionCOUNT.h"
+#include "eckit/sql/expression/function/FunctionMAX.h"
+#include "eckit/sql/expression/function/FunctionMIN.h"
+#include "eckit/sql/expression/function/FunctionRMS.h"
+#include "eckit/sql/expression/function/FunctionSTDEV.h"
+#include "eckit/sql/expression/function/FunctionSUM.h"
+#include "eckit/sql/expression/function/FunctionVAR.h"
+#include "eckit/sql/type/SQLType.h"
+
+using namespace eckit::sql::expression;
+using namespace eckit::sql::expression::function;
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLHashAggregation::SQLHashAggregation(const Expressions& groupBy, const Expressions& aggregated) :
+    groupBy_(groupBy), key_(std::vector<bool>()) {
+
+    for (const auto& e : groupBy_) {
+        groupByValues_.push_back(e.get());
+    }
+
+    for (const auto& e : aggregated) {
+        Aggregate a;
+        a.expression = e;
+        a.statistic  = EXPRESSION;
+
+        // STDEV before VAR, which it derives from
+        auto* f = dynamic_cast<FunctionExpression*>(e.get());
+        if (f && f->args().size() == 1 && !f->args()[0]->isAggregate()) {
+            a.argument = f->args()[0].get();
+            if (dynamic_cast<FunctionCOUNT*>(f)) {
+                a.statistic = COUNT;
+            }
+            else if (dynamic_cast<FunctionSUM*>(f)) {
+                a.statistic = SUM;
+            }
+            else if (dynamic_cast<FunctionAVG*>(f)) {
+                a.statistic = AVG;
+            }
+            else if (dynamic_cast<FunctionSTDEV*>(f)) {
+                a.statistic = STDEV;
+            }
+            else if (dynamic_cast<FunctionVAR*>(f)) {
+                a.statistic = VAR;
+            }
+            else if (dynamic_cast<FunctionRMS*>(f)) {
+                a.statistic = RMS;
+            }
+            else if (a.argument->type()->size() == sizeof(double)) {
+                // The result has the type of the argument, a single word
+                if (dynamic_cast<FunctionMIN*>(f)) {
+                    a.statistic = MIN;
+                }
+                else if (dynamic_cast<FunctionMAX*>(f)) {
+                    a.statistic = MAX;
+                }
+            }
+        }
+        if (a.statistic == EXPRESSION) {
+            a.argument = nullptr;
+        }
+
+        aggregates_.emplace_back(std::move(a));
+    }
+}
+
+SQLHashAggregation::~SQLHashAggregation() {}
+
+void SQLHashAggregation::clear() {
+    key_.clear();
+    format_.clear();
+    groups_.reset();
+    rows_.clear();
+    order_.clear();
+    for (auto& a : aggregates_) {
+        a.count.clear();
+        a.sum.clear();
+        a.squares.clear();
+        a.value.clear();
+        a.clones.clear();
+        a.result.reset();
+    }
+}
+
+bool SQLHashAggregation::mergeable() const {
+    return std::none_of(aggregates_.begin(), aggregates_.end(),
+                        [](const Aggregate& a) { return a.statistic == EXPRESSION; });
+}
+
+void SQLHashAggregation::layout(const SQLSortKey::Values& keyValues, const Expressions& rowValues) {
+    std::vector<size_t> keyWidths(key_.widths());
+    std::vector<size_t> rowWidths(format_.widths());
+    const size_t words = format_.words();
+
+    key_.update(keyValues);
+    format_.update(rowValues);
+
+    keyBuffer_.resize(key_.size());
+    rowBuffer_.resize(format_.words());
+
+    // Wider strings: the keys are widened and hashed again, and the rows widened
+
+    std::unique_ptr<SQLRowSet> groups(new SQLRowSet(key_.size()));
+    std::vector<double> rows(size() * format_.words());
+
+    for (size_t g = 0; g < size(); ++g) {
+        key_.widen(keyWidths, reinterpret_cast<const unsigned char*>(groups_->row(g)), keyBuffer_.data());
+        groups->insert(keyBuffer_.data(), SQLRowSet::hash(keyBuffer_.data(), key_.size()));
+        format_.widen(rowWidths, &rows_[g * words], &rows[g * format_.words()]);
+    }
+
+    groups_.swap(groups);
+    rows_.swap(rows);
+}
+
+void SQLHashAggregation::addGroup(const double* row) {
+    rows_.insert(rows_.end(), row, row + format_.words());
+
+    for (auto& a : aggregates_) {
+        switch (a.statistic) {
+            case VAR:
+            case STDEV:
+                a.squares.push_back(0);
+                // fall through
+            case SUM:
+            case AVG:
+                a.sum.push_back(0);
+                // fall through
+            case COUNT:
+                a.count.push_back(0);
+                break;
+            case RMS:
+                a.squares.push_back(0);
+                a.count.push_back(0);
+                break;
+            case MIN:
+                a.value.push_back(DBL_MAX);
+                break;
+            case MAX:
+                a.value.push_back(-DBL_MAX);
+                break;
+            case EXPRESSION:
+                a.clones.push_back(a.expression->clone());
+                break;
+        }
+    }
+}
+
+void SQLHashAggregation::accumulate(Aggregate& a, size_t group) {
+    if (a.statistic == EXPRESSION) {
+        a.clones[group]->partialResult();
+        return;
+    }
+
+    bool missing = false;
+    double value = a.argument->eval(missing);
+    if (missing) {
+        return;
+    }
+
+    switch (a.statistic) {
+        case VAR:
+        case STDEV:
+            a.squares[group] += value * value;
+            // fall through
+        case SUM:
+        case AVG:
+            a.sum[group] += value;
+            // fall through
+        case COUNT:
+            a.count[group]++;
+            break;
+        case RMS:
+            a.squares[group] += value * value;
+            a.count[group]++;
+            break;
+        case MIN:
+            if (value < a.value[group]) {
+                a.value[group] = value;
+            }
+            break;
+        case MAX:
+            if (value > a.value[group]) {
+                a.value[group] = value;
+            }
+            break;
+        case EXPRESSION:
+            break;
+    }
+}
+
+void SQLHashAggregation::add() {
+    if (!key_.fits(groupByValues_) || !format_.fits(groupBy_)) {
+        layout(groupByValues_, groupBy_);
+    }
+
+    key_.encode(groupByValues_, keyBuffer_.data());
+    auto g = groups_->insert(keyBuffer_.data(), SQLRowSet::hash(keyBuffer_.data(), key_.size()));
+
+    if (g.second) {
+        format_.encode(groupBy_, rowBuffer_.data());
+        addGroup(rowBuffer_.data());
+        order_.clear();
+    }
+
+    for (auto& a : aggregates_) {
+        accumulate(a, g.first);
+    }
+}
+
+void SQLHashAggregation::combine(Aggregate& a, size_t group, const Aggregate& other, size_t otherGroup) {
+    switch (a.statistic) {
+        case VAR:
+        case STDEV:
+            a.squares[group] += other.squares[otherGroup];
+            // fall through
+        case SUM:
+        case AVG:
+            a.sum[group] += other.sum[otherGroup];
+            // fall through
+        case COUNT:
+            a.count[group] += other.count[otherGroup];
+            break;
+        case RMS:
+            a.squares[group] += other.squares[otherGroup];
+            a.count[group] += other.count[otherGroup];
+            break;
+        case MIN:
+            a.value[group] = std::min(a.value[group], other.value[otherGroup]);
+            break;
+        case MAX:
+            a.value[group] = std::max(a.value[group], other.value[otherGroup]);
+            break;
+        case EXPRESSION:
+            NOTIMP;
+    }
+}
+
+void SQLHashAggregation::merge(SQLHashAggregation& other) {
+    ASSERT(mergeable());
+    ASSERT(other.aggregates_.size() == aggregates_.size());
+    ASSERT(other.groupBy_.size() == groupBy_.size());
+
+    if (other.size() == 0) {
+        return;
+    }
+
+    // Adopt the widths of the other layouts where they are wider
+
+    const Expressions& values = other.format_.decode(other.rows_.data());
+    SQLSortKey::Values keyValues;
+    for (const auto& v : values) {
+        keyValues.push_back(v.get());
+    }
+    if (!key_.fits(keyValues) || !format_.fits(values)) {
+        layout(keyValues, values);
+    }
+
+    const size_t otherWords = other.format_.words();
+
+    for (size_t o = 0; o < other.size(); ++o) {
+        key_.widen(other.key_.widths(), reinterpret_cast<const unsigned char*>(other.groups_->row(o)),
+                   keyBuffer_.data());
+        auto g = groups_->insert(keyBuffer_.data(), SQLRowSet::hash(keyBuffer_.data(), key_.size()));
+
+        if (g.second) {
+            format_.widen(other.format_.widths(), &other.rows_[o * otherWords], rowBuffer_.data());
+            addGroup(rowBuffer_.data());
+        }
+
+        for (size_t i = 0; i < aggregates_.size(); ++i) {
+            combine(aggregates_[i], g.first, other.aggregates_[i], o);
+        }
+    }
+
+    order_.clear();
+}
+
+void SQLHashAggregation::sort() {
+    order_.resize(size());
+    for (size_t g = 0; g < order_.size(); ++g) {
+        order_[g] = g;
+    }
+
+    const size_t size = key_.size();
+    std::sort(order_.begin(), order_.end(), [this, size](size_t a, size_t b) {
+        return std::memcmp(groups_->row(a), groups_->row(b), size) < 0;
+    });
+}
+
+const Expressions& SQLHashAggregation::values(size_t i) {
+    return format_.decode(&rows_[group(i) * format_.words()]);
+}
+
+const Expressions& SQLHashAggregation::aggregates(size_t i) {
+    const size_t g = group(i);
+
+    results_.clear();
+    for (auto& a : aggregates_) {
+        if (a.statistic == EXPRESSION) {
+            results_.push_back(a.clones[g]);
+            continue;
+        }
+
+        if (!a.result) {
+            a.result = std::make_shared<SQLExpressionEvaluated>(*a.expression);
+        }
+
+        // As the functions evaluate
+
+        bool missing = false;
+        double value = 0;
+        switch (a.statistic) {
+            case COUNT:
+                value = a.count[g];
+                break;
+            case SUM:
+                missing = a.count[g] == 0;
+                value   = a.sum[g];
+                break;
+            case AVG:
+                missing = a.count[g] == 0;
+                value   = missing ? 0 : a.sum[g] / a.count[g];
+                break;
+            case VAR:
+            case STDEV:
+                missing = a.count[g] == 0;
+                if (!missing) {
+                    double x = a.sum[g] / a.count[g];
+                    value    = a.squares[g] / a.count[g] - x * x;
+                }
+                if (a.statistic == STDEV) {
+                    value = std::sqrt(std::max(value, 0.));
+                }
+                break;
+            case RMS:
+                missing = a.count[g] == 0;
+                value   = missing ? 0 : std::sqrt(a.squares[g] / a.count[g]);
+                break;
+            case MIN:
+                missing = a.value[g] == DBL_MAX;
+                value   = a.value[g];
+                break;
+            case MAX:
+                missing = a.value[g] == -DBL_MAX;
+                value   = a.value[g];
+                break;
+            case EXPRESSION:
+                break;
+        }
+
+        static_cast<SQLExpressionEvaluated&>(*a.result).value(&value, missing);
+        results_.push_back(a.result);
+    }
+
+    return results_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,125 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLHashAggregation_H
+#define eckit_sql_SQLHashAggregation_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/SQLRowFormat.h"
+#include "eckit/sql/SQLRowSet.h"
+#include "eckit/sql/SQLSortKey.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Aggregated results grouped by the values of the non-aggregated columns, for SELECTs that mix both.
+///
+/// Groups are found in a hash table (SQLRowSet) of the binary keys of their values (SQLSortKey), so they are told
+/// apart as ORDER BY would. The values first seen for each group are kept with SQLRowFormat.
+/// COUNT, SUM, AVG, VAR, STDEV, RMS, MIN and MAX of a numeric column keep their state in an array per statistic,
+/// indexed by group. Other aggregated expressions are cloned for each group.
+///
+/// Aggregations of different rows of a query, e.g. in different threads, are combined with merge().
+
+class SQLHashAggregation : private NonCopyable {
+public:
+    /// @param groupBy the non-aggregated columns, prepared
+    /// @param aggregated the aggregated columns, prepared
+    SQLHashAggregation(const expression::Expressions& groupBy, const expression::Expressions& aggregated);
+    ~SQLHashAggregation();
+
+    /// Adds the current row of the columns to its group
+    void add();
+
+    /// @returns true if merge() can combine the states of the aggregates
+    bool mergeable() const;
+
+    /// Adds the groups of an aggregation of the same columns, over rows that come after those added here
+    void merge(SQLHashAggregation&);
+
+    /// @returns the number of groups
+    size_t size() const { return groups_ ? groups_->size() : 0; }
+
+    /// Orders the groups on their values, ascending
+    void sort();
+
+    /// @returns the values of the non-aggregated columns of a group, valid until the next call
+    const expression::Expressions& values(size_t group);
+
+    /// @returns the results of the aggregated columns of a group, valid until the next call
+    const expression::Expressions& aggregates(size_t group);
+
+    void clear();
+
+private:  // types
+    enum Statistic
+    {
+        COUNT,
+        SUM,
+        AVG,
+        VAR,
+        STDEV,
+        RMS,
+        MIN,
+        MAX,
+        EXPRESSION  ///< anything else, cloned
+    };
+
+    struct Aggregate {
+        Statistic statistic;
+        std::shared_ptr<expression::SQLExpression> expression;
+        expression::SQLExpression* argument = nullptr;
+
+        // By group, as used by the statistic
+        std::vector<size_t> count;
+        std::vector<double> sum;
+        std::vector<double> squares;
+        std::vector<double> value;  ///< MIN, MAX
+        expression::Expressions clones;
+
+        std::shared_ptr<expression::SQLExpression> result;  ///< SQLExpressionEvaluated
+    };
+
+private:  // methods
+    void layout(const SQLSortKey::Values&, const expression::Expressions&);
+    void addGroup(const double* row);
+    void accumulate(Aggregate&, size_t group);
+    void combine(Aggregate&, size_t group, const Aggregate& other, size_t otherGroup);
+    size_t group(size_t i) const { return order_.empty() ? i : order_[i]; }
+
+private:  // members
+    expression::Expressions groupBy_;
+    SQLSortKey::Values groupByValues_;
+    std::vector<Aggregate> aggregates_;
+
+    SQLSortKey key_;
+    SQLRowFormat format_;
+    std::unique_ptr<SQLRowSet> groups_;  ///< of keys
+    std::vector<double> rows_;           ///< values first seen, by group
+    std::vector<unsigned char> keyBuffer_;
+    std::vector<double> rowBuffer_;
+
+    std::vector<size_t> order_;  ///< of the groups, once sorted
+    expression::Expressions results_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
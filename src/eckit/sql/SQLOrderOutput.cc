@@ -8,8 +8,16 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
 #include "eckit/sql/SQLOrderOutput.h"
-#include "eckit/sql/expression/SQLExpressionEvaluated.h"
 
 using namespace eckit::sql::expression;
 
@@ -25,8 +33,64 @@ namespace eckit::sql {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+const size_t maxRuns = 64;
+
+/// Sorts chunks in parallel, then merges them pairwise, also in parallel
+template <typename T, typename Less>
+void parallelSort(std::vector<T>& v, Less less, size_t threads) {
+    const size_t minChunk = 64 * 1024;
+    size_t chunks         = std::max<size_t>(1, std::min(threads, v.size() / minChunk));
+    if (chunks == 1) {
+        std::sort(v.begin(), v.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t c = 0; c <= chunks; ++c) {
+        bounds.push_back(v.size() * c / chunks);
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t c = 0; c < chunks; ++c) {
+        workers.emplace_back(
+            [&, c] { std::sort(v.begin() + bounds[c], v.begin() + bounds[c + 1], less); });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        workers.clear();
+        for (size_t c = 0; c + 2 < bounds.size(); c += 2) {
+            auto first = v.begin() + bounds[c], middle = v.begin() + bounds[c + 1], last = v.begin() + bounds[c + 2];
+            workers.emplace_back([=] { std::inplace_merge(first, middle, last, less); });
+            merged.push_back(bounds[c]);
+        }
+        if (bounds.size() % 2 == 0) {
+            merged.push_back(bounds[bounds.size() - 2]);  // odd chunk out
+        }
+        merged.push_back(bounds.back());
+        for (auto& w : workers) {
+            w.join();
+        }
+        bounds.swap(merged);
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 SQLOrderOutput::SQLOrderOutput(SQLOutput& output, const std::pair<Expressions, std::vector<bool>>& by) :
-    output_(output), by_(by) {}
+    output_(output),
+    by_(by),
+    key_(by_.second),
+    memory_(Resource<size_t>("sqlSortMemory;$ECKIT_SQL_SORT_MEMORY", 512 * 1024 * 1024)),
+    threads_(Resource<size_t>("sqlSortThreads;$ECKIT_SQL_SORT_THREADS",
+                              std::min<size_t>(8, std::max<unsigned>(1, std::thread::hardware_concurrency())))) {}
 
 SQLOrderOutput::~SQLOrderOutput() {}
 
@@ -50,54 +114,263 @@ void SQLOrderOutput::flush() {
     output_.flush();
 }
 
-bool SQLOrderOutput::cachedNext() {
+void SQLOrderOutput::clear() {
+    format_.clear();
+    key_.clear();
+    std::vector<unsigned char>().swap(keys_);
+    std::vector<double>().swap(rows_);
+    std::vector<size_t>().swap(order_);
+    count_ = 0;
+    runs_.clear();
+    sources_.clear();
+    heap_.clear();
+    merging_ = false;
+}
+
+bool SQLOrderOutput::output(const Expressions& results) {
+    byValues_.clear();
+    for (size_t i = 0; i < by_.first.size(); ++i) {
+        byValues_.push_back(byIndices_[i] ? results[byIndices_[i] - 1].get() : by_.first[i].get());
+    }
+
+    // New (wider) types: rows in memory keep their layout in a run of their own
+
+    if (!format_.fits(results) || !key_.fits(byValues_)) {
+        if (count_ > 0) {
+            spill();
+        }
+        format_.update(results);
+        key_.update(byValues_);
+    }
 
-    while (true) {
+    keys_.resize(keys_.size() + key_.size());
+    key_.encode(byValues_, &keys_[keys_.size() - key_.size()]);
 
-        auto it = sortedResults_.begin();
+    rows_.resize(rows_.size() + format_.words());
+    format_.encode(results, &rows_[rows_.size() - format_.words()]);
 
-        // If there are no more results, we are done
+    count_++;
+
+    if (keys_.size() + rows_.size() * sizeof(double) >= memory_) {
+        spill();
+    }
+
+    return false;
+}
+
+void SQLOrderOutput::sort() {
+    // Sort on the first 8 bytes of the keys, then the rest, then the order of arrival
+
+    struct Entry {
+        uint64_t prefix;
+        size_t index;
+    };
+
+    const size_t size         = key_.size();
+    const size_t prefix       = std::min<size_t>(size, sizeof(uint64_t));
+    const unsigned char* keys = keys_.data();
+
+    std::vector<Entry> entries(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        const unsigned char* key = keys + i * size;
+        uint64_t p               = 0;
+        for (size_t b = 0; b < sizeof(uint64_t); ++b) {
+            p = (p << 8) | (b < prefix ? key[b] : 0);
+        }
+        entries[i] = {p, i};
+    }
+
+    parallelSort(
+        entries,
+        [keys, size, prefix](const Entry& a, const Entry& b) {
+            if (a.prefix != b.prefix) {
+                return a.prefix < b.prefix;
+            }
+            int c = std::memcmp(keys + a.index * size + prefix, keys + b.index * size + prefix, size - prefix);
+            return c != 0 ? c < 0 : a.index < b.index;
+        },
+        threads_);
+
+    order_.resize(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        order_[i] = entries[i].index;
+    }
+}
+
+void SQLOrderOutput::spill() {
+    sort();
+
+    const size_t keySize = key_.size();
+    const size_t words   = format_.words();
+
+    Run run{std::make_unique<SQLSpillFile>(keySize + words * sizeof(double)), key_.widths(), format_.widths(),
+            keySize};
+
+    std::vector<char> record(run.file->recordSize());
+    for (size_t i : order_) {
+        std::memcpy(record.data(), &keys_[i * keySize], keySize);
+        std::memcpy(record.data() + keySize, &rows_[i * words], words * sizeof(double));
+        run.file->write(record.data());
+    }
+
+    LOG_DEBUG_LIB(LibEcKit) << "SQLOrderOutput: spilled " << count_ << " rows, "
+                            << Bytes(double(run.file->count() * run.file->recordSize())) << std::endl;
+
+    runs_.emplace_back(std::move(run));
+    if (runs_.size() == maxRuns) {
+        mergeRuns();
+    }
 
-        if (it == sortedResults_.end()) {
+    keys_.clear();
+    rows_.clear();
+    order_.clear();
+    count_ = 0;
+}
+
+bool SQLOrderOutput::advance(Source& source) {
+    if (!source.run) {
+        if (source.next == order_.size()) {
             return false;
         }
+        size_t i   = order_[source.next++];
+        source.key = &keys_[i * key_.size()];
+        source.row = &rows_[i * format_.words()];
+        return true;
+    }
 
-        // Given identical sorted keys, we use the order that rows are appended
+    const Run& run     = *source.run;
+    const char* record = run.file->next();
+    if (!record) {
+        return false;
+    }
 
-        std::queue<Expressions>& rows = it->second;
-        ASSERT(rows.size() >= 1);
-        bool success = output_.output(rows.front());
+    // Records are not aligned for doubles, and may need widening
+    source.keyBuffer.resize(key_.size());
+    key_.widen(run.keyWidths, reinterpret_cast<const unsigned char*>(record), source.keyBuffer.data());
+
+    std::vector<double> row((run.file->recordSize() - run.keySize) / sizeof(double));
+    std::memcpy(row.data(), record + run.keySize, row.size() * sizeof(double));
+    source.rowBuffer.resize(format_.words());
+    format_.widen(run.rowWidths, row.data(), source.rowBuffer.data());
+
+    source.key = source.keyBuffer.data();
+    source.row = source.rowBuffer.data();
+    return true;
+}
 
-        // Remove entries that have been output
+void SQLOrderOutput::startMerge() {
+    merging_ = true;
 
-        rows.pop();
-        if (rows.empty()) {
-            sortedResults_.erase(it);
+    if (count_ > 0) {
+        sort();
+    }
+
+    // Runs in the order they were written, then the rows in memory, the most recent
+
+    sources_.resize(runs_.size() + 1);
+    for (size_t i = 0; i < runs_.size(); ++i) {
+        sources_[i].run = &runs_[i];
+        runs_[i].file->rewind();
+    }
+
+    heap_.clear();
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        if (advance(sources_[i])) {
+            heap_.push_back(i);
         }
+    }
+}
 
-        if (success) {
-            return true;
+bool SQLOrderOutput::after(size_t a, size_t b) const {
+    int c = std::memcmp(sources_[a].key, sources_[b].key, key_.size());
+    return c != 0 ? c > 0 : a > b;
+}
+
+void SQLOrderOutput::mergeRuns() {
+
+    // Limits the files open at once, the runs are merged into one in the current layout
+
+    const size_t keySize = key_.size();
+    const size_t words   = format_.words();
+
+    Run run{std::make_unique<SQLSpillFile>(keySize + words * sizeof(double)), key_.widths(), format_.widths(),
+            keySize};
+
+    sources_.resize(runs_.size());
+    for (size_t i = 0; i < runs_.size(); ++i) {
+        sources_[i].run = &runs_[i];
+        runs_[i].file->rewind();
+        if (advance(sources_[i])) {
+            heap_.push_back(i);
         }
     }
+
+    auto greater = [this](size_t a, size_t b) { return after(a, b); };
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+
+    std::vector<char> record(run.file->recordSize());
+    while (!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end(), greater);
+        Source& source = sources_[heap_.back()];
+
+        std::memcpy(record.data(), source.key, keySize);
+        std::memcpy(record.data() + keySize, source.row, words * sizeof(double));
+        run.file->write(record.data());
+
+        if (advance(source)) {
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+        else {
+            heap_.pop_back();
+        }
+    }
+
+    sources_.clear();
+    runs_.clear();
+    runs_.emplace_back(std::move(run));
 }
 
-bool SQLOrderOutput::output(const Expressions& results) {
-    OrderByExpressions byValues(by_.second);
-    Expressions& byExpressions(by_.first);
-    for (size_t i = 0; i < byExpressions.size(); ++i) {
-        byValues.push_back(
-            std::make_shared<SQLExpressionEvaluated>(byIndices_[i] ? *results[byIndices_[i] - 1] : *byExpressions[i]));
+bool SQLOrderOutput::cachedNext() {
+
+    // Min-heap of the sources on their current key, ties going to the earlier source
+
+    auto greater = [this](size_t a, size_t b) { return after(a, b); };
+
+    if (!merging_) {
+        if (count_ == 0 && runs_.empty()) {
+            return false;
+        }
+        startMerge();
+        std::make_heap(heap_.begin(), heap_.end(), greater);
     }
 
-    Expressions resultValues;
-    for (size_t i = 0; i < results.size(); ++i) {
-        resultValues.push_back(std::make_shared<SQLExpressionEvaluated>(*results[i]));
+    while (!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end(), greater);
+        size_t s = heap_.back();
+
+        bool success = output_.output(format_.decode(sources_[s].row));
+
+        if (advance(sources_[s])) {
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+        else {
+            heap_.pop_back();
+        }
+
+        if (success) {
+            return true;
+        }
     }
 
-    sortedResults_[byValues].push(resultValues);
+    clear();
     return false;
 }
 
+bool SQLOrderOutput::evaluatesExpressions() const {
+    // Columns given by their index are taken from the results
+    return output_.evaluatesExpressions() || std::find(byIndices_.begin(), byIndices_.end(), 0) != byIndices_.end();
+}
+
 void SQLOrderOutput::preprepare(SQLSelect& sql) {
     output_.preprepare(sql);
 
@@ -16,42 +16,92 @@
 #ifndef eckit_sql_SQLOrderOutput_H
 #define eckit_sql_SQLOrderOutput_H
 
-#include <queue>
+#include <memory>
+#include <vector>
 
 #include "eckit/sql/SQLOutput.h"
-#include "eckit/sql/expression/OrderByExpressions.h"
+#include "eckit/sql/SQLRowFormat.h"
+#include "eckit/sql/SQLSortKey.h"
+#include "eckit/sql/SQLSpillFile.h"
 #include "eckit/sql/expression/SQLExpressions.h"
 
 namespace eckit::sql {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Buffers rows with binary sort keys (SQLSortKey) in flat arrays, sorted in parallel when output starts.
+/// Beyond sqlSortMemory bytes, rows are sorted and spilled to temporary files as runs, which are merged on output.
+/// Rows with equal keys keep the order in which they arrived.
+
 class SQLOrderOutput : public SQLOutput {
 public:
     SQLOrderOutput(SQLOutput& output, const std::pair<expression::Expressions, std::vector<bool>>& by);
     ~SQLOrderOutput() override;
 
+private:  // types
+    /// Sorted rows spilled to disk, records are a key then a row, in the layout of the time
+    struct Run {
+        std::unique_ptr<SQLSpillFile> file;
+        std::vector<size_t> keyWidths;
+        std::vector<size_t> rowWidths;
+        size_t keySize;
+    };
+
+    /// A sorted sequence being merged: a run, or the rows in memory
+    struct Source {
+        Run* run                 = nullptr;
+        size_t next              = 0;  ///< rows in memory: position in order_
+        const unsigned char* key = nullptr;
+        const double* row        = nullptr;
+        std::vector<unsigned char> keyBuffer;  ///< widened from a run
+        std::vector<double> rowBuffer;
+    };
+
 private:  // methods
     void print(std::ostream&) const override;
 
+    void sort();
+    void spill();
+    void mergeRuns();
+    void startMerge();
+    bool advance(Source&);
+    bool after(size_t source1, size_t source2) const;
+    void clear();
+
     // -- Members
 
     SQLOutput& output_;
     std::pair<expression::Expressions, std::vector<bool>> by_;
+    std::vector<size_t> byIndices_;
 
-    typedef std::map<expression::OrderByExpressions, std::queue<Expressions>> SortedResults;
+    SQLRowFormat format_;
+    SQLSortKey key_;
+    SQLSortKey::Values byValues_;
 
-    SortedResults sortedResults_;
-    std::vector<size_t> byIndices_;
+    // Rows in memory, in order of arrival
+    std::vector<unsigned char> keys_;
+    std::vector<double> rows_;
+    size_t count_ = 0;
+    std::vector<size_t> order_;  ///< of the rows in memory, once sorted
+
+    std::vector<Run> runs_;
+
+    bool merging_ = false;
+    std::vector<Source> sources_;
+    std::vector<size_t> heap_;  ///< of sources_
+
+    size_t memory_;
+    size_t threads_;
 
     // -- Overridden methods
     void reset() override;
     void flush() override;
 
-    /// OrderBy builds a std::map of sorted results. Now we start outputting them.
+    /// OrderBy buffers the results. Now we sort and start outputting them.
     bool cachedNext() override;
 
     bool output(const expression::Expressions&) override;
+    bool evaluatesExpressions() const override;
     void preprepare(SQLSelect&) override;
     void prepare(SQLSelect&) override;
     void cleanup(SQLSelect&) override;
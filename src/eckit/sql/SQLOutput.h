@@ -48,6 +48,10 @@ public:
 
     virtual bool output(const expression::Expressions&) = 0;
 
+    /// True if the output evaluates expressions of its own (e.g. ORDER BY a column), which only the SQLSelect that
+    /// prepared it can provide. It can then not be given rows evaluated elsewhere, e.g. by a parallel scan.
+    virtual bool evaluatesExpressions() const { return false; }
+
     virtual void outputReal(double, bool)                = 0;
     virtual void outputDouble(double, bool)              = 0;
     virtual void outputInt(double, bool)                 = 0;
@@ -0,0 +1,376 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/BigNum.h"
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLColumn.h"
+#include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLParallelScan.h"
+#include "eckit/sql/SQLSelect.h"
+#include "eckit/sql/SQLTable.h"
+#include "eckit/sql/expression/function/FunctionExpression.h"
+#include "eckit/sql/expression/function/FunctionROWNUMBER.h"
+#include "eckit/sql/expression/function/FunctionTHIN.h"
+
+using namespace eckit::sql::expression;
+using namespace eckit::sql::expression::function;
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Functions share their arguments when cloned
+std::shared_ptr<SQLExpression> deepClone(const SQLExpression& e) {
+    std::shared_ptr<SQLExpression> clone = e.clone();
+    if (auto* f = dynamic_cast<FunctionExpression*>(clone.get())) {
+        for (auto& arg : f->args()) {
+            arg = deepClone(*arg);
+        }
+    }
+    return clone;
+}
+
+/// Functions of the rows scanned so far, which a split scan does not know
+bool dependsOnRowNumber(SQLExpression& e) {
+    if (dynamic_cast<FunctionROWNUMBER*>(&e) || dynamic_cast<FunctionTHIN*>(&e)) {
+        return true;
+    }
+    if (auto* f = dynamic_cast<FunctionExpression*>(&e)) {
+        for (auto& arg : f->args()) {
+            if (dependsOnRowNumber(*arg)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Keeps the rows of results of a worker, in the morsel being scanned
+class SQLParallelScan::MorselOutput : public SQLOutput {
+public:
+    void morsel(Morsel* m) { morsel_ = m; }
+
+private:
+    bool output(const Expressions& results) override {
+        Morsel& m(*morsel_);
+
+        if (!m.format.fits(results)) {
+            std::vector<size_t> widths(m.format.widths());
+            const size_t words = m.format.words();
+            m.format.update(results);
+
+            std::vector<double> rows(m.count * m.format.words());
+            for (size_t r = 0; r < m.count; ++r) {
+                m.format.widen(widths, &m.rows[r * words], &rows[r * m.format.words()]);
+            }
+            m.rows.swap(rows);
+        }
+
+        m.rows.resize((m.count + 1) * m.format.words());
+        m.format.encode(results, &m.rows[m.count * m.format.words()]);
+        m.count++;
+        return true;
+    }
+
+    void prepare(SQLSelect&) override {}
+    void cleanup(SQLSelect&) override {}
+    void reset() override {}
+    void flush() override {}
+    unsigned long long count() override { return 0; }
+
+    void outputReal(double, bool) override { NOTIMP; }
+    void outputDouble(double, bool) override { NOTIMP; }
+    void outputInt(double, bool) override { NOTIMP; }
+    void outputUnsignedInt(double, bool) override { NOTIMP; }
+    void outputString(const char*, size_t, bool) override { NOTIMP; }
+    void outputBitfield(double, bool) override { NOTIMP; }
+
+    Morsel* morsel_ = nullptr;
+};
+
+SQLParallelScan::Worker::Worker() {}
+
+SQLParallelScan::Worker::~Worker() {}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLParallelScan::SQLParallelScan(SQLSelect& select) :
+    select_(select),
+    threads_(Resource<size_t>("sqlScanThreads;$ECKIT_SQL_SCAN_THREADS",
+                              std::min<size_t>(8, std::max<unsigned>(1, std::thread::hardware_concurrency())))),
+    morselRows_(Resource<unsigned long long>("sqlScanMorselRows;$ECKIT_SQL_SCAN_MORSEL_ROWS", 64 * 1024)),
+    ordered_(Resource<bool>("sqlScanOrdered;$ECKIT_SQL_SCAN_ORDERED", true)),
+    rows_(0),
+    morsels_(0),
+    window_(4 * threads_),
+    next_(0),
+    emitted_(0),
+    failed_(false) {}
+
+SQLParallelScan::~SQLParallelScan() {}
+
+bool SQLParallelScan::splittable() const {
+    SQLSelect& s(select_);
+
+    if (threads_ < 2 || morselRows_ == 0) {
+        return false;
+    }
+
+    if (s.cursors_.size() != 1 || s.sortedTables_.size() != 1 || s.doOutputCached_) {
+        return false;
+    }
+
+    if (s.sortedTables_[0]->table_->splittableRows() <= morselRows_) {
+        return false;
+    }
+
+    if (s.output_.evaluatesExpressions()) {
+        return false;
+    }
+
+    for (const auto& c : s.select_) {
+        if (dependsOnRowNumber(*c)) {
+            return false;
+        }
+    }
+    if (s.where_ && dependsOnRowNumber(*s.where_)) {
+        return false;
+    }
+
+    if (s.aggregate_) {
+        if (s.mixedAggregatedAndScalar_) {
+            return s.aggregatedResults_->mergeable();
+        }
+        return SQLHashAggregation(Expressions(), s.aggregated_).mergeable();
+    }
+
+    return true;
+}
+
+void SQLParallelScan::prepare() {
+    rows_    = select_.sortedTables_[0]->table_->splittableRows();
+    morsels_ = (rows_ + morselRows_ - 1) / morselRows_;
+
+    std::vector<std::reference_wrapper<const SQLTable>> tables;
+    for (const SQLTable* t : select_.tables_) {
+        tables.push_back(*t);
+    }
+
+    // Workers are prepared here, as preparing a SELECT updates the metadata of the columns of the table
+
+    for (size_t i = 0; i < std::min<size_t>(threads_, morsels_); ++i) {
+        workers_.emplace_back(new Worker);
+        Worker& w(*workers_.back());
+
+        Expressions columns;
+        for (const auto& c : select_.select_) {
+            columns.push_back(deepClone(*c));
+        }
+        std::shared_ptr<SQLExpression> where(select_.where_ ? deepClone(*select_.where_) : nullptr);
+
+        w.output.reset(new MorselOutput);
+        w.select.reset(new SQLSelect(columns, tables, where, *w.output));
+        w.select->prepareExecute();
+
+        ASSERT(w.select->cursors_.size() == 1);
+        ASSERT(w.select->sortedTables_.size() == 1);
+
+        // Aggregates are added up in a single group, so that they can be merged
+
+        SQLSelect& s(*w.select);
+        if (s.aggregate_ && !s.mixedAggregatedAndScalar_) {
+            Expressions group;
+            group.push_back(SQLExpression::number(0));
+            s.aggregatedResults_.reset(new SQLHashAggregation(group, s.aggregated_));
+            s.mixedAggregatedAndScalar_ = true;
+        }
+    }
+}
+
+bool SQLParallelScan::execute() {
+    if (!splittable()) {
+        return false;
+    }
+
+    prepare();
+
+    Log::debug<LibEcKit>() << "SQLParallelScan: " << BigNum(rows_) << " rows in " << morsels_ << " morsels, "
+                           << workers_.size() << " threads" << std::endl;
+
+    std::vector<std::thread> threads;
+    for (auto& w : workers_) {
+        Worker* worker = w.get();
+        threads.emplace_back([this, worker] { work(*worker); });
+    }
+
+    try {
+        if (!select_.aggregate_) {
+            merge();
+        }
+    }
+    catch (...) {
+        fail(std::current_exception());
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+
+    if (select_.aggregate_) {
+        aggregate();
+    }
+
+    for (const auto& w : workers_) {
+        select_.total_ += w->select->total_;
+        select_.skips_ += w->select->skips_;
+    }
+    workers_.clear();
+
+    return true;
+}
+
+void SQLParallelScan::work(Worker& w) {
+    try {
+        for (;;) {
+            size_t morsel;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this] {
+                    return failed_ || next_ == morsels_ || select_.aggregate_ || next_ < emitted_ + window_;
+                });
+                if (failed_ || next_ == morsels_) {
+                    return;
+                }
+                morsel = next_++;
+            }
+
+            scan(w, morsel);
+        }
+    }
+    catch (...) {
+        fail(std::current_exception());
+    }
+}
+
+void SQLParallelScan::scan(Worker& w, size_t morsel) {
+    SQLSelect& s(*w.select);
+    SelectOneTable& table(*s.sortedTables_[0]);
+
+    unsigned long long begin = morsel * morselRows_;
+    unsigned long long end   = std::min(begin + morselRows_, rows_);
+
+    s.cursors_[0].reset(table.table_->rangeIterator(table.fetch_, begin, end));
+    bind(table, *s.cursors_[0]);
+
+    Morsel results;
+    w.output->morsel(&results);
+
+    while (s.processNextTableRow(0)) {
+        s.writeOutput();
+    }
+
+    w.output->morsel(nullptr);
+
+    if (!select_.aggregate_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.emplace(morsel, std::move(results));
+        cond_.notify_all();
+    }
+}
+
+void SQLParallelScan::merge() {
+    while (emitted_ < morsels_) {
+        Morsel morsel;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return failed_ || (ordered_ ? ready_.count(emitted_) != 0 : !ready_.empty()); });
+            if (failed_) {
+                return;
+            }
+            auto it = ordered_ ? ready_.find(emitted_) : ready_.begin();
+            morsel  = std::move(it->second);
+            ready_.erase(it);
+        }
+
+        for (size_t r = 0; r < morsel.count; ++r) {
+            if (select_.output_.output(morsel.format.decode(&morsel.rows[r * morsel.format.words()]))) {
+                select_.count_++;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        emitted_++;
+        cond_.notify_all();
+    }
+}
+
+void SQLParallelScan::aggregate() {
+    if (select_.mixedAggregatedAndScalar_) {
+        // Merged in the order of the workers, rather than of the rows: a group keeps values from any of its rows
+        for (const auto& w : workers_) {
+            select_.aggregatedResults_->merge(*w->select->aggregatedResults_);
+        }
+        return;
+    }
+
+    SQLHashAggregation& results(*workers_[0]->select->aggregatedResults_);
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        results.merge(*workers_[i]->select->aggregatedResults_);
+    }
+
+    // As the serial scan, there is no output without rows
+
+    if (results.size() != 0 && select_.output_.output(results.aggregates(0))) {
+        select_.count_++;
+    }
+}
+
+void SQLParallelScan::fail(std::exception_ptr e) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+        error_ = e;
+    }
+    failed_ = true;
+    cond_.notify_all();
+}
+
+void SQLParallelScan::bind(SelectOneTable& table, SQLTableIterator& cursor) {
+    const double* data(cursor.data());
+    const std::vector<size_t> offsets(cursor.columnOffsets());
+    const std::vector<size_t> doublesSizes(cursor.doublesDataSizes());
+
+    for (size_t i = 0; i < table.fetch_.size(); i++) {
+        const SQLColumn& column(table.fetch_[i].get());
+        if (doublesSizes[i] * sizeof(double) != column.type().size()) {
+            throw SeriousBug("SQLParallelScan: the layout of column " + column.fullName() + " changes between rows");
+        }
+        table.values_[i]->first = &data[offsets[i]];
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
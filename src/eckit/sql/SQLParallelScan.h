@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLParallelScan_H
+#define eckit_sql_SQLParallelScan_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/SQLRowFormat.h"
+
+namespace eckit::sql {
+
+class SQLOutput;
+class SQLSelect;
+struct SelectOneTable;
+class SQLTableIterator;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Scan of the table of a SELECT split into ranges of rows (morsels), taken in turn by worker threads.
+///
+/// Each worker runs a copy of the SELECT, with expressions of its own, that evaluates WHERE and the results on the
+/// rows of its morsels. Rows of results are given to the output of the SELECT by the calling thread, in the order
+/// of the table or as morsels complete. Aggregates are added up by each worker (SQLHashAggregation), and merged.
+///
+/// The scan only applies to a single table that is splittable, to aggregates that can be merged, and to outputs
+/// that do not evaluate expressions of their own (e.g. ORDER BY a column). Functions of the number of rows
+/// (ROWNUMBER, THIN) are left to the serial scan.
+
+class SQLParallelScan : private NonCopyable {
+public:
+    explicit SQLParallelScan(SQLSelect&);
+    ~SQLParallelScan();
+
+    /// Scans all the rows, giving rows of results to the output, or adding up the aggregates of the SELECT.
+    /// @returns false, having done nothing, if the scan of the SELECT can not be split
+    bool execute();
+
+private:  // types
+    struct Morsel {
+        SQLRowFormat format;
+        std::vector<double> rows;
+        size_t count = 0;
+    };
+
+    class MorselOutput;
+
+    struct Worker {
+        Worker();
+        ~Worker();
+        std::unique_ptr<MorselOutput> output;
+        std::unique_ptr<SQLSelect> select;
+    };
+
+private:  // methods
+    bool splittable() const;
+    void prepare();
+    void work(Worker&);
+    void scan(Worker&, size_t morsel);
+    void merge();
+    void aggregate();
+    void fail(std::exception_ptr);
+
+    static void bind(SelectOneTable&, SQLTableIterator&);
+
+private:  // members
+    SQLSelect& select_;
+
+    size_t threads_;
+    unsigned long long morselRows_;
+    bool ordered_;
+
+    unsigned long long rows_;
+    size_t morsels_;
+    size_t window_;  ///< of morsels taken but not output, to bound the memory
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    size_t next_;                     ///< morsel to take
+    size_t emitted_;                  ///< morsels output
+    std::map<size_t, Morsel> ready_;  ///< scanned, waiting for output
+    bool failed_;
+    std::exception_ptr error_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
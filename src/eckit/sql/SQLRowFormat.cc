@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLRowFormat.h"
+#include "eckit/sql/expression/SQLExpressionEvaluated.h"
+#include "eckit/sql/type/SQLType.h"
+
+using namespace eckit::sql::expression;
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool SQLRowFormat::fits(const Expressions& results) const {
+    if (results.size() != widths_.size() || widths_.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]->type()->size() > widths_[i] * sizeof(double)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SQLRowFormat::update(const Expressions& results) {
+    bool changed = widths_.size() != results.size();
+    if (changed) {
+        ASSERT(widths_.empty());
+        widths_.assign(results.size(), 0);
+    }
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        size_t bytes = results[i]->type()->size();
+        ASSERT(bytes % sizeof(double) == 0);
+        if (bytes / sizeof(double) > widths_[i]) {
+            widths_[i] = bytes / sizeof(double);
+            changed    = true;
+        }
+    }
+
+    if (changed) {
+        offsets_.clear();
+        words_ = 0;
+        for (size_t width : widths_) {
+            offsets_.push_back(words_);
+            words_ += width + 1;
+        }
+
+        // Replay with the widest types
+        columns_.clear();
+        for (const auto& r : results) {
+            columns_.push_back(std::make_shared<SQLExpressionEvaluated>(*r));
+        }
+    }
+}
+
+void SQLRowFormat::clear() {
+    widths_.clear();
+    offsets_.clear();
+    words_ = 0;
+    columns_.clear();
+}
+
+void SQLRowFormat::encode(const Expressions& results, double* row) const {
+    ASSERT(results.size() == widths_.size());
+    std::fill(row, row + words_, 0.);
+    for (size_t i = 0; i < results.size(); ++i) {
+        bool missing = false;
+        results[i]->eval(&row[offsets_[i]], missing);
+        row[offsets_[i] + widths_[i]] = missing ? 1 : 0;
+    }
+}
+
+const Expressions& SQLRowFormat::decode(const double* row) {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        static_cast<SQLExpressionEvaluated&>(*columns_[i]).value(&row[offsets_[i]], row[offsets_[i] + widths_[i]] != 0);
+    }
+    return columns_;
+}
+
+void SQLRowFormat::widen(const std::vector<size_t>& widths, const double* in, double* out) const {
+    ASSERT(widths.size() == widths_.size());
+    std::fill(out, out + words_, 0.);
+    for (size_t i = 0; i < widths.size(); ++i) {
+        ASSERT(widths[i] <= widths_[i]);
+        std::copy(in, in + widths[i], &out[offsets_[i]]);
+        out[offsets_[i] + widths_[i]] = in[widths[i]];
+        in += widths[i] + 1;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,64 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLRowFormat_H
+#define eckit_sql_SQLRowFormat_H
+
+#include <cstddef>
+#include <vector>
+
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Fixed width layout of output rows, for the outputs that buffer them (ORDER BY, DISTINCT).
+///
+/// Each column takes the words (doubles) of its type, then one word for the missing flag. String types may widen
+/// between frames of the data: columns then grow, and narrower values are zero padded, which strings ignore.
+
+class SQLRowFormat {
+public:
+    /// @returns true if rows of these results can be written in this layout
+    bool fits(const expression::Expressions& results) const;
+
+    /// Adapts the layout to the types of a row of results, widening columns as needed
+    void update(const expression::Expressions& results);
+
+    void clear();
+
+    bool empty() const { return widths_.empty(); }
+    size_t words() const { return words_; }
+    const std::vector<size_t>& widths() const { return widths_; }
+
+    /// Writes a row of results into words() doubles
+    void encode(const expression::Expressions& results, double* row) const;
+
+    /// @returns expressions evaluating to the values of a row, valid until the next call
+    const expression::Expressions& decode(const double* row);
+
+    /// Copies a row written with narrower column widths into this layout
+    void widen(const std::vector<size_t>& widths, const double* in, double* out) const;
+
+private:
+    std::vector<size_t> widths_;  ///< words of the value of each column
+    std::vector<size_t> offsets_;
+    size_t words_ = 0;
+    expression::Expressions columns_;  ///< SQLExpressionEvaluated, one per column
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+
+#include "eckit/sql/SQLRowSet.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb3fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+}  // namespace
+
+SQLRowSet::SQLRowSet(size_t size) :
+    size_(size), words_((size + sizeof(double) - 1) / sizeof(double)), slots_(1024, 0) {}
+
+std::pair<size_t, bool> SQLRowSet::insert(const void* row, uint64_t hash) {
+    size_t i = find(row, hash);
+    if (slots_[i] != 0) {
+        return {slots_[i] - 1, false};
+    }
+
+    size_t n  = hashes_.size();
+    slots_[i] = n + 1;
+    rows_.resize(rows_.size() + words_, 0.);
+    std::memcpy(&rows_[n * words_], row, size_);
+    hashes_.push_back(hash);
+
+    if (hashes_.size() * 2 > slots_.size()) {
+        grow();
+    }
+    return {n, true};
+}
+
+bool SQLRowSet::contains(const void* row, uint64_t hash) const {
+    return slots_[find(row, hash)] != 0;
+}
+
+size_t SQLRowSet::bytes() const {
+    return rows_.capacity() * sizeof(double) + hashes_.capacity() * sizeof(uint64_t) + slots_.size() * sizeof(size_t);
+}
+
+uint64_t SQLRowSet::hash(const void* row, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(row);
+    uint64_t h    = size;
+    uint64_t word;
+    for (; size >= sizeof(word); size -= sizeof(word), p += sizeof(word)) {
+        std::memcpy(&word, p, sizeof(word));
+        h = mix(h ^ word);
+    }
+    if (size > 0) {
+        word = 0;
+        std::memcpy(&word, p, size);
+        h = mix(h ^ word);
+    }
+    return h;
+}
+
+size_t SQLRowSet::find(const void* row, uint64_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        size_t slot = slots_[i];
+        if (slot == 0 || (hashes_[slot - 1] == hash && std::memcmp(&rows_[(slot - 1) * words_], row, size_) == 0)) {
+            return i;
+        }
+    }
+}
+
+void SQLRowSet::grow() {
+    std::vector<size_t>(slots_.size() * 2, 0).swap(slots_);
+    size_t mask = slots_.size() - 1;
+    for (size_t r = 0; r < hashes_.size(); ++r) {
+        size_t i = hashes_[r] & mask;
+        while (slots_[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = r + 1;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,70 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLRowSet_H
+#define eckit_sql_SQLRowSet_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Open addressing hash table of fixed size rows, for DISTINCT and GROUP BY.
+///
+/// Rows are kept in one flat array, numbered in the order they were inserted. They are compared with memcmp, the
+/// caller provides their hash.
+
+class SQLRowSet {
+public:
+    /// @param size bytes per row
+    explicit SQLRowSet(size_t size);
+
+    /// @returns the number of the row, and true if it was not in the set before
+    std::pair<size_t, bool> insert(const void* row, uint64_t hash);
+
+    bool contains(const void* row, uint64_t hash) const;
+
+    size_t size() const { return hashes_.size(); }
+    size_t rowSize() const { return size_; }
+
+    /// Memory held, in bytes
+    size_t bytes() const;
+
+    /// Rows are aligned for doubles
+    const double* row(size_t i) const { return &rows_[i * words_]; }
+    uint64_t hash(size_t i) const { return hashes_[i]; }
+
+    /// A hash of size bytes, for callers that do not need a particular one
+    static uint64_t hash(const void* row, size_t size);
+
+private:
+    /// @returns the slot of the row, or the empty slot where it would go
+    size_t find(const void* row, uint64_t hash) const;
+
+    void grow();
+
+    size_t size_;
+    size_t words_;
+    std::vector<double> rows_;
+    std::vector<uint64_t> hashes_;
+    std::vector<size_t> slots_;  ///< row number + 1, 0 if empty
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -18,11 +18,10 @@
 #include "eckit/sql/SQLColumn.h"
 #include "eckit/sql/SQLDatabase.h"
 #include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLParallelScan.h"
 #include "eckit/sql/SQLTable.h"
 #include "eckit/sql/expression/ColumnExpression.h"
 #include "eckit/sql/expression/ConstantExpression.h"
-#include "eckit/sql/expression/OrderByExpressions.h"
-#include "eckit/sql/expression/SQLExpressionEvaluated.h"
 #include "eckit/sql/expression/SQLExpressions.h"
 
 namespace eckit::sql {
@@ -31,6 +30,10 @@ namespace eckit::sql {
 
 using namespace expression;
 
+namespace {
+const size_t noGroup = size_t(-1);
+}
+
 SQLSelect::SQLSelect(const Expressions& columns, const std::vector<std::reference_wrapper<const SQLTable>>& tables,
                      std::shared_ptr<SQLExpression> where, SQLOutput& output,
                      std::vector<std::unique_ptr<SQLOutput>>&& ownedOutputs) :
@@ -39,13 +42,14 @@ SQLSelect::SQLSelect(const Expressions& columns, const std::vector<std::referenc
     simplifiedWhere_(0),
     ownedOutputs_(std::move(ownedOutputs)),
     output_(output),
-    aggregatedResultsIterator_(aggregatedResults_.end()),
+    aggregatedResultsGroup_(noGroup),
     count_(0),
     total_(0),
     skips_(0),
     aggregate_(false),
     mixedAggregatedAndScalar_(false),
-    doOutputCached_(false) {
+    doOutputCached_(false),
+    scannedInParallel_(false) {
     // TODO: Convert tables_, allTables_ to use references rather than pointers.
     for (const SQLTable& t : tables) {
         tables_.push_back(&t);
@@ -218,6 +222,7 @@ void SQLSelect::prepareExecute() {
 
         if (aggregated_.size() != select_.size()) {
             mixedAggregatedAndScalar_ = true;
+            aggregatedResults_.reset(new SQLHashAggregation(nonAggregated_, aggregated_));
             Log::debug<LibEcKit>() << "SELECT has aggregated and non-aggregated results" << std::endl;
         }
     }
@@ -491,10 +496,12 @@ void SQLSelect::reset() {
     aggregate_                = false;
     mixedAggregatedAndScalar_ = false;
     doOutputCached_           = false;
+    scannedInParallel_        = false;
 
     aggregated_.clear();
     nonAggregated_.clear();
-    aggregatedResults_.clear();
+    aggregatedResults_.reset();
+    aggregatedResultsGroup_ = noGroup;
 
     mixedResultColumnIsAggregated_.clear();
 
@@ -538,23 +545,7 @@ bool SQLSelect::writeOutput() {
                 // For each set of non-aggregated values, keep track of the aggregated values
                 // n.b. newRow=false, as we are accumulating the values
 
-                OrderByExpressions nonAggregatedValues;
-                for (size_t i = 0; i < nonAggregated_.size(); ++i) {
-                    nonAggregatedValues.emplace_back(std::make_shared<SQLExpressionEvaluated>(*nonAggregated_[i]));
-                }
-
-                AggregatedResults::iterator results = aggregatedResults_.find(nonAggregatedValues);
-                if (results == aggregatedResults_.end()) {
-                    Expressions& aggregated = aggregatedResults_[nonAggregatedValues];
-                    for (const auto& expr : aggregated_) {
-                        aggregated.emplace_back(expr->clone());
-                    }
-                }
-
-                Expressions& aggregated = aggregatedResults_[nonAggregatedValues];
-                for (size_t i = 0; i < aggregated.size(); ++i) {
-                    aggregated[i]->partialResult();
-                }
+                aggregatedResults_->add();
             }
         }
     }
@@ -567,6 +558,8 @@ unsigned long long SQLSelect::process() {
     ASSERT(cursors_.size() != 0);
     ASSERT(count_ == 0);
 
+    scannedInParallel_ = SQLParallelScan(*this).execute();
+
     while (processOneRow()) {
         /* Intentionally blank */;
     }
@@ -639,9 +632,10 @@ bool SQLSelect::processOneRow() {
         return false;
     }
 
-    // If this is the first retrieve, we need to initialise all tables
+    // If this is the first retrieve, we need to initialise all tables. Unless a parallel scan has already been
+    // through them.
 
-    if (count_ == 0) {
+    if (count_ == 0 && !scannedInParallel_) {
         for (size_t idx = 0; idx < cursors_.size(); idx++) {
             if (!processNextTableRow(idx)) {
                 return false;  // If false, there is no data
@@ -659,7 +653,7 @@ bool SQLSelect::processOneRow() {
     // and increment the second, and continue until we have enumerated all possible combinations
     // of valid data across the tables.
 
-    if (!mixedAggregatedAndScalar_ || aggregatedResultsIterator_ == aggregatedResults_.end()) {
+    if (!scannedInParallel_ && (!mixedAggregatedAndScalar_ || aggregatedResultsGroup_ == noGroup)) {
 
         for (size_t idx = 0; idx < cursors_.size(); idx++) {
 
@@ -686,40 +680,44 @@ bool SQLSelect::processOneRow() {
     // We put this here rather than in postExecute such that the Select class in odb can
     // iterate over one entry at a time.
 
-    if (aggregatedResultsIterator_ == aggregatedResults_.end()) {
-        aggregatedResultsIterator_ = aggregatedResults_.begin();
-    }
-    else {
-        ++aggregatedResultsIterator_;
-    }
-    while (aggregatedResultsIterator_ != aggregatedResults_.end()) {
-        const OrderByExpressions& nonAggregated = aggregatedResultsIterator_->first;
-        Expressions& aggregated                 = aggregatedResultsIterator_->second;
-        Expressions results;
-        size_t ai = 0;
-        size_t ni = 0;
-        for (size_t i = 0; i < mixedResultColumnIsAggregated_.size(); i++) {
-            if (mixedResultColumnIsAggregated_[i]) {
-                results.push_back(aggregated[ai++]);
+    if (mixedAggregatedAndScalar_) {
+        if (aggregatedResultsGroup_ == noGroup) {
+            aggregatedResults_->sort();
+            aggregatedResultsGroup_ = 0;
+        }
+        else {
+            ++aggregatedResultsGroup_;
+        }
+        while (aggregatedResultsGroup_ < aggregatedResults_->size()) {
+            const Expressions& nonAggregated = aggregatedResults_->values(aggregatedResultsGroup_);
+            const Expressions& aggregated    = aggregatedResults_->aggregates(aggregatedResultsGroup_);
+            Expressions results;
+            size_t ai = 0;
+            size_t ni = 0;
+            for (size_t i = 0; i < mixedResultColumnIsAggregated_.size(); i++) {
+                if (mixedResultColumnIsAggregated_[i]) {
+                    results.push_back(aggregated[ai++]);
+                }
+                else {
+                    results.push_back(nonAggregated[ni++]);
+                }
             }
-            else {
-                results.push_back(nonAggregated[ni++]);
+
+            if (output_.output(results)) {
+                count_++;
+                return true;
             }
-        }
 
-        if (output_.output(results)) {
-            count_++;
-            return true;
+            ++aggregatedResultsGroup_;
         }
-
-        ++aggregatedResultsIterator_;
+        aggregatedResultsGroup_ = noGroup;
     }
 
     // If this is an aggregate (not mixed aggregate) case, then we are done the
     // first time we pass through. But ensure that the caller is told that there
     // is at least some data!
 
-    if (aggregate_ && !mixedAggregatedAndScalar_ && count_ == 0) {
+    if (aggregate_ && !mixedAggregatedAndScalar_ && count_ == 0 && !scannedInParallel_) {
         resultsOut();
         count_++;
         return true;
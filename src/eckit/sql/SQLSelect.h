@@ -20,13 +20,14 @@
 #include "eckit/filesystem/PathName.h"
 
 #include "eckit/sql/Environment.h"
+#include "eckit/sql/SQLHashAggregation.h"
 #include "eckit/sql/SQLOutput.h"
 #include "eckit/sql/SQLOutputConfig.h"
 #include "eckit/sql/SQLStatement.h"
 #include "eckit/sql/SelectOneTable.h"
-#include "eckit/sql/expression/OrderByExpressions.h"
 
 namespace eckit::sql {
+class SQLParallelScan;
 class SQLTableIterator;
 namespace expression::function {
 class FunctionROWNUMBER;
@@ -99,10 +100,9 @@ private:
     std::vector<std::unique_ptr<SQLOutput>> ownedOutputs_;
     SQLOutput& output_;
 
-    typedef std::map<expression::OrderByExpressions, expression::Expressions> AggregatedResults;
-
-    AggregatedResults aggregatedResults_;
-    AggregatedResults::iterator aggregatedResultsIterator_;
+    /// Groups of the SELECTs that mix aggregated and non-aggregated results
+    std::unique_ptr<SQLHashAggregation> aggregatedResults_;
+    size_t aggregatedResultsGroup_;  ///< being output, noGroup before (or after) the output
 
     // n.b. we don't use std::vector<bool> as you cannot take a reference to a single element.
 
@@ -120,6 +120,7 @@ private:
     bool aggregate_;
     bool mixedAggregatedAndScalar_;
     bool doOutputCached_;
+    bool scannedInParallel_;  ///< by SQLParallelScan, leaving the results to output
     Expressions aggregated_;
     Expressions nonAggregated_;
     std::vector<bool> mixedResultColumnIsAggregated_;
@@ -136,6 +137,7 @@ private:
 
     friend class expression::function::FunctionROWNUMBER;  // needs access to count_
     friend class expression::function::FunctionTHIN;       // needs access to count_
+    friend class SQLParallelScan;                          // runs copies of the SELECT over ranges of rows
 
     friend std::ostream& operator<<(std::ostream& s, const SQLSelect& p) {
         p.print(s);
@@ -0,0 +1,129 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLSortKey.h"
+#include "eckit/sql/expression/SQLExpression.h"
+#include "eckit/sql/type/SQLType.h"
+#include "eckit/utils/StringTools.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLSortKey::SQLSortKey(const std::vector<bool>& ascending) :
+    ascending_(ascending) {}
+
+bool SQLSortKey::fits(const Values& values) const {
+    if (values.size() != widths_.size() || widths_.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (strings_[i] && values[i]->type()->size() > widths_[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SQLSortKey::update(const Values& values) {
+    bool changed = widths_.size() != values.size();
+    if (changed) {
+        ASSERT(widths_.empty());
+        ASSERT(ascending_.empty() || ascending_.size() == values.size());
+        widths_.assign(values.size(), 0);
+        strings_.clear();
+        for (const auto* v : values) {
+            strings_.push_back(v->type()->getKind() == type::SQLType::stringType);
+        }
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        size_t width = strings_[i] ? values[i]->type()->size() : sizeof(uint64_t);
+        if (width > widths_[i]) {
+            widths_[i] = width;
+            changed    = true;
+        }
+    }
+
+    if (changed) {
+        size_ = 0;
+        for (size_t width : widths_) {
+            size_ += 1 + width;
+        }
+    }
+}
+
+void SQLSortKey::clear() {
+    strings_.clear();
+    widths_.clear();
+    size_ = 0;
+}
+
+void SQLSortKey::encode(const Values& values, unsigned char* key) const {
+    ASSERT(values.size() == widths_.size());
+    std::fill(key, key + size_, 0);
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        unsigned char* value = key + 1;
+        bool missing         = false;
+
+        if (strings_[i]) {
+            std::string s = values[i]->evalAsString(missing);
+            if (!missing) {
+                s = StringTools::trim(s, "\t\n\v\f\r ");
+                ASSERT(s.size() <= widths_[i]);
+                std::copy(s.begin(), s.end(), value);
+            }
+        }
+        else {
+            double d = values[i]->eval(missing);
+            if (!missing) {
+                if (d == 0) {
+                    d = 0;  // -0 == 0
+                }
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                bits = (bits & (uint64_t(1) << 63)) != 0 ? ~bits : bits | (uint64_t(1) << 63);
+                for (int b = 7; b >= 0; --b, bits >>= 8) {
+                    value[b] = static_cast<unsigned char>(bits);
+                }
+            }
+        }
+
+        key[0] = missing ? 0 : 1;
+
+        if (!ascending_.empty() && !ascending_[i]) {
+            std::transform(key, value + widths_[i], key, [](unsigned char c) { return ~c; });
+        }
+        key = value + widths_[i];
+    }
+}
+
+void SQLSortKey::widen(const std::vector<size_t>& widths, const unsigned char* in, unsigned char* out) const {
+    ASSERT(widths.size() == widths_.size());
+    for (size_t i = 0; i < widths.size(); ++i) {
+        ASSERT(widths[i] <= widths_[i]);
+        out = std::copy(in, in + 1 + widths[i], out);
+        in += 1 + widths[i];
+
+        // Zero padding, inverted for descending values
+        unsigned char pad = (!ascending_.empty() && !ascending_[i]) ? 0xff : 0;
+        out               = std::fill_n(out, widths_[i] - widths[i], pad);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,68 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLSortKey_H
+#define eckit_sql_SQLSortKey_H
+
+#include <cstddef>
+#include <vector>
+
+namespace eckit::sql {
+
+namespace expression {
+class SQLExpression;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Binary keys of the ORDER BY values of a row: rows sort as their keys compared with memcmp, in the order of
+/// OrderByExpressions.
+///
+/// Each value gives a byte for missing (missing first), then numbers as order preserving big-endian integers, or
+/// strings trimmed of white space and zero padded. Descending values are inverted.
+
+class SQLSortKey {
+public:
+    using Values = std::vector<const expression::SQLExpression*>;
+
+    explicit SQLSortKey(const std::vector<bool>& ascending);
+
+    /// @returns true if keys of these values can be written in this layout
+    bool fits(const Values&) const;
+
+    /// Adapts to the types of the values of a row, widening strings as needed
+    void update(const Values&);
+
+    void clear();
+
+    bool empty() const { return widths_.empty(); }
+    size_t size() const { return size_; }
+    const std::vector<size_t>& widths() const { return widths_; }
+
+    /// Writes size() bytes
+    void encode(const Values&, unsigned char* key) const;
+
+    /// Copies a key written with narrower strings into this layout
+    void widen(const std::vector<size_t>& widths, const unsigned char* in, unsigned char* out) const;
+
+private:
+    std::vector<bool> ascending_;
+    std::vector<bool> strings_;
+    std::vector<size_t> widths_;  ///< bytes of each value, after the missing byte
+    size_t size_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLSpillFile.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const size_t bufferSize = 1024 * 1024;
+
+/// An open temporary file, already unlinked
+FILE* temporary(std::string& path) {
+    const char* tmpdir = ::getenv("TMPDIR");
+    path               = std::string(tmpdir ? tmpdir : "/tmp") + "/eckitXXXXXXXXXXX";
+
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back(0);
+
+    int fd;
+    SYSCALL2(fd = ::mkstemp(name.data()), path);
+    path = name.data();
+
+    if (::unlink(name.data()) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw FailedSystemCall(path, "unlink", Here(), err);
+    }
+
+    FILE* file = ::fdopen(fd, "w+");
+    if (!file) {
+        int err = errno;
+        ::close(fd);
+        throw FailedSystemCall(path, "fdopen", Here(), err);
+    }
+    return file;
+}
+
+}  // namespace
+
+SQLSpillFile::SQLSpillFile(size_t recordSize) :
+    file_(temporary(path_)), recordSize_(recordSize) {
+    ASSERT(recordSize_ > 0);
+}
+
+SQLSpillFile::~SQLSpillFile() {
+    if (::fclose(file_) != 0) {
+        Log::error() << "SQLSpillFile: fclose(" << path_ << ")" << Log::syserr << std::endl;
+    }
+}
+
+void SQLSpillFile::write(const void* records, size_t count) {
+    ASSERT(!reading_);
+    if (::fwrite(records, recordSize_, count, file_) != count) {
+        throw WriteError(path_, Here());
+    }
+    count_ += count;
+}
+
+void SQLSpillFile::rewind() {
+    ASSERT(!reading_);
+    if (::fflush(file_) != 0 || ::fseek(file_, 0, SEEK_SET) != 0) {
+        throw FailedSystemCall("fseek(" + path_ + ")", Here());
+    }
+    // Only allocated for reading, as many files may be written at once
+    buffer_.resize(std::max(recordSize_, bufferSize / recordSize_ * recordSize_));
+
+    reading_ = true;
+    pos_     = 0;
+    end_     = 0;
+    left_    = count_;
+}
+
+const char* SQLSpillFile::next() {
+    ASSERT(reading_);
+    if (pos_ == end_) {
+        if (left_ == 0) {
+            return nullptr;
+        }
+        size_t records = std::min(left_, buffer_.size() / recordSize_);
+        if (::fread(buffer_, recordSize_, records, file_) != records) {
+            throw ReadError(path_, Here());
+        }
+        left_ -= records;
+        pos_ = 0;
+        end_ = records * recordSize_;
+    }
+
+    const char* record = buffer_ + pos_;
+    pos_ += recordSize_;
+    return record;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,65 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLSpillFile_H
+#define eckit_sql_SQLSpillFile_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Temporary file of fixed size records, for outputs that exceed their memory budget.
+/// Records are written, then read back in the same order. The file is removed as soon as it is open, so that
+/// nothing is left behind, whatever happens to the process.
+
+class SQLSpillFile : private NonCopyable {
+public:
+    explicit SQLSpillFile(size_t recordSize);
+    ~SQLSpillFile();
+
+    void write(const void* records, size_t count = 1);
+
+    /// Ends writing, next() then returns records from the first
+    void rewind();
+
+    /// @returns the next record, or nullptr at the end. Valid until the next call.
+    const char* next();
+
+    size_t count() const { return count_; }
+    size_t recordSize() const { return recordSize_; }
+
+private:
+    std::string path_;  ///< for messages, already removed
+    FILE* file_;
+
+    size_t recordSize_;
+    size_t count_ = 0;
+    bool reading_ = false;
+
+    Buffer buffer_;
+    size_t pos_  = 0;
+    size_t end_  = 0;
+    size_t left_ = 0;  ///< records not read from the file yet
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -232,6 +232,11 @@ std::string SQLTable::fullName() const {
     return owner_.name() + "." + name_;
 }
 
+SQLTableIterator* SQLTable::rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>&,
+                                          unsigned long long, unsigned long long) const {
+    NOTIMP;
+}
+
 void SQLTable::print(std::ostream& s) const {
     s << "CREATE TABLE " << fullName() << " AS (" << std::endl;
     for (std::map<int, SQLColumn*>::const_iterator j = columnsByIndex_.begin(); j != columnsByIndex_.end(); ++j) {
@@ -87,6 +87,14 @@ public:
                                        std::function<void(SQLTableIterator&)> metadataUpdateCallback) const
         = 0;
 
+    /// Tables whose scans can be split across threads return their number of rows, zero otherwise
+    virtual unsigned long long splittableRows() const { return 0; }
+
+    /// Iterator over the rows [begin, end) of a table with splittableRows(). The layout of the data must be the one
+    /// given by iterator() over the whole table, and must not change, so there is no metadata callback.
+    virtual SQLTableIterator* rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>&,
+                                            unsigned long long begin, unsigned long long end) const;
+
 protected:
     std::string path_;
     std::string name_;
@@ -69,6 +69,11 @@ void SQLExpressionEvaluated::output(SQLOutput& o) const {
     type_->output(o, &value_[0], missing_);
 }
 
+void SQLExpressionEvaluated::value(const double* data, bool missing) {
+    ::memcpy(&value_[0], data, value_.size() * sizeof(value_[0]));
+    missing_ = missing;
+}
+
 void SQLExpressionEvaluated::prepare(SQLSelect&) {
     NOTIMP;
 }
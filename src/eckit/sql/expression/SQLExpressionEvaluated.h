@@ -46,6 +46,9 @@ public:
 
     void output(SQLOutput& o) const override;
 
+    /// Replaces the value, for outputs replaying buffered rows. Reads as many words as the type takes.
+    void value(const double* data, bool missing);
+
 protected:
     void print(std::ostream&) const override;
 
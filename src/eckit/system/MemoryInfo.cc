@@ -15,6 +15,7 @@
 #include <cstring>
 #include <iostream>
 
+#include "eckit/io/BufferPool.h"
 #include "eckit/log/BigNum.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/memory/MMap.h"
@@ -29,6 +30,7 @@ MemoryInfo::MemoryInfo() {
     ::memset(this, 0, sizeof(*this));
     MMap::info(mmap_count_, mmap_size_);
     Shmget::info(shm_count_, shm_size_);
+    BufferPool::info(buffer_count_, buffer_size_, buffer_cached_);
 }
 
 static void put(std::ostream& out, const char* title, size_t value, bool& printed, bool bytes = true) {
@@ -63,6 +65,10 @@ void MemoryInfo::print(std::ostream& out) const {
     put(out, "shmem count", shm_count_, printed, false);
     put(out, "shmem size", shm_size_, printed);
 
+    put(out, "buffer count", buffer_count_, printed, false);
+    put(out, "buffer size", buffer_size_, printed);
+    put(out, "buffer cached", buffer_cached_, printed);
+
     // /proc/pid/smap
     put(out, "mapped shared", mapped_shared_, printed);
     put(out, "mapped read", mapped_read_, printed);
@@ -145,6 +151,10 @@ void MemoryInfo::delta(std::ostream& out, const MemoryInfo& other) const {
     diff(out, "shmem count", shm_count_, other.shm_count_, printed, false);
     diff(out, "shmem size", shm_size_, other.shm_size_, printed);
 
+    diff(out, "buffer count", buffer_count_, other.buffer_count_, printed, false);
+    diff(out, "buffer size", buffer_size_, other.buffer_size_, printed);
+    diff(out, "buffer cached", buffer_cached_, other.buffer_cached_, printed);
+
     // /proc/pid/smap
     diff(out, "mapped shared", mapped_shared_, other.mapped_shared_, printed);
     diff(out, "mapped read", mapped_read_, other.mapped_read_, printed);
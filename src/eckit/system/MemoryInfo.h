@@ -55,6 +55,12 @@ struct MemoryInfo {
     size_t shm_count_;
     size_t shm_size_;
 
+    // eckit::Buffer
+
+    size_t buffer_count_;
+    size_t buffer_size_;
+    size_t buffer_cached_;
+
 
     void print(std::ostream&) const;
     void delta(std::ostream&, const MemoryInfo& other) const;
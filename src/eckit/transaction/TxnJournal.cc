@@ -0,0 +1,611 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FDataSync.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/TimeStamp.h"
+#include "eckit/runtime/Main.h"
+#include "eckit/transaction/TxnJournal.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const uint32_t MAGIC = 0x4a4e5854;  // "TXNJ"
+
+/// On disk, followed by length bytes of payload
+struct Header {
+    uint32_t magic;
+    uint32_t length;
+    uint64_t id;
+    int64_t created;
+    int64_t time;
+    uint8_t type;
+    uint8_t padding[3];
+    uint32_t checksum;  ///< of the header, with a zero checksum, and of the payload
+};
+
+static_assert(sizeof(Header) == 40, "TxnJournal record header must not depend on the platform");
+
+uint32_t checksum(uint32_t h, const void* data, size_t length) {
+    // FNV-1a, only to detect records torn by a crash
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+uint32_t checksum(const Header& header, const void* payload) {
+    Header h   = header;
+    h.checksum = 0;
+    return checksum(checksum(2166136261u, &h, sizeof(h)), payload, h.length);
+}
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void writeAll(int fd, const char* p, size_t length, const PathName& path) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw WriteError(path, Here());
+        }
+        p += n;
+        length -= n;
+    }
+}
+
+/// Advisory lock on the journal directory: shared to list and read the segments, exclusive to remove or rename
+/// them. A flock() belongs to an open file, so it also serialises the threads of a process
+class DirectoryLock {
+public:
+    DirectoryLock(const PathName& path, int operation) {
+        fd_ = SYSCALL2(::open(path.localPath(), O_RDONLY | O_DIRECTORY | O_CLOEXEC), path);
+        int rc;
+        while ((rc = ::flock(fd_, operation)) < 0 && errno == EINTR) {}
+        if (rc < 0) {
+            int err = errno;
+            ::close(fd_);
+            throw FailedSystemCall(path, "flock", Here(), err);
+        }
+    }
+
+    ~DirectoryLock() { ::close(fd_); }
+
+private:
+    int fd_;
+};
+
+}  // namespace
+
+struct TxnJournal::Record {
+    RecordType type;
+    TxnID id;
+    int64_t created;
+    int64_t time;
+    std::string payload;
+
+    void encode(std::string& out) const {
+        Header h   = {};
+        h.magic    = MAGIC;
+        h.length   = uint32_t(payload.size());
+        h.id       = id;
+        h.created  = created;
+        h.time     = time;
+        h.type     = type;
+        h.checksum = checksum(h, payload.data());
+
+        ASSERT(h.length == payload.size());
+
+        out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.append(payload);
+    }
+};
+
+struct TxnJournal::Segment {
+    PathName path;
+    std::string host;
+    long pid;
+    unsigned long long sequence;
+
+    bool operator<(const Segment& other) const {
+        return host != other.host ? host < other.host
+                                  : (pid != other.pid ? pid < other.pid : sequence < other.sequence);
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TxnJournal::TxnJournal(const PathName& path) :
+    path_(path),
+    journal_(path + "/journal"),
+    done_(path + "/done"),
+    segmentSize_(Resource<size_t>("txnJournalSegmentSize", 64 * 1024 * 1024)),
+    compactSegments_(std::max<size_t>(Resource<size_t>("txnJournalCompactSegments", 4), 1)),
+    appended_(0),
+    written_(0),
+    writing_(false),
+    fd_(-1),
+    segmentBytes_(0),
+    sequence_(0),
+    current_(0),
+    sealed_(0),
+    stop_(false) {
+
+    std::ostringstream prefix;
+    prefix << Main::hostname() << "." << ::getpid() << ".";
+    prefix_ = prefix.str();
+
+    journal_.mkdir();
+    done_.mkdir();
+
+    adoptOrphans();
+
+    compactor_ = std::thread([this] { compactor(); });
+}
+
+TxnJournal::~TxnJournal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        wakeup_.notify_all();
+    }
+    compactor_.join();
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::string TxnJournal::segmentName(unsigned long long sequence) const {
+    std::ostringstream s;
+    s << prefix_ << std::setfill('0') << std::setw(10) << sequence;
+    return journal_ + "/" + s.str();
+}
+
+void TxnJournal::listSegments(std::vector<Segment>& result) const {
+    std::vector<PathName> files;
+    std::vector<PathName> dirs;
+    journal_.children(files, dirs);
+
+    for (const auto& f : files) {
+        // <host>.<pid>.<sequence>, the host name may contain dots
+        std::string name = f.baseName();
+        size_t s         = name.rfind('.');
+        size_t p         = s == std::string::npos || s == 0 ? std::string::npos : name.rfind('.', s - 1);
+        if (name[0] == '.' || p == std::string::npos || p == 0) {
+            continue;
+        }
+
+        char* end;
+        Segment seg;
+        seg.path     = f;
+        seg.host     = name.substr(0, p);
+        seg.pid      = std::strtol(name.c_str() + p + 1, &end, 10);
+        seg.sequence = std::strtoull(name.c_str() + s + 1, &end, 10);
+        if (*end == 0) {
+            result.push_back(seg);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+}
+
+void TxnJournal::adoptOrphans() {
+    DirectoryLock exclusive(journal_, LOCK_EX);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Segment> segments;
+    listSegments(segments);
+
+    std::string host = Main::hostname();
+    long pid         = ::getpid();
+
+    // Ours, left by an earlier process with the same pid
+    for (const auto& s : segments) {
+        if (s.host == host && s.pid == pid) {
+            sequence_ = std::max(sequence_, s.sequence);
+            sealed_++;
+        }
+    }
+
+    for (const auto& s : segments) {
+        if (s.host != host || s.pid == pid || ::kill(s.pid, 0) == 0 || errno != ESRCH) {
+            continue;
+        }
+
+        // Another process may be adopting it too
+        PathName adopted = segmentName(++sequence_);
+        if (::rename(s.path.localPath(), adopted.localPath()) == 0) {
+            Log::info() << "TxnJournal: adopting " << s.path << " as " << adopted << std::endl;
+            sealed_++;
+        }
+    }
+}
+
+void TxnJournal::openSegment() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (fd_ >= 0) {
+        SYSCALL2(::close(fd_), journal_);
+        fd_ = -1;
+        sealed_++;
+        if (sealed_ >= compactSegments_) {
+            wakeup_.notify_all();
+        }
+    }
+
+    current_      = ++sequence_;
+    PathName path = segmentName(current_);
+    fd_           = SYSCALL2(::open(path.localPath(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644), path);
+    segmentBytes_ = 0;
+
+    path.syncParentDirectory();
+}
+
+void TxnJournal::write(const std::string& batch) {
+    if (fd_ < 0 || (segmentBytes_ > 0 && segmentBytes_ + batch.size() > segmentSize_)) {
+        openSegment();
+    }
+
+    writeAll(fd_, batch.data(), batch.size(), journal_);
+    SYSCALL2(eckit::fdatasync(fd_), journal_);
+
+    segmentBytes_ += batch.size();
+}
+
+void TxnJournal::append(RecordType type, TxnID id, const void* payload, size_t length) {
+    Record r;
+    r.type    = type;
+    r.id      = id;
+    r.time    = now();
+    r.created = type == BEGIN ? r.time : 0;
+    r.payload.assign(static_cast<const char*>(payload), length);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+
+    r.encode(pending_);
+    const unsigned long long mine = ++appended_;
+
+    // Group commit: the first caller to find no write in progress writes all the records queued so far, including
+    // those of callers that arrived while the previous batch was synced
+    while (written_ < mine) {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+
+        if (writing_) {
+            synced_.wait(lock);
+            continue;
+        }
+
+        writing_ = true;
+        std::string batch;
+        batch.swap(pending_);
+        const unsigned long long last = appended_;
+
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            write(batch);
+        }
+        catch (...) {
+            // The state of the segment is unknown, give up rather than risk losing records silently
+            error = std::current_exception();
+        }
+
+        lock.lock();
+
+        writing_ = false;
+        if (error) {
+            error_ = error;
+        }
+        else {
+            written_ = last;
+        }
+        synced_.notify_all();
+    }
+}
+
+void TxnJournal::read(const PathName& path, std::vector<Record>& records) {
+    int fd = ::open(path.localPath(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return;  // removed by a process that does not lock the directory, its records are in another segment
+        }
+        throw FailedSystemCall(path, "open", Here(), errno);
+    }
+
+    std::string data;
+    char buffer[64 * 1024];
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            ::close(fd);
+            throw ReadError(path, Here());
+        }
+        if (n == 0) {
+            break;
+        }
+        data.append(buffer, n);
+    }
+    ::close(fd);
+
+    size_t pos = 0;
+    while (pos + sizeof(Header) <= data.size()) {
+        Header h;
+        ::memcpy(&h, data.data() + pos, sizeof(h));
+
+        const char* payload = data.data() + pos + sizeof(h);
+        if (h.magic != MAGIC || h.length > data.size() - pos - sizeof(h) || h.checksum != checksum(h, payload) ||
+            h.type < BEGIN || h.type > END) {
+            break;
+        }
+
+        Record r;
+        r.type    = RecordType(h.type);
+        r.id      = h.id;
+        r.created = h.created;
+        r.time    = h.time;
+        r.payload.assign(payload, h.length);
+        records.push_back(r);
+
+        pos += sizeof(h) + h.length;
+    }
+
+    if (pos != data.size()) {
+        // A crash while appending, the records after it were never acknowledged
+        Log::warning() << "TxnJournal: ignoring " << (data.size() - pos) << " bytes at the end of " << path
+                       << std::endl;
+    }
+}
+
+void TxnJournal::merge(const std::vector<Record>& records, Entries& entries) {
+    // Segments of different processes interleave in time, an END is final whatever comes after it
+    std::vector<const Record*> sorted;
+    sorted.reserve(records.size());
+    for (const auto& r : records) {
+        sorted.push_back(&r);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Record* a, const Record* b) { return a->time < b->time; });
+
+    for (const Record* r : sorted) {
+        auto j = entries.find(r->id);
+        if (j == entries.end()) {
+            Entry e = {r->id, true, 0, 0, std::string()};
+            j       = entries.insert(std::make_pair(r->id, e)).first;
+        }
+
+        Entry& e = j->second;
+        if (!e.active) {
+            continue;
+        }
+
+        if (r->created) {
+            e.created = r->created;
+        }
+        e.time    = r->time;
+        e.active  = r->type != END;
+        e.payload = r->payload;
+    }
+}
+
+void TxnJournal::scan(Entries& entries) const {
+    std::vector<Record> records;
+    {
+        // No segment is compacted between the listing and the reading
+        DirectoryLock shared(journal_, LOCK_SH);
+
+        std::vector<Segment> segments;
+        listSegments(segments);
+
+        for (const auto& s : segments) {
+            read(s.path, records);
+        }
+    }
+
+    merge(records, entries);
+}
+
+bool TxnJournal::active(TxnID id) const {
+    // Even for transactions begun here: another process may have ended them
+    Entries entries;
+    scan(entries);
+
+    auto j = entries.find(id);
+    return j != entries.end() && j->second.active;
+}
+
+void TxnJournal::compactor() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wakeup_.wait(lock, [this] { return stop_ || sealed_ >= compactSegments_; });
+        if (stop_) {
+            return;
+        }
+
+        lock.unlock();
+        try {
+            compact();
+        }
+        catch (std::exception& e) {
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is ignored, the segments will be compacted later" << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+void TxnJournal::compact() {
+    std::lock_guard<std::mutex> compacting(compactMutex_);
+
+    // Other processes neither compact nor read the segments meanwhile, so they are all listed and read
+    DirectoryLock exclusive(journal_, LOCK_EX);
+
+    // The sealed segments of this process: all ours but the one being written
+    std::vector<Segment> segments;
+    std::vector<Segment> others;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::vector<Segment> all;
+        listSegments(all);
+
+        PathName current = fd_ >= 0 ? PathName(segmentName(current_)) : PathName("/");
+        for (const auto& s : all) {
+            bool ours = s.path.baseName().asString().compare(0, prefix_.size(), prefix_) == 0;
+            (ours && s.path != current ? segments : others).push_back(s);
+        }
+
+        sealed_ = 0;
+    }
+
+    if (segments.empty()) {
+        return;
+    }
+
+    std::vector<Record> records;
+    for (const auto& s : segments) {
+        read(s.path, records);
+    }
+
+    // Transactions may be ended by another process than the one that began them
+    std::vector<Record> everything(records);
+    std::set<TxnID> elsewhere;
+    for (const auto& s : others) {
+        size_t n = everything.size();
+        read(s.path, everything);
+        for (size_t i = n; i < everything.size(); ++i) {
+            if (everything[i].type != END) {
+                elsewhere.insert(everything[i].id);
+            }
+        }
+    }
+
+    Entries entries;
+    merge(records, entries);
+
+    Entries global;
+    merge(everything, global);
+
+    // Backups of the ended transactions go where TxnLog::end() would have put them
+    std::map<std::string, std::string> backups;
+    std::string kept;
+
+    for (const auto& j : entries) {
+        const Entry& e = j.second;
+
+        Record r;
+        r.id      = e.id;
+        r.created = e.created;
+        r.time    = e.time;
+
+        if (e.active) {
+            // Otherwise, ended by another process, which keeps the END
+            if (global[e.id].active) {
+                r.type    = e.created == e.time ? BEGIN : UPDATE;
+                r.payload = e.payload;
+                r.encode(kept);
+            }
+            continue;
+        }
+
+        if (!e.payload.empty()) {
+            std::string date = TimeStamp(time_t(e.time / 1000000000), "%Y%m%d");
+            backups[date].append(e.payload);
+        }
+
+        // Begun by another process, whose segments still hold records of it
+        if (elsewhere.find(e.id) != elsewhere.end()) {
+            r.type = END;
+            r.encode(kept);
+        }
+    }
+
+    for (const auto& b : backups) {
+        PathName path = done_ + "/" + b.first;
+        int fd        = SYSCALL2(::open(path.localPath(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644), path);
+        try {
+            writeAll(fd, b.second.data(), b.second.size(), path);
+            SYSCALL2(eckit::fdatasync(fd), path);
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+        SYSCALL2(::close(fd), path);
+    }
+
+    if (!kept.empty()) {
+        PathName tmp = journal_ + "/." + prefix_ + "compact";
+        int fd       = SYSCALL2(::open(tmp.localPath(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644), tmp);
+        try {
+            writeAll(fd, kept.data(), kept.size(), tmp);
+            SYSCALL2(eckit::fdatasync(fd), tmp);
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+        SYSCALL2(::close(fd), tmp);
+
+        PathName compacted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            compacted = segmentName(++sequence_);
+        }
+        PathName::rename(tmp, compacted);
+        compacted.syncParentDirectory();
+    }
+
+    // A crash before this point leaves records both in the old and new segments, which merge to the same state
+    for (const auto& s : segments) {
+        s.path.unlink();
+    }
+
+    LOG_DEBUG_LIB(LibEcKit) << "TxnJournal: compacted " << segments.size() << " segment(s), " << records.size()
+                            << " record(s) into " << kept.size() << " bytes" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,142 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_TxnJournal_h
+#define eckit_TxnJournal_h
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/transaction/TxnEvent.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Append-only journal of transaction records, an alternative to one file per transaction in TxnLog.
+///
+/// Each process appends to its own segment files under <path>/journal, named <host>.<pid>.<sequence>, so that
+/// writers never share a file. Records of concurrent callers are written and synced together (group commit): the
+/// first caller to find no write in progress writes everything queued so far with a single fdatasync, the others
+/// wait for it. Full segments are sealed, and a background thread compacts the sealed segments of this process:
+/// ended transactions are dropped, after their backup is appended to <path>/done/<date>, and active ones are
+/// rewritten into a new segment. Segments left by dead processes of this host are adopted when the journal is
+/// opened. The state of the log is rebuilt by scanning all the segments. Compaction holds an exclusive flock() on
+/// <path>/journal and scans a shared one, so that no segment disappears between its listing and its reading.
+
+class TxnJournal : private NonCopyable {
+public:
+    enum RecordType : uint8_t
+    {
+        BEGIN  = 1,
+        UPDATE = 2,
+        END    = 3
+    };
+
+    /// Latest state of a transaction found in the journal
+    struct Entry {
+        TxnID id;
+        bool active;          ///< no END record
+        int64_t created;      ///< time of BEGIN (ns since epoch)
+        int64_t time;         ///< time of the latest record (ns since epoch)
+        std::string payload;  ///< latest encoded event, for an ended transaction its backup (empty if none)
+    };
+
+    typedef std::map<TxnID, Entry> Entries;
+
+    // -- Contructors
+
+    TxnJournal(const PathName& path);
+
+    // -- Destructor
+
+    ~TxnJournal();
+
+    // -- Methods
+
+    /// Appends a record, returns when it is on disk
+    void append(RecordType, TxnID, const void* payload, size_t length);
+
+    /// The state of all the transactions in the journal, by ID
+    void scan(Entries&) const;
+
+    /// Whether the transaction has begun and not ended, in any process. Scans the segments
+    bool active(TxnID) const;
+
+    /// Compacts the sealed segments of this process now
+    void compact();
+
+private:
+    struct Record;
+    struct Segment;
+
+    // -- Methods
+
+    void write(const std::string& batch);
+    void openSegment();
+
+    void listSegments(std::vector<Segment>&) const;
+    void adoptOrphans();
+    void compactor();
+
+    std::string segmentName(unsigned long long sequence) const;
+
+    static void read(const PathName&, std::vector<Record>&);
+    static void merge(const std::vector<Record>&, Entries&);
+
+    // -- Members
+
+    PathName path_;
+    PathName journal_;
+    PathName done_;
+    std::string prefix_;  ///< <host>.<pid>.
+
+    size_t segmentSize_;
+    size_t compactSegments_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable synced_;
+    std::string pending_;
+    unsigned long long appended_;  ///< records queued so far
+    unsigned long long written_;   ///< records on disk so far
+    bool writing_;
+    std::exception_ptr error_;
+
+    // Only used by the caller writing a batch
+    int fd_;
+    size_t segmentBytes_;
+
+    unsigned long long sequence_;  ///< last segment created by this process, under mutex_
+    unsigned long long current_;   ///< of the segment being written, under mutex_
+    size_t sealed_;                ///< segments sealed since the last compaction, under mutex_
+
+    std::mutex compactMutex_;  ///< one compaction at a time
+    std::condition_variable wakeup_;
+    bool stop_;
+    std::thread compactor_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -18,14 +18,18 @@
 #include "eckit/container/SharedMemArray.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/AutoCloser.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Seconds.h"
 #include "eckit/log/TimeStamp.h"
 #include "eckit/runtime/Monitor.h"
 #include "eckit/serialisation/FileStream.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Thread.h"
 #include "eckit/thread/ThreadControler.h"
+#include "eckit/transaction/TxnJournal.h"
 #include "eckit/transaction/TxnLog.h"
 #include "eckit/utils/Translator.h"
 
@@ -115,6 +119,17 @@ TxnLog<T>::TxnLog(const std::string& name) :
 
     PathName done = path_ + "/done";
     done.mkdir();
+
+    std::string txnLogType = Resource<std::string>("txnLogType;$ECKIT_TXN_LOG_TYPE", "Files");
+
+    if (txnLogType == "Journal") {
+        journal_.reset(new TxnJournal(path_));
+    }
+    else if (txnLogType != "Files") {
+        std::ostringstream oss;
+        oss << "Invalid txnLogType : " << txnLogType << ", valid types are 'Files' and 'Journal'" << std::endl;
+        throw eckit::BadParameter(oss.str(), Here());
+    }
 }
 
 template <class T>
@@ -127,9 +142,30 @@ PathName TxnLog<T>::name(const T& event) {
     return path_ + "/" + s.str();
 }
 
+template <class T>
+std::string TxnLog<T>::encode(const T& event) {
+    Buffer buffer(1024);
+    ResizableMemoryStream s(buffer);
+    s << event;
+    return std::string(static_cast<const char*>(buffer), s.position());
+}
+
 
 template <class T>
 void TxnLog<T>::begin(T& event) {
+    if (journal_) {
+        {
+            AutoLock<TxnArray> lock(*nextID_);
+            if (event.transactionID() == 0)
+                event.transactionID(++(*nextID_)[0]);
+        }
+
+        // Outside the lock, so that concurrent transactions are synced together
+        std::string record = encode(event);
+        journal_->append(TxnJournal::BEGIN, event.transactionID(), record.data(), record.size());
+        return;
+    }
+
     AutoLock<TxnArray> lock(*nextID_);
 
     if (event.transactionID() == 0)
@@ -147,6 +183,12 @@ template <class T>
 void TxnLog<T>::update(const T& event) {
     // AutoLock<TxnArray > lock(*nextID_);
 
+    if (journal_) {
+        std::string record = encode(event);
+        journal_->append(TxnJournal::UPDATE, event.transactionID(), record.data(), record.size());
+        return;
+    }
+
     PathName path = name(event);
     PathName next = path + ".tmp";
     {
@@ -159,6 +201,13 @@ void TxnLog<T>::update(const T& event) {
 
 template <class T>
 void TxnLog<T>::end(T& event, bool backup) {
+    if (journal_) {
+        // The backup is appended to done/ when the journal is compacted
+        std::string record = backup ? encode(event) : std::string();
+        journal_->append(TxnJournal::END, event.transactionID(), record.data(), record.size());
+        return;
+    }
+
     AutoLock<TxnArray> lock(*nextID_);
 
     PathName path = name(event);
@@ -181,6 +230,10 @@ void TxnLog<T>::end(T& event, bool backup) {
 
 template <class T>
 bool TxnLog<T>::exists(T& event) {
+    if (journal_) {
+        return journal_->active(event.transactionID());
+    }
+
     PathName path = name(event);
     return path.exists();
 }
@@ -190,19 +243,42 @@ class RecoverThread : public Thread {
     TxnArray& nextID_;
     TxnRecoverer<T>& client_;
     std::vector<PathName> result_;
+    std::vector<TxnJournal::Entry> entries_;
     long age_;
     time_t now_;
     virtual void run();
 
 public:
-    RecoverThread(const PathName&, TxnArray&, TxnRecoverer<T>&, long);
+    RecoverThread(const PathName&, TxnArray&, const TxnJournal*, TxnRecoverer<T>&, long);
     void recover();
 };
 
 template <class T>
-RecoverThread<T>::RecoverThread(const PathName& path, TxnArray& nextID, TxnRecoverer<T>& client, long age) :
+RecoverThread<T>::RecoverThread(const PathName& path, TxnArray& nextID, const TxnJournal* journal,
+                                TxnRecoverer<T>& client, long age) :
     nextID_(nextID), client_(client), age_(age), now_(::time(0)) {
     AutoLock<TxnArray> lock(nextID_);
+
+    if (journal) {
+        TxnJournal::Entries entries;
+        journal->scan(entries);
+
+        // Already by ID
+        for (const auto& e : entries) {
+            if (e.second.active) {
+                entries_.push_back(e.second);
+            }
+        }
+        Log::info() << entries_.size() << " task(s) found in journal" << std::endl;
+
+        if (entries.size()) {
+            TxnID id = entries.rbegin()->first;
+            if (id >= nextID_[0])
+                nextID_[0] = id + 1;
+        }
+        return;
+    }
+
     PathName::match(path + "/[0-9]*", result_);
 
     // Sort by ID to preserve order
@@ -246,16 +322,37 @@ void RecoverThread<T>::recover() {
                 Log::error() << "** Exception is ignored" << std::endl;
             }
     }
+
+    for (const auto& entry : entries_) {
+        time_t created = (entry.created ? entry.created : entry.time) / 1000000000;
+
+        if (now_ - created < age_)
+            Log::info() << "Skipping transaction " << entry.id << ", created " << Seconds(now_ - created) << " ago."
+                        << std::endl;
+        else
+            try {
+                MemoryStream log(entry.payload.data(), entry.payload.size());
+                T* task = Reanimator<T>::reanimate(log);
+                if (task) {
+                    ASSERT(task->transactionID() < nextID_[0]);
+                    client_.push(task);
+                }
+            }
+            catch (std::exception& e) {
+                Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+                Log::error() << "** Exception is ignored" << std::endl;
+            }
+    }
 }
 
 template <class T>
 void TxnLog<T>::recover(TxnRecoverer<T>& client, bool inThread, long age) {
     if (inThread) {
-        ThreadControler c(new RecoverThread<T>(path_, *nextID_, client, age));
+        ThreadControler c(new RecoverThread<T>(path_, *nextID_, journal_.get(), client, age));
         c.start();
     }
     else {
-        RecoverThread<T> r(path_, *nextID_, client, age);
+        RecoverThread<T> r(path_, *nextID_, journal_.get(), client, age);
         r.recover();
     }
 }
@@ -263,9 +360,14 @@ void TxnLog<T>::recover(TxnRecoverer<T>& client, bool inThread, long age) {
 template <class T>
 void TxnLog<T>::find(TxnFinder<T>& r) {
 
-    // Look for active transactions
+    // Look for active transactions, and with a journal the ended ones not yet compacted into done/
 
-    if (r.active()) {
+    if (journal_) {
+        if (findInJournal(r)) {
+            return;
+        }
+    }
+    else if (r.active()) {
 
         PathName path = path_ + "/[0-9]*";
         std::vector<PathName> active;
@@ -342,6 +444,67 @@ void TxnLog<T>::find(TxnFinder<T>& r) {
     }
 }
 
+template <class T>
+bool TxnLog<T>::findInJournal(TxnFinder<T>& r) {
+    if (!r.active() && !r.old()) {
+        return false;
+    }
+
+    TxnJournal::Entries entries;
+    journal_->scan(entries);
+
+    std::vector<const TxnJournal::Entry*> active;
+    std::vector<const TxnJournal::Entry*> ended;
+    for (const auto& e : entries) {
+        if (e.second.active) {
+            active.push_back(&e.second);
+        }
+        else if (!e.second.payload.empty()) {
+            ended.push_back(&e.second);
+        }
+    }
+
+    // Most recent first, as with the done/ files
+    std::sort(ended.begin(), ended.end(),
+              [](const TxnJournal::Entry* a, const TxnJournal::Entry* b) { return a->time > b->time; });
+
+    LOG_DEBUG_LIB(LibEcKit) << "TxnLog found " << active.size() << " active and " << ended.size()
+                            << " ended transaction(s) in journal" << std::endl;
+
+    std::vector<const TxnJournal::Entry*> search;
+    if (r.active()) {
+        search.insert(search.end(), active.begin(), active.end());
+    }
+    if (r.old()) {
+        search.insert(search.end(), ended.begin(), ended.end());
+    }
+
+    for (const TxnJournal::Entry* entry : search) {
+        try {
+            MemoryStream log(entry->payload.data(), entry->payload.size());
+            std::unique_ptr<T> task(Reanimator<T>::reanimate(log));
+            if (task) {
+                LOG_DEBUG_LIB(LibEcKit) << "Task found - id: " << task->transactionID() << " task: " << *task
+                                        << std::endl;
+                if (r.found(*task)) {
+                    return true;
+                }
+            }
+        }
+        catch (Abort& e) {
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is re-thrown" << std::endl;
+            throw;
+        }
+        catch (std::exception& e) {
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is ignored" << std::endl;
+        }
+    }
+
+    return false;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit
@@ -15,6 +15,8 @@
 #ifndef eckit_TxnLog_h
 #define eckit_TxnLog_h
 
+#include <memory>
+
 #include "eckit/filesystem/PathName.h"
 #include "eckit/runtime/Main.h"
 #include "eckit/transaction/TxnEvent.h"
@@ -45,7 +47,12 @@ struct TxnFinder {
 
 
 class TxnArray;
+class TxnJournal;
+
 
+/// Active transactions are kept under ~/txn/<name>, and the ended ones appended to done/<date> when backed up.
+/// By default each active transaction is a file, with resource txnLogType set to 'Journal' they are records of an
+/// append-only journal instead, synced in groups (see TxnJournal)
 
 template <class T>
 class TxnLog {
@@ -77,6 +84,10 @@ private:
 
     PathName name(const T& event);
 
+    static std::string encode(const T& event);
+
+    bool findInJournal(TxnFinder<T>&);
+
     static PathName buildPath(const std::string& name);
 
     // -- Members
@@ -84,6 +95,7 @@ private:
     PathName path_;
     PathName next_;     // Should be declared after 'path_'
     TxnArray* nextID_;  // Should be declared after 'next_'
+    std::unique_ptr<TxnJournal> journal_;
 };
 
 
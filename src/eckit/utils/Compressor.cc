@@ -64,15 +64,19 @@ void CompressorFactory::list(std::ostream& out) {
     }
 }
 
-Compressor* CompressorFactory::build() {
+std::string CompressorFactory::defaultCompression() {
 
     std::string compression = eckit::Resource<std::string>("defaultCompression;ECKIT_DEFAULT_COMPRESSION", "snappy");
 
     if (has(compression)) {
-        return build(compression);
+        return StringTools::lower(compression);
     }
 
-    return build("none");
+    return "none";
+}
+
+Compressor* CompressorFactory::build() {
+    return build(defaultCompression());
 }
 
 Compressor* CompressorFactory::build(const std::string& name) {
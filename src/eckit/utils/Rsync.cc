@@ -9,14 +9,25 @@
  */
 
 #include <librsync.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/filesystem/TmpFile.h"
 #include "eckit/io/Buffer.h"
 #include "eckit/io/DataHandle.h"
+#include "eckit/io/EmptyHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/PeekHandle.h"
 #include "eckit/io/StdFile.h"
 #include "eckit/log/Log.h"
 #include "eckit/utils/Tokenizer.h"
@@ -132,7 +143,8 @@ static rs_result drainOutputBuffer(rs_job_t* job, rs_buffers_t* buffers, void* o
     return RS_DONE;
 }
 
-static void runStreamedJob(rs_job_t* job, DataHandle* input, size_t ibuf_size, DataHandle* output, size_t obuf_size) {
+static void runStreamedJob(rs_job_t* job, DataHandle* input, size_t ibuf_size, DataHandle* output, size_t obuf_size,
+                           rs_stats_t* stats = nullptr) {
 
     Buffer ibuf(ibuf_size);
     handle_with_buffer ihwb = {input, &ibuf};
@@ -141,8 +153,156 @@ static void runStreamedJob(rs_job_t* job, DataHandle* input, size_t ibuf_size, D
     handle_with_buffer ohwb = {output, &obuf};
 
     rs_buffers_t buf;
-    RSCALL(rs_job_drive(job, &buf, input ? fillInputBuffer : nullptr, input ? static_cast<void*>(&ihwb) : nullptr,
-                        output ? drainOutputBuffer : nullptr, output ? static_cast<void*>(&ohwb) : nullptr));
+    rs_result res = rs_job_drive(job, &buf, input ? fillInputBuffer : nullptr, input ? static_cast<void*>(&ihwb) : nullptr,
+                                 output ? drainOutputBuffer : nullptr, output ? static_cast<void*>(&ohwb) : nullptr);
+
+    if (stats) {
+        *stats = *rs_job_statistics(job);
+    }
+
+    rs_job_free(job);
+    RSCALL(res);
+}
+
+/// Adds the statistics of the job of one segment to those of the whole file
+static void addStats(rs_stats_t& total, const rs_stats_t& stats) {
+    total.op = stats.op;
+    total.lit_cmds += stats.lit_cmds;
+    total.lit_bytes += stats.lit_bytes;
+    total.lit_cmdbytes += stats.lit_cmdbytes;
+    total.copy_cmds += stats.copy_cmds;
+    total.copy_bytes += stats.copy_bytes;
+    total.copy_cmdbytes += stats.copy_cmdbytes;
+    total.sig_cmds += stats.sig_cmds;
+    total.sig_bytes += stats.sig_bytes;
+    total.false_matches += stats.false_matches;
+    total.sig_blocks += stats.sig_blocks;
+    total.block_len = stats.block_len;
+    total.in_bytes += stats.in_bytes;
+    total.out_bytes += stats.out_bytes;
+    total.start = total.start ? std::min(total.start, stats.start) : stats.start;
+    total.end   = std::max(total.end, stats.end);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Segmented deltas are a sequence of librsync deltas, each against one segment of the base file:
+//   magic, number of segments
+//   for each segment: base offset, base length, delta length, delta
+
+static const char SEGMENTED_DELTA_MAGIC[] = {'E', 'C', 'K', 'I', 'T', 'R', 'S', 'D'};
+
+static void writeLength(DataHandle& out, unsigned long long value) {
+    unsigned char p[8];
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<unsigned char>(value & 0xff);
+        value >>= 8;
+    }
+    if (out.write(p, sizeof(p)) != sizeof(p)) {
+        throw WriteError("eckit::Rsync: failed to write segmented delta", Here());
+    }
+}
+
+static void readFully(DataHandle& in, void* buffer, size_t length) {
+    char* p     = static_cast<char*>(buffer);
+    size_t done = 0;
+    while (done < length) {
+        long len = in.read(p + done, length - done);
+        if (len <= 0) {
+            throw ReadError("eckit::Rsync: unexpected end of segmented delta", Here());
+        }
+        done += len;
+    }
+}
+
+static unsigned long long readLength(DataHandle& in) {
+    unsigned char p[8];
+    readFully(in, p, sizeof(p));
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+/// Runs f(0) ... f(n-1) on up to threads workers, rethrows the first exception
+template <typename F>
+static void parallelFor(size_t n, size_t threads, F f) {
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mutex;
+
+    auto work = [&] {
+        size_t i;
+        while (!failed && (i = next++) < n) {
+            try {
+                f(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::min(threads, n); ++t) {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/// Part of a file handle, as seen by a librsync patch job
+struct Segment {
+    DataHandle* handle;
+    unsigned long long offset;
+    unsigned long long length;
+};
+
+static rs_result readSegment(void* opaque, rs_long_t pos, size_t* len, void** buf) {
+    try {
+        Segment* s = reinterpret_cast<Segment*>(opaque);
+        if (static_cast<unsigned long long>(pos) >= s->length)
+            return RS_INPUT_ENDED;
+
+        s->handle->seek(s->offset + pos);
+
+        long rlen = s->handle->read(*buf, std::min<unsigned long long>(*len, s->length - pos));
+        if (rlen == 0)
+            return RS_INPUT_ENDED;
+
+        *len = rlen;
+    }
+    catch (std::exception& e) {
+        Log::error() << "eckit::Rsync: exception during read: " << e.what() << std::endl;
+        return RS_IO_ERROR;
+    }
+    catch (...) {
+        Log::error() << "eckit::Rsync: unknown exception during read" << std::endl;
+        return RS_IO_ERROR;
+    }
+
+    return RS_DONE;
+}
+
+static DataHandle* segmentHandle(const PathName& path, unsigned long long offset, unsigned long long length) {
+    if (length == 0) {
+        return new EmptyHandle();
+    }
+    return path.partHandle(offset, length);
 }
 
 
@@ -173,8 +333,36 @@ private:
     rs_signature_t* signature_;
 };
 
+static size_t defaultThreads() {
+    static long threads = Resource<long>("rsyncThreads;$ECKIT_RSYNC_THREADS", 1);
+    return std::max(threads, 1L);
+}
+
+static size_t defaultSegmentSize() {
+    static long segmentSize = Resource<long>("rsyncSegmentSize;$ECKIT_RSYNC_SEGMENT_SIZE", 256 * 1024 * 1024);
+    return segmentSize;
+}
+
+/// Segments must hold whole blocks, so that signatures line up with the unsegmented ones
+static size_t wholeBlocks(size_t segmentSize, size_t blockLen) {
+    return std::max<size_t>(segmentSize / blockLen, 1) * blockLen;
+}
+
 Rsync::Rsync(bool statistics) :
-    block_len_(RS_DEFAULT_BLOCK_LEN), strong_len_(0), statistics_(statistics) {}
+    block_len_(RS_DEFAULT_BLOCK_LEN),
+    strong_len_(0),
+    threads_(defaultThreads()),
+    segmentSize_(wholeBlocks(defaultSegmentSize(), block_len_)),
+    compareContents_(Resource<bool>("rsyncCompareContents;$ECKIT_RSYNC_COMPARE_CONTENTS", false)),
+    statistics_(statistics) {}
+
+Rsync::Rsync(bool statistics, size_t threads, size_t segmentSize) :
+    block_len_(RS_DEFAULT_BLOCK_LEN),
+    strong_len_(0),
+    threads_(std::max<size_t>(threads, 1)),
+    segmentSize_(wholeBlocks(segmentSize ? segmentSize : defaultSegmentSize(), block_len_)),
+    compareContents_(Resource<bool>("rsyncCompareContents;$ECKIT_RSYNC_COMPARE_CONTENTS", false)),
+    statistics_(statistics) {}
 
 Rsync::~Rsync() {}
 
@@ -192,6 +380,11 @@ void Rsync::syncData(const PathName& source, const PathName& target) {
         Log::debug<LibEcKit>() << "Rsync::syncData(source=" << source.fullName() << ", target=" << target.fullName()
                                << ")" << std::endl;
 
+    if (threads_ > 1 && size_t(source.size()) > segmentSize_) {
+        syncSegments(source, target);
+        return;
+    }
+
     rs_stats_t stats;
 
     target.touch();
@@ -256,15 +449,17 @@ void Rsync::syncRecursive(const PathName& source, const PathName& target) {
     ASSERT(source.isDir());
     target.mkdir();
 
+    // Directories are visited before their content, so they can be created as the tree is read
     std::vector<PathName> files;
-    std::vector<PathName> dirs;
-    source.childrenRecursive(files, dirs);
-
-    for (const auto& dir : dirs) {
-        PathName rebased = rebasePath(dir, source, target);
+    source.walk([&](const PathName& path, bool dir) {
+        if (!dir) {
+            files.push_back(path);
+            return;
+        }
+        PathName rebased = rebasePath(path, source, target);
         Log::debug<LibEcKit>() << "Making sure directory " << rebased << " exists" << std::endl;
         rebased.mkdir();
-    }
+    });
 
     for (const auto& file : files) {
         if (file.isLink()) {
@@ -299,21 +494,204 @@ bool Rsync::shouldUpdate(const PathName& source, const PathName& target) {
     if (source.size() != target.size())
         return true;
 
+    if (compareContents_)
+        return !sameContents(source, target);
+
     if (source.lastModified() > target.lastModified())
         return true;
 
     return false;
 }
 
+size_t Rsync::segments(const PathName& path) const {
+    unsigned long long size = path.size();
+    return (size + segmentSize_ - 1) / segmentSize_;
+}
+
+bool Rsync::sameContents(const PathName& source, const PathName& target) {
+    if (source.size() != target.size())
+        return false;
+
+    unsigned long long size = source.size();
+    std::atomic<bool> same{true};
+
+    parallelFor(segments(source), threads_, [&](size_t i) {
+        const size_t bufsize         = 4 * 1024 * 1024;
+        unsigned long long offset    = i * segmentSize_;
+        unsigned long long remaining = std::min<unsigned long long>(segmentSize_, size - offset);
+
+        std::unique_ptr<DataHandle> lhs(source.partHandle(offset, remaining));
+        std::unique_ptr<DataHandle> rhs(target.partHandle(offset, remaining));
+
+        lhs->openForRead();
+        AutoClose closer1(*lhs);
+        rhs->openForRead();
+        AutoClose closer2(*rhs);
+
+        Buffer lbuf(bufsize);
+        Buffer rbuf(bufsize);
+
+        while (same && remaining > 0) {
+            size_t len = std::min<unsigned long long>(bufsize, remaining);
+            readFully(*lhs, lbuf, len);
+            readFully(*rhs, rbuf, len);
+            if (::memcmp(lbuf, rbuf, len) != 0) {
+                same = false;
+            }
+            remaining -= len;
+        }
+    });
+
+    return same;
+}
+
+void Rsync::segmentDelta(const PathName& base, const PathName& source, size_t segment, DataHandle& output,
+                         rs_stats* signatureStats, rs_stats* deltaStats) {
+    unsigned long long offset     = segment * segmentSize_;
+    unsigned long long baseSize   = base.size();
+    unsigned long long sourceSize = source.size();
+
+    unsigned long long baseLength   = offset < baseSize ? std::min<unsigned long long>(segmentSize_, baseSize - offset) : 0;
+    unsigned long long sourceLength = std::min<unsigned long long>(segmentSize_, sourceSize - offset);
+
+    MemoryHandle signature;
+    {
+        std::unique_ptr<DataHandle> in(segmentHandle(base, offset, baseLength));
+        in->openForRead();
+        AutoClose closer(*in);
+        signature.openForWrite(0);
+        computeSignature(*in, signature, signatureStats);
+        signature.close();
+    }
+
+    std::unique_ptr<DataHandle> in(segmentHandle(source, offset, sourceLength));
+    in->openForRead();
+    AutoClose closer(*in);
+    signature.openForRead();
+    AutoClose closer2(signature);
+    computeDelta(signature, *in, output, deltaStats);
+}
+
+void Rsync::syncSegments(const PathName& source, const PathName& target) {
+    unsigned long long size = source.size();
+
+    target.touch();
+
+    PathName patched = PathName::unique(target);
+    Log::debug<LibEcKit>() << "Rsync::syncData using " << segments(source) << " segments, " << threads_
+                           << " threads and temporary output file " << patched << std::endl;
+
+    patched.touch();
+    patched.truncate(size);
+
+    rs_stats_t signatureStats{};
+    rs_stats_t deltaStats{};
+    rs_stats_t patchStats{};
+    std::mutex mutex;
+
+    // Each segment of the source is rebuilt from the same segment of the target and written in place
+
+    parallelFor(segments(source), threads_, [&](size_t i) {
+        unsigned long long offset     = i * segmentSize_;
+        unsigned long long targetSize = target.size();
+
+        rs_stats_t stats[3];
+
+        MemoryHandle delta;
+        delta.openForWrite(0);
+        segmentDelta(target, source, i, delta, &stats[0], &stats[1]);
+        delta.close();
+        delta.openForRead();
+        AutoClose closer1(delta);
+
+        FileHandle base(target);
+        base.openForRead();
+        AutoClose closer2(base);
+
+        Segment segment{&base, offset,
+                        offset < targetSize ? std::min<unsigned long long>(segmentSize_, targetSize - offset) : 0};
+
+        FileHandle out(patched, true);
+        out.openForWrite(size);
+        AutoClose closer3(out);
+        out.seek(offset);
+
+        rs_job_t* job = rs_patch_begin(readSegment, static_cast<void*>(&segment));
+        runStreamedJob(job, &delta, 64 * 1024, &out, 64 * 1024, &stats[2]);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        addStats(signatureStats, stats[0]);
+        addStats(deltaStats, stats[1]);
+        addStats(patchStats, stats[2]);
+    });
+
+    std::ostream& os = statistics_ ? Log::info() : Log::debug<LibEcKit>();
+    logStats(&signatureStats, os);
+    logStats(&deltaStats, os);
+    logStats(&patchStats, os);
+
+    PathName::rename(patched, target);
+}
+
+void Rsync::computeSegmentedDelta(const PathName& base, const PathName& source, DataHandle& output) {
+    size_t n = segments(source);
+
+    std::vector<std::unique_ptr<TmpFile> > deltas(n);
+
+    parallelFor(n, threads_, [&](size_t i) {
+        deltas[i].reset(new TmpFile(false));
+        FileHandle out(*deltas[i]);
+        out.openForWrite(0);
+        AutoClose closer(out);
+        segmentDelta(base, source, i, out);
+    });
+
+    unsigned long long baseSize = base.size();
+
+    if (output.write(SEGMENTED_DELTA_MAGIC, sizeof(SEGMENTED_DELTA_MAGIC)) != sizeof(SEGMENTED_DELTA_MAGIC)) {
+        throw WriteError("eckit::Rsync: failed to write segmented delta", Here());
+    }
+    writeLength(output, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        unsigned long long offset = i * segmentSize_;
+        writeLength(output, offset);
+        writeLength(output, offset < baseSize ? std::min<unsigned long long>(segmentSize_, baseSize - offset) : 0);
+        writeLength(output, deltas[i]->size());
+
+        std::unique_ptr<DataHandle> in(deltas[i]->fileHandle());
+        in->openForRead();
+        AutoClose closer(*in);
+
+        Buffer buffer(64 * 1024);
+        long len;
+        while ((len = in->read(buffer, buffer.size())) > 0) {
+            if (output.write(buffer, len) != len) {
+                throw WriteError("eckit::Rsync: failed to write segmented delta", Here());
+            }
+        }
+
+        deltas[i].reset();
+    }
+}
+
 void Rsync::computeSignature(DataHandle& input, DataHandle& output) {
-    rs_job_t* job = rs_sig_begin(block_len_, strong_len_, RS_RK_BLAKE2_SIG_MAGIC);
-    runStreamedJob(job, &input, 4 * block_len_, &output, 12 + 4 * (4 + strong_len_));
+    computeSignature(input, output, nullptr);
 }
 
 void Rsync::computeDelta(DataHandle& signature, DataHandle& input, DataHandle& output) {
+    computeDelta(signature, input, output, nullptr);
+}
+
+void Rsync::computeSignature(DataHandle& input, DataHandle& output, rs_stats* stats) {
+    rs_job_t* job = rs_sig_begin(block_len_, strong_len_, RS_RK_BLAKE2_SIG_MAGIC);
+    runStreamedJob(job, &input, 4 * block_len_, &output, 12 + 4 * (4 + strong_len_), stats);
+}
+
+void Rsync::computeDelta(DataHandle& signature, DataHandle& input, DataHandle& output, rs_stats* stats) {
     Signature sig(signature);
     rs_job_t* job = rs_delta_begin(sig);
-    runStreamedJob(job, &input, block_len_, &output, 10 + 4 * block_len_);
+    runStreamedJob(job, &input, block_len_, &output, 10 + 4 * block_len_, stats);
 }
 
 
@@ -341,8 +719,34 @@ static rs_result readDataHandle(void* opaque, rs_long_t pos, size_t* len, void**
 }
 
 void Rsync::updateData(DataHandle& input, DataHandle& delta, DataHandle& output) {
-    rs_job_t* job = rs_patch_begin(readDataHandle, static_cast<void*>(&input));
-    runStreamedJob(job, &delta, 64 * 1024, &output, 64 * 1024);
+    PeekHandle peek(delta);
+
+    char magic[sizeof(SEGMENTED_DELTA_MAGIC)];
+    if (peek.peek(magic, sizeof(magic)) != sizeof(magic) ||
+        ::memcmp(magic, SEGMENTED_DELTA_MAGIC, sizeof(magic)) != 0) {
+        rs_job_t* job = rs_patch_begin(readDataHandle, static_cast<void*>(&input));
+        runStreamedJob(job, &peek, 64 * 1024, &output, 64 * 1024);
+        return;
+    }
+
+    peek.skip(sizeof(magic));
+
+    unsigned long long n = readLength(peek);
+    for (unsigned long long i = 0; i < n; ++i) {
+        Segment segment{&input, 0, 0};
+        segment.offset = readLength(peek);
+        segment.length = readLength(peek);
+
+        Buffer buffer(size_t(readLength(peek)));
+        readFully(peek, buffer, buffer.size());
+
+        MemoryHandle dlt(buffer.data(), buffer.size());
+        dlt.openForRead();
+        AutoClose closer(dlt);
+
+        rs_job_t* job = rs_patch_begin(readSegment, static_cast<void*>(&segment));
+        runStreamedJob(job, &dlt, 64 * 1024, &output, 64 * 1024);
+    }
 }
 
 }  // namespace eckit
@@ -11,6 +11,10 @@
 #ifndef eckit_utils_Rsync_H
 #define eckit_utils_Rsync_H
 
+#include <cstddef>
+
+struct rs_stats;
+
 namespace eckit {
 
 class DataHandle;
@@ -21,21 +25,50 @@ class Rsync {
 public:  // methods
     Rsync(bool statistics = false);
 
+    /// @param threads number of workers used on files larger than one segment
+    /// @param segmentSize files are split into independent segments of this size, 0 for the default
+    Rsync(bool statistics, size_t threads, size_t segmentSize = 0);
+
     ~Rsync();
 
     void syncData(const PathName& source, const PathName& target);
     void syncRecursive(const PathName& source, const PathName& target);
 
+    /// @note with rsyncCompareContents, files of the same size are compared byte by byte instead of by date
     bool shouldUpdate(const PathName& source, const PathName& target);
 
+    /// Compares two files byte by byte, segments are compared in parallel
+    bool sameContents(const PathName& source, const PathName& target);
+
     void computeSignature(DataHandle& input, DataHandle& output);
     void computeDelta(DataHandle& signature, DataHandle& input, DataHandle& output);
+
+    /// Computes the signatures and deltas of each segment of source against the same segment of base in
+    /// parallel, and merges them into a segmented delta which updateData() understands
+    void computeSegmentedDelta(const PathName& base, const PathName& source, DataHandle& output);
+
+    /// Applies a delta, either a librsync delta or a segmented delta, to input
+    /// @pre input must be seekable
     void updateData(DataHandle& input, DataHandle& delta, DataHandle& output);
 
+private:  // methods
+    void syncSegments(const PathName& source, const PathName& target);
+    void segmentDelta(const PathName& base, const PathName& source, size_t segment, DataHandle& output,
+                      rs_stats* signatureStats = nullptr, rs_stats* deltaStats = nullptr);
+
+    void computeSignature(DataHandle& input, DataHandle& output, rs_stats*);
+    void computeDelta(DataHandle& signature, DataHandle& input, DataHandle& output, rs_stats*);
+
+    size_t segments(const PathName&) const;
+
 private:  // members
     size_t block_len_;
     size_t strong_len_;
 
+    size_t threads_;
+    size_t segmentSize_;
+    bool compareContents_;
+
     bool statistics_;
 };
 
@@ -0,0 +1,247 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#define XXH_INLINE_ALL
+#include "eckit/contrib/xxhash/xxhash.h"
+
+#include "eckit/utils/WeightedRendezvousHash.h"
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Finalisation step of MurmurHash3, a bijection with full avalanche
+inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t nodeSeed(const std::string& node) {
+    return XXH64(node.data(), node.size(), 0);
+}
+
+void checkWeight(double weight) {
+    if (!(weight >= 0) || std::isinf(weight)) {
+        std::ostringstream oss;
+        oss << "WeightedRendezvousHash: invalid node weight " << weight;
+        throw BadParameter(oss.str(), Here());
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+WeightedRendezvousHash::WeightedRendezvousHash() {}
+
+WeightedRendezvousHash::WeightedRendezvousHash(const std::vector<Node>& nodes) {
+    for (const auto& node : nodes) {
+        addNode(node);
+    }
+}
+
+WeightedRendezvousHash::WeightedRendezvousHash(const std::vector<std::pair<Node, double> >& nodes) {
+    for (const auto& node : nodes) {
+        addNode(node.first, node.second);
+    }
+}
+
+WeightedRendezvousHash::~WeightedRendezvousHash() {}
+
+uint64_t WeightedRendezvousHash::hashKey(const Key& key) {
+    static const char separator = 0;
+
+    XXH64_state_t state;
+    XXH64_reset(&state, 0);
+
+    for (const auto& kv : key) {
+        XXH64_update(&state, kv.first.data(), kv.first.size());
+        XXH64_update(&state, &separator, 1);
+        XXH64_update(&state, kv.second.data(), kv.second.size());
+        XXH64_update(&state, &separator, 1);
+    }
+
+    return XXH64_digest(&state);
+}
+
+size_t WeightedRendezvousHash::jumpHash(uint64_t hash, size_t buckets) {
+    ASSERT(buckets > 0);
+
+    int64_t b = -1;
+    int64_t j = 0;
+
+    while (j < static_cast<int64_t>(buckets)) {
+        b    = j;
+        hash = hash * 2862933555777941757ULL + 1;
+        j    = static_cast<int64_t>((b + 1) * (double(1LL << 31) / double((hash >> 33) + 1)));
+    }
+
+    return static_cast<size_t>(b);
+}
+
+double WeightedRendezvousHash::score(uint64_t keyHash, size_t node) const {
+    if (weights_[node] == 0) {
+        return 0;
+    }
+
+    // Map the top 53 bits onto (0,1), both ends excluded
+    double u = (double(mix(keyHash ^ seeds_[node]) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+
+    return -weights_[node] / std::log(u);
+}
+
+void WeightedRendezvousHash::checkNotEmpty() const {
+    if (nodes_.empty()) {
+        throw BadParameter("Cannot return hashed order with no nodes", Here());
+    }
+}
+
+size_t WeightedRendezvousHash::select(const Key& key) {
+    uint64_t h = hashKey(key);
+
+    AutoLock<Mutex> lock(mutex_);
+    return selectInternal(h);
+}
+
+WeightedRendezvousHash::Node WeightedRendezvousHash::selectNode(const Key& key) {
+    uint64_t h = hashKey(key);
+
+    AutoLock<Mutex> lock(mutex_);
+    return nodes_[selectInternal(h)];
+}
+
+size_t WeightedRendezvousHash::selectInternal(uint64_t keyHash) const {
+
+    // n.b. Does not do locking. That is delegated to the public calling functions.
+
+    checkNotEmpty();
+
+    size_t best      = 0;
+    double bestScore = score(keyHash, 0);
+
+    for (size_t i = 1; i < nodes_.size(); ++i) {
+        double s = score(keyHash, i);
+        if (s > bestScore) {
+            best      = i;
+            bestScore = s;
+        }
+    }
+
+    return best;
+}
+
+void WeightedRendezvousHash::hashOrder(const Key& key, std::vector<Node>& nodes) {
+    // Scratch space of the calling thread, kept between calls
+    static thread_local std::vector<size_t> indices;
+
+    uint64_t h = hashKey(key);
+
+    AutoLock<Mutex> lock(mutex_);
+    hashOrderInternal(h, indices);
+
+    nodes.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        nodes[i] = nodes_[indices[i]];
+    }
+}
+
+void WeightedRendezvousHash::hashOrder(const Key& key, std::vector<size_t>& indices) {
+    uint64_t h = hashKey(key);
+
+    AutoLock<Mutex> lock(mutex_);
+    hashOrderInternal(h, indices);
+}
+
+void WeightedRendezvousHash::hashOrderInternal(uint64_t keyHash, std::vector<size_t>& indices) {
+
+    // n.b. Does not do locking. That is delegated to the public calling functions.
+
+    checkNotEmpty();
+
+    scores_.resize(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        scores_[i] = score(keyHash, i);
+    }
+
+    indices.resize(nodes_.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    const std::vector<double>& scores = scores_;
+    std::sort(indices.begin(), indices.end(), [&scores](size_t lhs, size_t rhs) {
+        return scores[lhs] > scores[rhs] || (scores[lhs] == scores[rhs] && lhs < rhs);
+    });
+}
+
+bool WeightedRendezvousHash::addNode(const Node& node, double weight) {
+    checkWeight(weight);
+
+    AutoLock<Mutex> lock(mutex_);
+
+    auto it = std::find(nodes_.begin(), nodes_.end(), node);
+    if (it == nodes_.end()) {
+        nodes_.push_back(node);
+        seeds_.push_back(nodeSeed(node));
+        weights_.push_back(weight);
+        return true;
+    }
+
+    return false;
+}
+
+bool WeightedRendezvousHash::removeNode(const Node& node) {
+    AutoLock<Mutex> lock(mutex_);
+
+    auto it = std::find(nodes_.begin(), nodes_.end(), node);
+    if (it != nodes_.end()) {
+        size_t i = it - nodes_.begin();
+        nodes_.erase(it);
+        seeds_.erase(seeds_.begin() + i);
+        weights_.erase(weights_.begin() + i);
+        return true;
+    }
+
+    return false;
+}
+
+bool WeightedRendezvousHash::setWeight(const Node& node, double weight) {
+    checkWeight(weight);
+
+    AutoLock<Mutex> lock(mutex_);
+
+    auto it = std::find(nodes_.begin(), nodes_.end(), node);
+    if (it != nodes_.end()) {
+        weights_[it - nodes_.begin()] = weight;
+        return true;
+    }
+
+    return false;
+}
+
+size_t WeightedRendezvousHash::size() {
+    AutoLock<Mutex> lock(mutex_);
+    return nodes_.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
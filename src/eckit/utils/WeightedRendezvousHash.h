@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_utils_WeightedRendezvousHash_H
+#define eckit_utils_WeightedRendezvousHash_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Weighted Rendezvous or Highest Random Weight (HRW) hashing, built for throughput.
+///
+/// Unlike RendezvousHash, the key is not flattened into a string and no digest strings are produced: the key is
+/// hashed once with a streaming 64-bit xxHash, then combined with a precomputed per-node seed through an integer
+/// mixing function. Each node carries a weight, and the score of a node is -weight / ln(u), with u the combined
+/// hash mapped to (0,1), so that the share of keys placed on a node is proportional to its weight.
+///
+/// Selecting the rendezvous node does not allocate. Computing the full order reuses the storage of the vector
+/// passed in, and of a scratch vector per thread.
+///
+/// It is thread-safe, in terms that threads can add and remove nodes whilst others compute the rendezvous node.
+
+class WeightedRendezvousHash : private eckit::NonCopyable {
+
+public:  // types
+    typedef std::string Node;
+
+    typedef std::map<std::string, std::string> Key;
+
+public:  // methods
+    WeightedRendezvousHash();
+
+    WeightedRendezvousHash(const std::vector<Node>& nodes);
+
+    WeightedRendezvousHash(const std::vector<std::pair<Node, double> >& nodes);
+
+    ~WeightedRendezvousHash();
+
+    /// @returns the index of the rendezvous node for the given key
+    size_t select(const Key& key);
+
+    /// @returns the rendezvous node for the given key
+    Node selectNode(const Key& key);
+
+    /// Provide a list of nodes / indices in the list of nodes for the given key, by decreasing score
+    void hashOrder(const Key& key, std::vector<Node>& nodes);
+
+    void hashOrder(const Key& key, std::vector<size_t>& indices);
+
+    /// Adds node to node list. No effect if node already present
+    /// @returns true is node insertion was successful
+    bool addNode(const Node& node, double weight = 1.0);
+
+    /// Removes node from node list. No effect if node not present
+    /// @returns true is node removal was successful
+    bool removeNode(const Node& node);
+
+    /// Changes the weight of a node. No effect if node not present
+    /// @returns true if the node was found
+    bool setWeight(const Node& node, double weight);
+
+    size_t size();
+
+public:  // class methods
+    /// Hashes the key (names and values) without building intermediate strings
+    static uint64_t hashKey(const Key& key);
+
+    /// Jump consistent hash (Lamping & Veach), maps a 64-bit hash onto one of buckets without any table.
+    /// Suitable when nodes are numbered and only ever added or removed at the end of the range.
+    static size_t jumpHash(uint64_t hash, size_t buckets);
+
+private:  // methods
+    double score(uint64_t keyHash, size_t node) const;
+
+    size_t selectInternal(uint64_t keyHash) const;
+
+    void hashOrderInternal(uint64_t keyHash, std::vector<size_t>& indices);
+
+    void checkNotEmpty() const;
+
+private:  // members
+    eckit::Mutex mutex_;  //< protects addition and removal of nodes
+
+    std::vector<Node> nodes_;
+    std::vector<uint64_t> seeds_;
+    std::vector<double> weights_;
+
+    std::vector<double> scores_;  //< scratch space for hashOrder, protected by mutex_
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // end namespace eckit
+
+#endif
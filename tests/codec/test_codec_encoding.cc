@@ -647,6 +647,26 @@ CASE("Encode/Decode scalar") {
 
 // -------------------------------------------------------------------------------------------------------
 
+CASE("Metadata set/remove are seen by look-ups") {
+    codec::Metadata metadata;
+    metadata.set("type", "array");
+    metadata.set("shape", std::vector<int>{2, 3});
+    EXPECT(metadata.getString("type") == "array");
+    EXPECT(!metadata.has("datatype"));
+
+    LocalConfiguration other;
+    other.set("type", "scalar");
+    other.set("datatype", "real64");
+    metadata.set(other);
+    EXPECT(metadata.getString("type") == "scalar");
+    EXPECT(metadata.getString("datatype") == "real64");
+
+    metadata.remove("shape");
+    EXPECT(!metadata.has("shape"));
+}
+
+// -------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
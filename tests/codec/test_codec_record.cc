@@ -10,8 +10,11 @@
  */
 
 
+#include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <iterator>
+#include <string>
 #include <vector>
 
 #include "eckit/codec/codec.h"
@@ -451,6 +454,229 @@ CASE("Async read") {
 
 //-----------------------------------------------------------------------------
 
+template <typename T>
+bool equal(const codec::ArrayReference& ref, const std::vector<T>& v) {
+    return ref.datatype() == codec::make_datatype<T>() && ref.size() == v.size() &&
+           ::memcmp(ref.data(), v.data(), v.size() * sizeof(T)) == 0;
+}
+
+CASE("Read records through a mapping") {
+    SECTION("record2 in records.atlas" + suffix()) {
+        // not at the start of the file
+        codec::ArrayReference v1;
+        codec::ArrayReference v2;
+        Arrays data;
+        {
+            codec::RecordReader record(globals::records[1]);
+            record.mmap(true);
+            record.read("v1", v1);
+            record.read("v2", v2);
+            record.read("v3", data.v3);
+            record.wait();
+            record.verify();
+        }
+
+        // The references keep the mapping alive
+        EXPECT(equal(v1, globals::record2.data.v1));
+        EXPECT(equal(v2, globals::record2.data.v2));
+        EXPECT(::memcmp(data.v3.data(), globals::record2.data.v3.data(), data.v3.size() * sizeof(int)) == 0);
+    }
+
+    SECTION("links of record.atlas" + suffix()) {
+        Arrays data;
+        codec::ArrayReference v4;
+        codec::RecordReader record("record.atlas" + suffix());
+        record.mmap(true);
+        record.read("v1", data.v1);
+        record.read("v2", data.v2);
+        record.read("v3", data.v3);
+        record.read("v4", v4);
+        record.wait();
+        record.verify();
+
+        EXPECT(data == globals::record1.data);
+        EXPECT(equal(v4, globals::record2.data.v1));
+    }
+
+    SECTION("deferred checksum") {
+        const std::string path = "record_mmap.atlas" + suffix();
+        const std::vector<double> values{1.5, 2.5, 3.5, 4.5};
+        {
+            codec::RecordWriter record;
+            record.checksum(true);
+            record.set("v", codec::ref(values), no_compression);
+            record.write(path);
+        }
+
+        // corrupt the data section
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+            auto pos = content.find(std::string(reinterpret_cast<const char*>(values.data()), sizeof(double)));
+            EXPECT(pos != std::string::npos);
+            file.seekp(static_cast<std::streamoff>(pos));
+            file.put(static_cast<char>(content[pos] ^ 1));
+        }
+
+        codec::RecordReader record(path);
+        record.mmap(true);
+        record.checksum(true);
+        codec::ArrayReference v;
+        record.read("v", v);
+        EXPECT_NO_THROW(record.wait());
+        EXPECT(v.size() == values.size());
+        EXPECT_THROWS_AS(record.verify(), codec::DataCorruption);
+
+        // Copied into a vector, the checksum is verified straight away
+        codec::RecordReader copied(path);
+        copied.mmap(true);
+        copied.checksum(true);
+        std::vector<double> w;
+        copied.read("v", w);
+        EXPECT_THROWS_AS(copied.wait(), codec::DataCorruption);
+    }
+
+    SECTION("doubles after metadata of any length") {
+        const std::string path = "record_mmap_aligned.atlas" + suffix();
+        const std::vector<double> values{1.5, 2.5, 3.5, 4.5, 5.5};
+
+        for (size_t length = 1; length <= sizeof(double); ++length) {
+            {
+                codec::RecordWriter record;
+                record.set("name", std::string(length, 'x'));
+                record.set("v", codec::ref(values), no_compression);
+                record.write(path);
+            }
+
+            codec::ArrayReference v;
+            codec::ArrayReference again;
+            for (auto* ref : {&v, &again}) {
+                codec::RecordReader record(path);
+                record.mmap(true);
+                record.read("v", *ref);
+                record.wait();
+            }
+
+            // Read through a typed pointer, a view of a misaligned section would be undefined behaviour
+            const auto* d = static_cast<const double*>(v.data());
+            EXPECT(reinterpret_cast<std::uintptr_t>(d) % alignof(double) == 0);
+            EXPECT(v.size() == values.size());
+
+            // Data sections are aligned when written, both are views of the same mapping
+            EXPECT(again.data() == v.data());
+
+            double sum = 0;
+            for (size_t i = 0; i < v.size(); ++i) {
+                sum += d[i];
+            }
+            EXPECT(sum == 17.5);
+        }
+    }
+
+    SECTION("a file rewritten under the same path is mapped again") {
+        const std::string path = "record_mmap_rewritten.atlas" + suffix();
+
+        codec::ArrayReference first;
+        codec::ArrayReference second;
+        for (auto* v : {&first, &second}) {
+            const std::vector<int> values(v == &first ? 4 : 6, v == &first ? 1 : 2);
+            {
+                codec::RecordWriter record;
+                record.set("v", codec::ref(values), no_compression);
+                record.write(path);
+            }
+
+            // first keeps the old mapping alive
+            codec::RecordReader record(path);
+            record.mmap(true);
+            record.read("v", *v);
+            record.wait();
+            EXPECT(equal(*v, values));
+        }
+
+        EXPECT(first.size() == 4);
+        EXPECT(second.size() == 6);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("Read slices of arrays") {
+    const std::string path = "record_slices.atlas" + suffix();
+    const codec::ArrayShape shape{4, 5, 6};
+
+    std::vector<double> field(4 * 5 * 6);
+    for (size_t i = 0; i < field.size(); ++i) {
+        field[i] = static_cast<double>(i);
+    }
+
+    {
+        codec::RecordWriter record;
+        record.set("raw", codec::ArrayReference(field.data(), shape), no_compression);
+        record.set("compressed", codec::ArrayReference(field.data(), shape));
+        record.write(path);
+    }
+
+    auto expected = [&](const codec::ArraySlice& slice) {
+        std::vector<double> v;
+        for (size_t i = slice.offsets()[0]; i < slice.offsets()[0] + slice.counts()[0]; ++i) {
+            for (size_t j = slice.offsets()[1]; j < slice.offsets()[1] + slice.counts()[1]; ++j) {
+                for (size_t k = slice.offsets()[2]; k < slice.offsets()[2] + slice.counts()[2]; ++k) {
+                    v.push_back(field[(i * shape[1] + j) * shape[2] + k]);
+                }
+            }
+        }
+        return v;
+    };
+
+    const std::vector<codec::ArraySlice> slices{
+        {codec::ArrayShape{2, 0, 0}, codec::ArrayShape{1, 5, 6}},  // one level, contiguous
+        {codec::ArrayShape{1, 0, 0}, codec::ArrayShape{2, 5, 6}},  // two levels, contiguous
+        {codec::ArrayShape{0, 1, 2}, codec::ArrayShape{4, 3, 2}},  // strided
+        {codec::ArrayShape{3, 4, 5}, codec::ArrayShape{1, 1, 1}},  // one value
+        {codec::ArrayShape{0, 0, 0}, codec::ArrayShape{4, 5, 6}},  // everything
+    };
+
+    for (bool mmap : {false, true}) {
+        for (const std::string key : {"raw", "compressed"}) {
+            SECTION(key + (mmap ? " mmap" : "")) {
+                for (const auto& slice : slices) {
+                    std::vector<double> v;
+                    codec::RecordReader record(path);
+                    record.mmap(mmap);
+                    record.read(key, v, slice);
+                    record.wait();
+                    EXPECT(v == expected(slice));
+
+                    codec::ArrayReference ref;
+                    codec::RecordReader record_ref(path);
+                    record_ref.mmap(mmap);
+                    record_ref.read(key, ref, slice).wait();
+                    EXPECT(ref.shape() == slice.counts());
+                    EXPECT(equal(ref, expected(slice)));
+                }
+            }
+        }
+    }
+
+    SECTION("stream") {
+        codec::InputFileStream stream(path);
+        codec::RecordReader record(stream);
+        std::vector<double> v;
+        record.read("raw", v, slices[2]).wait();
+        EXPECT(v == expected(slices[2]));
+    }
+
+    SECTION("out of bounds") {
+        std::vector<double> v;
+        codec::RecordReader record(path);
+        record.read("raw", v, {codec::ArrayShape{3, 0, 0}, codec::ArrayShape{2, 5, 6}});
+        EXPECT_THROWS_AS(record.wait(), codec::Exception);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 CASE("Recursive Write/read records in nested subdirectories") {
     auto reference_path = eckit::PathName{"atlas_test_io_refpath"};
 
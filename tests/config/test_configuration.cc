@@ -390,6 +390,78 @@ CASE("test_local_configuration") {
     EXPECT(office == 3);
 }
 
+CASE("Look up with precompiled keys") {
+    LocalConfiguration local;
+    local.set("manager.name", "Sidonia");
+    local.set("manager.office", 1);
+    local.set("manager.desks", std::vector<long>{4, 5});
+    local.set("budget", 1.5);
+
+    const Configuration::Key name("manager.name");
+    const Configuration::Key office("manager.office");
+    const Configuration::Key desks("manager.desks");
+    const Configuration::Key missing("manager.phone");
+
+    EXPECT(local.getString(name) == "Sidonia");
+    EXPECT(local.getInt(office) == 1);
+    EXPECT(local.getDouble("budget") == 1.5);
+    EXPECT(local.getInt(missing, 42) == 42);
+    EXPECT(!local.has(missing));
+    EXPECT_THROWS(local.getString(missing));
+
+    std::vector<long> v;
+    EXPECT(local.get(desks, v));
+    EXPECT(v == (std::vector<long>{4, 5}));
+
+    // Names are split as before
+    EXPECT(local.getString(Configuration::Key(".manager..name.")) == "Sidonia");
+    EXPECT(local.getString(".manager..name.") == "Sidonia");
+    EXPECT(local.has(""));
+
+    // Going through something else than a map is handled as before
+    EXPECT(local.getLong("manager.desks.1") == 5);
+    EXPECT(local.getLong(Configuration::Key("manager.desks.1")) == 5);
+    EXPECT_THROWS(local.has("budget.x"));
+
+    SECTION("Changes are seen") {
+        LocalConfiguration copy(local);
+        EXPECT(copy.getInt(office) == 1);
+
+        copy.set("manager.office", 2);
+        copy.set("manager.phone", "1234");
+        EXPECT(copy.getInt(office) == 2);
+        EXPECT(copy.getString(missing) == "1234");
+
+        EXPECT(local.getInt(office) == 1);
+        EXPECT(!local.has(missing));
+    }
+
+    SECTION("Other separators") {
+        LocalConfiguration slashed('/');
+        slashed.set("manager/name", "Suske");
+        EXPECT(slashed.getString(Configuration::Key("manager/name", '/')) == "Suske");
+        EXPECT(slashed.getString(Configuration::Key("manager/name")) == "Suske");
+        EXPECT(!slashed.has(Configuration::Key("manager.name")));
+    }
+
+    SECTION("Sub-configurations") {
+        EXPECT(local.getString(name) == "Sidonia");
+
+        LocalConfiguration manager(local, "manager");
+        EXPECT(manager.getString("name") == "Sidonia");
+        EXPECT(manager.getInt(Configuration::Key("office")) == 1);
+        EXPECT(!manager.has("budget"));
+
+        manager.set("office", 3);
+        EXPECT(manager.getInt("office") == 3);
+        EXPECT(local.getInt(office) == 1);
+
+        EXPECT_THROWS(LocalConfiguration(local, "manager.phone"));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 CASE("Hash a configuration") {
     std::unique_ptr<Hash> h(eckit::HashFactory::instance().build("MD5"));
 
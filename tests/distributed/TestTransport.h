@@ -0,0 +1,175 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#pragma once
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "eckit/distributed/Consumer.h"
+#include "eckit/distributed/Message.h"
+#include "eckit/distributed/Producer.h"
+#include "eckit/distributed/Transport.h"
+#include "eckit/option/CmdArgs.h"
+
+#include "eckit/testing/Test.h"
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const size_t MAX_MESSAGES = 4096;
+
+/// How many times each message was processed, across the processes
+struct Processed {
+    std::atomic<uint32_t> count[MAX_MESSAGES];
+};
+
+class TestProducer : public distributed::Producer {
+public:
+    TestProducer(distributed::Transport& transport, size_t messages) :
+        Producer(transport), messages_(messages), next_(0), statistics_(0) {}
+
+    bool produce(distributed::Message& message) override {
+        if (next_ == messages_) {
+            return false;
+        }
+        message << next_++;
+        return true;
+    }
+
+    void messageFromWorker(distributed::Message& message, int) const override {
+        std::string ok;
+        message >> ok;
+        EXPECT(ok == "OK");
+        statistics_++;
+    }
+
+    void finalise() override {}
+
+    size_t statistics() const { return statistics_; }
+
+private:
+    size_t messages_;
+    size_t next_;
+    mutable size_t statistics_;
+};
+
+class TestConsumer : public distributed::Consumer {
+public:
+    TestConsumer(distributed::Transport& transport, Processed& processed, size_t killAfter) :
+        Consumer(transport), processed_(processed), killAfter_(killAfter), consumed_(0) {}
+
+    void getNextMessage(distributed::Message& message) const override { getNextWorkMessage(message); }
+
+    void consume(distributed::Message& message) override {
+        size_t i;
+        message >> i;
+        ASSERT(i < MAX_MESSAGES);
+        processed_.count[i]++;
+
+        ::usleep(500);
+
+        if (++consumed_ == killAfter_) {
+            ::kill(::getpid(), SIGKILL);
+        }
+    }
+
+    void finalise() override {}
+
+private:
+    Processed& processed_;
+    size_t killAfter_;
+    size_t consumed_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline void usage(const std::string&) {}
+
+/// A producer in this process and workers in forked ones, the transport is chosen by the options set by subclasses
+class Run {
+public:
+    Run() {
+        void* addr = ::mmap(nullptr, sizeof(Processed), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        ASSERT(addr != MAP_FAILED);
+        processed_ = new (addr) Processed();
+        for (auto& c : processed_->count) {
+            c = 0;
+        }
+    }
+
+    virtual ~Run() { ::munmap(processed_, sizeof(Processed)); }
+
+    /// A worker process, killed after processing killAfter messages if not 0
+    pid_t worker(size_t killAfter = 0) {
+        pid_t pid = ::fork();
+        ASSERT(pid >= 0);
+        if (pid == 0) {
+            int status = 0;
+            try {
+                option::CmdArgs args(&usage);
+                setupWorker(args);
+
+                std::unique_ptr<distributed::Transport> transport(distributed::TransportFactory::build(args));
+                TestConsumer consumer(*transport, *processed_, killAfter);
+                static_cast<distributed::Actor&>(consumer).run();
+            }
+            catch (...) {
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        return pid;
+    }
+
+    std::unique_ptr<distributed::Transport> producer() {
+        option::CmdArgs args(&usage);
+        setupProducer(args);
+        return std::unique_ptr<distributed::Transport>(distributed::TransportFactory::build(args));
+    }
+
+    /// @returns the wait status of the worker
+    int join(pid_t pid) {
+        int status;
+        while (::waitpid(pid, &status, 0) < 0) {
+            ASSERT(errno == EINTR);
+        }
+        return status;
+    }
+
+    bool exited(pid_t pid) {
+        int status = join(pid);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    uint32_t count(size_t i) const { return processed_->count[i].load(); }
+
+private:
+    virtual void setupProducer(option::CmdArgs&) const = 0;
+    virtual void setupWorker(option::CmdArgs&) const   = 0;
+
+    Processed* processed_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
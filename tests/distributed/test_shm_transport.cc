@@ -0,0 +1,155 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestTransport.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class ShmRun : public Run {
+public:
+    ShmRun(const std::string& name) : name_("/eckit-test-shm-" + std::to_string(::getpid()) + "-" + name) {}
+
+    bool segmentExists() const {
+        int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return fd >= 0;
+    }
+
+private:
+    void setupProducer(option::CmdArgs& args) const override {
+        args.set("shm", name_);
+        args.set("transport", "shm");
+        args.set("window", size_t(16));
+        args.set("workers", size_t(8));
+    }
+
+    void setupWorker(option::CmdArgs& args) const override {
+        args.set("shm", name_);
+        args.set("attach", true);
+        args.set("transport", "shm");
+    }
+
+    std::string name_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Every message is processed once") {
+    const size_t messages = 2000;
+
+    ShmRun run("normal");
+    auto transport = run.producer();
+
+    std::vector<pid_t> workers;
+    for (size_t i = 0; i < 3; ++i) {
+        workers.push_back(run.worker());
+    }
+
+    TestProducer producer(*transport, messages);
+    producer.run();
+
+    EXPECT(producer.statistics() == workers.size());
+    for (pid_t pid : workers) {
+        EXPECT(run.exited(pid));
+    }
+
+    for (size_t i = 0; i < messages; ++i) {
+        EXPECT(run.count(i) == 1);
+    }
+}
+
+CASE("The messages of a worker killed mid-run are processed by the others") {
+    const size_t messages = 2000;
+
+    ShmRun run("killed");
+    auto transport = run.producer();
+
+    pid_t killed = run.worker(50);
+    std::vector<pid_t> workers;
+    for (size_t i = 0; i < 2; ++i) {
+        workers.push_back(run.worker());
+    }
+
+    // Reaped straight away, a zombie would look alive to the producer
+    int status = 0;
+    std::thread reaper([&] { status = run.join(killed); });
+
+    TestProducer producer(*transport, messages);
+    producer.run();
+
+    reaper.join();
+    EXPECT(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+
+    EXPECT(producer.statistics() == workers.size());
+    for (pid_t pid : workers) {
+        EXPECT(run.exited(pid));
+    }
+
+    // At least once: the message being processed when the worker was killed is processed again
+    size_t again = 0;
+    for (size_t i = 0; i < messages; ++i) {
+        EXPECT(run.count(i) >= 1);
+        again += run.count(i) - 1;
+    }
+    EXPECT(again <= 1);
+}
+
+CASE("Shutdown") {
+    ShmRun run("shutdown");
+
+    {
+        auto transport = run.producer();
+
+        std::vector<pid_t> workers;
+        for (size_t i = 0; i < 2; ++i) {
+            workers.push_back(run.worker());
+        }
+
+        TestProducer producer(*transport, 0);
+        producer.run();
+
+        // Without work, the second worker may only come after the producer has finished
+        EXPECT(producer.statistics() >= 1 && producer.statistics() <= workers.size());
+        for (pid_t pid : workers) {
+            EXPECT(run.exited(pid));
+        }
+
+        // A worker that comes after the producer has finished stops straight away
+        EXPECT(run.exited(run.worker()));
+    }
+
+    EXPECT(!run.segmentExists());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "TestTransport.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class TcpRun : public Run {
+public:
+    TcpRun(size_t window) : port_(10000 + ::getpid() % 20000), window_(window) {}
+
+private:
+    void setupProducer(option::CmdArgs& args) const override {
+        args.set("transport", "tcp");
+        args.set("port", port_);
+        args.set("window", window_);
+        args.set("batch", size_t(4));
+    }
+
+    void setupWorker(option::CmdArgs& args) const override {
+        setupProducer(args);
+        args.set("host", "localhost");
+    }
+
+    size_t port_;
+    size_t window_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Every message is processed once") {
+    const size_t messages = 2000;
+
+    TcpRun run(16);
+    auto transport = run.producer();
+
+    std::vector<pid_t> workers;
+    for (size_t i = 0; i < 3; ++i) {
+        workers.push_back(run.worker());
+    }
+
+    TestProducer producer(*transport, messages);
+    producer.run();
+
+    EXPECT(producer.statistics() == workers.size());
+    for (pid_t pid : workers) {
+        EXPECT(run.exited(pid));
+    }
+
+    for (size_t i = 0; i < messages; ++i) {
+        EXPECT(run.count(i) == 1);
+    }
+}
+
+CASE("The window of a worker killed mid-run is processed by the others") {
+    const size_t messages = 2000;
+    const size_t window   = 64;
+
+    TcpRun run(window);
+    auto transport = run.producer();
+
+    pid_t killed = run.worker(50);
+    std::vector<pid_t> workers;
+    for (size_t i = 0; i < 2; ++i) {
+        workers.push_back(run.worker());
+    }
+
+    TestProducer producer(*transport, messages);
+    producer.run();
+
+    int status = run.join(killed);
+    EXPECT(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+
+    EXPECT(producer.statistics() == workers.size());
+    for (pid_t pid : workers) {
+        EXPECT(run.exited(pid));
+    }
+
+    // At least once: the messages processed but not reported yet when the worker was killed are processed again
+    size_t again = 0;
+    for (size_t i = 0; i < messages; ++i) {
+        EXPECT(run.count(i) >= 1);
+        again += run.count(i) - 1;
+    }
+    EXPECT(again <= window);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -14,6 +14,7 @@
 
 #include "eckit/types/Types.h"
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/FileSystemSize.h"
 #include "eckit/filesystem/LocalPathName.h"
 #include "eckit/filesystem/PathName.h"
@@ -241,6 +242,37 @@ CASE("Find children files and dirs") {
             EXPECT(ref_files.find(r) != ref_files.end());
         }
     }
+
+    SECTION("Walk with several threads") {
+        std::set<LocalPathName> walked_dirs;
+        std::set<LocalPathName> walked_files;
+        bool ordered = true;
+
+        LocalPathName(t.localPath()).walk(
+            [&](const LocalPathName& p, bool dir) {
+                LocalPathName r = p.relativePath(LocalPathName::cwd());
+                // A directory is always visited before its content
+                if (r.dirName() != "testdir" && walked_dirs.find(r.dirName()) == walked_dirs.end()) {
+                    ordered = false;
+                }
+                (dir ? walked_dirs : walked_files).insert(r);
+            },
+            4);
+
+        EXPECT(ordered);
+        EXPECT(walked_dirs == ref_dirs);
+        EXPECT(walked_files == ref_files);
+
+        t.walk([&](const PathName& p, bool dir) { (dir ? dirs : files).push_back(p); });
+
+        EXPECT(files.size() == 3);
+        EXPECT(dirs.size() == 6);
+    }
+
+    SECTION("Walk a directory that does not exist") {
+        LocalPathName missing = LocalPathName::cwd() + "/testdir/missing";
+        EXPECT_THROWS_AS(missing.walk([](const LocalPathName&, bool) {}), FailedSystemCall);
+    }
 }
 
 CASE("Extract basename") {
@@ -8,7 +8,9 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
 #include <list>
+#include <vector>
 
 #include "eckit/container/KDTree.h"
 #include "eckit/geometry/Point2.h"
@@ -354,6 +356,105 @@ CASE("test_kdtree_mapped") {
     }
 }
 
+CASE("test_kdtree_batch_queries") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 5000; ++i) {
+        points.emplace_back(Point(double((i * 7919) % 997) / 10., double((i * 104729) % 991) / 10.), double(i));
+    }
+
+    Tree kd;
+    kd.build(points);
+
+    std::vector<Point> queries;
+    for (size_t i = 0; i < 3000; ++i) {
+        queries.emplace_back(double((i * 31) % 1013) / 10. - 1., double((i * 17) % 1019) / 10. - 1.);
+    }
+
+    SECTION("kNearestNeighbours") {
+        const size_t k = 5;
+        for (size_t threads : {1, 4}) {
+            std::vector<Tree::NodeInfo> result(queries.size() * k);
+            kd.kNearestNeighbours(queries.data(), queries.size(), k, result.data(), threads);
+
+            for (size_t i = 0; i < queries.size(); ++i) {
+                Tree::NodeList expect = kd.kNearestNeighbours(queries[i], k);
+                EXPECT_EQUAL(expect.size(), k);
+                for (size_t j = 0; j < k; ++j) {
+                    EXPECT_EQUAL(result[i * k + j].distance(), expect[j].distance());
+                }
+            }
+        }
+    }
+
+    SECTION("kNearestNeighbours, more than in the tree") {
+        Tree small;
+        std::vector<Tree::Value> few(points.begin(), points.begin() + 3);
+        small.build(few);
+
+        std::vector<Tree::NodeInfo> result(2 * 5);
+        small.kNearestNeighbours(queries.data(), 2, 5, result.data());
+        for (size_t i = 0; i < 2; ++i) {
+            EXPECT(result[i * 5 + 1].distance() <= result[i * 5 + 2].distance());
+            EXPECT(result[i * 5 + 2].node_ != nullptr);
+            EXPECT(result[i * 5 + 3].node_ == nullptr);
+            EXPECT(result[i * 5 + 4].node_ == nullptr);
+        }
+    }
+
+    SECTION("findInSphere") {
+        const double radius = 2.;
+        std::vector<size_t> offsets;
+        Tree::NodeList result;
+
+        for (size_t threads : {1, 4}) {
+            kd.findInSphere(queries.data(), queries.size(), radius, offsets, result, threads);
+            EXPECT_EQUAL(offsets.size(), queries.size() + 1);
+            EXPECT_EQUAL(offsets.back(), result.size());
+
+            for (size_t i = 0; i < queries.size(); ++i) {
+                Tree::NodeList expect = kd.findInSphere(queries[i], radius);
+                EXPECT_EQUAL(offsets[i + 1] - offsets[i], expect.size());
+                for (size_t j = 0; j < expect.size(); ++j) {
+                    EXPECT_EQUAL(result[offsets[i] + j].distance(), expect[j].distance());
+                }
+            }
+        }
+    }
+}
+
+CASE("test_kdtree_parallel_build") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 200000; ++i) {
+        points.emplace_back(Point(double((i * 7919) % 100003) / 100., double((i * 104729) % 99991) / 100.), double(i));
+    }
+
+    Tree kd;
+    kd.build(points, 4);
+    EXPECT_EQUAL(kd.size(), points.size());
+
+    // Every point is in the tree once
+    std::vector<bool> seen(points.size(), false);
+    for (auto& item : kd) {
+        auto i = size_t(item.payload());
+        EXPECT(i < seen.size() && !seen[i]);
+        seen[i] = true;
+    }
+    EXPECT(std::find(seen.begin(), seen.end(), false) == seen.end());
+
+    for (size_t i = 0; i < 100; ++i) {
+        Point p(double((i * 37) % 1000) + 0.5, double((i * 53) % 1000) + 0.25);
+        double d = kd.nearestNeighbour(p).distance();
+        double e = kd.nearestNeighbourBruteForce(p).distance();
+        EXPECT_EQUAL(d, e);
+    }
+}
+
 CASE("test_kdtree_iterate_empty") {
     using Tree = KDTreeMemory<TestTreeTrait>;
 
@@ -8,6 +8,8 @@
  * does it submit to any jurisdiction.
  */
 
+#include <cmath>
+#include <memory>
 #include <vector>
 
 #include "eckit/geometry/Point2.h"
@@ -381,6 +383,81 @@ CASE("LonLatPolygon") {
     }
 }
 
+CASE("LonLatPolygon batch") {
+    using Polygon = geometry::polygon::LonLatPolygon;
+
+    // many vertices, so that edges are spread over latitude bands
+    std::vector<Polygon::value_type> points;
+    for (size_t i = 0; i < 720; ++i) {
+        double a = double(i) * M_PI / 360.;
+        double r = 20. + 10. * std::sin(7. * a);
+        points.emplace_back(r * std::cos(a), r * std::sin(a) * 0.5);
+    }
+    points.push_back(points.front());
+
+    // long meridional edges, spanning all the bands, and a jagged top
+    std::vector<Polygon::value_type> comb{{0, -80}, {0, 80}};
+    for (size_t i = 1; i < 200; ++i) {
+        comb.emplace_back(double(i) * 0.5, i % 2 ? 70. : 80.);
+    }
+    comb.emplace_back(100, 80);
+    comb.emplace_back(100, -80);
+    comb.emplace_back(0, -80);
+
+    // many long meridional edges, more than the bands can index in full
+    std::vector<Polygon::value_type> saw{{0, -85}};
+    for (size_t i = 0; i <= 500; ++i) {
+        saw.emplace_back(double(i) * 0.2, i % 2 ? 80. : -80.);
+    }
+    saw.emplace_back(100, -85);
+    saw.emplace_back(0, -85);
+
+    const std::vector<Polygon> polys{Polygon(points), Polygon(comb), Polygon(saw),
+                                     Polygon({{-44.2299698513, 44.8732496764},
+                                              {-12.2849279262, 75.2545011911},
+                                              {72.2148603917, 76.7993105902},
+                                              {196.903572422, 71.1350094603},
+                                              {304.194105814, 52.8269579527},
+                                              {266.886210026, -17.7495991714},
+                                              {108.327652927, 34.8499103834},
+                                              {-96.2694736324, -17.4340627522},
+                                              {-99.8761719143, 7.28288763265},
+                                              {-44.2299698513, 44.8732496764}}),
+                                     Polygon({{0, 90}, {0, 0}, {1, 0}, {1, 90}, {0, 90}})};
+
+    std::vector<double> lons;
+    std::vector<double> lats;
+    for (double lat = -90; lat <= 90; lat += 0.5) {
+        for (double lon = -360; lon <= 360; lon += 1.25) {
+            lons.push_back(lon);
+            lats.push_back(lat);
+        }
+    }
+
+    for (const auto& poly : polys) {
+        std::unique_ptr<bool[]> inside(new bool[lons.size()]);
+        poly.contains(lons.size(), lons.data(), lats.data(), inside.get());
+
+        size_t count = 0;
+        for (size_t i = 0; i < lons.size(); ++i) {
+            EXPECT(inside[i] == poly.contains({lons[i], lats[i]}));
+            count += inside[i] ? 1 : 0;
+        }
+        EXPECT(0 < count && count < lons.size());
+    }
+
+    // normalised angles
+    std::vector<double> lon2{0.5, 0.5, 180.5};
+    std::vector<double> lat2{45., 135., 135.};
+    bool inside[3];
+    polys.back().contains(lon2.size(), lon2.data(), lat2.data(), inside, true);
+    for (size_t i = 0; i < lon2.size(); ++i) {
+        EXPECT(inside[i] == polys.back().contains({lon2[i], lat2[i]}, true));
+    }
+
+    EXPECT_THROWS(polys.back().contains(lon2.size(), lon2.data(), lat2.data(), inside));
+}
+
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
@@ -10,12 +10,14 @@
 
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include "eckit/geometry/Point2.h"
 #include "eckit/geometry/Point3.h"
 #include "eckit/geometry/SphereT.h"
 #include "eckit/geometry/UnitSphere.h"
 #include "eckit/testing/Test.h"
+#include "eckit/types/FloatCompare.h"
 
 namespace eckit::test {
 
@@ -321,6 +323,45 @@ CASE("test two units sphere sub areas") {
     EXPECT(4. * sub_area_sphere_1 == sub_area_sphere_2);
 }
 
+// -----------------------------------------------------------------------------
+// test batch distances
+
+CASE("test unit sphere batch distances") {
+    const PointLonLat P(-71.6, -33.);
+
+    std::vector<double> lons;
+    std::vector<double> lats;
+    for (double lat = -90.; lat <= 90.; lat += 7.5) {
+        for (double lon = -400.; lon <= 400.; lon += 13.) {
+            lons.push_back(lon);
+            lats.push_back(lat);
+        }
+    }
+    lons.push_back(P.lon());
+    lats.push_back(P.lat());
+
+    std::vector<double> angles(lons.size());
+    std::vector<double> distances(lons.size());
+    UnitSphere::centralAngle(P, lons.size(), lons.data(), lats.data(), angles.data());
+    TwoUnitsSphere::distance(P, lons.size(), lons.data(), lats.data(), distances.data());
+
+    for (size_t i = 0; i < lons.size(); ++i) {
+        const PointLonLat Q(lons[i], lats[i]);
+        EXPECT(types::is_approximately_equal(angles[i], UnitSphere::centralAngle(P, Q), 1e-12));
+        EXPECT(types::is_approximately_equal(distances[i], TwoUnitsSphere::distance(P, Q), 1e-12));
+    }
+    EXPECT(angles.back() == 0.);
+
+    // normalised angles
+    const double lon = 10.;
+    const double lat = 100.;
+    double angle     = 0.;
+    UnitSphere::centralAngle(P, 1, &lon, &lat, &angle, true);
+    EXPECT(types::is_approximately_equal(angle, UnitSphere::centralAngle(P, PointLonLat(lon, lat), true), 1e-12));
+
+    EXPECT_THROWS(UnitSphere::centralAngle(P, 1, &lon, &lat, &angle));
+}
+
 // -----------------------------------------------------------------------------
 
 }  // namespace eckit::test
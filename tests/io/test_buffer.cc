@@ -1,3 +1,4 @@
+#include <cstdint>
 
 #include <cstdlib>
 #include <cstring>
@@ -6,6 +7,7 @@
 #include <algorithm>
 
 #include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/testing/Test.h"
 
 
@@ -112,7 +114,7 @@ CASE("Test eckit Buffer Zero") {
     free(expected);
 }
 
-// NOTE: resize allocates a new buffer whenever the new size is different -- this is inefficient
+// NOTE: resize allocates a new buffer whenever the new size falls in another size class of the BufferPool
 CASE("Test eckit Buffer resize") {
     const size_t sz = std::strlen(msg) + 1;
     Buffer buf;
@@ -141,6 +143,90 @@ CASE("Test eckit Buffer resize") {
     EXPECT(buf.size() == newSize);
 }
 
+CASE("Test eckit Buffer pool") {
+    BufferPool& pool = BufferPool::instance();
+    pool.purge();
+
+    auto aligned = [](const Buffer& b, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(b.data()) % alignment == 0;
+    };
+
+    SECTION("Alignment") {
+        Buffer page(4096);
+        EXPECT(aligned(page, 4096));
+
+        Buffer medium(100 * 1024);
+        EXPECT(aligned(medium, 4096));
+        EXPECT(medium.capacity() >= medium.size());
+
+        Buffer large(3 * 1024 * 1024 + 1);
+        EXPECT(aligned(large, 2 * 1024 * 1024));
+        EXPECT(large.capacity() >= large.size());
+
+        // Size classes, not whole huge pages
+        EXPECT(pool.capacity(2 * 1024 * 1024 + 1) < 3 * 1024 * 1024);
+        EXPECT(pool.capacity(64 * 1024 * 1024 + 1) % (2 * 1024 * 1024) == 0);
+    }
+
+    SECTION("Released buffers are reused") {
+        const size_t sz = 1024 * 1024;
+
+        const void* first = nullptr;
+        {
+            Buffer buf(sz);
+            first = buf.data();
+        }
+
+        BufferPool::Stats before = pool.stats();
+        EXPECT(before.cached == 1);
+
+        Buffer buf(sz - 1000);  // same size class
+        EXPECT(buf.data() == first);
+
+        BufferPool::Stats after = pool.stats();
+        EXPECT(after.hits == before.hits + 1);
+        EXPECT(after.cached == 0);
+        EXPECT(after.count == before.count + 1);
+    }
+
+    SECTION("Resizing large buffers keeps the data") {
+        const size_t sz = 4 * 1024 * 1024;
+        Buffer buf(sz);
+        for (size_t i = 0; i < sz; ++i) {
+            static_cast<char*>(buf)[i] = char(i % 251);
+        }
+
+        buf.resize(3 * sz, true);
+        EXPECT(buf.size() == 3 * sz);
+        EXPECT(aligned(buf, 4096));
+
+        bool same = true;
+        for (size_t i = 0; i < sz; ++i) {
+            same = same && static_cast<char*>(buf)[i] == char(i % 251);
+        }
+        EXPECT(same);
+
+        // Same size class, nothing moves
+        const void* data = buf.data();
+        buf.resize(3 * sz - 1, false);
+        EXPECT(buf.data() == data);
+    }
+
+    SECTION("Released buffers are given again aligned, even after mremap") {
+        const size_t sz = 2 * 1024 * 1024;
+        for (size_t i = 0; i < 8; ++i) {
+            Buffer buf(sz);
+            buf.resize(3 * sz, true);
+        }
+
+        Buffer buf(3 * sz);
+        EXPECT(aligned(buf, 2 * 1024 * 1024));
+    }
+
+    pool.purge();
+    EXPECT(pool.stats().cachedSize == 0);
+}
+
 CASE("Test copying and construction from of std::string") {
 
     class TestProtectedBuffer : public Buffer {
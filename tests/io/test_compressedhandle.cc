@@ -0,0 +1,140 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/CompressedHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/utils/Compressor.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::vector<std::string> compressions{"none", "snappy", "lz4", "bzip2", "aec"};
+
+static std::string payload(size_t size) {
+    std::string s;
+    s.reserve(size);
+    const std::string msg("THE QUICK BROWN FOX JUMPED OVER THE LAZY DOG'S BACK 1234567890 ");
+    while (s.size() < size) {
+        s += msg.substr(0, std::min(msg.size(), size - s.size()));
+        s += char(s.size() % 251);
+    }
+    s.resize(size);
+    return s;
+}
+
+static void compress(const std::string& in, MemoryHandle& out, const std::string& compression, size_t blockSize,
+                     long threads) {
+    MemoryHandle src(in.data(), in.size());
+    CompressedHandle zip(out, compression, blockSize, threads);
+    src.copyTo(zip, 1000);
+}
+
+static std::string uncompress(MemoryHandle& in, size_t blockSize, long threads) {
+    CompressedHandle unzip(in, "", blockSize, threads);
+    MemoryHandle out;
+    unzip.copyTo(out, 777);
+    return out.str();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Round trip") {
+    for (const auto& compression : compressions) {
+        if (!CompressorFactory::instance().has(compression)) {
+            continue;
+        }
+        for (size_t size : {size_t(0), size_t(1), size_t(4096), size_t(100000)}) {
+            for (long threads : {0, 1, 4}) {
+                SECTION("CASE " + compression + " size=" + std::to_string(size) + " threads=" + std::to_string(threads)) {
+                    std::string in = payload(size);
+
+                    MemoryHandle compressed;
+                    compress(in, compressed, compression, 4096, threads);
+
+                    // Stream is readable with any number of threads, compression is recorded in the header
+                    EXPECT(uncompress(compressed, 4096, threads) == in);
+                    EXPECT(uncompress(compressed, 4096, 2) == in);
+                }
+            }
+        }
+    }
+}
+
+CASE("Partial reads cross block boundaries") {
+    std::string in = payload(10000);
+
+    MemoryHandle compressed;
+    compress(in, compressed, "none", 1000, 2);
+
+    CompressedHandle unzip(compressed);
+    unzip.openForRead();
+
+    std::string out;
+    char buf[333];
+    long len;
+    while ((len = unzip.read(buf, sizeof(buf))) > 0) {
+        out.append(buf, len);
+    }
+    EXPECT(unzip.read(buf, sizeof(buf)) == 0);
+    EXPECT(unzip.position() == Offset(in.size()));
+    unzip.close();
+
+    EXPECT(out == in);
+}
+
+CASE("Mismatched compression is detected") {
+    MemoryHandle compressed;
+    compress(payload(100), compressed, "none", 64, 0);
+
+    CompressedHandle unzip(compressed, "dummy name");
+    EXPECT_THROWS_AS(unzip.openForRead(), BadValue);
+}
+
+CASE("Not a compressed stream") {
+    std::string junk = payload(1000);
+    MemoryHandle in(junk.data(), junk.size());
+
+    CompressedHandle unzip(in);
+    EXPECT_THROWS_AS(unzip.openForRead(), BadValue);
+}
+
+CASE("Truncated stream") {
+    std::string in = payload(10000);
+
+    MemoryHandle compressed;
+    compress(in, compressed, "none", 1000, 0);
+
+    std::string truncated = compressed.str().substr(0, compressed.str().size() / 2);
+
+    for (long threads : {0, 2}) {
+        MemoryHandle h(truncated.data(), truncated.size());
+        EXPECT_THROWS_AS(uncompress(h, 1000, threads), ReadError);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -8,7 +8,9 @@
  * does it submit to any jurisdiction.
  */
 
+#include <cstdlib>
 #include <cstring>
+#include <random>
 
 #include "eckit/config/Resource.h"
 #include "eckit/filesystem/PathName.h"
@@ -186,10 +188,92 @@ CASE("PartFileHandle with multiple parts") {
     ph.close();
 }
 
+CASE("PartFileHandle with many scattered parts") {
+
+    std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+    PathName path    = PathName::unique(base + "/scattered") + ".dat";
+
+    const size_t size = 256 * 1024;
+    std::vector<char> data(size);
+    std::mt19937 rng(42);
+    for (auto& c : data) {
+        c = char(rng());
+    }
+
+    {
+        FileHandle f(path);
+        f.openForWrite(0);
+        f.write(data.data(), size);
+        f.close();
+    }
+
+    // Small and large parts, in random order, some overlapping, some empty, some touching
+
+    OffsetList offsets;
+    LengthList lengths;
+    std::string expected;
+
+    auto add = [&](size_t offset, size_t length) {
+        offsets.push_back(offset);
+        lengths.push_back(length);
+        expected.append(&data[offset], length);
+    };
+
+    for (size_t i = 0; i < 2000; ++i) {
+        size_t length = rng() % 8 == 0 ? rng() % 16384 : rng() % 200;
+        size_t offset = rng() % (size - length);
+        add(offset, length);
+        if (i % 100 == 0) {
+            add(offset + length, 10);
+            add(offset, 0);
+        }
+    }
+    add(0, size);
+    add(size - 1, 1);
+
+    PartFileHandle ph(path, offsets, lengths);
+    ph.openForRead();
+
+    EXPECT(ph.size() == Length(expected.size()));
+
+    SECTION("Read in chunks") {
+        for (long chunk : {1L, 1000L, 4096L, 100000L}) {
+            ph.rewind();
+            std::string read;
+            std::vector<char> buff(chunk);
+            long n;
+            while ((n = ph.read(buff.data(), chunk)) > 0) {
+                read.append(buff.data(), n);
+                EXPECT(ph.position() == Offset(read.size()));
+            }
+            EXPECT(read == expected);
+        }
+    }
+
+    SECTION("Seek and read") {
+        for (size_t i = 0; i < 100; ++i) {
+            size_t from = rng() % expected.size();
+            size_t len  = rng() % 20000;
+            ph.seek(from);
+            std::vector<char> buff(len);
+            long n = ph.read(buff.data(), len);
+            EXPECT(n == long(std::min(len, expected.size() - from)));
+            EXPECT(std::string(buff.data(), n) == expected.substr(from, n));
+            EXPECT(ph.position() == Offset(from + n));
+        }
+    }
+
+    ph.close();
+    path.unlink();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
+    // Small read-ahead windows and gaps, so that the tests cross many windows
+    ::setenv("ECKIT_PART_FILE_HANDLE_READ_AHEAD", "4096", 0);
+    ::setenv("ECKIT_PART_FILE_HANDLE_GAP", "256", 0);
     return run_tests(argc, argv);
 }
@@ -0,0 +1,205 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpFile.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/PartFileHandle.h"
+#include "eckit/io/RawFileHandle.h"
+#include "eckit/io/ZeroCopy.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct CountingWatcher : public TransferWatcher {
+    long long bytes = 0;
+    bool data       = false;
+    void watch(const void* p, long len) override {
+        bytes += len;
+        if (p) {
+            data = true;
+        }
+    }
+    bool needsData() const override { return false; }
+};
+
+struct DataWatcher : public CountingWatcher {
+    bool needsData() const override { return true; }
+};
+
+static std::string payload(size_t size) {
+    std::string s(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+        s[i] = char((i * 7 + i / 251) % 256);
+    }
+    return s;
+}
+
+static void write(const PathName& path, const std::string& content) {
+    FileHandle out(path);
+    out.openForWrite(0);
+    AutoClose closer(out);
+    out.write(content.data(), content.size());
+}
+
+static std::string read(const PathName& path) {
+    FileHandle in(path);
+    MemoryHandle out;
+    in.copyTo(out);
+    return out.str();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("saveInto between files") {
+    const std::string data = payload(3 * 1024 * 1024 + 17);
+
+    TmpFile source;
+    TmpFile target;
+    write(source, data);
+
+    SECTION("FileHandle to FileHandle") {
+        CountingWatcher watcher;
+        FileHandle in(source);
+        FileHandle out(target);
+        EXPECT(in.saveInto(out, watcher) == Length(data.size()));
+        EXPECT(read(target) == data);
+        EXPECT(watcher.bytes == (long long)data.size());
+        EXPECT(!watcher.data);
+    }
+
+    SECTION("Watcher needing the data") {
+        DataWatcher watcher;
+        FileHandle in(source);
+        FileHandle out(target);
+        EXPECT(in.saveInto(out, watcher) == Length(data.size()));
+        EXPECT(read(target) == data);
+        EXPECT(watcher.bytes == (long long)data.size());
+        EXPECT(watcher.data);
+    }
+
+    SECTION("PartFileHandle to RawFileHandle") {
+        OffsetList offsets{0, 1000, 2 * 1024 * 1024};
+        LengthList lengths{10, 5000, 1024 * 1024};
+
+        std::string expected;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            expected += data.substr(size_t(offsets[i]), size_t(lengths[i]));
+        }
+
+        CountingWatcher watcher;
+        PartFileHandle in(source, offsets, lengths);
+        RawFileHandle out(target);
+        EXPECT(in.saveInto(out, watcher) == Length(expected.size()));
+        EXPECT(read(target) == expected);
+        EXPECT(watcher.bytes == (long long)expected.size());
+    }
+
+    SECTION("Short source") {
+        PartFileHandle in(source, Offset(data.size() - 10), Length(20));
+        FileHandle out(target);
+        EXPECT_THROWS(in.saveInto(out));
+    }
+}
+
+CASE("ZeroCopy from a stream") {
+    const std::string data = payload(1024 * 1024 + 3);
+
+    TmpFile target;
+
+    int fds[2];
+    EXPECT(::pipe(fds) == 0);
+
+    std::thread writer([&] {
+        const char* p = data.data();
+        size_t left   = data.size();
+        while (left > 0) {
+            ssize_t n = ::write(fds[1], p, left);
+            if (n <= 0) {
+                break;
+            }
+            p += n;
+            left -= n;
+        }
+        ::close(fds[1]);
+    });
+
+    int out = ::open(target.localPath(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    EXPECT(out >= 0);
+
+    long long progress = 0;
+    ZeroCopy copier([&](long n) { progress += n; });
+    EXPECT(copier.copy(fds[0], out) == Length(data.size()));
+
+    writer.join();
+    ::close(fds[0]);
+    ::close(out);
+
+    EXPECT(progress == (long long)data.size());
+    EXPECT(read(target) == data);
+}
+
+CASE("ZeroCopy from a stream into a file opened for appending") {
+    // splice() into a file opened with O_APPEND fails with EINVAL, data already in the pipe is written by hand
+    const std::string data = payload(4 * 1024 * 1024 + 5);
+
+    TmpFile target;
+
+    int fds[2];
+    EXPECT(::pipe(fds) == 0);
+
+    std::thread writer([&] {
+        const char* p = data.data();
+        size_t left   = data.size();
+        while (left > 0) {
+            ssize_t n = ::write(fds[1], p, left);
+            if (n <= 0) {
+                break;
+            }
+            p += n;
+            left -= n;
+        }
+        ::close(fds[1]);
+    });
+
+    int out = ::open(target.localPath(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    EXPECT(out >= 0);
+
+    ZeroCopy copier;
+    EXPECT(copier.copy(fds[0], out) == Length(data.size()));
+
+    writer.join();
+    ::close(fds[0]);
+    ::close(out);
+
+    EXPECT(read(target) == data);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "eckit/linalg/LinearAlgebraDense.h"
+#include "eckit/log/Timer.h"
+#include "util.h"
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+using linalg::Matrix;
+using linalg::Scalar;
+using linalg::Size;
+using linalg::Vector;
+
+Matrix random_matrix(Size rows, Size cols) {
+    std::mt19937 gen(rows * 31 + cols);
+    std::uniform_real_distribution<Scalar> dist(-1., 1.);
+    Matrix m(rows, cols);
+    std::generate(m.data(), m.data() + m.size(), [&] { return dist(gen); });
+    return m;
+}
+
+Vector random_vector(Size n) {
+    std::mt19937 gen(n);
+    std::uniform_real_distribution<Scalar> dist(-1., 1.);
+    Vector v(n);
+    std::generate(v.data(), v.data() + v.size(), [&] { return dist(gen); });
+    return v;
+}
+
+Scalar max_difference(const Scalar* a, const Scalar* b, Size n) {
+    Scalar diff = 0.;
+    for (Size i = 0; i < n; ++i) {
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+/// Runs work and returns the time, the best of a few runs
+template <class Work>
+double best_time(Work work) {
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        Timer timer;
+        work();
+        double t = timer.elapsed();
+        best     = run == 0 ? t : std::min(best, t);
+    }
+    return best;
+}
+
+const std::vector<std::string> backends{"generic", "blocked"};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("benchmark gemm") {
+    for (Size n : {64, 200, 512}) {
+        // Not multiples of the blocking, to go through the edges
+        Matrix A = random_matrix(n + 3, n);
+        Matrix B = random_matrix(n, n + 5);
+
+        std::vector<Matrix> C;
+        for (const auto& name : backends) {
+            const auto& la = linalg::LinearAlgebraDense::getBackend(name);
+
+            C.emplace_back(A.rows(), B.cols());
+            double t = best_time([&] { la.gemm(A, B, C.back()); });
+
+            Log::info() << "gemm " << std::setw(4) << n << " " << std::setw(8) << name << ": " << std::setw(10)
+                        << std::fixed << std::setprecision(3) << 2. * A.rows() * A.cols() * B.cols() / t * 1e-9
+                        << " GFlop/s " << la << std::endl;
+        }
+
+        EXPECT(max_difference(C[0].data(), C[1].data(), C[0].size()) < 1e-10 * n);
+    }
+}
+
+CASE("benchmark gemv") {
+    for (Size n : {100, 1000, 3000}) {
+        Matrix A = random_matrix(n + 7, n);
+        Vector x = random_vector(n);
+
+        std::vector<Vector> y;
+        for (const auto& name : backends) {
+            const auto& la = linalg::LinearAlgebraDense::getBackend(name);
+
+            y.emplace_back(A.rows());
+            double t = best_time([&] { la.gemv(A, x, y.back()); });
+
+            Log::info() << "gemv " << std::setw(4) << n << " " << std::setw(8) << name << ": " << std::setw(10)
+                        << std::fixed << std::setprecision(3) << 2. * A.rows() * A.cols() / t * 1e-9 << " GFlop/s "
+                        << la << std::endl;
+        }
+
+        EXPECT(max_difference(y[0].data(), y[1].data(), y[0].size()) < 1e-10 * n);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,158 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/log/Timer.h"
+#include "eckit/memory/Counted.h"
+#include "eckit/memory/Owned.h"
+#include "eckit/memory/SharedPtr.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
+#include "eckit/value/Value.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NCOPIES 1000000
+
+/// Counted as it was, with a mutex around the count, to compare with
+class LockedCounted : private NonCopyable {
+public:
+    LockedCounted() :
+        count_(0) {}
+    virtual ~LockedCounted() {}
+
+    void attach() const {
+        AutoLock<Mutex> lock(mutex_);
+        count_++;
+    }
+
+    void detach() const {
+        mutex_.lock();
+        if (--count_ == 0) {
+            mutex_.unlock();
+            delete this;
+        }
+        else {
+            mutex_.unlock();
+        }
+    }
+
+    size_t count() const { return count_; }
+
+private:
+    mutable Mutex mutex_;
+    mutable size_t count_;
+};
+
+struct FooLocked : public LockedCounted {};
+struct FooCounted : public Counted {};
+struct FooOwned : public OwnedLock {};
+
+/// Minimal intrusive handle, as Value and SharedBuffer do
+template <class T>
+class Handle {
+public:
+    explicit Handle(T* p) :
+        p_(p) { p_->attach(); }
+    Handle(const Handle& other) :
+        p_(other.p_) { p_->attach(); }
+    ~Handle() { p_->detach(); }
+    size_t count() const { return p_->count(); }
+
+private:
+    T* p_;
+};
+
+/// Copies and destroys handles on one shared object from all the threads, returns the copies per second
+template <class H>
+double copies(const H& shared, size_t threads) {
+    std::vector<std::thread> workers;
+    Timer timer;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (size_t i = 0; i < NCOPIES; ++i) {
+                H copy(shared);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return double(threads * NCOPIES) / timer.elapsed();
+}
+
+template <class H>
+void benchmark(const std::string& name, const H& shared, const std::vector<size_t>& threads) {
+    std::cout << std::setw(24) << std::left << name;
+    for (size_t n : threads) {
+        std::cout << std::setw(16) << std::right << size_t(copies(shared, n));
+    }
+    std::cout << std::endl;
+}
+
+std::vector<size_t> threadCounts() {
+    std::vector<size_t> threads{1};
+    size_t hw = std::max(std::thread::hardware_concurrency(), 2U);
+    for (size_t n = 2; n <= std::min<size_t>(hw, 16); n *= 2) {
+        threads.push_back(n);
+    }
+    return threads;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("benchmark_counted") {
+    std::vector<size_t> threads = threadCounts();
+
+    std::cout << "copies per second with" << std::endl;
+    std::cout << std::setw(24) << "threads:";
+    for (size_t n : threads) {
+        std::cout << std::setw(16) << std::right << n;
+    }
+    std::cout << std::endl;
+
+    Handle<FooLocked> locked(new FooLocked);
+    benchmark("Counted with mutex", locked, threads);
+    EXPECT(locked.count() == 1);
+
+    Handle<FooCounted> counted(new FooCounted);
+    benchmark("Counted", counted, threads);
+    EXPECT(counted.count() == 1);
+
+    SharedPtr<FooOwned> owned(new FooOwned);
+    benchmark("SharedPtr<OwnedLock>", owned, threads);
+    EXPECT(owned.owners() == 1);
+
+    Value value(std::string("a value to share"));
+    benchmark("Value", value, threads);
+    EXPECT(value.as<std::string>() == "a value to share");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,159 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpFile.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/message/MessageIndex.h"
+#include "eckit/message/Splitter.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::message;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Toy format: "TOY!", total length as 4 bytes big-endian, payload, "7777"
+
+class ToyBuilder : public SplitterBuilderBase {
+    Splitter* make(PeekHandle&) const override { NOTIMP; }
+    bool match(PeekHandle&) const override { return false; }
+
+    std::string magic() const override { return "TOY!"; }
+
+    size_t messageLength(const void* p, size_t size) const override {
+        const unsigned char* c = static_cast<const unsigned char*>(p);
+        if (size < 12) {
+            return 0;
+        }
+        size_t length = (size_t(c[4]) << 24) | (size_t(c[5]) << 16) | (size_t(c[6]) << 8) | c[7];
+        if (length < 12 || length > size || ::memcmp(c + length - 4, "7777", 4) != 0) {
+            return 0;
+        }
+        return length;
+    }
+};
+
+static ToyBuilder toyBuilder;
+
+static std::string toy(const std::string& payload) {
+    size_t length = payload.size() + 12;
+    std::string s("TOY!");
+    s += char(length >> 24);
+    s += char(length >> 16);
+    s += char(length >> 8);
+    s += char(length);
+    return s + payload + "7777";
+}
+
+static void write(const PathName& path, const std::string& content) {
+    std::unique_ptr<DataHandle> out(path.fileHandle());
+    out->openForWrite(0);
+    AutoClose closer(*out);
+    out->write(content.data(), content.size());
+}
+
+static std::string read(DataHandle* h) {
+    std::unique_ptr<DataHandle> in(h);
+    MemoryHandle out;
+    in->copyTo(out);
+    return out.str();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Index messages") {
+    std::vector<std::string> messages;
+    std::vector<size_t> offsets;
+    std::string content = "garbage";
+
+    for (size_t i = 0; i < 5000; ++i) {
+        std::string payload(i % 97, char('a' + i % 26));
+        if (i % 10 == 0) {
+            payload += "TOY!";  // magic within a message
+        }
+        messages.push_back(toy(payload));
+        offsets.push_back(content.size());
+        content += messages.back();
+        if (i % 7 == 0) {
+            content += "TOY! junk";  // magic not starting a valid message
+        }
+    }
+
+    TmpFile file;
+    write(file, content);
+
+    for (size_t threads : {1, 2, 5}) {
+        SECTION("threads=" + std::to_string(threads)) {
+            MessageIndex index(file, threads);
+
+            EXPECT(index.size() == messages.size());
+            EXPECT(index.upToDate());
+
+            for (size_t i = 0; i < index.size(); ++i) {
+                EXPECT(size_t(index[i].offset) == offsets[i]);
+                EXPECT(size_t(index[i].length) == messages[i].size());
+            }
+
+            EXPECT(read(index.readHandle(4321)) == messages[4321]);
+        }
+    }
+}
+
+CASE("Save and load index") {
+    TmpFile file;
+    write(file, toy("first") + toy("second") + toy("third"));
+
+    MessageIndex index(file);
+    EXPECT(index.size() == 3);
+
+    TmpFile saved;
+    index.save(saved);
+
+    MessageIndex loaded = MessageIndex::load(saved);
+    EXPECT(loaded.path() == index.path());
+    EXPECT(loaded.size() == 3);
+    EXPECT(loaded.upToDate());
+    EXPECT(read(loaded.readHandle(1)) == toy("second"));
+
+    write(file, toy("first"));
+    EXPECT(!loaded.upToDate());
+
+    EXPECT_THROWS_AS(MessageIndex::load(file), BadValue);
+}
+
+CASE("Empty file") {
+    TmpFile file;
+    write(file, "");
+
+    MessageIndex index(file);
+    EXPECT(index.size() == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    // Small chunks, so that messages are split across chunk boundaries
+    ::setenv("ECKIT_MESSAGE_INDEX_CHUNK_SIZE", "300", 1);
+    return run_tests(argc, argv);
+}
@@ -8,7 +8,9 @@
  * does it submit to any jurisdiction.
  */
 
+#include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <numeric>
 
 #include "eckit/filesystem/LocalPathName.h"
@@ -819,6 +821,110 @@ CASE("test_broadcastFile") {
     EXPECT(comm.broadcastFile(path, root).str() == str);
 }
 
+CASE("test_broadcastFile in chunks") {
+    mpi::Comm& comm = mpi::comm("world");
+    size_t root     = comm.size() - 1;
+
+    // Larger than a few chunks (see main), and not a multiple of the chunk size
+    std::string str;
+    for (size_t i = 0; str.size() < 100000; ++i) {
+        str += std::to_string(i) + "\n";
+    }
+
+    LocalPathName path(eckit::Main::instance().name() + "_broadcastFileChunks.txt");
+    if (comm.rank() == root) {
+        std::ofstream file(path.c_str(), std::ios_base::out);
+        file << str;
+        file.close();
+    }
+
+    EXPECT(comm.broadcastFile(path, root).str() == str);
+
+    {
+        std::unique_ptr<mpi::NodeSharedBuffer> buffer = comm.broadcastFileNodeShared(path, root);
+        EXPECT(buffer->size() == str.size());
+        EXPECT(buffer->str() == str);
+        comm.barrier();
+    }
+
+    LocalPathName missing(eckit::Main::instance().name() + "_broadcastFileMissing.txt");
+    EXPECT_THROWS_AS(comm.broadcastFile(missing, root), CantOpenFile);
+    EXPECT_THROWS_AS(comm.broadcastFileNodeShared(missing, root), CantOpenFile);
+}
+
+CASE("test_persistent_requests") {
+    auto& comm = mpi::comm("world");
+    int nproc  = comm.size();
+    int irank  = comm.rank();
+
+    int right = (irank + 1) % nproc;
+    int left  = (irank + nproc - 1) % nproc;
+    int tag   = 11;
+
+    std::vector<double> send(3);
+    std::vector<double> recv(3);
+
+    std::vector<mpi::Request> requests;
+    requests.push_back(comm.receiveInit(recv.data(), recv.size(), left, tag));
+    requests.push_back(comm.sendInit(send.data(), send.size(), right, tag));
+
+    for (int step = 0; step < 5; ++step) {
+        for (size_t i = 0; i < send.size(); ++i) {
+            send[i] = 1000 * step + 10 * irank + i;
+        }
+
+        comm.startAll(requests);
+        comm.waitAll(requests);
+
+        for (size_t i = 0; i < recv.size(); ++i) {
+            EXPECT(recv[i] == 1000 * step + 10 * left + i);
+        }
+    }
+
+    // Started one at a time
+    comm.start(requests[0]);
+    comm.start(requests[1]);
+    comm.wait(requests[1]);
+    comm.wait(requests[0]);
+    EXPECT(recv[0] == 4000 + 10 * left);
+}
+
+CASE("test_neighbourAllToAllv") {
+    auto& comm = mpi::comm("world");
+    int nproc  = comm.size();
+    int irank  = comm.rank();
+
+    int right = (irank + 1) % nproc;
+    int left  = (irank + nproc - 1) % nproc;
+
+    // Ring: two values to the right, one to the left
+    mpi::Comm& ring = comm.graph({left, right}, {right, left}, "ring");
+
+    std::vector<int> sources;
+    std::vector<int> destinations;
+    ring.neighbours(sources, destinations);
+    EXPECT(sources == std::vector<int>({left, right}));
+    EXPECT(destinations == std::vector<int>({right, left}));
+
+    std::vector<int> send       = {100 * irank, 100 * irank + 1, 100 * irank + 50};
+    std::vector<int> sendcounts = {2, 1};
+    std::vector<int> sdispls    = {0, 2};
+
+    std::vector<int> recv(3);
+    std::vector<int> recvcounts = {2, 1};
+    std::vector<int> rdispls    = {0, 2};
+
+    // The same counts and displacements are reused for every exchange
+    for (int step = 0; step < 3; ++step) {
+        ring.neighbourAllToAllv(send, sendcounts, sdispls, recv, recvcounts, rdispls);
+        EXPECT(recv == std::vector<int>({100 * left, 100 * left + 1, 100 * right + 50}));
+    }
+
+    mpi::deleteComm("ring");
+
+    EXPECT_THROWS_AS(comm.neighbours(sources, destinations), SeriousBug);
+}
+
 CASE("test_waitAll") {
 
     auto& comm = mpi::comm("world");
@@ -1016,6 +1122,7 @@ CASE("test_iProbe") {
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
+    ::setenv("ECKIT_MPI_BROADCAST_FILE_CHUNK_SIZE", "4096", 0);
     int failures = run_tests(argc, argv);
     eckit::mpi::finaliseAllComms();
     return failures;
@@ -8,8 +8,13 @@
  * does it submit to any jurisdiction.
  */
 
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
 #include "eckit/log/Log.h"
 #include "eckit/parser/CSVParser.h"
+#include "eckit/parser/CSVReader.h"
 
 #include "eckit/testing/Test.h"
 
@@ -46,6 +51,149 @@ CASE("test_eckit_parser_csv_2") {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+std::vector<std::vector<std::string>> rows(const std::string& csv, bool header = false,
+                                           std::vector<size_t>* lines = nullptr) {
+    istringstream in(csv);
+    CSVReader reader(in, header);
+    std::vector<std::vector<std::string>> result;
+    reader.read([&](const CSVReader::Row& row) {
+        result.emplace_back();
+        for (size_t i = 0; i < row.size(); ++i) {
+            result.back().emplace_back(row[i]);
+        }
+        if (lines) {
+            lines->push_back(row.line());
+        }
+    });
+    return result;
+}
+
+CASE("CSVReader gives rows to a callback") {
+    using Rows = std::vector<std::vector<std::string>>;
+
+    EXPECT(rows("1,2,3\n4,5,6") == Rows({{"1", "2", "3"}, {"4", "5", "6"}}));
+    EXPECT(rows("1,2,3\n4,5,6\n") == Rows({{"1", "2", "3"}, {"4", "5", "6"}}));
+    EXPECT(rows("a,,c\n,\n") == Rows({{"a", "", "c"}, {"", ""}}));
+    EXPECT(rows("").empty());
+
+    std::vector<size_t> lines;
+    EXPECT(rows("a,b\r\n1,2\r\n\r\n\n3,4\r\n", true, &lines) == Rows({{"1", "2"}, {"3", "4"}}));
+    EXPECT(lines == std::vector<size_t>({2, 5}));
+
+    istringstream in("x;y\n1;2\n");
+    CSVReader reader(in, true, ';');
+    EXPECT(reader.header() == std::vector<std::string>({"x", "y"}));
+    EXPECT(reader.read([](const CSVReader::Row& row) { EXPECT(row.size() == 2); }) == 1);
+}
+
+CASE("CSVReader reads quoted fields") {
+    using Rows = std::vector<std::vector<std::string>>;
+
+    std::vector<size_t> lines;
+    EXPECT(rows("\"a,b\",\"say \"\"hi\"\"\",c\n\"two\nlines\",\"\",x\nlast,1,2", false, &lines) ==
+           Rows({{"a,b", "say \"hi\"", "c"}, {"two\nlines", "", "x"}, {"last", "1", "2"}}));
+    EXPECT(lines == std::vector<size_t>({1, 2, 4}));
+
+    EXPECT_THROWS_AS(rows("a,\"b\n"), StreamParser::Error);
+    EXPECT_THROWS_AS(rows("a,\"b\"c\n"), StreamParser::Error);
+}
+
+CASE("CSVReader fills typed columns") {
+    istringstream in(
+        "station,lat,lon,height\n"
+        "brest,48.39,-4.49,103\n"
+        "reading, 51.45 ,-0.97,\n"
+        "\"bologna, italy\",,11.34,+54\n");
+    CSVReader reader(in, true);
+
+    std::vector<CSVReader::Column> columns{{"height", CSVReader::Column::INTEGER},
+                                           {"lat", CSVReader::Column::REAL},
+                                           {size_t(0), CSVReader::Column::STRING}};
+    EXPECT(reader.read(columns) == 3);
+
+    EXPECT(columns[0].integers() == std::vector<long>({103, CSVReader::Column::missingInteger, 54}));
+    EXPECT(columns[1].size() == 3);
+    EXPECT(columns[1].reals()[0] == 48.39);
+    EXPECT(columns[1].reals()[1] == 51.45);
+    EXPECT(std::isnan(columns[1].reals()[2]));
+    EXPECT(columns[2].name() == "station");
+    EXPECT(columns[2].strings() == std::vector<std::string>({"brest", "reading", "bologna, italy"}));
+}
+
+CASE("CSVReader reports errors in columns") {
+    auto read = [](const std::string& csv, const std::string& name, CSVReader::Column::Type type) {
+        istringstream in(csv);
+        CSVReader reader(in, true);
+        std::vector<CSVReader::Column> columns{{name, type}};
+        reader.read(columns);
+    };
+
+    EXPECT_THROWS_AS(read("a,b\n1,2\n", "c", CSVReader::Column::REAL), UserError);
+    EXPECT_THROWS_AS(read("a,b\n1,2\n3\n", "b", CSVReader::Column::REAL), StreamParser::Error);
+    EXPECT_THROWS_AS(read("a,b\n1,2\n3,x\n", "b", CSVReader::Column::REAL), StreamParser::Error);
+    EXPECT_THROWS_AS(read("a,b\n1,2.5\n", "b", CSVReader::Column::INTEGER), StreamParser::Error);
+
+    istringstream in("1,2\n");
+    CSVReader reader(in, false);
+    std::vector<CSVReader::Column> columns{{"a", CSVReader::Column::REAL}};
+    EXPECT_THROWS_AS(reader.read(columns), UserError);
+}
+
+CASE("CSVReader parses columns with threads") {
+    // Small blocks, so that rows and quotes are split between blocks
+
+    ::setenv("ECKIT_CSV_READER_BUFFER_SIZE", "65536", 1);
+
+    std::ostringstream csv;
+    csv << "id,value,name\n";
+    for (size_t i = 0; i < 100000; ++i) {
+        csv << i << "," << i * 0.25 << ",name" << i % 13 << "\n";
+        if (i % 1000 == 0) {
+            csv << "\n";
+        }
+    }
+    csv << "100000,0.5,\"quoted\nname\"\n";
+
+    auto read = [&csv](size_t threads) {
+        istringstream in(csv.str());
+        CSVReader reader(in, true);
+        reader.threads(threads);
+        std::vector<CSVReader::Column> columns{{"id", CSVReader::Column::INTEGER},
+                                               {"value", CSVReader::Column::REAL},
+                                               {"name", CSVReader::Column::STRING}};
+        EXPECT(reader.read(columns) == 100001);
+        return columns;
+    };
+
+    std::vector<CSVReader::Column> serial(read(1));
+    std::vector<CSVReader::Column> threaded(read(4));
+
+    EXPECT(serial[0].integers().back() == 100000);
+    EXPECT(serial[2].strings().back() == "quoted\nname");
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT(serial[i].integers() == threaded[i].integers());
+        EXPECT(serial[i].reals() == threaded[i].reals());
+        EXPECT(serial[i].strings() == threaded[i].strings());
+    }
+
+    // Errors are reported at their line in the input
+
+    std::string text(csv.str());
+    text.replace(text.find("\n50000,12500,"), 14, "\n50000,x,");
+    csv.str(text);
+    try {
+        read(4);
+        EXPECT(false);
+    }
+    catch (const StreamParser::Error& e) {
+        EXPECT(std::string(e.what()).find("Line: 50052 ") != std::string::npos);
+    }
+
+    ::unsetenv("ECKIT_CSV_READER_BUFFER_SIZE");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 // CASE( "test_eckit_parser_eof" ) {
 //     istringstream in("");
 //     CSVParser p(in);
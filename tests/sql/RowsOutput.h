@@ -0,0 +1,62 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#pragma once
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Rows of results, as text: the values of a row each followed by '|', NULL when missing
+class RowsOutput : public sql::SQLOutput {
+public:
+    std::vector<std::string> rows;
+
+private:
+    void prepare(sql::SQLSelect&) override {}
+    void cleanup(sql::SQLSelect&) override {}
+    void reset() override { rows_.clear(); }
+    void flush() override { std::swap(rows_, rows); }
+    bool output(const sql::expression::Expressions& results) override {
+        row_.str("");
+        for (const auto& r : results) {
+            r->output(*this);
+        }
+        rows_.push_back(row_.str());
+        return true;
+    }
+    void outputReal(double d, bool missing) override { row_ << (missing ? "NULL" : std::to_string(d)) << "|"; }
+    void outputDouble(double d, bool missing) override { outputReal(d, missing); }
+    void outputInt(double d, bool missing) override { row_ << (missing ? "NULL" : std::to_string(long(d))) << "|"; }
+    void outputUnsignedInt(double d, bool missing) override { outputInt(d, missing); }
+    void outputString(const char* s, size_t l, bool missing) override {
+        row_ << (missing ? "NULL" : std::string(s, ::strnlen(s, l))) << "|";
+    }
+    void outputBitfield(double d, bool missing) override { outputInt(d, missing); }
+    unsigned long long count() override { return rows_.size(); }
+
+    std::vector<std::string> rows_;
+    std::ostringstream row_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
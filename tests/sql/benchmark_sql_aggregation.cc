@@ -0,0 +1,227 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "eckit/log/Log.h"
+#include "eckit/log/Timer.h"
+#include "eckit/sql/SQLColumn.h"
+#include "eckit/sql/SQLDatabase.h"
+#include "eckit/sql/SQLHashAggregation.h"
+#include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLParser.h"
+#include "eckit/sql/SQLSession.h"
+#include "eckit/sql/SQLStatement.h"
+#include "eckit/sql/SQLTable.h"
+#include "eckit/sql/expression/NumberExpression.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+#include "eckit/sql/expression/function/FunctionFactory.h"
+#include "eckit/sql/type/SQLType.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit::testing;
+using namespace eckit::sql;
+using namespace eckit::sql::expression;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const size_t ROWS   = 2000000;
+const size_t GROUPS = 100000;
+
+long station(size_t row) {
+    return (row * 2654435761UL) % GROUPS;
+}
+
+double obsvalue(size_t row) {
+    return std::sin(double(row)) * 100.;
+}
+
+/// Rows made up as they are read
+class SyntheticTable : public SQLTable {
+public:
+    SyntheticTable(SQLDatabase& db) :
+        SQLTable(db, "synthetic", "synthetic") {
+        addColumn("station", 0, type::SQLType::lookup("integer"), false, 0);
+        addColumn("obsvalue", 1, type::SQLType::lookup("real"), false, 0);
+    }
+
+private:
+    class Iterator : public SQLTableIterator {
+    public:
+        Iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns) {
+            for (const auto& col : columns) {
+                offsets_.push_back(col.get().index());
+            }
+        }
+
+    private:
+        void rewind() override { row_ = 0; }
+        bool next() override {
+            if (row_ == ROWS) {
+                return false;
+            }
+            data_[0] = station(row_);
+            data_[1] = obsvalue(row_);
+            row_++;
+            return true;
+        }
+        std::vector<size_t> columnOffsets() const override { return offsets_; }
+        std::vector<size_t> doublesDataSizes() const override { return std::vector<size_t>(offsets_.size(), 1); }
+        std::vector<char> columnsHaveMissing() const override { return std::vector<char>(offsets_.size(), false); }
+        std::vector<double> missingValues() const override { return std::vector<double>(offsets_.size(), 0); }
+        const double* data() const override { return data_; }
+
+        std::vector<size_t> offsets_;
+        size_t row_ = 0;
+        double data_[2];
+    };
+
+    SQLTableIterator* iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                               std::function<void(SQLTableIterator&)>) const override {
+        return new Iterator(columns);
+    }
+};
+
+/// Counts the groups, and adds up the counts of rows
+class GroupOutput : public SQLOutput {
+public:
+    size_t groups = 0;
+    double rows   = 0;
+
+private:
+    void prepare(SQLSelect&) override {}
+    void cleanup(SQLSelect&) override {}
+    void reset() override {}
+    void flush() override {}
+    bool output(const Expressions& results) override {
+        bool missing = false;
+        groups++;
+        rows += results[1]->eval(missing);
+        return true;
+    }
+    void outputReal(double, bool) override {}
+    void outputDouble(double, bool) override {}
+    void outputInt(double, bool) override {}
+    void outputUnsignedInt(double, bool) override {}
+    void outputString(const char*, size_t, bool) override {}
+    void outputBitfield(double, bool) override {}
+    unsigned long long count() override { return groups; }
+};
+
+/// The aggregation of some rows, with expressions of its own so that it can run in a thread
+struct Partial {
+    Partial() :
+        key(std::make_shared<NumberExpression>(0)), value(std::make_shared<NumberExpression>(0)) {
+        auto& factory = function::FunctionFactory::instance();
+        Expressions groupBy;
+        groupBy.push_back(key);
+        Expressions aggregated;
+        for (const char* name : {"count", "sum", "min", "max", "var"}) {
+            aggregated.push_back(factory.build(name, value));
+        }
+        aggregation = std::make_unique<SQLHashAggregation>(groupBy, aggregated);
+    }
+
+    void add(size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            key->value(station(row));
+            value->value(obsvalue(row));
+            aggregation->add();
+        }
+    }
+
+    std::shared_ptr<NumberExpression> key;
+    std::shared_ptr<NumberExpression> value;
+    std::unique_ptr<SQLHashAggregation> aggregation;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("benchmark GROUP BY") {
+    SQLSession session(std::make_unique<GroupOutput>());
+    SQLDatabase& db(session.currentDatabase());
+    db.addTable(new SyntheticTable(db));
+
+    GroupOutput& output(static_cast<GroupOutput&>(session.output()));
+
+    SQLParser().parseString(session, "select station, count(obsvalue), sum(obsvalue), min(obsvalue), max(obsvalue), "
+                                     "var(obsvalue) from synthetic");
+
+    Timer timer;
+    session.statement().execute();
+    double t = timer.elapsed();
+
+    Log::info() << "GROUP BY of " << ROWS << " rows into " << output.groups << " groups: " << std::fixed
+                << std::setprecision(3) << t << "s, " << ROWS / t * 1e-6 << " Mrows/s" << std::endl;
+
+    EXPECT(output.groups == GROUPS);
+    EXPECT(output.rows == ROWS);
+}
+
+CASE("benchmark partitioned aggregation") {
+    std::vector<double> sums;
+
+    for (size_t threads : {1, 2, 4}) {
+        std::vector<Partial> partials(threads);
+
+        Timer timer;
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] { partials[t].add(ROWS * t / threads, ROWS * (t + 1) / threads); });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        SQLHashAggregation& result = *partials[0].aggregation;
+        for (size_t t = 1; t < threads; ++t) {
+            result.merge(*partials[t].aggregation);
+        }
+        result.sort();
+        double t = timer.elapsed();
+
+        Log::info() << "Aggregation of " << ROWS << " rows in " << threads << " thread(s): " << std::fixed
+                    << std::setprecision(3) << t << "s, " << ROWS / t * 1e-6 << " Mrows/s" << std::endl;
+
+        EXPECT(result.size() == GROUPS);
+
+        double rows = 0;
+        double sum  = 0;
+        for (size_t g = 0; g < result.size(); ++g) {
+            bool missing = false;
+            EXPECT(result.values(g)[0]->eval(missing) == g);
+
+            const Expressions& aggregates = result.aggregates(g);
+            rows += aggregates[0]->eval(missing);
+            sum += aggregates[1]->eval(missing);
+        }
+        EXPECT(rows == ROWS);
+        sums.push_back(sum);
+    }
+
+    // Partial sums are added in another order
+    for (double sum : sums) {
+        EXPECT(std::abs(sum - sums[0]) < 1e-6 * ROWS);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
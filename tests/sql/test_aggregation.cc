@@ -0,0 +1,382 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLHashAggregation.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+#include "eckit/sql/expression/function/FunctionFactory.h"
+#include "eckit/sql/type/SQLType.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit::testing;
+using namespace eckit::sql;
+using namespace eckit::sql::expression;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The value of a column in the current row: a number, or a string of some words, possibly missing
+class Variable : public SQLExpression {
+public:
+    /// A number
+    Variable() :
+        type_(&type::SQLType::lookup("real")) {}
+
+    /// A string
+    explicit Variable(size_t words) :
+        type_(&type::SQLType::lookup("string", words)), words_(words) {}
+
+    void set(double d, bool missing = false) {
+        number_  = d;
+        missing_ = missing;
+    }
+
+    void set(const std::string& s) {
+        ASSERT(words_ > 0 && s.size() <= words_ * sizeof(double));
+        string_  = s;
+        missing_ = false;
+    }
+
+    /// As a new frame of data may do
+    void widen(size_t words) {
+        type_  = &type::SQLType::lookup("string", words);
+        words_ = words;
+    }
+
+private:
+    void prepare(SQLSelect&) override {}
+    void cleanup(SQLSelect&) override {}
+    double eval(bool& missing) const override {
+        missing = missing_;
+        return number_;
+    }
+    void eval(double* out, bool& missing) const override {
+        missing = missing_;
+        if (words_ == 0) {
+            *out = number_;
+            return;
+        }
+        std::fill(out, out + words_, 0.);
+        std::memcpy(out, string_.data(), string_.size());
+    }
+    std::string evalAsString(bool& missing) const override {
+        missing = missing_;
+        return string_;
+    }
+    bool isConstant() const override { return false; }
+    const type::SQLType* type() const override { return type_; }
+    std::shared_ptr<SQLExpression> clone() const override { NOTIMP; }
+    std::shared_ptr<SQLExpression> reshift(int) const override { NOTIMP; }
+    void print(std::ostream& s) const override { s << "Variable"; }
+
+    const type::SQLType* type_;
+    size_t words_  = 0;
+    double number_ = 0;
+    std::string string_;
+    bool missing_ = false;
+};
+
+const std::vector<std::string> STATISTICS{"count", "sum", "avg", "min", "max", "var", "stdev", "rms"};
+
+/// SELECT key, count(value), sum(value), ... GROUP BY key
+struct Aggregation {
+    explicit Aggregation(size_t keyWords = 0) :
+        key(keyWords ? std::make_shared<Variable>(keyWords) : std::make_shared<Variable>()),
+        value(std::make_shared<Variable>()) {
+        Expressions groupBy;
+        groupBy.push_back(key);
+        Expressions aggregated;
+        for (const auto& name : STATISTICS) {
+            aggregated.push_back(function::FunctionFactory::instance().build(name, value));
+        }
+        aggregation = std::make_unique<SQLHashAggregation>(groupBy, aggregated);
+        EXPECT(aggregation->mergeable());
+    }
+
+    std::shared_ptr<Variable> key;
+    std::shared_ptr<Variable> value;
+    std::unique_ptr<SQLHashAggregation> aggregation;
+};
+
+/// The statistics of the values of a group, computed as they are defined
+struct Expected {
+    std::vector<double> values;
+
+    bool missing() const { return values.empty(); }
+    double count() const { return values.size(); }
+    double sum() const {
+        double s = 0;
+        for (double v : values) {
+            s += v;
+        }
+        return s;
+    }
+    double avg() const { return sum() / count(); }
+    double min() const { return *std::min_element(values.begin(), values.end()); }
+    double max() const { return *std::max_element(values.begin(), values.end()); }
+    double var() const {
+        // Population variance, around the mean
+        double m = avg();
+        double s = 0;
+        for (double v : values) {
+            s += (v - m) * (v - m);
+        }
+        return s / count();
+    }
+    double stdev() const { return std::sqrt(var()); }
+    double rms() const {
+        double s = 0;
+        for (double v : values) {
+            s += v * v;
+        }
+        return std::sqrt(s / count());
+    }
+};
+
+bool close(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max(1., std::max(std::abs(a), std::abs(b)));
+}
+
+/// Compares the aggregates of a group with the expected statistics
+void check(SQLHashAggregation& aggregation, size_t group, const Expected& expected) {
+    const Expressions& results = aggregation.aggregates(group);
+    ASSERT(results.size() == STATISTICS.size());
+
+    bool missing = false;
+    EXPECT(results[0]->eval(missing) == expected.count());
+    EXPECT(!missing);
+
+    const double values[] = {expected.missing() ? 0 : expected.sum(),   expected.missing() ? 0 : expected.avg(),
+                             expected.missing() ? 0 : expected.min(),   expected.missing() ? 0 : expected.max(),
+                             expected.missing() ? 0 : expected.var(),   expected.missing() ? 0 : expected.stdev(),
+                             expected.missing() ? 0 : expected.rms()};
+
+    for (size_t i = 1; i < STATISTICS.size(); ++i) {
+        missing  = false;
+        double v = results[i]->eval(missing);
+        EXPECT(missing == expected.missing());
+        if (!missing && !close(v, values[i - 1])) {
+            Log::info() << STATISTICS[i] << " of group " << group << ": " << v << ", expected " << values[i - 1]
+                        << std::endl;
+            EXPECT(close(v, values[i - 1]));
+        }
+    }
+}
+
+double key(SQLHashAggregation& aggregation, size_t group) {
+    bool missing = false;
+    return aggregation.values(group)[0]->eval(missing);
+}
+
+std::string name(SQLHashAggregation& aggregation, size_t group) {
+    bool missing = false;
+    return aggregation.values(group)[0]->evalAsString(missing);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Statistics of each group are those computed directly") {
+    const size_t rows   = 10000;
+    const size_t groups = 37;
+
+    Aggregation a;
+    std::map<double, Expected> expected;
+
+    for (size_t row = 0; row < rows; ++row) {
+        double k     = double((row * 7919) % groups) - 5;
+        double v     = std::sin(double(row)) * 100 + k;
+        bool missing = row % 13 == 0;
+
+        a.key->set(k);
+        a.value->set(v, missing);
+        a.aggregation->add();
+
+        if (!missing) {
+            expected[k].values.push_back(v);
+        }
+    }
+
+    // A group of missing values only
+    a.key->set(1000);
+    for (size_t row = 0; row < 3; ++row) {
+        a.value->set(1, true);
+        a.aggregation->add();
+    }
+    expected[1000];
+
+    a.aggregation->sort();
+    EXPECT(a.aggregation->size() == expected.size());
+
+    size_t g = 0;
+    for (const auto& e : expected) {
+        EXPECT(key(*a.aggregation, g) == e.first);
+        check(*a.aggregation, g, e.second);
+        g++;
+    }
+
+    SECTION("COUNT of missing values only is 0, the others NULL") {
+        const Expressions& results = a.aggregation->aggregates(expected.size() - 1);
+        bool missing               = false;
+        EXPECT(results[0]->eval(missing) == 0);
+        EXPECT(!missing);
+        for (size_t i = 1; i < results.size(); ++i) {
+            missing = false;
+            results[i]->eval(missing);
+            EXPECT(missing);
+        }
+    }
+}
+
+CASE("Merged partial aggregations give the statistics of all their rows") {
+    const size_t rows   = 6000;
+    const size_t groups = 50;
+
+    std::vector<Aggregation> partials(3);
+    std::map<double, Expected> expected;
+
+    for (size_t row = 0; row < rows; ++row) {
+        // Some groups only in some partials
+        Aggregation& a = partials[row * partials.size() / rows];
+        double k       = double((row * 31 + row / 1000) % groups);
+        double v       = std::cos(double(row)) * 10;
+
+        a.key->set(k);
+        a.value->set(v, row % 7 == 0);
+        a.aggregation->add();
+
+        if (row % 7 != 0) {
+            expected[k].values.push_back(v);
+        }
+        else {
+            expected[k];
+        }
+    }
+
+    for (size_t i = 1; i < partials.size(); ++i) {
+        partials[0].aggregation->merge(*partials[i].aggregation);
+    }
+
+    SQLHashAggregation& result = *partials[0].aggregation;
+    result.sort();
+    EXPECT(result.size() == expected.size());
+
+    size_t g = 0;
+    for (const auto& e : expected) {
+        EXPECT(key(result, g) == e.first);
+        check(result, g, e.second);
+        g++;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("String keys are grouped as compared, ignoring trailing white space") {
+    Aggregation a(2);
+
+    const std::vector<std::pair<std::string, double>> rows{
+        {"abc", 1}, {"abc  ", 2}, {"abcd", 4}, {"", 8}, {"abc", 16}, {"a-longer-strin", 32}, {"abcd ", 64}, {"", 128}};
+
+    for (const auto& r : rows) {
+        a.key->set(r.first);
+        a.value->set(r.second);
+        a.aggregation->add();
+    }
+
+    a.aggregation->sort();
+    EXPECT(a.aggregation->size() == 4);
+
+    // Sorted on the keys, the values first seen are kept
+    const std::vector<std::string> names{"", "a-longer-strin", "abc", "abcd"};
+    const std::vector<double> sums{136, 32, 19, 68};
+    for (size_t g = 0; g < names.size(); ++g) {
+        EXPECT(name(*a.aggregation, g) == names[g]);
+        bool missing = false;
+        EXPECT(a.aggregation->aggregates(g)[1]->eval(missing) == sums[g]);
+    }
+}
+
+CASE("String keys widening between frames keep their groups") {
+    Aggregation a(1);
+
+    for (const std::string& s : {"abc", "defgh", "abc"}) {
+        a.key->set(s);
+        a.value->set(1);
+        a.aggregation->add();
+    }
+
+    // A new frame, with wider strings
+    a.key->widen(3);
+    for (const std::string& s : {"abc", "a-string-of-twenty", "defgh  ", "abc"}) {
+        a.key->set(s);
+        a.value->set(1);
+        a.aggregation->add();
+    }
+
+    a.aggregation->sort();
+    EXPECT(a.aggregation->size() == 3);
+
+    const std::vector<std::string> names{"a-string-of-twenty", "abc", "defgh"};
+    const std::vector<double> counts{1, 4, 2};
+    for (size_t g = 0; g < names.size(); ++g) {
+        EXPECT(name(*a.aggregation, g) == names[g]);
+        bool missing = false;
+        EXPECT(a.aggregation->aggregates(g)[0]->eval(missing) == counts[g]);
+    }
+}
+
+CASE("Merging aggregations of strings of different widths") {
+    for (bool narrowFirst : {true, false}) {
+        Aggregation narrow(1);
+        Aggregation wide(3);
+
+        for (const std::string& s : {"abc", "xyz", "abc"}) {
+            narrow.key->set(s);
+            narrow.value->set(1);
+            narrow.aggregation->add();
+        }
+
+        for (const std::string& s : {"abc ", "a-string-of-twenty", "xyz"}) {
+            wide.key->set(s);
+            wide.value->set(10);
+            wide.aggregation->add();
+        }
+
+        SQLHashAggregation& result = narrowFirst ? *narrow.aggregation : *wide.aggregation;
+        result.merge(narrowFirst ? *wide.aggregation : *narrow.aggregation);
+        result.sort();
+        EXPECT(result.size() == 3);
+
+        const std::vector<std::string> names{"a-string-of-twenty", "abc", "xyz"};
+        const std::vector<double> sums{10, 12, 11};
+        for (size_t g = 0; g < names.size(); ++g) {
+            std::string n = name(result, g);
+            EXPECT(n.substr(0, n.find_last_not_of(' ') + 1) == names[g]);
+            bool missing = false;
+            EXPECT(result.aggregates(g)[1]->eval(missing) == sums[g]);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
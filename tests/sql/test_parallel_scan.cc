@@ -0,0 +1,179 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "eckit/sql/SQLColumn.h"
+#include "eckit/sql/SQLDatabase.h"
+#include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLParser.h"
+#include "eckit/sql/SQLSession.h"
+#include "eckit/sql/SQLStatement.h"
+#include "eckit/sql/SQLTable.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+#include "eckit/testing/Test.h"
+
+#include "RowsOutput.h"
+
+using namespace eckit::testing;
+using namespace eckit::sql;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const unsigned long long ROWS = 1000;
+
+const char* NAMES[] = {"alpha", "beta", "gamma-delta", "", "epsilon"};
+
+/// A table of rows made up from their number, that can be scanned in ranges
+class SplitTable : public SQLTable {
+public:
+    SplitTable(SQLDatabase& db) :
+        SQLTable(db, "split", "split") {
+        addColumn("icol", 0, type::SQLType::lookup("integer"), false, 0);
+        addColumn("rcol", 1, type::SQLType::lookup("real"), false, 0);
+        addColumn("scol", 2, type::SQLType::lookup("string", 2), false, 0);
+    }
+
+    mutable std::atomic<size_t> ranges{0};
+
+private:
+    class Iterator : public SQLTableIterator {
+    public:
+        Iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns, unsigned long long begin,
+                 unsigned long long end) :
+            begin_(begin), end_(end), row_(begin) {
+            const size_t offsets[] = {0, 1, 2};
+            const size_t sizes[]   = {1, 1, 2};
+            for (const auto& col : columns) {
+                offsets_.push_back(offsets[col.get().index()]);
+                sizes_.push_back(sizes[col.get().index()]);
+            }
+        }
+
+    private:
+        void rewind() override { row_ = begin_; }
+        bool next() override {
+            if (row_ == end_) {
+                return false;
+            }
+            data_[0] = row_ % 17;
+            data_[1] = row_ * 0.5;
+            data_[2] = data_[3] = 0;
+            ::strncpy(reinterpret_cast<char*>(&data_[2]), NAMES[row_ % 5], 2 * sizeof(double));
+            row_++;
+            return true;
+        }
+        std::vector<size_t> columnOffsets() const override { return offsets_; }
+        std::vector<size_t> doublesDataSizes() const override { return sizes_; }
+        std::vector<char> columnsHaveMissing() const override { return std::vector<char>(offsets_.size(), false); }
+        std::vector<double> missingValues() const override { return std::vector<double>(offsets_.size(), 0); }
+        const double* data() const override { return data_; }
+
+        unsigned long long begin_;
+        unsigned long long end_;
+        unsigned long long row_;
+        std::vector<size_t> offsets_;
+        std::vector<size_t> sizes_;
+        double data_[4];
+    };
+
+    SQLTableIterator* iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                               std::function<void(SQLTableIterator&)>) const override {
+        return new Iterator(columns, 0, ROWS);
+    }
+
+    unsigned long long splittableRows() const override { return ROWS; }
+
+    SQLTableIterator* rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                                    unsigned long long begin, unsigned long long end) const override {
+        ranges++;
+        return new Iterator(columns, begin, end);
+    }
+};
+
+/// Runs a query, scanning the table with the given number of threads
+std::vector<std::string> select(const std::string& sql, const char* threads, const char* ordered = "1",
+                                size_t* ranges = nullptr) {
+    ::setenv("ECKIT_SQL_SCAN_THREADS", threads, 1);
+    ::setenv("ECKIT_SQL_SCAN_MORSEL_ROWS", "64", 1);
+    ::setenv("ECKIT_SQL_SCAN_ORDERED", ordered, 1);
+
+    SQLSession session(std::make_unique<RowsOutput>());
+    SQLDatabase& db(session.currentDatabase());
+    auto* table = new SplitTable(db);
+    db.addTable(table);
+
+    SQLParser().parseString(session, sql);
+    session.statement().execute();
+
+    if (ranges) {
+        *ranges = table->ranges;
+    }
+    return static_cast<RowsOutput&>(session.output()).rows;
+}
+
+/// Compares the results of the serial and of the parallel scans
+void compare(const std::string& sql, bool parallel = true) {
+    std::vector<std::string> serial(select(sql, "1"));
+
+    size_t ranges = 0;
+    EXPECT(select(sql, "4", "1", &ranges) == serial);
+    EXPECT((ranges != 0) == parallel);
+
+    std::vector<std::string> unordered(select(sql, "4", "0"));
+    std::sort(unordered.begin(), unordered.end());
+    std::sort(serial.begin(), serial.end());
+    EXPECT(unordered == serial);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Parallel scan of rows") {
+    EXPECT(select("select icol, rcol from split", "1").size() == ROWS);
+
+    compare("select icol, rcol, scol from split");
+    compare("select icol * 2, scol from split where icol > 10 and scol <> 'beta'");
+}
+
+CASE("Parallel scan with DISTINCT") {
+    compare("select distinct scol from split");
+    compare("select distinct icol, scol from split where rcol > 100");
+}
+
+CASE("Parallel scan of aggregates") {
+    compare("select count(*), sum(rcol), min(rcol), max(icol), avg(rcol) from split");
+    compare("select count(*), sum(rcol) from split where icol > 100");
+    compare("select icol, count(rcol), sum(rcol), max(rcol) from split");
+    compare("select scol, icol, min(rcol), avg(icol) from split where icol < 5");
+
+    std::vector<std::string> rows(select("select icol, count(rcol) from split", "4"));
+    EXPECT(rows.size() == 17);
+    EXPECT(rows.front() == "0|59.000000|");
+}
+
+CASE("Serial scan when the rows must be known") {
+    compare("select rownumber(), icol from split", false);
+    compare("select icol, rcol from split order by rcol desc", false);
+    compare("select first(rcol), icol from split", false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
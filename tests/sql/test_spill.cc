@@ -0,0 +1,592 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eckit/sql/SQLColumn.h"
+#include "eckit/sql/SQLDatabase.h"
+#include "eckit/sql/SQLDistinctOutput.h"
+#include "eckit/sql/SQLOrderOutput.h"
+#include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLSelect.h"
+#include "eckit/sql/SQLSession.h"
+#include "eckit/sql/SQLSortKey.h"
+#include "eckit/sql/SQLSpillFile.h"
+#include "eckit/sql/SQLTable.h"
+#include "eckit/sql/expression/ColumnExpression.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+#include "eckit/sql/type/SQLType.h"
+#include "eckit/testing/Test.h"
+
+#include "RowsOutput.h"
+
+using namespace eckit::testing;
+using namespace eckit::sql;
+using namespace eckit::sql::expression;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A constant number or string, possibly missing
+class TestValue : public SQLExpression {
+public:
+    TestValue(double d) :
+        type_(&type::SQLType::lookup("real")), number_(d) {}
+    TestValue(const std::string& s, size_t words = 1) :
+        type_(&type::SQLType::lookup("string", words)), string_(s) {}
+
+    static std::shared_ptr<TestValue> missing(const std::shared_ptr<TestValue>& v) {
+        v->missing_ = true;
+        return v;
+    }
+
+private:
+    void prepare(SQLSelect&) override {}
+    void cleanup(SQLSelect&) override {}
+    double eval(bool& missing) const override {
+        missing = missing_;
+        return number_;
+    }
+    std::string evalAsString(bool& missing) const override {
+        missing = missing_;
+        return string_;
+    }
+    bool isConstant() const override { return true; }
+    const type::SQLType* type() const override { return type_; }
+    std::shared_ptr<SQLExpression> clone() const override { NOTIMP; }
+    std::shared_ptr<SQLExpression> reshift(int) const override { NOTIMP; }
+    void print(std::ostream& s) const override { s << "TestValue"; }
+
+    const type::SQLType* type_;
+    double number_ = 0;
+    std::string string_;
+    bool missing_ = false;
+};
+
+std::shared_ptr<TestValue> number(double d) {
+    return std::make_shared<TestValue>(d);
+}
+
+std::shared_ptr<TestValue> string(const std::string& s, size_t words = 1) {
+    return std::make_shared<TestValue>(s, words);
+}
+
+/// @returns the key of one value, in a layout fitted to it
+std::vector<unsigned char> key(const std::shared_ptr<TestValue>& value, bool ascending = true) {
+    SQLSortKey key(std::vector<bool>{ascending});
+    SQLSortKey::Values values{value.get()};
+    key.update(values);
+
+    std::vector<unsigned char> result(key.size());
+    key.encode(values, result.data());
+    return result;
+}
+
+/// Keys compared as SQLOrderOutput does
+int compare(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    EXPECT(a.size() == b.size());
+    int c = std::memcmp(a.data(), b.data(), a.size());
+    return c < 0 ? -1 : (c > 0 ? 1 : 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Files of the spill directory, to check that nothing is left behind
+size_t files(const std::string& dir) {
+    size_t count = 0;
+    DIR* d       = ::opendir(dir.c_str());
+    ASSERT(d);
+    while (struct dirent* e = ::readdir(d)) {
+        if (std::string(e->d_name) != "." && std::string(e->d_name) != "..") {
+            count++;
+        }
+    }
+    ::closedir(d);
+    return count;
+}
+
+/// Points TMPDIR, where the spill files go, to an empty directory for the duration of a test
+class SpillDirectory {
+public:
+    SpillDirectory() {
+        const char* tmpdir = ::getenv("TMPDIR");
+        previous_          = tmpdir ? tmpdir : "";
+
+        char dir[] = "/tmp/eckit_test_sql_spill_XXXXXX";
+        ASSERT(::mkdtemp(dir));
+        path_ = dir;
+        ::setenv("TMPDIR", path_.c_str(), 1);
+    }
+
+    ~SpillDirectory() {
+        if (previous_.empty()) {
+            ::unsetenv("TMPDIR");
+        }
+        else {
+            ::setenv("TMPDIR", previous_.c_str(), 1);
+        }
+        ::rmdir(path_.c_str());
+    }
+
+    size_t files() const { return test::files(path_); }
+
+private:
+    std::string path_;
+    std::string previous_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const double MISSING = -99999;
+
+struct Row {
+    double key;  ///< MISSING for missing
+    std::string name;
+    long seq;
+};
+
+/// Rows given in a vector. The string column widens from one word to two at a given row, as between frames of data.
+class TestTable : public SQLTable {
+public:
+    TestTable(SQLDatabase& db, const std::vector<Row>& rows, size_t widenAt) :
+        SQLTable(db, "test", "test"), rows_(rows), widenAt_(widenAt) {
+        addColumn("key", 0, type::SQLType::lookup("real"), true, MISSING);
+        addColumn("name", 1, type::SQLType::lookup("string", 1), false, 0);
+        addColumn("seq", 2, type::SQLType::lookup("integer"), false, 0);
+    }
+
+private:
+    class Iterator : public SQLTableIterator {
+    public:
+        Iterator(const TestTable& owner, const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                 std::function<void(SQLTableIterator&)> update) :
+            owner_(owner), update_(update) {
+            for (const auto& col : columns) {
+                indexes_.push_back(col.get().index());
+            }
+            layout(1);
+        }
+
+    private:
+        void layout(size_t words) {
+            const size_t offsets[] = {0, 1, 1 + words};
+            const size_t sizes[]   = {1, words, 1};
+            offsets_.clear();
+            sizes_.clear();
+            for (size_t i : indexes_) {
+                offsets_.push_back(offsets[i]);
+                sizes_.push_back(sizes[i]);
+            }
+            words_ = words;
+            data_.assign(2 + words, 0);
+        }
+
+        void rewind() override { row_ = 0; }
+
+        bool next() override {
+            if (row_ == owner_.widenAt_) {
+                layout(2);
+                update_(*this);
+            }
+            if (row_ == owner_.rows_.size()) {
+                return false;
+            }
+
+            const Row& r = owner_.rows_[row_++];
+            ASSERT(r.name.size() <= words_ * sizeof(double));
+            std::fill(data_.begin(), data_.end(), 0);
+            data_[0] = r.key;
+            std::memcpy(&data_[1], r.name.data(), r.name.size());
+            data_[1 + words_] = r.seq;
+            return true;
+        }
+
+        std::vector<size_t> columnOffsets() const override { return offsets_; }
+        std::vector<size_t> doublesDataSizes() const override { return sizes_; }
+        std::vector<char> columnsHaveMissing() const override {
+            std::vector<char> result;
+            for (size_t i : indexes_) {
+                result.push_back(i == 0);
+            }
+            return result;
+        }
+        std::vector<double> missingValues() const override {
+            return std::vector<double>(indexes_.size(), MISSING);
+        }
+        const double* data() const override { return data_.data(); }
+
+        const TestTable& owner_;
+        std::function<void(SQLTableIterator&)> update_;
+        std::vector<size_t> indexes_;
+        std::vector<size_t> offsets_;
+        std::vector<size_t> sizes_;
+        std::vector<double> data_;
+        size_t words_ = 1;
+        size_t row_   = 0;
+    };
+
+    SQLTableIterator* iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                               std::function<void(SQLTableIterator&)> update) const override {
+        return new Iterator(*this, columns, update);
+    }
+
+    std::vector<Row> rows_;
+    size_t widenAt_;
+};
+
+std::string text(const Row& r, const std::vector<std::string>& columns) {
+    std::ostringstream s;
+    for (const auto& c : columns) {
+        if (c == "key") {
+            s << (r.key == MISSING ? std::string("NULL") : std::to_string(r.key)) << "|";
+        }
+        else if (c == "name") {
+            s << r.name << "|";
+        }
+        else {
+            s << r.seq << "|";
+        }
+    }
+    return s.str();
+}
+
+/// SELECT [DISTINCT] columns FROM rows [ORDER BY by], with the memory budgets given
+std::vector<std::string> select(const std::vector<Row>& rows, const std::vector<std::string>& columns, bool distinct,
+                                const std::vector<std::pair<std::string, bool>>& by = {}, size_t widenAt = size_t(-1),
+                                const char* memory = "1") {
+    ::setenv("ECKIT_SQL_SORT_MEMORY", memory, 1);
+    ::setenv("ECKIT_SQL_DISTINCT_MEMORY", memory, 1);
+
+    SQLSession session(std::make_unique<RowsOutput>());
+    SQLDatabase& db(session.currentDatabase());
+    auto* table = new TestTable(db, rows, widenAt);
+    db.addTable(table);
+
+    Expressions results;
+    for (const auto& c : columns) {
+        results.push_back(std::make_shared<ColumnExpression>(c, table));
+    }
+
+    RowsOutput& out = static_cast<RowsOutput&>(session.output());
+    std::unique_ptr<SQLOutput> wrapped;
+    SQLOutput* o = &out;
+    if (distinct) {
+        wrapped.reset(new SQLDistinctOutput(out));
+        o = wrapped.get();
+    }
+    if (!by.empty()) {
+        std::pair<Expressions, std::vector<bool>> order;
+        for (const auto& b : by) {
+            order.first.push_back(std::make_shared<ColumnExpression>(b.first, table));
+            order.second.push_back(b.second);
+        }
+        wrapped.reset(new SQLOrderOutput(out, order));
+        o = wrapped.get();
+    }
+
+    SQLSelect(results, {std::cref<SQLTable>(*table)}, nullptr, *o).execute();
+
+    ::unsetenv("ECKIT_SQL_SORT_MEMORY");
+    ::unsetenv("ECKIT_SQL_DISTINCT_MEMORY");
+    return out.rows;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Sort keys of numbers order as the numbers") {
+    const std::vector<double> values{-std::numeric_limits<double>::infinity(),
+                                     -1e300,
+                                     -2.5,
+                                     -1,
+                                     -std::numeric_limits<double>::denorm_min(),
+                                     0,
+                                     std::numeric_limits<double>::denorm_min(),
+                                     1e-300,
+                                     1,
+                                     2.5,
+                                     1e300,
+                                     std::numeric_limits<double>::infinity()};
+
+    auto missing = TestValue::missing(number(0));
+
+    SECTION("Ascending, missing first") {
+        for (size_t i = 0; i < values.size(); ++i) {
+            EXPECT(compare(key(missing), key(number(values[i]))) < 0);
+            for (size_t j = 0; j < values.size(); ++j) {
+                EXPECT(compare(key(number(values[i])), key(number(values[j]))) == (i < j ? -1 : (i > j ? 1 : 0)));
+            }
+        }
+    }
+
+    SECTION("Descending, the reverse, missing last") {
+        for (size_t i = 0; i < values.size(); ++i) {
+            EXPECT(compare(key(missing, false), key(number(values[i]), false)) > 0);
+            for (size_t j = 0; j < values.size(); ++j) {
+                EXPECT(compare(key(number(values[i]), false), key(number(values[j]), false))
+                       == (i < j ? 1 : (i > j ? -1 : 0)));
+            }
+        }
+    }
+
+    SECTION("-0 is 0") {
+        EXPECT(key(number(-0.0)) == key(number(0)));
+        EXPECT(key(number(-0.0), false) == key(number(0), false));
+    }
+}
+
+CASE("Sort keys of strings order as the trimmed strings") {
+    auto keys = [](const std::vector<std::string>& strings, bool ascending) {
+        // One layout, as wide as the widest
+        SQLSortKey key(std::vector<bool>{ascending});
+        std::vector<std::shared_ptr<TestValue>> values;
+        for (const auto& s : strings) {
+            values.push_back(string(s, (s.size() + 7) / 8));
+            key.update(SQLSortKey::Values{values.back().get()});
+        }
+
+        std::vector<std::vector<unsigned char>> result;
+        for (const auto& v : values) {
+            result.emplace_back(key.size());
+            key.encode(SQLSortKey::Values{v.get()}, result.back().data());
+        }
+        return result;
+    };
+
+    const std::vector<std::string> sorted{"", "a", "abc", "abcd", "abcdefghijklmno", "abd", "b"};
+
+    for (bool ascending : {true, false}) {
+        auto k = keys(sorted, ascending);
+        for (size_t i = 0; i + 1 < k.size(); ++i) {
+            EXPECT(compare(k[i], k[i + 1]) == (ascending ? -1 : 1));
+        }
+    }
+
+    // Trimmed of white space, as strings are compared
+    auto k = keys({"abc", "abc  ", "  abc", "\tabc\n", "abc d"}, true);
+    EXPECT(k[0] == k[1]);
+    EXPECT(k[0] == k[2]);
+    EXPECT(k[0] == k[3]);
+    EXPECT(compare(k[0], k[4]) < 0);
+
+    // Missing before the empty string
+    EXPECT(compare(key(TestValue::missing(string("a"))), key(string(""))) < 0);
+}
+
+CASE("Sort keys widen to the keys of a wider layout") {
+    for (bool ascending : {true, false}) {
+        auto narrow = string("abc");
+        auto wide   = string("abcdefghijkl", 2);
+        auto n      = number(-2.5);
+
+        SQLSortKey key(std::vector<bool>{true, ascending});
+        key.update(SQLSortKey::Values{n.get(), narrow.get()});
+        std::vector<size_t> widths = key.widths();
+
+        std::vector<unsigned char> before(key.size());
+        key.encode(SQLSortKey::Values{n.get(), narrow.get()}, before.data());
+
+        key.update(SQLSortKey::Values{n.get(), wide.get()});
+        EXPECT(key.widths() != widths);
+
+        std::vector<unsigned char> widened(key.size());
+        key.widen(widths, before.data(), widened.data());
+
+        std::vector<unsigned char> direct(key.size());
+        key.encode(SQLSortKey::Values{n.get(), narrow.get()}, direct.data());
+        EXPECT(widened == direct);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Spill files give back their records, and leave nothing behind") {
+    SpillDirectory dir;
+
+    const size_t recordSize = 24;
+    const size_t count      = 100000;  // more than the read buffer
+
+    {
+        SQLSpillFile file(recordSize);
+        EXPECT(dir.files() == 0);  // removed as soon as open
+
+        std::vector<uint64_t> record(recordSize / sizeof(uint64_t));
+        for (size_t i = 0; i < count; i += 2) {
+            std::vector<uint64_t> two(2 * record.size());
+            for (size_t j = 0; j < two.size(); ++j) {
+                two[j] = i * 3 + j;
+            }
+            if (i % 4) {
+                file.write(two.data(), 2);
+            }
+            else {
+                file.write(two.data());
+                file.write(two.data() + record.size());
+            }
+        }
+        EXPECT(file.count() == count);
+
+        file.rewind();
+        bool same = true;
+        size_t n  = 0;
+        while (const char* r = file.next()) {
+            std::memcpy(record.data(), r, recordSize);
+            for (size_t j = 0; j < record.size(); ++j) {
+                same = same && record[j] == n * 3 + j;
+            }
+            n++;
+        }
+        EXPECT(same);
+        EXPECT(n == count);
+        EXPECT(file.next() == nullptr);
+    }
+
+    SECTION("Empty") {
+        SQLSpillFile file(8);
+        file.rewind();
+        EXPECT(file.next() == nullptr);
+    }
+
+    EXPECT(dir.files() == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Keys with many repeats, some missing, the sequence number telling the order of arrival
+std::vector<Row> rows(size_t n) {
+    const char* names[] = {"alpha", "beta", "gamma", "delta  ", "", "epsilon"};
+    std::vector<Row> result;
+    for (size_t i = 0; i < n; ++i) {
+        double key = i % 11 == 0 ? MISSING : double((i * 7919) % 23) - 11.5;
+        result.push_back(Row{key, names[(i * 31) % 6], long(i)});
+    }
+    return result;
+}
+
+std::vector<std::string> sorted(std::vector<Row> rows, bool ascending, const std::vector<std::string>& columns) {
+    // Missing first ascending, last descending, stable
+    std::stable_sort(rows.begin(), rows.end(), [ascending](const Row& a, const Row& b) {
+        double ka = a.key == MISSING ? -std::numeric_limits<double>::infinity() : a.key;
+        double kb = b.key == MISSING ? -std::numeric_limits<double>::infinity() : b.key;
+        return ascending ? ka < kb : ka > kb;
+    });
+    std::vector<std::string> result;
+    for (const auto& r : rows) {
+        result.push_back(text(r, columns));
+    }
+    return result;
+}
+
+CASE("ORDER BY merges more runs than are open at once, keeping equal keys in order of arrival") {
+    SpillDirectory dir;
+
+    // A run per row: 200 runs are merged by 64
+    const auto input = rows(200);
+    const std::vector<std::string> columns{"key", "seq"};
+
+    for (bool ascending : {true, false}) {
+        EXPECT(select(input, columns, false, {{"key", ascending}}) == sorted(input, ascending, columns));
+        EXPECT(select(input, columns, false, {{"key", ascending}}, size_t(-1), "4096")
+               == sorted(input, ascending, columns));
+        EXPECT(select(input, columns, false, {{"key", ascending}}, size_t(-1), "1000000000")
+               == sorted(input, ascending, columns));
+    }
+
+    // Strings widening in the middle, while already spilled
+    auto widened = input;
+    for (size_t i = 100; i < widened.size(); i += 3) {
+        widened[i].name = "a-longer-string";
+    }
+    std::vector<Row> byName(widened);
+    std::stable_sort(byName.begin(), byName.end(), [](const Row& a, const Row& b) {
+        auto trim = [](const std::string& s) { return s.substr(0, s.find_last_not_of(' ') + 1); };
+        return trim(a.name) < trim(b.name);
+    });
+    std::vector<std::string> expected;
+    for (const auto& r : byName) {
+        expected.push_back(text(r, {"name", "seq"}));
+    }
+    EXPECT(select(widened, {"name", "seq"}, false, {{"name", true}}, 100) == expected);
+
+    EXPECT(dir.files() == 0);
+}
+
+/// The distinct rows, in the order they first arrived
+std::vector<std::string> distinct(const std::vector<Row>& rows, const std::vector<std::string>& columns) {
+    std::set<std::string> seen;
+    std::vector<std::string> result;
+    for (const auto& r : rows) {
+        std::string t = text(r, columns);
+        if (seen.insert(t).second) {
+            result.push_back(t);
+        }
+    }
+    return result;
+}
+
+CASE("DISTINCT keeps the order of first arrival through the spilled partitions") {
+    SpillDirectory dir;
+
+    const auto input = rows(2000);
+
+    for (const char* memory : {"1", "256", "1000000000"}) {
+        EXPECT(select(input, {"key"}, true, {}, size_t(-1), memory) == distinct(input, {"key"}));
+        EXPECT(select(input, {"key", "name"}, true, {}, size_t(-1), memory) == distinct(input, {"key", "name"}));
+    }
+
+    SECTION("Strings widening while spilled") {
+        auto widened = input;
+        for (size_t i = 1000; i < widened.size(); i += 5) {
+            widened[i].name = "a-longer-string";
+        }
+
+        for (const char* memory : {"1", "256", "1000000000"}) {
+            EXPECT(select(widened, {"name", "key"}, true, {}, 1000, memory) == distinct(widened, {"name", "key"}));
+        }
+    }
+
+    EXPECT(dir.files() == 0);
+}
+
+CASE("DISTINCT partitions again the partitions with more distinct rows than fit in memory") {
+    SpillDirectory dir;
+
+    // Many distinct rows, each repeated, so that the partitions spilled are themselves beyond the budget
+    std::vector<Row> input = rows(4000);
+    for (auto& r : input) {
+        r.seq %= 1000;
+    }
+
+    for (const char* memory : {"1", "4096", "1000000000"}) {
+        EXPECT(select(input, {"seq"}, true, {}, size_t(-1), memory) == distinct(input, {"seq"}));
+        EXPECT(select(input, {"seq", "name"}, true, {}, size_t(-1), memory) == distinct(input, {"seq", "name"}));
+    }
+
+    EXPECT(dir.files() == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,312 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/serialisation/Reanimator.h"
+#include "eckit/serialisation/Stream.h"
+#include "eckit/transaction/TxnJournal.h"
+#include "eckit/transaction/TxnLog.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class TestTask : public TxnEvent {
+public:
+    TestTask(const std::string& payload) :
+        payload_(payload) {}
+
+    TestTask(Stream& s) :
+        TxnEvent(s) {
+        s >> payload_;
+    }
+
+    void encode(Stream& s) const override {
+        TxnEvent::encode(s);
+        s << payload_;
+    }
+
+    const ReanimatorBase& reanimator() const override { return reanimator_; }
+    static const ClassSpec& classSpec() { return classSpec_; }
+
+    std::string payload_;
+
+private:
+    static ClassSpec classSpec_;
+    static Reanimator<TestTask> reanimator_;
+};
+
+ClassSpec TestTask::classSpec_ = {
+    &TxnEvent::classSpec(),
+    "TestTask",
+};
+Reanimator<TestTask> TestTask::reanimator_;
+
+struct Collector : public TxnRecoverer<TestTask>, public TxnFinder<TestTask> {
+    std::map<TxnID, std::string> tasks;
+    bool active_ = true;
+    bool old_    = false;
+
+    void push(TestTask* t) override {
+        tasks[t->transactionID()] = t->payload_;
+        delete t;
+    }
+    bool found(TestTask& t) override {
+        tasks[t.transactionID()] = t.payload_;
+        return false;
+    }
+    bool active() override { return active_; }
+    bool old() override { return old_; }
+};
+
+void cleanup(const PathName& path) {
+    std::vector<PathName> files;
+    std::vector<PathName> dirs;
+    path.childrenRecursive(files, dirs);
+    for (const auto& f : files) {
+        f.unlink();
+    }
+    std::reverse(dirs.begin(), dirs.end());
+    for (const auto& d : dirs) {
+        d.rmdir();
+    }
+    path.rmdir();
+}
+
+std::string uniqueName(const char* what) {
+    std::ostringstream s;
+    s << "eckit_test_txnlog_" << what << "_" << ::getpid();
+    return s.str();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Journal keeps the semantics of the transaction files") {
+    ::setenv("ECKIT_TXN_LOG_TYPE", "Journal", 1);
+
+    std::string name = uniqueName("journal");
+    PathName path    = std::string("~/txn/") + name;
+
+    const size_t nthreads = 4;
+    const size_t ntasks   = 50;
+
+    std::map<TxnID, std::string> active;
+    std::map<TxnID, std::string> ended;
+
+    {
+        TxnLog<TestTask> log(name);
+
+        // Concurrent transactions share the syncs
+        std::vector<std::vector<std::unique_ptr<TestTask> > > tasks(nthreads);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < nthreads; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < ntasks; ++i) {
+                    std::unique_ptr<TestTask> task(new TestTask("task " + std::to_string(t * ntasks + i)));
+                    log.begin(*task);
+                    if (i % 2) {
+                        log.end(*task, true);
+                    }
+                    else {
+                        task->payload_ += " updated";
+                        log.update(*task);
+                    }
+                    tasks[t].push_back(std::move(task));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        for (const auto& v : tasks) {
+            for (const auto& task : v) {
+                bool isActive = task->payload_.find("updated") != std::string::npos;
+                (isActive ? active : ended)[task->transactionID()] = task->payload_;
+                EXPECT(log.exists(*task) == isActive);
+            }
+        }
+
+        EXPECT(active.size() + ended.size() == nthreads * ntasks);
+
+        Collector found;
+        log.find(found);
+        EXPECT(found.tasks == active);
+
+        Collector old;
+        old.active_ = false;
+        old.old_    = true;
+        log.find(old);
+        EXPECT(old.tasks == ended);
+    }
+
+    // Another process starting
+    {
+        TxnLog<TestTask> log(name);
+
+        Collector recovered;
+        log.recover(recovered, false, 0);
+        EXPECT(recovered.tasks == active);
+
+        // New transactions do not reuse IDs
+        TestTask task("new");
+        log.begin(task);
+        EXPECT(task.transactionID() > active.rbegin()->first);
+        EXPECT(task.transactionID() > ended.rbegin()->first);
+        log.end(task, false);
+    }
+
+    ::unsetenv("ECKIT_TXN_LOG_TYPE");
+    cleanup(path);
+}
+
+CASE("Journal compaction moves ended transactions to done/") {
+    PathName path = std::string("~/txn/") + uniqueName("compaction");
+    path.mkdir();
+
+    std::map<TxnID, std::string> payloads;
+    {
+        TxnJournal journal(path);
+        for (TxnID id = 1; id <= 100; ++id) {
+            std::string payload = "payload " + std::to_string(id);
+            payloads[id]        = payload;
+            journal.append(TxnJournal::BEGIN, id, payload.data(), payload.size());
+        }
+        for (TxnID id = 1; id <= 100; id += 2) {
+            journal.append(TxnJournal::END, id, payloads[id].data(), payloads[id].size());
+        }
+    }
+
+    TxnJournal::Entries before;
+    TxnJournal::Entries after;
+    {
+        // Segments left by a process with our pid are ours, and sealed
+        TxnJournal journal(path);
+        journal.scan(before);
+        journal.compact();
+        journal.scan(after);
+    }
+
+    EXPECT(before.size() == 100);
+    EXPECT(after.size() == 50);
+
+    for (const auto& e : after) {
+        EXPECT(e.second.active);
+        EXPECT(e.first % 2 == 0);
+        EXPECT(e.second.payload == payloads[e.first]);
+        EXPECT(e.second.created == before[e.first].created);
+    }
+
+    std::vector<PathName> done;
+    PathName::match(path + "/done/[0-9]*", done);
+    EXPECT(done.size() >= 1);
+
+    size_t backups = 0;
+    for (const auto& d : done) {
+        backups += size_t(d.size());
+    }
+    size_t expected = 0;
+    for (TxnID id = 1; id <= 100; id += 2) {
+        expected += payloads[id].size();
+    }
+    EXPECT(backups == expected);
+
+    cleanup(path);
+}
+
+CASE("Journal sees the transactions ended by another process, while both compact") {
+    PathName path = std::string("~/txn/") + uniqueName("processes");
+    path.mkdir();
+
+    const TxnID n = 200;
+    const std::string payload("payload");
+
+    {
+        TxnJournal journal(path);
+        for (TxnID id = 1; id <= n; ++id) {
+            journal.append(TxnJournal::BEGIN, id, payload.data(), payload.size());
+        }
+        EXPECT(journal.active(1));
+
+        pid_t pid = ::fork();
+        ASSERT(pid >= 0);
+        if (pid == 0) {
+            int status = 0;
+            try {
+                TxnJournal other(path);
+                for (TxnID id = 1; id <= n; ++id) {
+                    other.append(TxnJournal::END, id, payload.data(), payload.size());
+                    if (id % 10 == 0) {
+                        other.compact();
+                    }
+                }
+            }
+            catch (...) {
+                status = 1;
+            }
+            ::_exit(status);
+        }
+
+        // Once seen ended, a transaction stays ended, whatever the compactions in between
+        std::set<TxnID> ended;
+        int status = 0;
+        for (bool running = true; running;) {
+            running = ::waitpid(pid, &status, WNOHANG) == 0;
+
+            journal.compact();
+
+            TxnJournal::Entries entries;
+            journal.scan(entries);
+            for (const auto& id : ended) {
+                auto j = entries.find(id);
+                EXPECT(j == entries.end() || !j->second.active);
+            }
+            for (const auto& e : entries) {
+                if (!e.second.active) {
+                    ended.insert(e.first);
+                }
+            }
+        }
+
+        EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+        for (TxnID id = 1; id <= n; ++id) {
+            EXPECT(!journal.active(id));
+        }
+    }
+
+    cleanup(path);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
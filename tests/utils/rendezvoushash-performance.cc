@@ -0,0 +1,118 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <iostream>
+
+#include "eckit/log/BigNum.h"
+#include "eckit/log/Seconds.h"
+#include "eckit/log/Timer.h"
+#include "eckit/utils/RendezvousHash.h"
+#include "eckit/utils/Translator.h"
+#include "eckit/utils/WeightedRendezvousHash.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::vector<RendezvousHash::Key> makeKeys(size_t n) {
+    eckit::Translator<size_t, std::string> toStr;
+
+    std::vector<RendezvousHash::Key> keys;
+    keys.reserve(n);
+
+    RendezvousHash::Key key{{"class", "od"}, {"expver", "0001"}, {"stream", "oper"}, {"type", "fc"}, {"param", "130.128"}};
+    for (size_t i = 0; i < n; ++i) {
+        key["step"]  = toStr(i / 137);
+        key["level"] = toStr(i % 137);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+static std::vector<std::string> makeNodes(size_t n) {
+    eckit::Translator<size_t, std::string> toStr;
+
+    std::vector<std::string> nodes;
+    for (size_t i = 0; i < n; ++i) {
+        nodes.push_back("node" + toStr(i));
+    }
+    return nodes;
+}
+
+template <typename F>
+void time(const std::string& what, size_t n, F f) {
+    eckit::Timer timer;
+    timer.start();
+
+    size_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += f(i);
+    }
+
+    timer.stop();
+
+    std::cout << " - " << what << ": " << BigNum(n) << " in " << Seconds(timer.elapsed()) << ", "
+              << BigNum(size_t(n / timer.elapsed())) << "/s"
+              << " (" << (1e9 * timer.elapsed() / n) << " ns each, checksum " << sum << ")" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Test rendezvous hash performance") {
+
+    const size_t nkeys = 100000;
+
+    std::vector<RendezvousHash::Key> keys = makeKeys(nkeys);
+
+    time("WeightedRendezvousHash::hashKey", nkeys,
+         [&](size_t i) { return size_t(WeightedRendezvousHash::hashKey(keys[i])); });
+
+    time("WeightedRendezvousHash::jumpHash(1024)", nkeys, [&](size_t i) {
+        return WeightedRendezvousHash::jumpHash(WeightedRendezvousHash::hashKey(keys[i]), 1024);
+    });
+
+    for (size_t nnodes : {4, 16, 64}) {
+
+        std::cout << nnodes << " nodes" << std::endl;
+
+        std::vector<std::string> nodes = makeNodes(nnodes);
+
+        RendezvousHash md5(nodes);
+        WeightedRendezvousHash xxh(nodes);
+
+        std::vector<size_t> indices;
+
+        time("RendezvousHash::hashOrder (md5)", nkeys / 10, [&](size_t i) {
+            md5.hashOrder(keys[i], indices);
+            return indices[0];
+        });
+
+        time("WeightedRendezvousHash::hashOrder", nkeys, [&](size_t i) {
+            xxh.hashOrder(keys[i], indices);
+            return indices[0];
+        });
+
+        time("WeightedRendezvousHash::select", nkeys, [&](size_t i) { return xxh.select(keys[i]); });
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
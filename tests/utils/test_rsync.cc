@@ -196,6 +196,99 @@ CASE("File sync") {
         target.unlink();
 }
 
+static void fill(const PathName& path, size_t lines, size_t skip) {
+    std::ofstream ofs(path.localPath());
+    for (size_t i = 0; i < lines; ++i) {
+        if (skip && i % skip == 0) {
+            ofs << "Changed line " << i * 7 << std::endl;
+        }
+        ofs << "Line " << i << " of the quick brown fox jumping over the lazy dog" << std::endl;
+    }
+}
+
+CASE("Parallel file sync") {
+
+    // Small segments, so that files span many of them
+
+    Rsync rsync(false, 4, 4096);
+
+    PathName source = PathName::unique(PathName(LocalPathName::cwd()) / "test");
+    PathName target = PathName::unique(PathName(LocalPathName::cwd()) / "test");
+    PathName delta  = PathName::unique(PathName(LocalPathName::cwd()) / "test");
+
+    SECTION("File sync to inexistent target") {
+        fill(source, 1000, 0);
+
+        EXPECT_NO_THROW(rsync.syncData(source, target));
+        EXPECT(same_contents(source, target));
+        EXPECT(rsync.sameContents(source, target));
+    }
+
+    SECTION("File sync to shorter target") {
+        fill(source, 2000, 13);
+        fill(target, 500, 0);
+
+        EXPECT(!rsync.sameContents(source, target));
+        EXPECT_NO_THROW(rsync.syncData(source, target));
+        EXPECT(same_contents(source, target));
+    }
+
+    SECTION("File sync to longer target") {
+        fill(source, 1000, 17);
+        fill(target, 3000, 0);
+
+        EXPECT_NO_THROW(rsync.syncData(source, target));
+        EXPECT(same_contents(source, target));
+    }
+
+    SECTION("Contents comparison") {
+        fill(source, 1000, 0);
+        fill(target, 1000, 0);
+        EXPECT(rsync.sameContents(source, target));
+
+        // Same size, one byte different, in the last segment
+        {
+            std::fstream f(target.localPath(), std::ios::in | std::ios::out);
+            f.seekp(-10, std::ios::end);
+            f.put('#');
+        }
+        EXPECT(source.size() == target.size());
+        EXPECT(!rsync.sameContents(source, target));
+    }
+
+    SECTION("Segmented delta") {
+        fill(source, 2000, 11);
+        fill(target, 1500, 0);
+
+        {
+            std::unique_ptr<DataHandle> out(delta.fileHandle());
+            out->openForWrite(0);
+            AutoClose closer(*out);
+            EXPECT_NO_THROW(rsync.computeSegmentedDelta(target, source, *out));
+        }
+
+        std::unique_ptr<DataHandle> in(target.fileHandle());
+        in->openForRead();
+        std::unique_ptr<DataHandle> dlt(delta.fileHandle());
+        dlt->openForRead();
+        MemoryHandle out;
+        out.openForWrite(0);
+        EXPECT_NO_THROW(rsync.updateData(*in, *dlt, out));
+
+        std::unique_ptr<DataHandle> ref(source.fileHandle());
+        EXPECT(ref->compare(out));
+    }
+
+    if (source.exists())
+        source.unlink();
+
+    if (target.exists())
+        target.unlink();
+
+    if (delta.exists())
+        delta.unlink();
+}
+
 CASE("Directory sync") {
 
     Rsync rsync;
@@ -0,0 +1,193 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+
+#include "eckit/types/Types.h"
+#include "eckit/utils/Translator.h"
+#include "eckit/utils/WeightedRendezvousHash.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+typedef WeightedRendezvousHash::Key Key;
+
+static std::vector<Key> makeKeys(size_t n) {
+    eckit::Translator<size_t, std::string> toStr;
+
+    std::vector<Key> keys;
+    keys.reserve(n);
+
+    Key key{{"class", "od"}, {"stream", "oper"}, {"type", "fc"}};
+    for (size_t i = 0; i < n; ++i) {
+        key["step"]  = toStr(i / 100);
+        key["level"] = toStr(i % 100);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+CASE("test_eckit_utils_weighted_rendezvous_hash_order") {
+    std::vector<std::string> nodes = {"node01", "node02", "node03", "node04"};
+
+    WeightedRendezvousHash rendezvous(nodes);
+
+    Key key{{"class", "od"}, {"stream", "oper"}, {"type", "fc"}, {"level", "1"}};
+
+    std::vector<size_t> indices;
+    std::vector<std::string> node_order;
+
+    rendezvous.hashOrder(key, indices);
+    rendezvous.hashOrder(key, node_order);
+
+    EXPECT(indices.size() == 4);
+    EXPECT(node_order.size() == 4);
+    EXPECT(rendezvous.select(key) == indices[0]);
+    EXPECT(rendezvous.selectNode(key) == node_order[0]);
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        EXPECT(nodes[indices[i]] == node_order[i]);
+    }
+
+    std::sort(indices.begin(), indices.end());
+    EXPECT(indices == std::vector<size_t>({0, 1, 2, 3}));
+}
+
+CASE("test_eckit_utils_weighted_rendezvous_hash_key") {
+    Key key1{{"class", "od"}, {"stream", "oper"}};
+    Key key2{{"class", "o"}, {"dstream", "oper"}};  // same characters, different split
+    Key key3{{"class", "od"}, {"stream", "oper"}};
+
+    EXPECT(WeightedRendezvousHash::hashKey(key1) == WeightedRendezvousHash::hashKey(key3));
+    EXPECT(WeightedRendezvousHash::hashKey(key1) != WeightedRendezvousHash::hashKey(key2));
+    EXPECT_NO_THROW(WeightedRendezvousHash::hashKey(Key()));
+}
+
+CASE("test_eckit_utils_weighted_rendezvous_hash_distribution") {
+    std::vector<std::string> nodes = {"node01", "node02", "node03", "node04", "node05", "node06", "node07"};
+
+    WeightedRendezvousHash rendezvous(nodes);
+
+    std::vector<size_t> counts(nodes.size(), 0);
+    for (const auto& key : makeKeys(70000)) {
+        counts[rendezvous.select(key)]++;
+    }
+
+    // Test that we have << roughly >> similar counts on all the nodes. (Very stochastic).
+    for (size_t count : counts) {
+        EXPECT(9500 < count && count < 10500);
+    }
+}
+
+CASE("test_eckit_utils_weighted_rendezvous_hash_weights") {
+    std::vector<std::pair<std::string, double> > nodes{{"small", 1.}, {"medium", 2.}, {"large", 4.}, {"none", 0.}};
+
+    WeightedRendezvousHash rendezvous(nodes);
+
+    std::map<std::string, size_t> counts;
+    for (const auto& key : makeKeys(70000)) {
+        counts[rendezvous.selectNode(key)]++;
+    }
+
+    EXPECT(counts["none"] == 0);
+    EXPECT(9000 < counts["small"] && counts["small"] < 11000);
+    EXPECT(19000 < counts["medium"] && counts["medium"] < 21000);
+    EXPECT(39000 < counts["large"] && counts["large"] < 41000);
+
+    EXPECT(rendezvous.setWeight("none", 1.));
+    EXPECT(!rendezvous.setWeight("unknown", 1.));
+    EXPECT_THROWS_AS(rendezvous.setWeight("none", -1.), BadParameter);
+}
+
+CASE("test_eckit_utils_weighted_rendezvous_hash_add_remove_node") {
+    WeightedRendezvousHash rendezvous(std::vector<std::string>{"node01", "node02", "node03"});
+
+    std::vector<Key> keys = makeKeys(10000);
+
+    std::vector<std::string> before;
+    for (const auto& key : keys) {
+        before.push_back(rendezvous.selectNode(key));
+    }
+
+    // Adding a node only moves keys onto the new node
+
+    EXPECT(rendezvous.addNode("node04"));
+    EXPECT(!rendezvous.addNode("node04"));
+    EXPECT(rendezvous.size() == 4);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        std::string node = rendezvous.selectNode(keys[i]);
+        if (node != before[i]) {
+            EXPECT(node == "node04");
+            moved++;
+        }
+    }
+    EXPECT(2000 < moved && moved < 3000);
+
+    // Removing it again restores the original placement
+
+    EXPECT(rendezvous.removeNode("node04"));
+    EXPECT(!rendezvous.removeNode("node04"));
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT(rendezvous.selectNode(keys[i]) == before[i]);
+    }
+}
+
+CASE("test_eckit_utils_weighted_rendezvous_hash_throws_empty_node_list") {
+    WeightedRendezvousHash rendezvous;
+
+    Key key{{"class", "od"}};
+    std::vector<size_t> indices;
+
+    EXPECT_THROWS_AS(rendezvous.select(key), BadParameter);
+    EXPECT_THROWS_AS(rendezvous.hashOrder(key, indices), BadParameter);
+
+    rendezvous.addNode("node01");
+    EXPECT(rendezvous.select(key) == 0);
+}
+
+CASE("test_eckit_utils_jump_hash") {
+    std::vector<Key> keys = makeKeys(10000);
+
+    std::vector<size_t> counts(10, 0);
+    for (const auto& key : keys) {
+        uint64_t h = WeightedRendezvousHash::hashKey(key);
+        size_t b   = WeightedRendezvousHash::jumpHash(h, 10);
+        EXPECT(b < 10);
+        counts[b]++;
+
+        // Growing the number of buckets only moves keys onto the new bucket
+        size_t b11 = WeightedRendezvousHash::jumpHash(h, 11);
+        EXPECT(b11 == b || b11 == 10);
+    }
+
+    for (size_t count : counts) {
+        EXPECT(800 < count && count < 1200);
+    }
+
+    EXPECT(WeightedRendezvousHash::jumpHash(12345, 1) == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}